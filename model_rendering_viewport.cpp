@@ -33,12 +33,16 @@
 #include <string.h>
 #include <math.h>
 #include <time.h>
+#include <ctype.h>
+#include <errno.h>
 #include <vector>
 #include <string>
 #include <float.h>
 #include <algorithm>
 #include <memory>
 #include <map>
+#include <future>
+#include <random>
 
 // ImGui
 #include "imgui.h"
@@ -59,11 +63,68 @@
 // stb_image
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb_image_write.h"
 
 // tinyobjloader
 #define TINYOBJLOADER_IMPLEMENTATION
 #include "tiny_obj_loader.h"
 
+// Shared normal/tangent generation
+#include "mesh_normals.h"
+
+// Mesh efficiency statistics
+#include "mesh_analysis.h"
+
+// GL command capture (F12 captures one frame, Shift+F12 ten frames)
+#include "gl_capture.h"
+
+// Tracked GPU allocations and leak report
+#include "gpu_memory.h"
+
+// Per-frame arena for transient geometry and UI lists
+#define FRAME_ARENA_IMPLEMENTATION
+#include "frame_arena.h"
+
+// CPU trace zones (F11 exports a Chrome trace)
+#include "cpu_trace.h"
+
+// Camera flythrough recording and benchmark playback
+#include "camera_path.h"
+
+// Change notification for model source files
+#include "file_watcher.h"
+
+// Chunked octree meshes streamed from disk
+#include "out_of_core_mesh.h"
+
+// Screenshots and video through asynchronous pixel readback (F10 screenshot, F9 record)
+#include "frame_recorder.h"
+
+// GL submission on its own thread, fed with double-buffered frame packets
+#include "render_thread.h"
+
+// Buffer uploads for imported meshes on a shared context, fenced before first use
+#include "upload_thread.h"
+
+// Index-based half-edge meshes for polygon editing, uploaded by dirty range
+#include "half_edge_mesh.h"
+
+// Catmull-Clark and Loop subdivision surfaces evaluated from stencil tables
+#include "subdivision.h"
+
+// Progressive CPU path tracer, for the preview mode and --path-trace stills
+#include "path_tracer.h"
+
+// Lightmap baking with automatic UV charts, traced against the path tracer's trees
+#include "lightmap.h"
+
+// Ambient occlusion baked into an extra vertex attribute at import
+#include "vertex_occlusion.h"
+
+// Merged, simplified proxies drawn in place of distant clusters of static objects
+#include "hlod.h"
+
 // Simple GLB loader
 struct GLBModel {
     std::vector<float> vertices;
@@ -85,6 +146,15 @@ struct GLBModel {
 #define COLOR_SUCCESS ImVec4(0.2f, 0.8f, 0.4f, 1.00f)
 #define COLOR_WARNING ImVec4(1.0f, 0.8f, 0.2f, 1.00f)
 
+// Analytic primitive an object was created from (drives the tessellation path)
+enum PrimitiveShape {
+    SHAPE_MESH,
+    SHAPE_SPHERE,
+    SHAPE_CYLINDER,
+    SHAPE_CONE,
+    SHAPE_COUNT
+};
+
 // 3D Object structure with transform controls
 struct GameObject {
     GLuint vao, vbo, ebo;
@@ -96,15 +166,20 @@ struct GameObject {
     glm::vec3 scale;
     glm::vec3 color;
     char name[256];
+    char sourcePath[1024];  // file the mesh was imported from, empty for primitives
     bool visible;
     bool selected;
+    bool bakedOcclusion;    // vbo carries one occlusion float per vertex after the vertices
+    bool isStatic;          // may be merged into an HLOD proxy with its neighbours
+    PrimitiveShape shape;
     
     GameObject() : position(0.0f), rotation(0.0f), scale(1.0f), 
-                   color(0.8f, 0.8f, 0.8f), visible(true), selected(false),
-                   vao(0), vbo(0), ebo(0), vertexCount(0), indexCount(0) {
+                   color(0.8f, 0.8f, 0.8f), visible(true), selected(false), bakedOcclusion(false), isStatic(true),
+                   shape(SHAPE_MESH), vao(0), vbo(0), ebo(0), vertexCount(0), indexCount(0) {
         bboxMin = glm::vec3(-0.5f);
         bboxMax = glm::vec3(0.5f);
         strcpy_s(name, "Unnamed Object");
+        sourcePath[0] = '\0';
     }
     
     glm::mat4 getModelMatrix() const {
@@ -163,12 +238,566 @@ bool showStatsWindow = true;
 bool showTransformWindow = true;
 bool showLightWindow = true;
 bool showObjectListWindow = true;
+bool showMeshInspectorWindow = true;
+bool showGpuMemoryWindow = true;
+bool showCameraPathWindow = true;
+bool showOutOfCoreWindow = true;
+bool showCaptureWindow = true;
+bool showMeshEditWindow = true;
+bool showSubdivisionWindow = true;
+bool showPathTraceWindow = true;
+bool showLightmapWindow = true;
+bool showHlodWindow = true;
 
-// Viewport rendering variables
+// Hardware tessellation (GL 4.0) for the analytic primitives
+struct TessPatchMesh {
+    GLuint vao = 0, vbo = 0, ebo = 0;
+    int indexCount = 0;
+};
+static TessPatchMesh tessPatchMeshes[SHAPE_COUNT];
+static bool tessellationSupported = false;
+static bool useTessellation = false;
+static float tessEdgePixels = 8.0f;
+
+// Viewport rendering variables (the whole area; quad view splits it between the scene views)
 static ImVec2 viewportPos(0, 0);
 static ImVec2 viewportSize(0, 0);
-static GLuint viewportFramebuffer = 0;
-static GLuint viewportTexture = 0;
+
+// Scene views. View 0 is the perspective view driven by the orbit camera; quad view adds
+// top, front and side orthographic views that pan and zoom independently.
+enum SceneViewType {
+    VIEW_PERSPECTIVE,
+    VIEW_TOP,
+    VIEW_FRONT,
+    VIEW_SIDE,
+    VIEW_TYPE_COUNT
+};
+
+struct SceneView {
+    SceneViewType type = VIEW_PERSPECTIVE;
+    glm::vec3 orthoCenter = glm::vec3(0.0f);    // orthographic views only
+    float orthoHeight = 12.0f;                  // world units from bottom to top edge
+    
+    // Filled every frame
+    ImVec2 screenPos, screenSize;               // where the image is shown
+    glm::mat4 view, projection;
+    glm::vec3 eye;
+    std::vector<int> visibleItems;              // indices into sceneDrawList that survive culling
+};
+
+// Framebuffer a view is drawn into. Created at startup so the texture name the UI shows
+// never changes; after that only the render thread touches it (to resize it).
+struct SceneViewTarget {
+    GLuint framebuffer = 0, texture = 0, renderbuffer = 0;
+    int width = 0, height = 0;                  // current attachment size
+};
+
+static const int MAX_SCENE_VIEWS = 4;
+static SceneView sceneViews[MAX_SCENE_VIEWS];
+static SceneViewTarget sceneViewTargets[MAX_SCENE_VIEWS];
+static bool quadView = false;
+static int activeSceneView = 0;                 // view under the mouse, receives camera input
+
+// Scene traversal shared by all views: transforms and bounds are computed once per frame.
+// Items carry copies of what drawing needs, since objects can change before they are drawn.
+struct SceneDrawItem {
+    GLuint vao;
+    int indexCount;
+    PrimitiveShape shape;
+    glm::vec3 color;
+    glm::mat4 model;
+    glm::vec3 center;                           // world-space bounding sphere
+    float radius;
+    bool tessellated;
+    bool lightmapped;                           // vao is the baked copy with lightmap uvs
+    glm::vec4 lightmapScaleOffset;              // the object's block of the atlas: uv * xy + zw
+    int hlodProxy;                              // item drawn instead when the cluster is small on screen,
+                                                // -1 if none; a proxy refers to itself
+};
+static std::vector<SceneDrawItem> sceneDrawList;
+static const size_t PARALLEL_CULL_THRESHOLD = 4096;    // below this, worker threads cost more than they save
+
+// Helper geometry, created on first use
+static GLuint gridVAO = 0, gridVBO = 0, gridColorVBO = 0;
+static GLuint axesVAO = 0, axesVBO = 0, axesColorVBO = 0;
+static GLuint gizmoVAO = 0, gizmoVBO = 0, gizmoColorVBO = 0;
+
+// Mesh inspector state (stats are computed on a worker thread)
+enum MeshOptimizeAction {
+    OPTIMIZE_WELD,
+    OPTIMIZE_CLEANUP,
+    OPTIMIZE_VERTEX_CACHE,
+    OPTIMIZE_VERTEX_FETCH,
+    OPTIMIZE_ALL
+};
+
+struct OptimizedMesh {
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+};
+
+struct MeshInspectorState {
+    std::shared_ptr<GameObject> statsObject;    // object the current stats describe
+    MeshStats stats;
+    bool statsValid = false;
+    
+    std::shared_ptr<GameObject> analyzingObject;
+    std::future<MeshStats> analyzeJob;
+    
+    std::shared_ptr<GameObject> optimizingObject;
+    std::future<OptimizedMesh> optimizeJob;
+};
+static MeshInspectorState meshInspector;
+
+// Polygon editing of one object at a time. The half-edge mesh is the master copy;
+// the object gets buffers of its own with room to grow, patched with the ranges
+// each edit dirtied.
+struct MeshEditState {
+    std::shared_ptr<GameObject> object;
+    HalfEdgeMesh mesh;
+    std::vector<int> selectedFaces;
+    
+    std::shared_ptr<GameObject> buildingObject;     // read back, waiting for the half-edge build
+    std::future<HalfEdgeMesh> buildJob;
+    
+    size_t vertexCapacity = 0;                      // what the object's buffers have room for
+    size_t indexCapacity = 0;
+    float extrudeDistance = 0.25f;                  // world units
+    glm::vec3 moveOffset = glm::vec3(0.0f);         // drag widget value, applied as deltas
+    
+    float lastEditMs = 0.0f;                        // edit and upload together
+    size_t lastUploadBytes = 0;
+    int lastUploadCalls = 0;
+};
+static MeshEditState meshEdit;
+
+// Subdivision surfaces drawn in place of objects' meshes. The object's own mesh is the
+// control cage; the refined surface has buffers of its own, refilled when the level changes
+// and patched by dirty range when mesh edit moves cage vertices.
+struct SubdivisionEntry {
+    std::shared_ptr<GameObject> object;
+    SubdivisionCage cage;                           // quads merged back; Loop fans them again
+    std::future<SubdivisionCage> cageJob;           // read back, waiting for the weld
+    GLuint cageVbo = 0;                             // buffer the cage came from, to notice reloads
+    float deviation = 0.0f;                         // cage to limit surface, object units
+    
+    SubdivisionScheme scheme = SUBDIVISION_CATMULL_CLARK;
+    float creaseAngle = 180.0f;                     // degrees; 180 creases open edges only
+    bool adaptive = true;
+    int fixedLevel = 2;
+    
+    // Surfaces built for the current cage topology, kept so zooming back and forth is free
+    std::unique_ptr<SubdivisionSurface> levels[SubdivisionSurface::MAX_LEVEL + 1];
+    int level = -1;                                 // uploaded, -1 until the first build lands
+    int wantedLevel = 0;
+    int topology = 0;                               // bumped when faces, scheme or creases change
+    
+    std::future<std::unique_ptr<SubdivisionSurface>> buildJob;
+    int buildLevel = 0;
+    int buildTopology = 0;
+    std::chrono::steady_clock::time_point buildStart;
+    float buildMs = 0.0f;
+    
+    GLuint vao = 0, vbo = 0, ebo = 0;
+    size_t vertexCapacity = 0, indexCapacity = 0;
+    int indexCount = 0;
+};
+
+struct SubdivisionState {
+    static const size_t MAX_FACES = 1 << 20;        // adaptive or not, no level goes past this
+    
+    std::vector<std::unique_ptr<SubdivisionEntry>> entries;
+    std::vector<std::unique_ptr<SubdivisionEntry>> retired;    // removed while a worker still runs
+    float pixelTolerance = 0.5f;                    // adaptive levels: deviation allowed on screen
+    int maxLevel = 4;
+    
+    float lastUpdateMs = 0.0f;                      // incremental re-evaluation and upload
+    size_t lastUpdateBytes = 0;
+};
+static SubdivisionState subdivision;
+
+// Path traced preview of the perspective view. CPU copies of the meshes are kept per vertex
+// buffer, so objects sharing a mesh (Duplicate, the stress scene) share one tree as well.
+struct PathTraceMesh {
+    int vertexCount = 0, indexCount = 0;            // to notice a buffer name reused for another mesh
+    int id = -1;                                    // PathTracer mesh
+};
+
+struct PathTraceState {
+    PathTracer tracer;
+    bool enabled = false;
+    int maxSamples = 256;
+    int maxBounces = 3;
+    bool groundPlane = true;
+    float exposure = 1.0f;
+    
+    std::map<GLuint, PathTraceMesh> meshes;
+    std::vector<int> staleMeshes;                   // rewritten in place, freed at the next restart
+    uint64_t sceneHash = 0;                         // everything the image depends on, 0 forces a restart
+    uint64_t imageVersion = 0;
+    bool displayed = false;                         // the perspective view shows the traced image
+    float restartMs = 0.0f;                         // gathering meshes and instances at the last restart
+};
+static PathTraceState pathTrace;
+
+// Baked lightmaps. A bake runs on a worker against its own copy of the scene; every baked
+// object gets a copy of its mesh with lightmap uvs and a block of one shared atlas. An object
+// draws from its lightmap only while it still matches what was baked (same buffer, transform
+// and light); otherwise it is lit as usual until the next bake, which redoes only those.
+struct LightmapEntry {
+    std::shared_ptr<GameObject> object;
+    GLuint sourceVbo = 0;                           // what was baked; 0 once the buffer was rewritten
+    int sourceIndexCount = 0;
+    glm::mat4 model = glm::mat4(1.0f);
+    uint64_t lightHash = 0;
+    uint64_t settingsHash = 0;
+    
+    int width = 0, height = 0;                      // block, and where it sits in the atlas
+    int atlasX = 0, atlasY = 0;
+    std::vector<float> texels;                      // kept for repacking the atlas
+    int chartCount = 0;
+    float texelsPerUnit = 0.0f;
+    bool fromCache = false;
+    
+    GLuint vao = 0, vbo = 0, ebo = 0;
+    int indexCount = 0;
+};
+
+// An object as it was when a bake started; objects not baked are still in the scene for shadows
+struct LightmapJobObject {
+    std::shared_ptr<GameObject> object;
+    GLuint sourceVbo = 0;
+    int sourceIndexCount = 0;
+    glm::mat4 model = glm::mat4(1.0f);
+    glm::vec3 color = glm::vec3(1.0f);
+    int mesh = -1;                                  // index into LightmapJob::meshes
+    bool bake = false;
+};
+
+struct LightmapJobMesh {
+    std::vector<float> vertices;                    // position + normal
+    std::vector<unsigned int> indices;
+};
+
+struct LightmapJob {
+    std::vector<LightmapJobObject> objects;
+    std::vector<LightmapJobMesh> meshes;            // read back once per buffer
+    LightmapSettings settings;
+    PathTracer::Settings light;
+    uint64_t lightHash = 0;
+    uint64_t settingsHash = 0;
+    std::string cacheDirectory;
+};
+
+struct LightmapResult {
+    LightmapJobObject source;
+    uint64_t lightHash = 0;                         // of the job, not of the scene when it lands
+    uint64_t settingsHash = 0;
+    LightmapBake bake;
+    bool valid = false;                             // false: the mesh could not be unwrapped
+    bool fromCache = false;
+};
+
+struct LightmapState {
+    LightmapSettings settings;
+    bool enabled = true;                            // draw baked objects from their lightmaps
+    std::string cacheDirectory = "lightmap_cache";
+    std::map<const GameObject*, std::unique_ptr<LightmapEntry>> entries;
+    
+    GLuint atlas = 0;
+    int atlasWidth = 0, atlasHeight = 0;
+    
+    std::future<std::vector<LightmapResult>> job;
+    std::atomic<bool> cancel{false};
+    std::atomic<int> objectsDone{0};
+    std::atomic<int> rowsDone{0};                   // of the object being traced
+    int objectsTotal = 0;
+    std::chrono::steady_clock::time_point bakeStart;
+    float bakeMs = 0.0f;
+    int traced = 0, loaded = 0, failed = 0;         // last bake
+};
+static LightmapState lightmaps;
+
+// HLOD: static objects grouped by grid cell (src/hlod.h), each cluster drawn as one merged,
+// simplified proxy in views where it covers fewer pixels than the threshold. Clusters are
+// regrouped while the draw list is built; one whose members moved, changed or left draws
+// its members until a worker has rebuilt its proxy, which waits until they hold still.
+struct HlodCluster {
+    int frame = -1;                                 // last frame the cluster had members
+    int memberCount = 0;
+    uint64_t membersHash = 0;                       // meshes, transforms and colors, this frame
+    uint64_t settledHash = 0;                       // membersHash over the last stableFrames frames
+    int stableFrames = 0;
+    int slot = -1;                                  // in buildSceneDrawList()'s cluster list, this frame only
+    int drawItem = -1;                              // proxy in sceneDrawList, this frame only
+    
+    uint64_t proxyHash = 0;                         // membersHash the proxy was built from, 0 for none
+    std::vector<GLuint> sourceBuffers;              // member meshes of the proxy
+    GLuint vao = 0, vbo = 0, ebo = 0;
+    int indexCount = 0;
+    size_t sourceTriangles = 0;
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = 0.0f;
+};
+
+// CPU copy of a member mesh, read back once per buffer
+struct HlodMesh {
+    int vertexCount = 0, indexCount = 0;            // to notice a buffer name reused for another mesh
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+};
+
+struct HlodResult {
+    uint64_t cell = 0;
+    uint64_t membersHash = 0;                       // of the members as they were gathered
+    HlodProxy proxy;
+    float buildMs = 0.0f;
+};
+
+struct HlodState {
+    static const int SETTLE_FRAMES = 30;            // members hold still this long before a rebuild
+    
+    bool enabled = true;
+    HlodSettings settings;
+    float screenPixels = 128.0f;                    // clusters smaller than this on screen draw their proxy
+    
+    std::unordered_map<uint64_t, HlodCluster> clusters;     // by cell
+    std::map<GLuint, std::shared_ptr<HlodMesh>> meshes;
+    int frame = 0;
+    
+    std::future<HlodResult> job;                    // one cluster at a time
+    int rebuilds = 0;
+    float lastBuildMs = 0.0f;
+};
+static HlodState hlod;
+
+// Camera path recording and playback; frame times are collected while playing
+struct CameraBenchmarkState {
+    static const int WARMUP_FRAMES = 30;       // rendered at the first pose, not measured
+    static const int QUERY_COUNT = 4;          // GPU timer queries in flight
+    
+    CameraPath path;
+    char pathFile[1024] = "";                   // defaults to next to the last imported model
+    
+    bool recording = false;
+    double recordStart = 0.0;
+    
+    bool playing = false;
+    int frameCount = 600;
+    int frame = 0;                              // negative during warm-up
+    double lastFrameStart = 0.0;
+    GLuint gpuQueries[QUERY_COUNT] = {};
+    std::vector<float> cpuMs;
+    std::vector<float> gpuMs;                   // filled on the render thread
+    
+    // Camera to restore when playback ends
+    glm::vec3 savedTarget;
+    float savedYaw = 0.0f, savedPitch = 0.0f, savedDistance = 0.0f;
+    
+    FrameTimingSummary summary;
+    bool hasSummary = false;
+};
+static CameraBenchmarkState cameraBenchmark;
+
+// Object list rows, sorted and filtered. Kept in step with `objects` by the
+// outlinerObject* notifications so the panel never rescans the scene per frame.
+enum OutlinerSortMode {
+    OUTLINER_SORT_SCENE,
+    OUTLINER_SORT_NAME
+};
+
+struct OutlinerState {
+    std::vector<int> rows;                      // object indices in display order
+    char filter[128] = "";
+    char activeFilter[128] = "";                // lowercase filter `rows` was built with
+    int sortMode = OUTLINER_SORT_SCENE;
+    size_t indexedObjects = 0;                  // objects.size() as last seen by the index
+    bool valid = false;
+    
+    int lastSelection = -1;                     // scrolled into view when the selection changes
+    int renameObject = -1;
+    char renameBuffer[256] = "";
+};
+static OutlinerState outliner;
+
+static const int STRESS_SCENE_SEED = 1234;      // fixed so runs are comparable
+
+// Imported OBJ geometry, produced on the loading thread and uploaded on the GL thread
+struct ObjMeshData {
+    std::vector<float> vertices;                // interleaved position + normal
+    std::vector<unsigned int> indices;
+    std::vector<float> occlusion;               // one per vertex, empty unless baked
+    glm::vec3 bboxMin = glm::vec3(0.0f), bboxMax = glm::vec3(0.0f);
+    uint64_t contentHash = 0;
+    std::string message;                        // error or parser warning
+    bool valid = false;
+    bool unchanged = false;                     // hot reload found the same contents as last time
+};
+
+// Re-import of model files changed on disk
+struct HotReloadState {
+    bool enabled = true;
+    std::map<std::string, uint64_t> contentHashes;  // source path -> contents of the last import
+    std::string reloadingPath;
+    std::future<ObjMeshData> job;
+    std::vector<std::string> queued;            // changed while another file was importing
+    bool uploading = false;                     // new mesh on its way to the GPU, swapped in when there
+    int reloads = 0;
+};
+static HotReloadState hotReload;
+
+// Ambient occlusion baked into vertices as models are imported and primitives created.
+// Imports keep the result in a .ao file next to the model, keyed by its contents.
+struct VertexOcclusionState {
+    bool enabled = false;
+    VertexOcclusionSettings settings;
+    std::map<uint64_t, std::vector<float>> primitives;  // key -> result, render thread only
+};
+static VertexOcclusionState vertexOcclusion;
+
+// A mesh too large for memory, streamed chunk by chunk into a fixed GPU cache.
+// It is drawn with the scene but is not a GameObject (no selection or gizmo).
+// The cache and the per-frame selection belong to the render thread; the
+// settings reach it through the frame packet.
+struct OutOfCoreState {
+    static const int SLOT_VERTICES = 65536;                             // uint16 indices
+    static const int SLOT_INDICES = OutOfCoreBuilder::LEAF_TRIANGLES * 3;
+    static const int UPLOADS_PER_FRAME = 8;
+    static const int MAX_REQUESTS = 64;
+    
+    OutOfCoreMesh mesh;
+    OocChunkLoader loader;
+    char path[1024] = "";
+    glm::mat4 model = glm::mat4(1.0f);                                  // fits the mesh into a 2-unit box
+    float modelScale = 1.0f;
+    glm::vec3 color = glm::vec3(0.75f, 0.75f, 0.72f);
+    bool visible = true;
+    float pixelError = 2.0f;                                            // refine chunks above this
+    int cacheMegabytes = 256;
+    
+    // Conversion from OBJ runs on a worker thread
+    std::future<std::string> convertJob;                                // error message, empty on success
+    std::atomic<float> convertProgress{0.0f};
+    std::atomic<bool> convertCancel{false};
+    std::string convertTarget;
+    
+    // GPU cache: fixed-size slots in one vertex and one index buffer
+    GLuint vao = 0, vbo = 0, ebo = 0;
+    int slotCount = 0;
+    std::vector<int> nodeSlot;                                          // node -> slot, -1 when not resident
+    std::vector<uint32_t> slotNode;                                     // slot -> node, UINT32_MAX when free
+    std::vector<uint64_t> slotLastUsed;                                 // frame the slot was last needed
+    uint64_t frame = 0;
+    
+    // Selection for the current frame
+    std::vector<uint32_t> drawList;
+    std::vector<std::pair<float, uint32_t>> wanted;                     // (screen error, node)
+    int uploadsLastFrame = 0;
+    size_t trianglesDrawn = 0;
+};
+static OutOfCoreState outOfCore;
+
+// Screenshots and recordings of the perspective view. Readbacks are tagged with
+// what they are for, since they come back a few frames after they were queued.
+enum CaptureMode {
+    CAPTURE_VIDEO,          // one .y4m stream
+    CAPTURE_PNG_SEQUENCE    // numbered PNG files
+};
+
+struct ViewportCaptureState {
+    static const uint64_t TAG_SCREENSHOT = 1;
+    static const uint64_t TAG_RECORD = 2;
+    
+    PixelReadback readback;
+    FrameEncoder encoder;
+    bool screenshotRequested = false;
+    int screenshotCount = 0;
+    bool recording = false;
+    bool writing = false;               // recording as the render thread sees it; later frames are dropped
+    int mode = CAPTURE_VIDEO;
+    int framesPerSecond = 60;
+    char outputBase[1024] = "";         // recording path without extension
+    uint64_t framesQueued = 0;          // frames of the current recording sent to the render thread
+    uint64_t framesEncoded = 0;         // frames of the current recording handed to the encoder
+};
+static ViewportCaptureState viewportCapture;
+
+// ImGui draw lists copied out of the context, so the next frame's UI can be built
+// while this one is drawn. The lists are reused and keep their buffers.
+struct ImGuiDrawCopy {
+    ImDrawData data;
+    std::vector<ImDrawList*> lists;
+    
+    ~ImGuiDrawCopy() {
+        for (ImDrawList* list : lists) IM_DELETE(list);
+    }
+};
+
+// Everything the render thread needs to draw one frame. The main thread fills it from
+// the editor state and never touches it again until the render thread is done with it.
+struct FramePacket {
+    int displayWidth = 0, displayHeight = 0;
+    
+    // Scene views with their culling results, and the items they index
+    int viewCount = 0;
+    SceneView views[MAX_SCENE_VIEWS];
+    std::vector<SceneDrawItem> drawItems;
+    
+    // Render settings as they were when the frame was built
+    bool wireframe = false;
+    bool showGrid = true, showAxes = true;
+    float gridSize = 20.0f;
+    float backgroundColor[4] = {};
+    glm::vec3 lightPos = glm::vec3(0.0f);
+    glm::vec3 lightColor = glm::vec3(1.0f);
+    float tessEdgePixels = 8.0f;
+    
+    // Transform gizmo of the selected object
+    bool drawGizmo = false;
+    bool gizmoLineStrip = false;
+    glm::mat4 gizmoModel = glm::mat4(1.0f);
+    std::vector<float> gizmoVertices, gizmoColors;
+    
+    // Out-of-core mesh settings
+    bool outOfCoreVisible = true;
+    glm::vec3 outOfCoreColor = glm::vec3(1.0f);
+    float outOfCorePixelError = 2.0f;
+    
+    // Path traced preview: replaces the perspective view once the first image has arrived
+    bool pathTraced = false;
+    int pathTraceWidth = 0, pathTraceHeight = 0;
+    std::vector<uint8_t> pathTraceImage;    // RGBA, bottom row first; empty when unchanged
+    
+    GLuint lightmapAtlas = 0;
+    
+    uint64_t captureTag = 0;            // ViewportCaptureState tags, 0 when the frame is not captured
+    int benchmarkFrame = -1;            // camera benchmark frame to GPU-time, -1 when not timed
+    
+    ImGuiDrawCopy ui;
+};
+
+// Numbers the render thread reports back for the panels; they lag by a frame
+struct RenderStats {
+    size_t outOfCoreChunksDrawn = 0;
+    size_t outOfCoreTriangles = 0;
+    size_t outOfCoreWanted = 0;
+    int outOfCoreUploads = 0;
+    int outOfCoreResident = 0;
+    int readbacksPending = 0;
+    uint64_t readbackStalls = 0;
+};
+
+struct RenderFeedback {
+    std::mutex mutex;
+    RenderStats stats;
+    std::string status;                 // replaces the status line when not empty
+};
+
+static RenderThread<FramePacket> renderThread;
+static RenderFeedback renderFeedback;
+static RenderStats renderStats;         // main thread copy, taken at the start of the frame
+static bool useRenderThread = true;     // off: everything is drawn on the main thread, as before
+static UploadThread uploadThread;
 
 // Mouse state variables
 static glm::vec2 lastMousePos(0.0f, 0.0f);
@@ -182,14 +811,20 @@ const char* vertexShaderSource = R"(
 #version 330 core
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
+layout (location = 3) in float aOcclusion;
+layout (location = 4) in vec3 aColor;
 out vec3 FragPos;
 out vec3 Normal;
+out float Occlusion;
+out vec3 VertexColor;
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 void main() {
     FragPos = vec3(model * vec4(aPos, 1.0));
     Normal = mat3(transpose(inverse(model))) * aNormal;
+    Occlusion = aOcclusion;
+    VertexColor = aColor;
     gl_Position = projection * view * vec4(FragPos, 1.0);
 }
 )";
@@ -198,6 +833,8 @@ const char* fragmentShaderSource = R"(
 #version 330 core
 in vec3 FragPos;
 in vec3 Normal;
+in float Occlusion;
+in vec3 VertexColor;
 out vec4 FragColor;
 uniform vec3 lightPos;
 uniform vec3 viewPos;
@@ -205,13 +842,13 @@ uniform vec3 lightColor;
 uniform vec3 objectColor;
 uniform int useUniformColor;
 void main() {
-    vec3 color = objectColor;
+    vec3 color = objectColor * VertexColor;
     vec3 norm = normalize(Normal);
     vec3 lightDir = normalize(lightPos - FragPos);
     float diff = max(dot(norm, lightDir), 0.0);
     vec3 diffuse = diff * lightColor;
     vec3 ambient = 0.2 * lightColor;
-    vec3 result = (ambient + diffuse) * color;
+    vec3 result = (ambient + diffuse) * color * Occlusion;
     FragColor = vec4(result, 1.0);
 }
 )";
@@ -261,6 +898,133 @@ void main() {
 }
 )";
 
+// Baked objects: the lightmap holds all the lighting, so shading is one fetch and one multiply
+const char* lightmapVertexShader = R"(
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 2) in vec2 aLightmapUV;
+out vec2 LightmapUV;
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec4 lightmapScaleOffset;
+void main() {
+    LightmapUV = aLightmapUV * lightmapScaleOffset.xy + lightmapScaleOffset.zw;
+    gl_Position = projection * view * model * vec4(aPos, 1.0);
+}
+)";
+
+const char* lightmapFragmentShader = R"(
+#version 330 core
+in vec2 LightmapUV;
+out vec4 FragColor;
+uniform sampler2D lightmap;
+uniform vec3 objectColor;
+void main() {
+    FragColor = vec4(texture(lightmap, LightmapUV).rgb * objectColor, 1.0);
+}
+)";
+
+// Tessellation shaders: each patch is a quad in the (u, v) parameter space of
+// an analytic surface, so detail comes from the surface itself and not from
+// the coarse control mesh
+const char* tessVertexShader = R"(
+#version 400 core
+layout (location = 0) in vec3 aParam;
+out vec3 Param;
+void main() {
+    Param = aParam;
+}
+)";
+
+// Shared by the control and evaluation stages. param = (u, v, part)
+const char* tessSurfaceFunctions = R"(
+const float PI = 3.14159265359;
+vec3 evaluateSurface(vec3 param, out vec3 normal) {
+    float angle = param.x * 2.0 * PI;
+    vec2 dir = vec2(cos(angle), sin(angle));
+    int part = int(param.z + 0.5);
+    if (part == 0) {
+        // Sphere, v runs from the north pole
+        float polar = param.y * PI;
+        normal = vec3(dir.x * sin(polar), cos(polar), dir.y * sin(polar));
+        return normal * 0.5;
+    } else if (part == 1) {
+        // Cylinder side
+        normal = vec3(dir.x, 0.0, dir.y);
+        return vec3(dir.x * 0.5, 0.5 - param.y, dir.y * 0.5);
+    } else if (part == 2) {
+        // Top cap, v is the radius fraction
+        normal = vec3(0.0, 1.0, 0.0);
+        return vec3(dir.x * 0.5 * param.y, 0.5, dir.y * 0.5 * param.y);
+    } else if (part == 3) {
+        // Bottom cap
+        normal = vec3(0.0, -1.0, 0.0);
+        return vec3(dir.x * 0.5 * param.y, -0.5, dir.y * 0.5 * param.y);
+    }
+    // Cone side, apex at v = 0
+    normal = normalize(vec3(dir.x, 0.5, dir.y));
+    return vec3(dir.x * 0.5 * param.y, 0.5 - param.y, dir.y * 0.5 * param.y);
+}
+)";
+
+const char* tessControlShader = R"(
+layout (vertices = 4) out;
+in vec3 Param[];
+out vec3 PatchParam[];
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec2 viewportSize;
+uniform float edgePixels;
+vec2 toScreen(vec3 param) {
+    vec3 normal;
+    vec4 clip = projection * view * model * vec4(evaluateSurface(param, normal), 1.0);
+    return clip.xy / max(clip.w, 0.001) * 0.5 * viewportSize;
+}
+float edgeLevel(vec3 a, vec3 b) {
+    // Curved edges are measured through their midpoint. The result only
+    // depends on the edge, so neighbouring patches agree and there are no cracks
+    vec3 m = (a + b) * 0.5;
+    float pixels = distance(toScreen(a), toScreen(m)) + distance(toScreen(m), toScreen(b));
+    return clamp(pixels / edgePixels, 1.0, 64.0);
+}
+void main() {
+    PatchParam[gl_InvocationID] = Param[gl_InvocationID];
+    if (gl_InvocationID == 0) {
+        gl_TessLevelOuter[0] = edgeLevel(Param[0], Param[3]);
+        gl_TessLevelOuter[1] = edgeLevel(Param[0], Param[1]);
+        gl_TessLevelOuter[2] = edgeLevel(Param[1], Param[2]);
+        gl_TessLevelOuter[3] = edgeLevel(Param[3], Param[2]);
+        gl_TessLevelInner[0] = max(gl_TessLevelOuter[1], gl_TessLevelOuter[3]);
+        gl_TessLevelInner[1] = max(gl_TessLevelOuter[0], gl_TessLevelOuter[2]);
+    }
+}
+)";
+
+const char* tessEvaluationShader = R"(
+layout (quads, fractional_odd_spacing, ccw) in;
+in vec3 PatchParam[];
+out vec3 FragPos;
+out vec3 Normal;
+out float Occlusion;
+out vec3 VertexColor;
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+void main() {
+    vec2 t = gl_TessCoord.xy;
+    vec3 param = mix(mix(PatchParam[0], PatchParam[1], t.x), mix(PatchParam[3], PatchParam[2], t.x), t.y);
+    vec3 normal;
+    vec3 pos = evaluateSurface(param, normal);
+    FragPos = vec3(model * vec4(pos, 1.0));
+    Normal = mat3(transpose(inverse(model))) * normal;
+    Occlusion = 1.0;
+    VertexColor = vec3(1.0);
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
+)";
+
 // Function prototypes
 void initGLFW();
 void initGLEW();
@@ -268,31 +1032,137 @@ void initImGui();
 void setupStyle();
 GLuint compileShader(const char* source, GLenum type);
 GLuint createShaderProgram(const char* vertexSource, const char* fragmentSource);
+GLuint createTessellationProgram();
+void initTessellation();
+void createPatchMesh(PrimitiveShape shape);
+void setObjectGpuOwner(const GameObject& obj);
+void retainObjectBuffers(const GameObject& obj);
+void releaseObjectBuffers(const GameObject& obj);
 void createPrimitive(const char* type, const glm::vec3& color = glm::vec3(0.8f, 0.8f, 0.8f));
 void createCube();
 void createSphere(int segments = 32);
 void createCylinder(int segments = 32);
 void createCone(int segments = 32);
 void createPlane();
+void buildCubeMesh(ObjMeshData& mesh);
+void buildSphereMesh(ObjMeshData& mesh, int segments = 32);
+void buildCylinderMesh(ObjMeshData& mesh, int segments = 32);
+void buildConeMesh(ObjMeshData& mesh, int segments = 32);
+void buildPlaneMesh(ObjMeshData& mesh);
+bool importOBJMesh(const char* path, ObjMeshData& mesh);
+void bakeMeshOcclusion(ObjMeshData& mesh, const VertexOcclusionSettings& settings, const std::string& cachePath);
+void uploadObjectBuffers(GameObject& obj, const ObjMeshData& mesh);
+void attachObjectBuffers(GameObject& obj);
 void loadOBJModel(const char* path);
+void addLoadedOBJModel(const std::string& path, const ObjMeshData& mesh, const std::shared_ptr<GameObject>& obj);
+void swapReloadedMesh(const std::string& path, GameObject& fresh, uint64_t contentHash);
+void startHotReload(const std::string& path);
+void updateHotReload();
+void openOutOfCoreMesh(const char* path);
+bool openConvertedMesh(const char* path);
+void closeOutOfCoreMesh();
+void createOutOfCoreCache();
+void releaseOutOfCoreCache();
+void collectOutOfCoreConversion();
+void updateOutOfCoreMesh(const FramePacket& packet);
+void renderOutOfCoreMesh(const FramePacket& packet, GLint modelLocation, GLint colorLocation);
+void showOutOfCoreMesh();
+void requestScreenshot();
+void startViewportRecording();
+void stopViewportRecording();
+void updateViewportCapture(const FramePacket& packet);
+void showCapture();
+uint64_t takeCaptureTag();
+void setRenderThreadEnabled(bool enabled);
+void collectRenderFeedback();
+void setRenderStatus(const char* message);
+void copyImGuiDrawData(const ImDrawData* source, ImGuiDrawCopy& copy);
+void renderFrame(FramePacket& packet);
 bool loadGLBModel(const char* path);
 void loadFileList();
 bool isModelFile(const char* filename);
-void renderObject(const GameObject& obj, GLuint shaderProgram);
-void renderGrid(GLuint shaderProgram);
+void renderObject(const SceneDrawItem& item, GLint modelLocation, GLint colorLocation);
+void renderTessellatedObject(const SceneDrawItem& item, GLint modelLocation, GLint colorLocation);
+void renderGrid(GLuint shaderProgram, float size);
 void renderAxes(GLuint shaderProgram);
-void renderGizmo(GLuint shaderProgram);
+void buildGizmoGeometry(FramePacket& packet);
+void uploadGizmoGeometry(const FramePacket& packet);
+void renderGizmo(GLuint shaderProgram, const FramePacket& packet);
 void updateCamera();
 void showMainMenuBar();
 void showStatusBar();
 void showLeftPanel();
+void rebuildOutlinerIndex();
+void outlinerObjectAdded(int index);
+void outlinerObjectRemoved(int index);
+void outlinerObjectRenamed(int index);
+void createStressScene(int count);
 void showRightPanel();
 void showViewport();
+void frameOrthographicViews(const glm::vec3& center, float size);
 void centerAllModels();
 void autoCenterSelectedModel();
-void render3DSceneToViewport();
-void createViewportFramebuffer();
-void resizeViewportFramebuffer(int width, int height);
+void buildScenePacket(FramePacket& packet);
+void render3DSceneToViewport(const FramePacket& packet);
+int sceneViewCount();
+void layoutSceneViews();
+void buildSceneDrawList();
+void cullSceneView(SceneView& sceneView);
+void renderSceneView(const FramePacket& packet, const SceneView& sceneView, SceneViewTarget& target);
+bool readbackMesh(const GameObject& obj, std::vector<float>& vertices, std::vector<unsigned int>& indices, size_t& gpuBytes);
+void updateMeshInspector();
+void startMeshOptimization(const std::shared_ptr<GameObject>& obj, MeshOptimizeAction action);
+void showMeshInspector();
+void beginMeshEdit(const std::shared_ptr<GameObject>& obj);
+void updateMeshEdit();
+void uploadMeshEdits();
+void endMeshEdit();
+void pickMeshEditFace(double x, double y, bool extend);
+void buildMeshEditHighlight(FramePacket& packet);
+void showMeshEdit();
+SubdivisionEntry* findSubdivision(const GameObject* obj);
+void enableSubdivision(const std::shared_ptr<GameObject>& obj);
+void removeSubdivision(const GameObject* obj);
+void updateSubdivision();
+void setSubdivisionCage(SubdivisionEntry& entry, SubdivisionCage cage);
+void invalidateSubdivision(SubdivisionEntry& entry);
+void moveSubdivisionCage(const GameObject& obj, const HalfEdgeMesh& mesh);
+void reshapeSubdivisionCage(const GameObject& obj, const HalfEdgeMesh& mesh);
+void uploadSubdivision(SubdivisionEntry& entry, SubdivisionSurface& surface, bool full);
+void releaseSubdivisionBuffers(const SubdivisionEntry& entry);
+void showSubdivision();
+void invalidatePathTraceMesh(GLuint vbo);
+void restartPathTrace(const SceneView& sceneView);
+void updatePathTrace(FramePacket& packet);
+void uploadPathTraceImage(const FramePacket& packet, SceneViewTarget& target);
+void showPathTrace();
+int renderPathTraceCommandLine(int argc, char** argv);
+LightmapEntry* findLightmap(const GameObject* obj);
+void invalidateLightmap(GLuint vbo);
+void startLightmapBake();
+void updateLightmaps();
+void uploadLightmapMesh(LightmapEntry& entry, const LightmapBake& bake);
+void packLightmapAtlas();
+void releaseLightmapBuffers(const LightmapEntry& entry);
+void clearLightmaps();
+void showLightmaps();
+void updateHlod();
+void startHlodBuild(uint64_t cell, HlodCluster& cluster);
+void uploadHlodProxy(HlodCluster& cluster, const HlodResult& result);
+void releaseHlodBuffers(const HlodCluster& cluster);
+void invalidateHlodMesh(GLuint vbo);
+void clearHlod();
+void showHlod();
+void showGpuMemory();
+void setCameraPathFileForScene(const char* scenePath);
+bool loadCameraPath(const char* path);
+void updateCameraPath();
+void beginBenchmarkQuery(int frame);
+void startCameraBenchmark();
+void finishCameraBenchmark(bool completed);
+void showCameraPath();
+void createViewportFramebuffer(SceneViewTarget& target, int width, int height);
+void resizeViewportFramebuffer(SceneViewTarget& target, int width, int height);
 std::string formatFileSize(size_t size);
 std::string formatTime(time_t time);
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
@@ -307,8 +1177,15 @@ std::string openFileDialog(const char* filter);
 GLuint modelShader = 0;
 GLuint gridShader = 0;
 GLuint gizmoShader = 0;
+GLuint tessShader = 0;
+GLuint lightmapShader = 0;
 
-int main() {
+int main(int argc, char** argv) {
+    // Headless stills need neither a window nor GL
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--path-trace") == 0) return renderPathTraceCommandLine(argc, argv);
+    }
+    
     // Initialize GLFW
     if (!glfwInit()) {
         fprintf(stderr, "Failed to initialize GLFW\n");
@@ -330,6 +1207,17 @@ int main() {
     modelShader = createShaderProgram(vertexShaderSource, fragmentShaderSource);
     gridShader = createShaderProgram(gridVertexShader, gridFragmentShader);
     gizmoShader = createShaderProgram(gizmoVertexShader, gizmoFragmentShader);
+    lightmapShader = createShaderProgram(lightmapVertexShader, lightmapFragmentShader);
+    
+    // Meshes without baked occlusion or vertex colors (only HLOD proxies have those) leave
+    // attributes 3 and 4 disabled and read these instead
+    glVertexAttrib1f(3, 1.0f);
+    glVertexAttrib3f(4, 1.0f, 1.0f, 1.0f);
+    
+    // Optional tessellation path, needs a 4.0 context or ARB_tessellation_shader
+    if (GLEW_VERSION_4_0 || GLEW_ARB_tessellation_shader) {
+        initTessellation();
+    }
     
     // Create default objects
     createPrimitive("Cube", glm::vec3(0.8f, 0.4f, 0.4f));
@@ -343,8 +1231,11 @@ int main() {
     GETCWD(currentDirectory, sizeof(currentDirectory));
     loadFileList();
     
-    // Create viewport framebuffer
-    createViewportFramebuffer();
+    // Scene views; their framebuffers start at 1x1 and follow the size they are drawn at
+    for (int i = 0; i < MAX_SCENE_VIEWS; ++i) {
+        sceneViews[i].type = static_cast<SceneViewType>(i);
+        createViewportFramebuffer(sceneViewTargets[i], 1, 1);
+    }
     
     // Set callbacks
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
@@ -354,9 +1245,37 @@ int main() {
     glfwSetKeyCallback(window, key_callback);
     glfwSetDropCallback(window, drop_callback);
     
-    // Main loop
+    // From here on the GL context belongs to the render thread. ImGui's device objects are
+    // created first, so ImGui_ImplOpenGL3_NewFrame() on the main thread has no GL work left.
+    ImGui_ImplOpenGL3_CreateDeviceObjects();
+    renderThread.setRenderer(renderFrame);
+    
+    // The upload context is created while the main context is still current here
+    if (!uploadThread.start(window)) {
+        fprintf(stderr, "No shared GL context, imported meshes are uploaded on the render thread\n");
+    }
+    setRenderThreadEnabled(useRenderThread);
+    
+    // Main loop: builds frame N+1 while the render thread draws frame N
+    CpuTrace::setThreadName("Main");
     while (!glfwWindowShouldClose(window)) {
+        TRACE_ZONE("Frame");
         glfwPollEvents();
+        collectRenderFeedback();
+        
+        FramePacket& packet = renderThread.packet();
+        glfwGetFramebufferSize(window, &packet.displayWidth, &packet.displayHeight);
+        FrameArena::beginFrame();
+        
+        // Swap in re-imported and optimised meshes before this frame's packet refers to them
+        updateHotReload();
+        uploadThread.finishUploads();
+        updateMeshInspector();
+        updateMeshEdit();
+        updateSubdivision();
+        updateLightmaps();
+        updateHlod();
+        collectOutOfCoreConversion();
         
         // Start ImGui frame
         ImGui_ImplOpenGL3_NewFrame();
@@ -381,42 +1300,107 @@ int main() {
             mainViewport->Size.y - (menuBarHeight + statusBarHeight + 2 * margin)
         );
         
-        // Render 3D scene to framebuffer
-        render3DSceneToViewport();
+        // Recorded flythroughs drive the camera while benchmarking
+        updateCameraPath();
+        
+        // Cull the scene and copy what drawing it needs into the packet (GPU-timed during playback)
+        buildScenePacket(packet);
+        updatePathTrace(packet);
+        bool timedFrame = cameraBenchmark.playing && cameraBenchmark.frame >= 0;
+        packet.benchmarkFrame = timedFrame ? cameraBenchmark.frame : -1;
+        packet.captureTag = takeCaptureTag();
+        if (cameraBenchmark.playing) cameraBenchmark.frame++;
         
         // Show panels (arranged around the viewport)
-        showLeftPanel();
-        showRightPanel();
-        showViewport();
-        
-        // Show status bar
-        showStatusBar();
-        
-        // Rendering
-        ImGui::Render();
-        int display_w, display_h;
-        glfwGetFramebufferSize(window, &display_w, &display_h);
-        glViewport(0, 0, display_w, display_h);
-        glClearColor(backgroundColor[0], backgroundColor[1], backgroundColor[2], backgroundColor[3]);
-        glClear(GL_COLOR_BUFFER_BIT);
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        {
+            TRACE_ZONE("Panels");
+            showLeftPanel();
+            showRightPanel();
+            showViewport();
+            
+            // Show status bar
+            showStatusBar();
+        }
         
-        glfwSwapBuffers(window);
+        // The draw data points into ImGui's own buffers, which the next frame reuses
+        {
+            TRACE_ZONE("ImGui Render");
+            ImGui::Render();
+            copyImGuiDrawData(ImGui::GetDrawData(), packet.ui);
+        }
+        
+        FrameArena::endFrame();
+        
+        // Waits only if the render thread is still on the frame before the last one
+        renderThread.submit();
+        if (useRenderThread != renderThread.threaded()) setRenderThreadEnabled(useRenderThread);
     }
     
-    // Cleanup
+    // Cleanup: let uploads in flight land, draw what is still queued and take the context back
+    pathTrace.tracer.stop();
+    if (lightmaps.job.valid()) {
+        lightmaps.cancel = true;
+        lightmaps.job.wait();
+    }
+    uploadThread.stop();
+    setRenderThreadEnabled(false);
+    uploadThread.attachUploads();
+    uploadThread.finishUploads();
     for (auto& obj : objects) {
-        if (obj->vao) glDeleteVertexArrays(1, &obj->vao);
-        if (obj->vbo) glDeleteBuffers(1, &obj->vbo);
-        if (obj->ebo) glDeleteBuffers(1, &obj->ebo);
+        releaseObjectBuffers(*obj);
+    }
+    for (auto& entry : subdivision.entries) {
+        releaseSubdivisionBuffers(*entry);
+    }
+    clearLightmaps();
+    if (hlod.job.valid()) hlod.job.wait();
+    clearHlod();
+    renderThread.flushDeferred();
+    
+    if (outOfCore.convertJob.valid()) {
+        outOfCore.convertCancel = true;
+        outOfCore.convertJob.wait();
+    }
+    closeOutOfCoreMesh();
+    
+    if (viewportCapture.recording) stopViewportRecording();
+    viewportCapture.encoder.stop();
+    viewportCapture.readback.release();
+    
+    for (auto& target : sceneViewTargets) {
+        GpuMemory::release(GPU_FRAMEBUFFER, target.framebuffer);
+        GpuMemory::release(GPU_TEXTURE, target.texture);
+        GpuMemory::release(GPU_RENDERBUFFER, target.renderbuffer);
     }
     
-    if (viewportFramebuffer) glDeleteFramebuffers(1, &viewportFramebuffer);
-    if (viewportTexture) glDeleteTextures(1, &viewportTexture);
+    GpuMemory::release(GPU_VERTEX_ARRAY, gridVAO);
+    GpuMemory::release(GPU_BUFFER, gridVBO);
+    GpuMemory::release(GPU_BUFFER, gridColorVBO);
+    GpuMemory::release(GPU_VERTEX_ARRAY, axesVAO);
+    GpuMemory::release(GPU_BUFFER, axesVBO);
+    GpuMemory::release(GPU_BUFFER, axesColorVBO);
+    GpuMemory::release(GPU_VERTEX_ARRAY, gizmoVAO);
+    GpuMemory::release(GPU_BUFFER, gizmoVBO);
+    GpuMemory::release(GPU_BUFFER, gizmoColorVBO);
+    
+    if (cameraBenchmark.gpuQueries[0]) {
+        uncapturedDeleteQueries(CameraBenchmarkState::QUERY_COUNT, cameraBenchmark.gpuQueries);
+    }
     
     if (modelShader) glDeleteProgram(modelShader);
     if (gridShader) glDeleteProgram(gridShader);
     if (gizmoShader) glDeleteProgram(gizmoShader);
+    if (tessShader) glDeleteProgram(tessShader);
+    if (lightmapShader) glDeleteProgram(lightmapShader);
+    
+    for (auto& patches : tessPatchMeshes) {
+        GpuMemory::release(GPU_VERTEX_ARRAY, patches.vao);
+        GpuMemory::release(GPU_BUFFER, patches.vbo);
+        GpuMemory::release(GPU_BUFFER, patches.ebo);
+    }
+    
+    // Anything still tracked at this point was never released
+    GpuMemory::dumpLeaks(stderr);
     
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
@@ -429,13 +1413,20 @@ int main() {
 }
 
 void initGLFW() {
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    // Ask for 4.0 so the tessellation path is available
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
     glfwWindowHint(GLFW_SAMPLES, 8); // MSAA
     
     window = glfwCreateWindow(windowWidth, windowHeight, "3D Model Viewer Pro", NULL, NULL);
+    if (!window) {
+        // Fall back to 3.3 without tessellation
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        window = glfwCreateWindow(windowWidth, windowHeight, "3D Model Viewer Pro", NULL, NULL);
+    }
     if (!window) {
         fprintf(stderr, "Failed to create GLFW window\n");
         glfwTerminate();
@@ -583,46 +1574,246 @@ GLuint createShaderProgram(const char* vertexSource, const char* fragmentSource)
     return program;
 }
 
+GLuint createTessellationProgram() {
+    // The surface functions are spliced in after the version line
+    std::string controlSource = std::string("#version 400 core\n") + tessSurfaceFunctions + tessControlShader;
+    std::string evaluationSource = std::string("#version 400 core\n") + tessSurfaceFunctions + tessEvaluationShader;
+    
+    GLuint shaders[4] = {
+        compileShader(tessVertexShader, GL_VERTEX_SHADER),
+        compileShader(controlSource.c_str(), GL_TESS_CONTROL_SHADER),
+        compileShader(evaluationSource.c_str(), GL_TESS_EVALUATION_SHADER),
+        compileShader(fragmentShaderSource, GL_FRAGMENT_SHADER)
+    };
+    
+    GLuint program = glCreateProgram();
+    for (GLuint shader : shaders) glAttachShader(program, shader);
+    glLinkProgram(program);
+    
+    GLint success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        char infoLog[512];
+        glGetProgramInfoLog(program, 512, NULL, infoLog);
+        fprintf(stderr, "Tessellation program linking failed:\n%s\n", infoLog);
+        glDeleteProgram(program);
+        program = 0;
+    }
+    
+    for (GLuint shader : shaders) glDeleteShader(shader);
+    
+    return program;
+}
+
+void initTessellation() {
+    tessShader = createTessellationProgram();
+    if (!tessShader) return;
+    
+    createPatchMesh(SHAPE_SPHERE);
+    createPatchMesh(SHAPE_CYLINDER);
+    createPatchMesh(SHAPE_CONE);
+    tessellationSupported = true;
+}
+
+void createPatchMesh(PrimitiveShape shape) {
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    
+    // Adds a uCount x vCount grid of quad patches for one surface part
+    auto addPatchGrid = [&](int part, int uCount, int vCount) {
+        unsigned int base = static_cast<unsigned int>(vertices.size() / 3);
+        for (int v = 0; v <= vCount; ++v) {
+            for (int u = 0; u <= uCount; ++u) {
+                vertices.push_back((float)u / (float)uCount);
+                vertices.push_back((float)v / (float)vCount);
+                vertices.push_back((float)part);
+            }
+        }
+        for (int v = 0; v < vCount; ++v) {
+            for (int u = 0; u < uCount; ++u) {
+                unsigned int first = base + v * (uCount + 1) + u;
+                unsigned int second = first + uCount + 1;
+                indices.push_back(first);
+                indices.push_back(first + 1);
+                indices.push_back(second + 1);
+                indices.push_back(second);
+            }
+        }
+    };
+    
+    // Part ids match evaluateSurface() in the tessellation shaders
+    if (shape == SHAPE_SPHERE) {
+        addPatchGrid(0, 8, 4);
+    } else if (shape == SHAPE_CYLINDER) {
+        addPatchGrid(1, 8, 1);
+        addPatchGrid(2, 8, 1);
+        addPatchGrid(3, 8, 1);
+    } else if (shape == SHAPE_CONE) {
+        addPatchGrid(4, 8, 1);
+        addPatchGrid(3, 8, 1);
+    }
+    
+    TessPatchMesh& patches = tessPatchMeshes[shape];
+    patches.vao = GPU_CREATE(GPU_VERTEX_ARRAY, "Tessellation Patches");
+    patches.vbo = GPU_CREATE(GPU_BUFFER, "Tessellation Patches");
+    patches.ebo = GPU_CREATE(GPU_BUFFER, "Tessellation Patches");
+    
+    glBindVertexArray(patches.vao);
+    
+    glBindBuffer(GL_ARRAY_BUFFER, patches.vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, patches.ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+    
+    // Surface parameter attribute
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    
+    glBindVertexArray(0);
+    
+    patches.indexCount = static_cast<int>(indices.size());
+}
+
+// Label an object's GPU allocations with its name for the memory panel and leak report
+void setObjectGpuOwner(const GameObject& obj) {
+    renderThread.invoke([&]() {
+        GpuMemory::setOwner(GPU_VERTEX_ARRAY, obj.vao, obj.name);
+        GpuMemory::setOwner(GPU_BUFFER, obj.vbo, obj.name);
+        GpuMemory::setOwner(GPU_BUFFER, obj.ebo, obj.name);
+    });
+}
+
+// Another reference to an object's mesh, for a copy that shares it. Queued with the
+// releases so the two stay in call order without waiting for the render thread.
+void retainObjectBuffers(const GameObject& obj) {
+    GLuint vao = obj.vao, vbo = obj.vbo, ebo = obj.ebo;
+    renderThread.defer([vao, vbo, ebo]() {
+        GpuMemory::retain(GPU_VERTEX_ARRAY, vao);
+        GpuMemory::retain(GPU_BUFFER, vbo);
+        GpuMemory::retain(GPU_BUFFER, ebo);
+    });
+}
+
+// Drop an object's references to its mesh; buffers shared with duplicates stay alive.
+// Frames already built may still draw the mesh, so the release waits until they have.
+void releaseObjectBuffers(const GameObject& obj) {
+    GLuint vao = obj.vao, vbo = obj.vbo, ebo = obj.ebo;
+    renderThread.defer([vao, vbo, ebo]() {
+        GpuMemory::release(GPU_VERTEX_ARRAY, vao);
+        GpuMemory::release(GPU_BUFFER, vbo);
+        GpuMemory::release(GPU_BUFFER, ebo);
+    });
+}
+
 void createPrimitive(const char* type, const glm::vec3& color) {
-    auto obj = std::make_shared<GameObject>();
+    // The creators upload the mesh, so they run on the render thread
+    renderThread.invoke([&]() {
+        if (strcmp(type, "Cube") == 0) {
+            createCube();
+        } else if (strcmp(type, "Sphere") == 0) {
+            createSphere();
+        } else if (strcmp(type, "Cylinder") == 0) {
+            createCylinder();
+        } else if (strcmp(type, "Cone") == 0) {
+            createCone();
+        } else if (strcmp(type, "Plane") == 0) {
+            createPlane();
+        } else {
+            createCube(); // Default to cube
+        }
+    });
+    
+    // The creator appended the new object; name and color it in place
+    auto& obj = objects.back();
     obj->color = color;
+    snprintf(obj->name, sizeof(obj->name), "%s %zu", type, objects.size());
+    setObjectGpuOwner(*obj);
+    selectedObjectIndex = objects.size() - 1;
+    outlinerObjectAdded(selectedObjectIndex);
     
-    if (strcmp(type, "Cube") == 0) {
+    // Auto-center the new model
+    autoCenterSelectedModel();
+}
+
+// Scatter `count` random primitives for measuring UI, culling and draw cost on
+// big scenes. One mesh is built per shape and shared by its copies, like Duplicate.
+void createStressScene(int count) {
+    TRACE_FUNCTION();
+    static const char* shapeNames[] = { "Cube", "Sphere", "Cylinder", "Cone", "Plane" };
+    const int shapeCount = IM_ARRAYSIZE(shapeNames);
+    count = glm::max(count, shapeCount);
+    
+    size_t first = objects.size();
+    objects.reserve(first + count);
+    renderThread.invoke([]() {
         createCube();
-    } else if (strcmp(type, "Sphere") == 0) {
         createSphere();
-    } else if (strcmp(type, "Cylinder") == 0) {
         createCylinder();
-    } else if (strcmp(type, "Cone") == 0) {
         createCone();
-    } else if (strcmp(type, "Plane") == 0) {
         createPlane();
-    } else {
-        createCube(); // Default to cube
-    }
+    });
+    
+    std::mt19937 random(STRESS_SCENE_SEED);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    float extent = cbrtf(static_cast<float>(count)) * 1.5f;
     
-    // Copy the last created object's buffers
-    if (!objects.empty()) {
-        obj->vao = objects.back()->vao;
-        obj->vbo = objects.back()->vbo;
-        obj->ebo = objects.back()->ebo;
-        obj->vertexCount = objects.back()->vertexCount;
-        obj->indexCount = objects.back()->indexCount;
-        obj->bboxMin = objects.back()->bboxMin;
-        obj->bboxMax = objects.back()->bboxMax;
+    for (int i = 0; i < count; i++) {
+        int shape = i % shapeCount;
+        std::shared_ptr<GameObject> obj;
+        if (i < shapeCount) {
+            obj = objects[first + i];
+        } else {
+            obj = std::make_shared<GameObject>(*objects[first + shape]);
+            retainObjectBuffers(*obj);
+            objects.push_back(obj);
+        }
+        
+        obj->position = (glm::vec3(unit(random), unit(random), unit(random)) * 2.0f - 1.0f) * extent;
+        obj->rotation = glm::vec3(unit(random), unit(random), unit(random)) * glm::two_pi<float>();
+        obj->scale = glm::vec3(0.3f + unit(random) * 0.7f);
+        obj->color = glm::vec3(0.3f) + glm::vec3(unit(random), unit(random), unit(random)) * 0.7f;
+        snprintf(obj->name, sizeof(obj->name), "%s %d", shapeNames[shape], i);
+        if (i < shapeCount) setObjectGpuOwner(*obj);
     }
     
-    snprintf(obj->name, sizeof(obj->name), "%s %zu", type, objects.size() + 1);
-    objects.push_back(obj);
-    selectedObjectIndex = objects.size() - 1;
+    // Appending one by one would re-sort the outliner per object
+    outliner.valid = false;
+    selectedObjectIndex = -1;
+    centerAllModels();
     
-    // Auto-center the new model
-    autoCenterSelectedModel();
+    snprintf(statusMessage, sizeof(statusMessage), "Created stress scene: %d objects", count);
 }
 
-void createCube() {
-    auto obj = std::make_shared<GameObject>();
+// Render thread: upload a built primitive and append it to the scene (createPrimitive()
+// names and colors it). Builders always make the same mesh, so occlusion is baked once
+// per shape and settings and kept for the session.
+static void addPrimitiveObject(ObjMeshData& mesh, PrimitiveShape shape) {
+    if (vertexOcclusion.enabled) {
+        mesh.contentHash = 14695981039346656037ull;
+        for (float value : mesh.vertices) {
+            uint32_t bits;
+            memcpy(&bits, &value, sizeof(bits));
+            mesh.contentHash = (mesh.contentHash ^ bits) * 1099511628211ull;
+        }
+        uint64_t key = VertexOcclusion::key(mesh.contentHash, mesh.vertices.size() / 6, vertexOcclusion.settings);
+        auto cached = vertexOcclusion.primitives.find(key);
+        if (cached != vertexOcclusion.primitives.end()) {
+            mesh.occlusion = cached->second;
+        } else {
+            bakeMeshOcclusion(mesh, vertexOcclusion.settings, std::string());
+            vertexOcclusion.primitives[key] = mesh.occlusion;
+        }
+    }
     
+    auto obj = std::make_shared<GameObject>();
+    uploadObjectBuffers(*obj, mesh);
+    attachObjectBuffers(*obj);
+    obj->shape = shape;
+    objects.push_back(obj);
+}
+
+void buildCubeMesh(ObjMeshData& mesh) {
     float vertices[] = {
         // positions          // normals
         -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
@@ -665,41 +1856,24 @@ void createCube() {
         20, 21, 22, 22, 23, 20
     };
     
-    glGenVertexArrays(1, &obj->vao);
-    glGenBuffers(1, &obj->vbo);
-    glGenBuffers(1, &obj->ebo);
-    
-    glBindVertexArray(obj->vao);
-    
-    glBindBuffer(GL_ARRAY_BUFFER, obj->vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-    
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, obj->ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-    
-    // Position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    
-    // Normal attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    
-    glBindVertexArray(0);
-    
-    obj->vertexCount = 24;
-    obj->indexCount = 36;
-    obj->bboxMin = glm::vec3(-0.5f, -0.5f, -0.5f);
-    obj->bboxMax = glm::vec3(0.5f, 0.5f, 0.5f);
-    
-    objects.push_back(obj);
+    mesh.vertices.assign(vertices, vertices + sizeof(vertices) / sizeof(float));
+    mesh.indices.assign(indices, indices + sizeof(indices) / sizeof(unsigned int));
+    mesh.bboxMin = glm::vec3(-0.5f, -0.5f, -0.5f);
+    mesh.bboxMax = glm::vec3(0.5f, 0.5f, 0.5f);
+    mesh.valid = true;
 }
 
-void createSphere(int segments) {
-    auto obj = std::make_shared<GameObject>();
-    
-    std::vector<float> vertices;
-    std::vector<unsigned int> indices;
+void createCube() {
+    ObjMeshData mesh;
+    buildCubeMesh(mesh);
+    addPrimitiveObject(mesh, SHAPE_MESH);
+}
+
+void buildSphereMesh(ObjMeshData& mesh, int segments) {
+    std::vector<float>& vertices = mesh.vertices;
+    std::vector<unsigned int>& indices = mesh.indices;
+    vertices.reserve((segments + 1) * (segments + 1) * 6);
+    indices.reserve(segments * segments * 6);
     
     for (int y = 0; y <= segments; ++y) {
         for (int x = 0; x <= segments; ++x) {
@@ -735,41 +1909,22 @@ void createSphere(int segments) {
         }
     }
     
-    glGenVertexArrays(1, &obj->vao);
-    glGenBuffers(1, &obj->vbo);
-    glGenBuffers(1, &obj->ebo);
-    
-    glBindVertexArray(obj->vao);
-    
-    glBindBuffer(GL_ARRAY_BUFFER, obj->vbo);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-    
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, obj->ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
-    
-    // Position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    
-    // Normal attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    
-    glBindVertexArray(0);
-    
-    obj->vertexCount = static_cast<int>(vertices.size() / 6);
-    obj->indexCount = static_cast<int>(indices.size());
-    obj->bboxMin = glm::vec3(-0.5f, -0.5f, -0.5f);
-    obj->bboxMax = glm::vec3(0.5f, 0.5f, 0.5f);
-    
-    objects.push_back(obj);
+    mesh.bboxMin = glm::vec3(-0.5f, -0.5f, -0.5f);
+    mesh.bboxMax = glm::vec3(0.5f, 0.5f, 0.5f);
+    mesh.valid = true;
 }
 
-void createCylinder(int segments) {
-    auto obj = std::make_shared<GameObject>();
-    
-    std::vector<float> vertices;
-    std::vector<unsigned int> indices;
+void createSphere(int segments) {
+    ObjMeshData mesh;
+    buildSphereMesh(mesh, segments);
+    addPrimitiveObject(mesh, SHAPE_SPHERE);
+}
+
+void buildCylinderMesh(ObjMeshData& mesh, int segments) {
+    std::vector<float>& vertices = mesh.vertices;
+    std::vector<unsigned int>& indices = mesh.indices;
+    vertices.reserve((2 + (segments + 1) * 4) * 6);
+    indices.reserve(segments * 12);
     
     // Top circle
     vertices.push_back(0.0f); vertices.push_back(0.5f); vertices.push_back(0.0f);
@@ -830,41 +1985,22 @@ void createCylinder(int segments) {
         indices.push_back(bottomRight);
     }
     
-    glGenVertexArrays(1, &obj->vao);
-    glGenBuffers(1, &obj->vbo);
-    glGenBuffers(1, &obj->ebo);
-    
-    glBindVertexArray(obj->vao);
-    
-    glBindBuffer(GL_ARRAY_BUFFER, obj->vbo);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-    
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, obj->ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
-    
-    // Position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    
-    // Normal attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    
-    glBindVertexArray(0);
-    
-    obj->vertexCount = static_cast<int>(vertices.size() / 6);
-    obj->indexCount = static_cast<int>(indices.size());
-    obj->bboxMin = glm::vec3(-0.5f, -0.5f, -0.5f);
-    obj->bboxMax = glm::vec3(0.5f, 0.5f, 0.5f);
-    
-    objects.push_back(obj);
+    mesh.bboxMin = glm::vec3(-0.5f, -0.5f, -0.5f);
+    mesh.bboxMax = glm::vec3(0.5f, 0.5f, 0.5f);
+    mesh.valid = true;
 }
 
-void createCone(int segments) {
-    auto obj = std::make_shared<GameObject>();
-    
-    std::vector<float> vertices;
-    std::vector<unsigned int> indices;
+void createCylinder(int segments) {
+    ObjMeshData mesh;
+    buildCylinderMesh(mesh, segments);
+    addPrimitiveObject(mesh, SHAPE_CYLINDER);
+}
+
+void buildConeMesh(ObjMeshData& mesh, int segments) {
+    std::vector<float>& vertices = mesh.vertices;
+    std::vector<unsigned int>& indices = mesh.indices;
+    vertices.reserve((2 + (segments + 1) * 3) * 6);
+    indices.reserve(segments * 6);
     
     // Top point
     vertices.push_back(0.0f); vertices.push_back(0.5f); vertices.push_back(0.0f);
@@ -909,39 +2045,18 @@ void createCone(int segments) {
         indices.push_back(2 + i * 3 + 2);
     }
     
-    glGenVertexArrays(1, &obj->vao);
-    glGenBuffers(1, &obj->vbo);
-    glGenBuffers(1, &obj->ebo);
-    
-    glBindVertexArray(obj->vao);
-    
-    glBindBuffer(GL_ARRAY_BUFFER, obj->vbo);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-    
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, obj->ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
-    
-    // Position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    
-    // Normal attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    
-    glBindVertexArray(0);
-    
-    obj->vertexCount = static_cast<int>(vertices.size() / 6);
-    obj->indexCount = static_cast<int>(indices.size());
-    obj->bboxMin = glm::vec3(-0.5f, -0.5f, -0.5f);
-    obj->bboxMax = glm::vec3(0.5f, 0.5f, 0.5f);
-    
-    objects.push_back(obj);
+    mesh.bboxMin = glm::vec3(-0.5f, -0.5f, -0.5f);
+    mesh.bboxMax = glm::vec3(0.5f, 0.5f, 0.5f);
+    mesh.valid = true;
 }
 
-void createPlane() {
-    auto obj = std::make_shared<GameObject>();
-    
+void createCone(int segments) {
+    ObjMeshData mesh;
+    buildConeMesh(mesh, segments);
+    addPrimitiveObject(mesh, SHAPE_CONE);
+}
+
+void buildPlaneMesh(ObjMeshData& mesh) {
     float vertices[] = {
         // positions          // normals
         -1.0f, 0.0f, -1.0f,  0.0f, 1.0f, 0.0f,
@@ -954,62 +2069,85 @@ void createPlane() {
         0, 1, 2, 2, 3, 0
     };
     
-    glGenVertexArrays(1, &obj->vao);
-    glGenBuffers(1, &obj->vbo);
-    glGenBuffers(1, &obj->ebo);
-    
-    glBindVertexArray(obj->vao);
-    
-    glBindBuffer(GL_ARRAY_BUFFER, obj->vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-    
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, obj->ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-    
-    // Position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    
-    // Normal attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    
-    glBindVertexArray(0);
-    
-    obj->vertexCount = 4;
-    obj->indexCount = 6;
-    obj->bboxMin = glm::vec3(-1.0f, 0.0f, -1.0f);
-    obj->bboxMax = glm::vec3(1.0f, 0.0f, 1.0f);
-    
-    objects.push_back(obj);
+    mesh.vertices.assign(vertices, vertices + sizeof(vertices) / sizeof(float));
+    mesh.indices.assign(indices, indices + sizeof(indices) / sizeof(unsigned int));
+    mesh.bboxMin = glm::vec3(-1.0f, 0.0f, -1.0f);
+    mesh.bboxMax = glm::vec3(1.0f, 0.0f, 1.0f);
+    mesh.valid = true;
 }
 
-void loadOBJModel(const char* path) {
+void createPlane() {
+    ObjMeshData mesh;
+    buildPlaneMesh(mesh);
+    addPrimitiveObject(mesh, SHAPE_MESH);
+}
+
+// Hash of a file's contents, used to skip re-imports when a save changed nothing
+static bool hashFileContents(const char* path, uint64_t& hash) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return false;
+    
+    // FNV-1a over 64-bit words; only needs to tell two versions of one file apart
+    hash = 14695981039346656037ull;
+    uint64_t words[8192];
+    size_t bytes;
+    while ((bytes = fread(words, 1, sizeof(words), file)) > 0) {
+        size_t wordCount = bytes / sizeof(uint64_t);
+        for (size_t i = 0; i < wordCount; i++) {
+            hash = (hash ^ words[i]) * 1099511628211ull;
+        }
+        const unsigned char* tail = reinterpret_cast<const unsigned char*>(words + wordCount);
+        for (size_t i = 0; i < bytes % sizeof(uint64_t); i++) {
+            hash = (hash ^ tail[i]) * 1099511628211ull;
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+// Parse an OBJ into interleaved position + normal vertices. Touches no GL or
+// editor state, so hot reload can run it on a worker thread.
+bool importOBJMesh(const char* path, ObjMeshData& mesh) {
+    TRACE_ZONE("Import OBJ");
+    if (!hashFileContents(path, mesh.contentHash)) {
+        mesh.message = std::string("Failed to load OBJ: cannot open ") + path;
+        return false;
+    }
+    
     tinyobj::attrib_t attrib;
     std::vector<tinyobj::shape_t> shapes;
     std::vector<tinyobj::material_t> materials;
     std::string warn, err;
     
     if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, path)) {
-        snprintf(statusMessage, sizeof(statusMessage), "Failed to load OBJ: %s", err.c_str());
-        return;
+        mesh.message = "Failed to load OBJ: " + err;
+        return false;
     }
     
     if (!warn.empty()) {
-        snprintf(statusMessage, sizeof(statusMessage), "OBJ warning: %s", warn.c_str());
+        mesh.message = "OBJ warning: " + warn;
     }
     
-    auto obj = std::make_shared<GameObject>();
-    
     // Combine all shapes into single vertex array
-    std::vector<float> vertices;
-    std::vector<unsigned int> indices;
+    std::vector<float>& vertices = mesh.vertices;
+    std::vector<unsigned int>& indices = mesh.indices;
     
     glm::vec3 bboxMin = glm::vec3(FLT_MAX);
     glm::vec3 bboxMax = glm::vec3(-FLT_MAX);
     
     unsigned int indexOffset = 0;
     
+    // Source position per corner, used to generate normals the file doesn't provide
+    std::vector<unsigned int> cornerPositions;
+    bool missingNormals = false;
+    
+    // Every corner becomes one vertex, so all three arrays can be sized up front
+    size_t cornerCount = 0;
+    for (const auto& shape : shapes) cornerCount += shape.mesh.indices.size();
+    vertices.reserve(cornerCount * 6);
+    indices.reserve(cornerCount);
+    cornerPositions.reserve(cornerCount);
+    
     for (const auto& shape : shapes) {
         for (const auto& index : shape.mesh.indices) {
             // Positions
@@ -1032,11 +2170,12 @@ void loadOBJModel(const char* path) {
                 ny = attrib.normals[3 * index.normal_index + 1];
                 nz = attrib.normals[3 * index.normal_index + 2];
             } else {
-                // Calculate normal from face if not provided
-                // For simplicity, we'll use a default up normal
-                nx = 0.0f; ny = 1.0f; nz = 0.0f;
+                // Generated below once all faces are known
+                missingNormals = true;
             }
             
+            cornerPositions.push_back(static_cast<unsigned int>(index.vertex_index));
+            
             vertices.push_back(px);
             vertices.push_back(py);
             vertices.push_back(pz);
@@ -1049,22 +2188,90 @@ void loadOBJModel(const char* path) {
     }
     
     if (vertices.empty()) {
-        snprintf(statusMessage, sizeof(statusMessage), "No vertices found in OBJ file");
-        return;
+        mesh.message = "No vertices found in OBJ file";
+        return false;
     }
     
-    // Create OpenGL buffers
-    glGenVertexArrays(1, &obj->vao);
-    glGenBuffers(1, &obj->vbo);
-    glGenBuffers(1, &obj->ebo);
-    
-    glBindVertexArray(obj->vao);
+    // Smooth normals (split at 60 degrees) for corners without a file normal
+    if (missingNormals) {
+        std::vector<float> generatedNormals(cornerPositions.size() * 3);
+        NormalGenerator::computeNormals(attrib.vertices.data(), attrib.vertices.size() / 3,
+                                        cornerPositions.data(), cornerPositions.size() / 3,
+                                        60.0f, generatedNormals.data());
+        
+        size_t corner = 0;
+        for (const auto& shape : shapes) {
+            for (const auto& index : shape.mesh.indices) {
+                if (index.normal_index < 0) {
+                    vertices[corner * 6 + 3] = generatedNormals[corner * 3 + 0];
+                    vertices[corner * 6 + 4] = generatedNormals[corner * 3 + 1];
+                    vertices[corner * 6 + 5] = generatedNormals[corner * 3 + 2];
+                }
+                corner++;
+            }
+        }
+    }
     
-    glBindBuffer(GL_ARRAY_BUFFER, obj->vbo);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    mesh.bboxMin = bboxMin;
+    mesh.bboxMax = bboxMax;
+    return true;
+}
+
+// Fill mesh.occlusion, from the .ao file at cachePath when it was baked for these contents
+// and settings. Without a path the bake is neither loaded nor saved. Touches no GL state.
+void bakeMeshOcclusion(ObjMeshData& mesh, const VertexOcclusionSettings& settings, const std::string& cachePath) {
+    TRACE_FUNCTION();
+    size_t vertexCount = mesh.vertices.size() / 6;
+    uint64_t key = VertexOcclusion::key(mesh.contentHash, vertexCount, settings);
+    if (!cachePath.empty() && VertexOcclusion::load(cachePath, key, vertexCount, mesh.occlusion)) return;
+    
+    mesh.occlusion = VertexOcclusion::bake(mesh.vertices.data(), vertexCount, 6,
+                                           mesh.indices.data(), mesh.indices.size(), settings);
+    if (!cachePath.empty() && !VertexOcclusion::save(cachePath, key, mesh.occlusion)) {
+        mesh.message = "Could not write " + cachePath + "; occlusion will be baked again next import";
+    }
+}
+
+// Upload step: fill new buffers for an imported mesh on the upload context (or the render
+// thread without one). The object's old buffers are not touched. Baked occlusion follows
+// the interleaved vertices in the same buffer. The calls bypass the GL capture hooks, which
+// belong to the render thread; the buffers are registered when attachObjectBuffers binds them.
+void uploadObjectBuffers(GameObject& obj, const ObjMeshData& mesh) {
+    TRACE_FUNCTION();
+    size_t vertexBytes = mesh.vertices.size() * sizeof(float);
+    size_t indexBytes = mesh.indices.size() * sizeof(unsigned int);
+    bool occlusion = !mesh.occlusion.empty() && mesh.occlusion.size() * 6 == mesh.vertices.size();
+    size_t occlusionBytes = occlusion ? mesh.occlusion.size() * sizeof(float) : 0;
+    uncapturedGenBuffers(1, &obj.vbo);
+    uncapturedGenBuffers(1, &obj.ebo);
+    
+    // No vertex array exists on this context, so the element buffer goes through a copy target
+    uncapturedBindBuffer(GL_COPY_WRITE_BUFFER, obj.vbo);
+    uncapturedBufferData(GL_COPY_WRITE_BUFFER, vertexBytes + occlusionBytes, NULL, GL_STATIC_DRAW);
+    uncapturedBufferSubData(GL_COPY_WRITE_BUFFER, 0, vertexBytes, mesh.vertices.data());
+    if (occlusion) uncapturedBufferSubData(GL_COPY_WRITE_BUFFER, vertexBytes, occlusionBytes, mesh.occlusion.data());
+    uncapturedBindBuffer(GL_COPY_WRITE_BUFFER, obj.ebo);
+    uncapturedBufferData(GL_COPY_WRITE_BUFFER, indexBytes, mesh.indices.data(), GL_STATIC_DRAW);
+    uncapturedBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    uploadThread.addUploadedBytes(vertexBytes + occlusionBytes + indexBytes);
+    
+    obj.bakedOcclusion = occlusion;
+    obj.vertexCount = static_cast<int>(mesh.vertices.size() / 6);
+    obj.indexCount = static_cast<int>(mesh.indices.size());
+    obj.bboxMin = mesh.bboxMin;
+    obj.bboxMax = mesh.bboxMax;
+}
+
+// Attach step, render thread: vertex arrays are not shared between contexts, so the
+// VAO is made here, and the uploaded buffers join the registry under the object's name
+void attachObjectBuffers(GameObject& obj) {
+    GPU_TRACK(GPU_BUFFER, obj.vbo, obj.name);
+    GPU_TRACK(GPU_BUFFER, obj.ebo, obj.name);
+    obj.vao = GPU_CREATE(GPU_VERTEX_ARRAY, obj.name);
     
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, obj->ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+    glBindVertexArray(obj.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, obj.vbo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, obj.ebo);
     
     // Position attribute
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
@@ -1074,13 +2281,23 @@ void loadOBJModel(const char* path) {
     glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
     glEnableVertexAttribArray(1);
     
-    glBindVertexArray(0);
+    // Occlusion attribute, packed after the last vertex
+    if (obj.bakedOcclusion) {
+        size_t offset = static_cast<size_t>(obj.vertexCount) * 6 * sizeof(float);
+        glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void*)offset);
+        glEnableVertexAttribArray(3);
+    }
     
-    // Set object properties
-    obj->vertexCount = static_cast<int>(vertices.size() / 6);
-    obj->indexCount = static_cast<int>(indices.size());
-    obj->bboxMin = bboxMin;
-    obj->bboxMax = bboxMax;
+    glBindVertexArray(0);
+}
+
+// Parsing and the buffer upload run on the upload thread; the object joins the scene
+// in addLoadedOBJModel() a frame or two later, once its buffers are on the GPU
+void loadOBJModel(const char* path) {
+    TRACE_FUNCTION();
+    std::string source = path;
+    auto mesh = std::make_shared<ObjMeshData>();
+    auto obj = std::make_shared<GameObject>();
     
     // Extract filename from path
     const char* filename = strrchr(path, '/');
@@ -1095,12 +2312,55 @@ void loadOBJModel(const char* path) {
     char* dot = strrchr(obj->name, '.');
     if (dot) *dot = '\0';
     
+    bool bakeOcclusion = vertexOcclusion.enabled;
+    VertexOcclusionSettings occlusionSettings = vertexOcclusion.settings;
+    
+    UploadThread::Job job;
+    job.prepare = [source, mesh, bakeOcclusion, occlusionSettings]() {
+        TRACE_ZONE("OBJ Import");
+        mesh->valid = importOBJMesh(source.c_str(), *mesh);
+        if (mesh->valid && bakeOcclusion) bakeMeshOcclusion(*mesh, occlusionSettings, source + ".ao");
+    };
+    job.upload = [mesh, obj]() {
+        if (!mesh->valid) return;
+        uploadObjectBuffers(*obj, *mesh);
+        
+        // Only the bounds and messages are needed from here on
+        std::vector<float>().swap(mesh->vertices);
+        std::vector<unsigned int>().swap(mesh->indices);
+        std::vector<float>().swap(mesh->occlusion);
+    };
+    job.attach = [mesh, obj]() {
+        if (mesh->valid) attachObjectBuffers(*obj);
+    };
+    job.finish = [source, mesh, obj]() { addLoadedOBJModel(source, *mesh, obj); };
+    uploadThread.submit(job);
+    
+    snprintf(statusMessage, sizeof(statusMessage), "Loading %s...", obj->name);
+}
+
+// Main thread, once the model's buffers are ready to draw
+void addLoadedOBJModel(const std::string& path, const ObjMeshData& mesh, const std::shared_ptr<GameObject>& obj) {
+    if (!mesh.valid) {
+        snprintf(statusMessage, sizeof(statusMessage), "%s", mesh.message.c_str());
+        return;
+    }
+    
+    if (!mesh.message.empty()) {
+        snprintf(statusMessage, sizeof(statusMessage), "%s", mesh.message.c_str());
+    }
+    
+    // Remember the source so edits to the file are picked up
+    strcpy_s(obj->sourcePath, sizeof(obj->sourcePath), path.c_str());
+    hotReload.contentHashes[path] = mesh.contentHash;
+    FileWatcher::watch(path);
+    
     // Calculate center and offset to position at origin
-    glm::vec3 center = (bboxMin + bboxMax) * 0.5f;
+    glm::vec3 center = (mesh.bboxMin + mesh.bboxMax) * 0.5f;
     obj->position = -center;
     
     // Scale the object to fit nicely in view
-    glm::vec3 size = bboxMax - bboxMin;
+    glm::vec3 size = mesh.bboxMax - mesh.bboxMin;
     float maxSize = glm::max(glm::max(size.x, size.y), size.z);
     if (maxSize > 0.0f) {
         float scaleFactor = 2.0f / maxSize;
@@ -1109,212 +2369,2769 @@ void loadOBJModel(const char* path) {
     
     objects.push_back(obj);
     selectedObjectIndex = objects.size() - 1;
+    outlinerObjectAdded(selectedObjectIndex);
     
     snprintf(statusMessage, sizeof(statusMessage), "Loaded OBJ: %s (%d vertices)", 
              obj->name, obj->vertexCount);
     
-    // Auto-center the loaded model
-    autoCenterSelectedModel();
+    // Camera paths live next to the model they were recorded for
+    setCameraPathFileForScene(path.c_str());
+    
+    // Auto-center the loaded model
+    autoCenterSelectedModel();
+}
+
+// Start re-importing a changed source file on a worker thread. One file is
+// imported and uploaded at a time; the rest wait in the queue.
+void startHotReload(const std::string& path) {
+    if (hotReload.job.valid() || hotReload.uploading) {
+        if (std::find(hotReload.queued.begin(), hotReload.queued.end(), path) == hotReload.queued.end()) {
+            hotReload.queued.push_back(path);
+        }
+        return;
+    }
+    
+    // Contents matching the last import need no parse at all
+    auto known = hotReload.contentHashes.find(path);
+    bool hasKnown = known != hotReload.contentHashes.end();
+    uint64_t knownHash = hasKnown ? known->second : 0;
+    
+    bool bakeOcclusion = vertexOcclusion.enabled;
+    VertexOcclusionSettings occlusionSettings = vertexOcclusion.settings;
+    
+    hotReload.reloadingPath = path;
+    hotReload.job = std::async(std::launch::async, [path, hasKnown, knownHash, bakeOcclusion, occlusionSettings]() {
+        ObjMeshData mesh;
+        if (hasKnown && hashFileContents(path.c_str(), mesh.contentHash) && mesh.contentHash == knownHash) {
+            mesh.unchanged = true;
+            return mesh;
+        }
+        mesh.valid = importOBJMesh(path.c_str(), mesh);
+        if (mesh.valid && bakeOcclusion) bakeMeshOcclusion(mesh, occlusionSettings, path + ".ao");
+        return mesh;
+    });
+}
+
+// Runs at the top of the frame, before the packet is built: collects a finished
+// import and points every object loaded from that file at the new buffers
+void updateHotReload() {
+    for (const std::string& path : FileWatcher::poll()) {
+        if (hotReload.enabled) startHotReload(path);
+    }
+    
+    // An optimisation still running on the same object would overwrite the new
+    // mesh, so a finished import waits for it
+    bool optimizing = meshInspector.optimizingObject &&
+                      hotReload.reloadingPath == meshInspector.optimizingObject->sourcePath;
+    
+    if (hotReload.job.valid() && !optimizing &&
+        hotReload.job.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        TRACE_ZONE("Hot Reload Swap");
+        ObjMeshData mesh = hotReload.job.get();
+        std::string path = hotReload.reloadingPath;
+        
+        std::vector<std::shared_ptr<GameObject>> users;
+        for (auto& obj : objects) {
+            if (path == obj->sourcePath) users.push_back(obj);
+        }
+        
+        if (users.empty()) {
+            // Every object from this file was deleted
+            FileWatcher::unwatch(path);
+            hotReload.contentHashes.erase(path);
+        } else if (mesh.unchanged) {
+            // Saved without changes; the current buffers are still right
+        } else if (!mesh.valid) {
+            snprintf(statusMessage, sizeof(statusMessage), "Reload failed, keeping old mesh. %s", mesh.message.c_str());
+        } else {
+            // The swap waits for the upload; reloadingPath stays set until then
+            auto fresh = std::make_shared<GameObject>();
+            auto data = std::make_shared<ObjMeshData>(std::move(mesh));
+            strcpy_s(fresh->name, sizeof(fresh->name), users.front()->name);
+            
+            UploadThread::Job job;
+            job.upload = [fresh, data]() { uploadObjectBuffers(*fresh, *data); };
+            job.attach = [fresh]() { attachObjectBuffers(*fresh); };
+            job.finish = [path, fresh, data]() { swapReloadedMesh(path, *fresh, data->contentHash); };
+            uploadThread.submit(job);
+            hotReload.uploading = true;
+        }
+        if (!hotReload.uploading) hotReload.reloadingPath.clear();
+    }
+    
+    if (!hotReload.job.valid() && !hotReload.uploading && !hotReload.queued.empty()) {
+        std::string next = hotReload.queued.front();
+        hotReload.queued.erase(hotReload.queued.begin());
+        startHotReload(next);
+    }
+}
+
+// Main thread, once a re-imported mesh is on the GPU: points every object loaded
+// from the file at the new buffers
+void swapReloadedMesh(const std::string& path, GameObject& fresh, uint64_t contentHash) {
+    TRACE_FUNCTION();
+    hotReload.uploading = false;
+    hotReload.reloadingPath.clear();
+    
+    // Objects may have been deleted while the upload ran
+    std::vector<std::shared_ptr<GameObject>> users;
+    for (auto& obj : objects) {
+        if (path == obj->sourcePath) users.push_back(obj);
+    }
+    
+    if (users.empty()) {
+        releaseObjectBuffers(fresh);
+        FileWatcher::unwatch(path);
+        hotReload.contentHashes.erase(path);
+        return;
+    }
+    
+    // Transform, color, name and selection live on the objects and are left alone
+    for (auto& obj : users) {
+        releaseObjectBuffers(*obj);
+        obj->vao = fresh.vao;
+        obj->vbo = fresh.vbo;
+        obj->ebo = fresh.ebo;
+        retainObjectBuffers(*obj);
+        obj->vertexCount = fresh.vertexCount;
+        obj->indexCount = fresh.indexCount;
+        obj->bboxMin = fresh.bboxMin;
+        obj->bboxMax = fresh.bboxMax;
+        obj->bakedOcclusion = fresh.bakedOcclusion;
+        
+        if (meshInspector.statsObject == obj) meshInspector.statsValid = false;
+    }
+    releaseObjectBuffers(fresh);
+    
+    hotReload.contentHashes[path] = contentHash;
+    hotReload.reloads++;
+    snprintf(statusMessage, sizeof(statusMessage), "Reloaded %s (%d vertices)",
+             users.front()->name, users.front()->vertexCount);
+}
+
+bool loadGLBModel(const char* path) {
+    TRACE_FUNCTION();
+    // For now, create a simple placeholder
+    snprintf(statusMessage, sizeof(statusMessage), 
+             "GLB loading not implemented. Creating placeholder cube.");
+    
+    createPrimitive("Cube", glm::vec3(0.8f, 0.6f, 0.2f));
+    strcpy_s(objects.back()->name, "GLB_Placeholder");
+    setObjectGpuOwner(*objects.back());
+    outlinerObjectRenamed(objects.size() - 1);
+    
+    return false; // Not implemented
+}
+
+// Center the top, front and side views on a region of the given extent
+void frameOrthographicViews(const glm::vec3& center, float size) {
+    for (auto& sceneView : sceneViews) {
+        sceneView.orthoCenter = center;
+        sceneView.orthoHeight = glm::max(size * 1.5f, 2.0f);
+    }
+}
+
+void centerAllModels() {
+    if (objects.empty()) return;
+    
+    // Calculate collective bounding box
+    glm::vec3 bboxMin = glm::vec3(FLT_MAX);
+    glm::vec3 bboxMax = glm::vec3(-FLT_MAX);
+    
+    for (const auto& obj : objects) {
+        glm::vec3 objMin = obj->bboxMin + obj->position;
+        glm::vec3 objMax = obj->bboxMax + obj->position;
+        
+        bboxMin.x = glm::min(bboxMin.x, objMin.x);
+        bboxMin.y = glm::min(bboxMin.y, objMin.y);
+        bboxMin.z = glm::min(bboxMin.z, objMin.z);
+        
+        bboxMax.x = glm::max(bboxMax.x, objMax.x);
+        bboxMax.y = glm::max(bboxMax.y, objMax.y);
+        bboxMax.z = glm::max(bboxMax.z, objMax.z);
+    }
+    
+    // Calculate center
+    glm::vec3 center = (bboxMin + bboxMax) * 0.5f;
+    
+    // Move camera target to center
+    cameraTarget = center;
+    
+    // Adjust camera distance based on bounding box size
+    glm::vec3 size = bboxMax - bboxMin;
+    float maxSize = glm::max(glm::max(size.x, size.y), size.z);
+    cameraDistance = glm::max(5.0f, maxSize * 2.0f);
+    frameOrthographicViews(center, maxSize);
+}
+
+void autoCenterSelectedModel() {
+    if (selectedObjectIndex >= 0 && selectedObjectIndex < objects.size()) {
+        auto& obj = objects[selectedObjectIndex];
+        
+        // Move camera to look at the object
+        cameraTarget = obj->position;
+        
+        // Calculate appropriate camera distance based on object size
+        glm::vec3 size = obj->bboxMax - obj->bboxMin;
+        float maxSize = glm::max(glm::max(size.x, size.y), size.z);
+        cameraDistance = glm::max(3.0f, maxSize * 2.0f);
+        frameOrthographicViews(obj->position, maxSize * glm::max(glm::max(obj->scale.x, obj->scale.y), obj->scale.z));
+        
+        snprintf(statusMessage, sizeof(statusMessage), "Centered on: %s", obj->name);
+    }
+}
+
+bool readbackMesh(const GameObject& obj, std::vector<float>& vertices, std::vector<unsigned int>& indices, size_t& gpuBytes) {
+    if (obj.vbo == 0 || obj.ebo == 0) return false;
+    
+    // Read through the copy target so the element binding of any VAO is left alone
+    GLint vboSize = 0, eboSize = 0;
+    renderThread.invoke([&]() {
+        glBindBuffer(GL_COPY_READ_BUFFER, obj.vbo);
+        glGetBufferParameteriv(GL_COPY_READ_BUFFER, GL_BUFFER_SIZE, &vboSize);
+        vertices.resize(vboSize / sizeof(float));
+        if (vboSize > 0) glGetBufferSubData(GL_COPY_READ_BUFFER, 0, vboSize, vertices.data());
+        
+        glBindBuffer(GL_COPY_READ_BUFFER, obj.ebo);
+        glGetBufferParameteriv(GL_COPY_READ_BUFFER, GL_BUFFER_SIZE, &eboSize);
+        indices.resize(std::min<size_t>(obj.indexCount, eboSize / sizeof(unsigned int)));
+        if (!indices.empty()) glGetBufferSubData(GL_COPY_READ_BUFFER, 0, indices.size() * sizeof(unsigned int), indices.data());
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    });
+    
+    // Editor meshes are interleaved position + normal
+    vertices.resize(std::min<size_t>(vertices.size(), static_cast<size_t>(obj.vertexCount) * 6));
+    gpuBytes = static_cast<size_t>(vboSize) + static_cast<size_t>(eboSize);
+    return !vertices.empty() && !indices.empty();
+}
+
+// Runs at the top of the frame like updateHotReload(), so the packet sees the new counts
+void updateMeshInspector() {
+    // Collect a finished optimisation and upload it on the render thread
+    if (meshInspector.optimizeJob.valid() &&
+        meshInspector.optimizeJob.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        OptimizedMesh result = meshInspector.optimizeJob.get();
+        auto obj = meshInspector.optimizingObject;
+        meshInspector.optimizingObject.reset();
+        
+        // Skip the upload if the object was deleted while the worker ran
+        bool alive = std::find(objects.begin(), objects.end(), obj) != objects.end();
+        if (alive && obj->vbo && obj->ebo && !result.indices.empty()) {
+            renderThread.invoke([&]() {
+                glBindBuffer(GL_COPY_WRITE_BUFFER, obj->vbo);
+                glBufferData(GL_COPY_WRITE_BUFFER, result.vertices.size() * sizeof(float), result.vertices.data(), GL_STATIC_DRAW);
+                glBindBuffer(GL_COPY_WRITE_BUFFER, obj->ebo);
+                glBufferData(GL_COPY_WRITE_BUFFER, result.indices.size() * sizeof(unsigned int), result.indices.data(), GL_STATIC_DRAW);
+                glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+                
+                // Baked occlusion was dropped with the old vertex order
+                if (obj->bakedOcclusion) {
+                    glBindVertexArray(obj->vao);
+                    glDisableVertexAttribArray(3);
+                    glBindVertexArray(0);
+                }
+            });
+            
+            // Objects can share buffers, keep all of their counts in sync
+            for (auto& other : objects) {
+                if (other->vbo == obj->vbo) {
+                    other->bakedOcclusion = false;
+                    other->vertexCount = static_cast<int>(result.vertices.size() / 6);
+                    other->indexCount = static_cast<int>(result.indices.size());
+                }
+            }
+            invalidatePathTraceMesh(obj->vbo);
+            invalidateLightmap(obj->vbo);
+            invalidateHlodMesh(obj->vbo);
+            
+            snprintf(statusMessage, sizeof(statusMessage), "Optimized %s: %d vertices, %d triangles",
+                     obj->name, obj->vertexCount, obj->indexCount / 3);
+        }
+        meshInspector.statsValid = false;
+        meshInspector.statsObject.reset();
+    }
+    
+    // Collect finished statistics
+    if (meshInspector.analyzeJob.valid() &&
+        meshInspector.analyzeJob.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        meshInspector.stats = meshInspector.analyzeJob.get();
+        meshInspector.statsObject = meshInspector.analyzingObject;
+        meshInspector.statsValid = true;
+        meshInspector.analyzingObject.reset();
+    }
+    
+    if (!showMeshInspectorWindow) return;
+    if (selectedObjectIndex < 0 || selectedObjectIndex >= static_cast<int>(objects.size())) return;
+    
+    // Start analysing a newly selected object once the worker is free
+    auto& selected = objects[selectedObjectIndex];
+    bool busy = meshInspector.analyzeJob.valid() || meshInspector.optimizeJob.valid();
+    bool current = meshInspector.statsValid && meshInspector.statsObject == selected;
+    if (busy || current) return;
+    
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    size_t gpuBytes = 0;
+    if (!readbackMesh(*selected, vertices, indices, gpuBytes)) return;
+    
+    meshInspector.analyzingObject = selected;
+    meshInspector.analyzeJob = std::async(std::launch::async,
+        [vertices = std::move(vertices), indices = std::move(indices), gpuBytes]() {
+            TRACE_ZONE("Mesh Analysis");
+            return MeshAnalyzer::analyze(vertices, 6, indices, gpuBytes);
+        });
+}
+
+void startMeshOptimization(const std::shared_ptr<GameObject>& obj, MeshOptimizeAction action) {
+    if (meshInspector.optimizeJob.valid()) return;
+    
+    // The edit buffers are sized ahead and mirror the half-edge mesh
+    if (meshEdit.object == obj || meshEdit.buildingObject == obj) {
+        snprintf(statusMessage, sizeof(statusMessage), "Finish editing %s first", obj->name);
+        return;
+    }
+    
+    // The result would land in buffers a reload is about to replace
+    if (hotReload.uploading && hotReload.reloadingPath == obj->sourcePath) {
+        snprintf(statusMessage, sizeof(statusMessage), "%s is being reloaded", obj->name);
+        return;
+    }
+    
+    OptimizedMesh mesh;
+    size_t gpuBytes = 0;
+    if (!readbackMesh(*obj, mesh.vertices, mesh.indices, gpuBytes)) return;
+    
+    meshInspector.optimizingObject = obj;
+    meshInspector.optimizeJob = std::async(std::launch::async, [mesh = std::move(mesh), action]() mutable {
+        TRACE_ZONE("Mesh Optimization");
+        if (action == OPTIMIZE_WELD || action == OPTIMIZE_ALL) {
+            MeshAnalyzer::weldVertices(mesh.vertices, 6, mesh.indices);
+        }
+        if (action == OPTIMIZE_CLEANUP || action == OPTIMIZE_ALL) {
+            MeshAnalyzer::removeBadTriangles(mesh.vertices, 6, mesh.indices);
+        }
+        if (action == OPTIMIZE_VERTEX_CACHE || action == OPTIMIZE_ALL) {
+            MeshAnalyzer::optimizeVertexCache(mesh.indices, mesh.vertices.size() / 6);
+        }
+        if (action == OPTIMIZE_VERTEX_FETCH || action == OPTIMIZE_ALL) {
+            MeshAnalyzer::optimizeVertexFetch(mesh.vertices, 6, mesh.indices);
+        }
+        return std::move(mesh);
+    });
+    snprintf(statusMessage, sizeof(statusMessage), "Optimizing %s...", obj->name);
+}
+
+// Reads the mesh back and builds the half-edge structure on a worker thread;
+// updateMeshEdit() switches the object over once it is done
+void beginMeshEdit(const std::shared_ptr<GameObject>& obj) {
+    if (meshEdit.buildJob.valid()) return;
+    endMeshEdit();
+    
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    size_t gpuBytes = 0;
+    if (!readbackMesh(*obj, vertices, indices, gpuBytes)) {
+        snprintf(statusMessage, sizeof(statusMessage), "Cannot read back %s", obj->name);
+        return;
+    }
+    
+    meshEdit.buildingObject = obj;
+    meshEdit.buildJob = std::async(std::launch::async,
+        [vertices = std::move(vertices), indices = std::move(indices)]() {
+            TRACE_ZONE("Half-Edge Build");
+            HalfEdgeMesh mesh;
+            mesh.build(vertices, 6, indices);
+            return mesh;
+        });
+    snprintf(statusMessage, sizeof(statusMessage), "Preparing %s for editing...", obj->name);
+}
+
+// Runs at the top of the frame: gives a freshly built object its edit buffers, and
+// stops editing an object that was deleted
+void updateMeshEdit() {
+    if (meshEdit.object && std::find(objects.begin(), objects.end(), meshEdit.object) == objects.end()) {
+        meshEdit.object.reset();
+        meshEdit.mesh.clear();
+        meshEdit.selectedFaces.clear();
+    }
+    
+    if (!meshEdit.buildJob.valid() ||
+        meshEdit.buildJob.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return;
+    
+    TRACE_ZONE("Mesh Edit Setup");
+    HalfEdgeMesh mesh = meshEdit.buildJob.get();
+    auto obj = meshEdit.buildingObject;
+    meshEdit.buildingObject.reset();
+    if (std::find(objects.begin(), objects.end(), obj) == objects.end()) return;
+    if (mesh.faceCount() == 0) {
+        snprintf(statusMessage, sizeof(statusMessage), "%s has no faces to edit", obj->name);
+        return;
+    }
+    
+    meshEdit.object = obj;
+    meshEdit.mesh = std::move(mesh);
+    meshEdit.selectedFaces.clear();
+    meshEdit.moveOffset = glm::vec3(0.0f);
+    const HalfEdgeMesh& edit = meshEdit.mesh;
+    
+    // Half as much again as the mesh needs, so most edits append in place
+    meshEdit.vertexCapacity = edit.vertexCount() + edit.vertexCount() / 2 + 1024;
+    meshEdit.indexCapacity = edit.indexCount() + edit.indexCount() / 2 + 3072;
+    std::vector<float> vertices(static_cast<size_t>(edit.vertexCount()) * 6);
+    std::vector<unsigned int> indices(edit.indexCount());
+    edit.writeVertices(0, edit.vertexCount(), vertices.data());
+    edit.writeIndices(0, edit.faceCount(), indices.data());
+    
+    // Buffers of its own: duplicates keep the shared mesh. Neither the file (hot reload) nor
+    // the analytic shape (tessellation) describes the object any more.
+    releaseObjectBuffers(*obj);
+    obj->sourcePath[0] = '\0';
+    obj->shape = SHAPE_MESH;
+    obj->bakedOcclusion = false;
+    renderThread.invoke([&]() {
+        obj->vao = GPU_CREATE(GPU_VERTEX_ARRAY, obj->name);
+        obj->vbo = GPU_CREATE(GPU_BUFFER, obj->name);
+        obj->ebo = GPU_CREATE(GPU_BUFFER, obj->name);
+        
+        glBindVertexArray(obj->vao);
+        glBindBuffer(GL_ARRAY_BUFFER, obj->vbo);
+        glBufferData(GL_ARRAY_BUFFER, meshEdit.vertexCapacity * 6 * sizeof(float), NULL, GL_DYNAMIC_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(float), vertices.data());
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, obj->ebo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, meshEdit.indexCapacity * sizeof(unsigned int), NULL, GL_DYNAMIC_DRAW);
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indices.size() * sizeof(unsigned int), indices.data());
+        
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+        glBindVertexArray(0);
+    });
+    obj->vertexCount = edit.vertexCount();
+    obj->indexCount = edit.indexCount();
+    if (meshInspector.statsObject == obj) meshInspector.statsValid = false;
+    
+    // A subdivided object's cage now comes from the edit mesh, so vertex ids line up
+    if (findSubdivision(obj.get())) reshapeSubdivisionCage(*obj, edit);
+    
+    snprintf(statusMessage, sizeof(statusMessage), "Editing %s: %d vertices, %d faces (Ctrl+click selects faces)",
+             obj->name, edit.vertexCount(), edit.faceCount());
+}
+
+// Push what the last edits changed. Dirty ranges go up with glBufferSubData; a buffer
+// that ran out of room is reallocated at twice the size and filled once.
+void uploadMeshEdits() {
+    TRACE_FUNCTION();
+    HalfEdgeMesh& mesh = meshEdit.mesh;
+    auto obj = meshEdit.object;
+    invalidatePathTraceMesh(obj->vbo);
+    invalidateLightmap(obj->vbo);
+    invalidateHlodMesh(obj->vbo);
+    bool growVertices = static_cast<size_t>(mesh.vertexCount()) > meshEdit.vertexCapacity;
+    bool growIndices = static_cast<size_t>(mesh.indexCount()) > meshEdit.indexCapacity;
+    if (growVertices) meshEdit.vertexCapacity = static_cast<size_t>(mesh.vertexCount()) * 2;
+    if (growIndices) meshEdit.indexCapacity = static_cast<size_t>(mesh.indexCount()) * 2;
+    
+    // Packed here so the render thread only copies; first is the offset into the staging data
+    struct Span {
+        size_t offset, count, first;
+    };
+    std::vector<float> vertexData;
+    std::vector<Span> vertexSpans;
+    std::vector<DirtyRanges::Range> vertexRanges = mesh.dirtyVertices.ranges();
+    if (growVertices) vertexRanges.assign(1, DirtyRanges::Range{ 0, mesh.vertexCount() });
+    for (const DirtyRanges::Range& r : vertexRanges) {
+        Span span = { static_cast<size_t>(r.begin) * 6, static_cast<size_t>(r.end - r.begin) * 6, vertexData.size() };
+        vertexData.resize(vertexData.size() + span.count);
+        mesh.writeVertices(r.begin, r.end, &vertexData[span.first]);
+        vertexSpans.push_back(span);
+        
+        // Bounds only grow while editing; endMeshEdit() tightens them
+        for (int v = r.begin; v < r.end; ++v) {
+            glm::vec3 p(mesh.positions[v * 3], mesh.positions[v * 3 + 1], mesh.positions[v * 3 + 2]);
+            obj->bboxMin = glm::min(obj->bboxMin, p);
+            obj->bboxMax = glm::max(obj->bboxMax, p);
+        }
+    }
+    
+    std::vector<unsigned int> indexData;
+    std::vector<Span> indexSpans;
+    std::vector<DirtyRanges::Range> faceRanges = mesh.dirtyFaces.ranges();
+    if (growIndices) faceRanges.assign(1, DirtyRanges::Range{ 0, mesh.faceCount() });
+    for (const DirtyRanges::Range& r : faceRanges) {
+        size_t first = mesh.indexOffset(r.begin);
+        Span span = { first, static_cast<size_t>(mesh.indexOffset(r.end)) - first, indexData.size() };
+        indexData.resize(indexData.size() + span.count);
+        mesh.writeIndices(r.begin, r.end, &indexData[span.first]);
+        indexSpans.push_back(span);
+    }
+    mesh.dirtyVertices.clear();
+    mesh.dirtyFaces.clear();
+    
+    renderThread.invoke([&]() {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, obj->vbo);
+        if (growVertices) {
+            glBufferData(GL_COPY_WRITE_BUFFER, meshEdit.vertexCapacity * 6 * sizeof(float), NULL, GL_DYNAMIC_DRAW);
+        }
+        for (const Span& span : vertexSpans) {
+            glBufferSubData(GL_COPY_WRITE_BUFFER, span.offset * sizeof(float), span.count * sizeof(float),
+                            &vertexData[span.first]);
+        }
+        
+        glBindBuffer(GL_COPY_WRITE_BUFFER, obj->ebo);
+        if (growIndices) {
+            glBufferData(GL_COPY_WRITE_BUFFER, meshEdit.indexCapacity * sizeof(unsigned int), NULL, GL_DYNAMIC_DRAW);
+        }
+        for (const Span& span : indexSpans) {
+            glBufferSubData(GL_COPY_WRITE_BUFFER, span.offset * sizeof(unsigned int), span.count * sizeof(unsigned int),
+                            &indexData[span.first]);
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    });
+    
+    // Duplicates made while editing share the buffers, keep all of their counts in sync
+    for (auto& other : objects) {
+        if (other->vbo == obj->vbo) {
+            other->vertexCount = mesh.vertexCount();
+            other->indexCount = mesh.indexCount();
+        }
+    }
+    meshEdit.lastUploadBytes = vertexData.size() * sizeof(float) + indexData.size() * sizeof(unsigned int);
+    meshEdit.lastUploadCalls = static_cast<int>(vertexSpans.size() + indexSpans.size());
+}
+
+void endMeshEdit() {
+    if (!meshEdit.object) return;
+    
+    float minimum[3], maximum[3];
+    meshEdit.mesh.bounds(minimum, maximum);
+    for (auto& other : objects) {
+        if (other->vbo == meshEdit.object->vbo) {
+            other->bboxMin = glm::make_vec3(minimum);
+            other->bboxMax = glm::make_vec3(maximum);
+        }
+    }
+    if (meshInspector.statsObject == meshEdit.object) meshInspector.statsValid = false;
+    
+    snprintf(statusMessage, sizeof(statusMessage), "Finished editing %s", meshEdit.object->name);
+    meshEdit.object.reset();
+    meshEdit.mesh.clear();
+    meshEdit.selectedFaces.clear();
+}
+
+// Cast a ray through the cursor in the view under it; shift toggles faces in the selection
+void pickMeshEditFace(double x, double y, bool extend) {
+    TRACE_FUNCTION();
+    const SceneView& view = sceneViews[activeSceneView];
+    if (view.screenSize.x <= 0.0f || view.screenSize.y <= 0.0f) return;
+    
+    glm::vec2 ndc((static_cast<float>(x) - view.screenPos.x) / view.screenSize.x * 2.0f - 1.0f,
+                  1.0f - (static_cast<float>(y) - view.screenPos.y) / view.screenSize.y * 2.0f);
+    glm::mat4 toObject = glm::inverse(view.projection * view.view * meshEdit.object->getModelMatrix());
+    glm::vec4 nearPoint = toObject * glm::vec4(ndc, -1.0f, 1.0f);
+    glm::vec4 farPoint = toObject * glm::vec4(ndc, 1.0f, 1.0f);
+    glm::vec3 origin = glm::vec3(nearPoint) / nearPoint.w;
+    glm::vec3 direction = glm::vec3(farPoint) / farPoint.w - origin;
+    
+    int face = meshEdit.mesh.pickFace(glm::value_ptr(origin), glm::value_ptr(direction));
+    std::vector<int>& selection = meshEdit.selectedFaces;
+    if (!extend) selection.clear();
+    if (face < 0) return;
+    
+    auto it = std::find(selection.begin(), selection.end(), face);
+    if (it == selection.end()) {
+        selection.push_back(face);
+    } else {
+        selection.erase(it);
+    }
+    meshEdit.moveOffset = glm::vec3(0.0f);
+}
+
+// Outlines of the selected faces, drawn through the gizmo's line path
+void buildMeshEditHighlight(FramePacket& packet) {
+    const size_t MAX_OUTLINED_FACES = 4096;
+    const HalfEdgeMesh& mesh = meshEdit.mesh;
+    std::vector<float>& vertices = packet.gizmoVertices;
+    std::vector<float>& colors = packet.gizmoColors;
+    vertices.clear();
+    colors.clear();
+    
+    size_t count = std::min(meshEdit.selectedFaces.size(), MAX_OUTLINED_FACES);
+    for (size_t i = 0; i < count; ++i) {
+        int f = meshEdit.selectedFaces[i];
+        for (int h = mesh.faceStart[f]; h < mesh.faceStart[f + 1]; ++h) {
+            const float* a = &mesh.positions[mesh.edgeVertex[h] * 3];
+            const float* b = &mesh.positions[mesh.edgeVertex[mesh.next(h)] * 3];
+            vertices.insert(vertices.end(), a, a + 3);
+            vertices.insert(vertices.end(), b, b + 3);
+            for (int k = 0; k < 2; ++k) {
+                colors.push_back(COLOR_ACCENT.x);
+                colors.push_back(COLOR_ACCENT.y);
+                colors.push_back(COLOR_ACCENT.z);
+            }
+        }
+    }
+    
+    packet.drawGizmo = !vertices.empty();
+    packet.gizmoLineStrip = false;
+    packet.gizmoModel = meshEdit.object->getModelMatrix();
+}
+
+SubdivisionEntry* findSubdivision(const GameObject* obj) {
+    for (auto& entry : subdivision.entries) {
+        if (entry->object.get() == obj) return entry.get();
+    }
+    return NULL;
+}
+
+// Read the object's mesh back and weld it into a cage on a worker thread
+static bool readSubdivisionCage(SubdivisionEntry& entry) {
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    size_t gpuBytes = 0;
+    if (!readbackMesh(*entry.object, vertices, indices, gpuBytes)) return false;
+    
+    entry.cageVbo = entry.object->vbo;
+    entry.cageJob = std::async(std::launch::async,
+        [vertices = std::move(vertices), indices = std::move(indices)]() {
+            TRACE_ZONE("Subdivision Cage");
+            HalfEdgeMesh mesh;
+            if (!mesh.build(vertices, 6, indices)) return SubdivisionCage();
+            return SubdivisionCage::fromHalfEdgeMesh(mesh, true);
+        });
+    return true;
+}
+
+void enableSubdivision(const std::shared_ptr<GameObject>& obj) {
+    if (findSubdivision(obj.get())) return;
+    
+    std::unique_ptr<SubdivisionEntry> entry(new SubdivisionEntry());
+    entry->object = obj;
+    if (meshEdit.object == obj) {
+        entry->cageVbo = obj->vbo;
+        setSubdivisionCage(*entry, SubdivisionCage::fromHalfEdgeMesh(meshEdit.mesh, true));
+    } else if (!readSubdivisionCage(*entry)) {
+        snprintf(statusMessage, sizeof(statusMessage), "Cannot read back %s", obj->name);
+        return;
+    }
+    subdivision.entries.push_back(std::move(entry));
+}
+
+void removeSubdivision(const GameObject* obj) {
+    auto it = std::find_if(subdivision.entries.begin(), subdivision.entries.end(),
+                           [obj](const std::unique_ptr<SubdivisionEntry>& entry) { return entry->object.get() == obj; });
+    if (it == subdivision.entries.end()) return;
+    
+    releaseSubdivisionBuffers(**it);
+    // Futures from std::async block when destroyed; let running workers finish first
+    if ((*it)->cageJob.valid() || (*it)->buildJob.valid()) subdivision.retired.push_back(std::move(*it));
+    subdivision.entries.erase(it);
+}
+
+void setSubdivisionCage(SubdivisionEntry& entry, SubdivisionCage cage) {
+    entry.cage = std::move(cage);
+    invalidateSubdivision(entry);
+}
+
+// The built levels no longer match the cage; the uploaded surface stays on screen until
+// a new one lands
+void invalidateSubdivision(SubdivisionEntry& entry) {
+    entry.deviation = SubdivisionSurface::cageDeviation(entry.cage, entry.creaseAngle);
+    entry.topology++;
+    for (auto& level : entry.levels) level.reset();
+}
+
+// Mesh edit moved cage vertices: only the refined vertices that depend on them are evaluated
+void moveSubdivisionCage(const GameObject& obj, const HalfEdgeMesh& mesh) {
+    SubdivisionEntry* entry = findSubdivision(&obj);
+    if (!entry || entry->cage.vertexCount() != mesh.vertexCount()) return;
+    
+    auto start = std::chrono::steady_clock::now();
+    std::vector<int> moved;
+    for (const DirtyRanges::Range& r : mesh.dirtyVertices.ranges()) {
+        memcpy(&entry->cage.positions[r.begin * 3], &mesh.positions[r.begin * 3], (r.end - r.begin) * 3 * sizeof(float));
+        for (int v = r.begin; v < r.end; ++v) moved.push_back(v);
+    }
+    
+    // Levels other than the one shown are evaluated again when they are switched to
+    if (entry->level < 0 || !entry->levels[entry->level]) return;
+    SubdivisionSurface& surface = *entry->levels[entry->level];
+    surface.update(entry->cage.positions.data(), moved);
+    uploadSubdivision(*entry, surface, false);
+    subdivision.lastUpdateMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Mesh edit changed the cage's faces; the tables are rebuilt in the background
+void reshapeSubdivisionCage(const GameObject& obj, const HalfEdgeMesh& mesh) {
+    SubdivisionEntry* entry = findSubdivision(&obj);
+    if (!entry) return;
+    entry->cageVbo = obj.vbo;
+    setSubdivisionCage(*entry, SubdivisionCage::fromHalfEdgeMesh(mesh, true));
+}
+
+// Screen pixels per object-space unit, in whichever view shows the object largest
+static float subdivisionPixelsPerUnit(const GameObject& obj) {
+    glm::mat4 model = obj.getModelMatrix();
+    float maxScale = glm::max(glm::max(glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1]))),
+                              glm::length(glm::vec3(model[2])));
+    glm::vec3 center = glm::vec3(model * glm::vec4((obj.bboxMin + obj.bboxMax) * 0.5f, 1.0f));
+    float radius = glm::length(obj.bboxMax - obj.bboxMin) * 0.5f * maxScale;
+    
+    float best = 0.0f;
+    for (int i = 0; i < sceneViewCount(); ++i) {
+        const SceneView& view = sceneViews[i];
+        if (view.screenSize.y <= 0.0f) continue;
+        
+        // projection[1][1] is cot(fov / 2) in perspective and 2 / height in orthographic views
+        float pixels = view.projection[1][1] * 0.5f * view.screenSize.y;
+        if (view.type == VIEW_PERSPECTIVE) {
+            float depth = -(view.view * glm::vec4(center, 1.0f)).z - radius;
+            pixels /= glm::max(depth, 0.1f);
+        }
+        best = glm::max(best, pixels * maxScale);
+    }
+    return best;
+}
+
+static size_t subdivisionFaceCount(const SubdivisionEntry& entry, int level) {
+    if (entry.scheme == SUBDIVISION_CATMULL_CLARK) {
+        return SubdivisionSurface::faceCountAt(entry.cage, SUBDIVISION_CATMULL_CLARK, level);
+    }
+    size_t triangles = entry.cage.faceVertices.size() - 2 * static_cast<size_t>(entry.cage.faceCount());
+    return triangles << (2 * level);
+}
+
+static int chooseSubdivisionLevel(const SubdivisionEntry& entry) {
+    int level = entry.fixedLevel;
+    if (entry.adaptive) {
+        float pixelsPerUnit = subdivisionPixelsPerUnit(*entry.object);
+        level = SubdivisionSurface::levelFor(entry.deviation, pixelsPerUnit, subdivision.pixelTolerance, subdivision.maxLevel);
+        
+        // Step down only once the level below would be well within tolerance, so an object
+        // sitting at the threshold does not flip between levels
+        if (level < entry.level &&
+            SubdivisionSurface::levelFor(entry.deviation, pixelsPerUnit, subdivision.pixelTolerance * 0.5f,
+                                         subdivision.maxLevel) >= entry.level) {
+            level = entry.level;
+        }
+    }
+    while (level > 0 && subdivisionFaceCount(entry, level) > SubdivisionState::MAX_FACES) level--;
+    return level;
+}
+
+static void showSubdivisionLevel(SubdivisionEntry& entry, int level) {
+    TRACE_FUNCTION();
+    SubdivisionSurface& surface = *entry.levels[level];
+    surface.evaluate(entry.cage.positions.data());
+    uploadSubdivision(entry, surface, true);
+    entry.level = level;
+}
+
+static void startSubdivisionBuild(SubdivisionEntry& entry, int level) {
+    entry.buildLevel = level;
+    entry.buildTopology = entry.topology;
+    entry.buildStart = std::chrono::steady_clock::now();
+    
+    SubdivisionCage cage = entry.scheme == SUBDIVISION_LOOP ? entry.cage.triangulated() : entry.cage;
+    SubdivisionScheme scheme = entry.scheme;
+    float creaseAngle = entry.creaseAngle;
+    entry.buildJob = std::async(std::launch::async, [cage = std::move(cage), scheme, level, creaseAngle]() {
+        TRACE_ZONE("Subdivision Build");
+        std::unique_ptr<SubdivisionSurface> surface(new SubdivisionSurface());
+        if (!surface->build(cage, scheme, level, creaseAngle)) surface.reset();
+        return surface;
+    });
+}
+
+template <typename T>
+static bool futureReady(const std::future<T>& job) {
+    return job.valid() && job.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+// Runs at the top of the frame: collects cages and builds, and moves every surface to the
+// level its screen size calls for
+void updateSubdivision() {
+    TRACE_FUNCTION();
+    auto& retired = subdivision.retired;
+    retired.erase(std::remove_if(retired.begin(), retired.end(), [](const std::unique_ptr<SubdivisionEntry>& entry) {
+        return (!entry->cageJob.valid() || futureReady(entry->cageJob)) &&
+               (!entry->buildJob.valid() || futureReady(entry->buildJob));
+    }), retired.end());
+    
+    // Surfaces of deleted objects go, and so do those of meshes without faces
+    std::vector<const GameObject*> dropped;
+    for (auto& entry : subdivision.entries) {
+        if (std::find(objects.begin(), objects.end(), entry->object) == objects.end()) {
+            dropped.push_back(entry->object.get());
+        } else if (futureReady(entry->cageJob)) {
+            SubdivisionCage cage = entry->cageJob.get();
+            if (cage.faceCount() == 0) {
+                snprintf(statusMessage, sizeof(statusMessage), "%s has no faces to subdivide", entry->object->name);
+                dropped.push_back(entry->object.get());
+            } else {
+                setSubdivisionCage(*entry, std::move(cage));
+            }
+        }
+    }
+    for (const GameObject* obj : dropped) removeSubdivision(obj);
+    
+    for (auto& pointer : subdivision.entries) {
+        SubdivisionEntry& entry = *pointer;
+        
+        // A reload replaced the mesh underneath; mesh edit keeps the cage current itself
+        if (!entry.cageJob.valid() && entry.object->vbo != entry.cageVbo && entry.object != meshEdit.object) {
+            entry.cageVbo = entry.object->vbo;
+            readSubdivisionCage(entry);
+        }
+        if (entry.cage.faceCount() == 0) continue;
+        
+        if (futureReady(entry.buildJob)) {
+            std::unique_ptr<SubdivisionSurface> surface = entry.buildJob.get();
+            if (surface && entry.buildTopology == entry.topology) {
+                entry.levels[entry.buildLevel] = std::move(surface);
+                entry.buildMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - entry.buildStart).count();
+            }
+        }
+        
+        entry.wantedLevel = chooseSubdivisionLevel(entry);
+        if (entry.levels[entry.wantedLevel]) {
+            if (entry.wantedLevel != entry.level) showSubdivisionLevel(entry, entry.wantedLevel);
+        } else if (!entry.buildJob.valid()) {
+            startSubdivisionBuild(entry, entry.wantedLevel);
+        }
+    }
+}
+
+// Buffers grow by a quarter when a level outgrows them. A level change fills them in full;
+// cage moves upload the surface's dirty vertex ranges only.
+void uploadSubdivision(SubdivisionEntry& entry, SubdivisionSurface& surface, bool full) {
+    TRACE_FUNCTION();
+    const std::vector<float>& vertices = surface.vertexData();
+    const std::vector<unsigned int>& indices = surface.indexData();
+    size_t vertexCount = surface.vertexCount(), indexCount = surface.indexCount();
+    bool growVertices = vertexCount > entry.vertexCapacity;
+    bool growIndices = indexCount > entry.indexCapacity;
+    if (growVertices) entry.vertexCapacity = vertexCount + vertexCount / 4;
+    if (growIndices) entry.indexCapacity = indexCount + indexCount / 4;
+    
+    std::vector<DirtyRanges::Range> ranges = surface.dirtyVertices.ranges();
+    if (full) ranges.assign(1, DirtyRanges::Range{ 0, static_cast<int>(vertexCount) });
+    surface.dirtyVertices.clear();
+    invalidatePathTraceMesh(entry.vbo);
+    
+    size_t bytes = full ? indexCount * sizeof(unsigned int) : 0;
+    for (const DirtyRanges::Range& r : ranges) bytes += static_cast<size_t>(r.end - r.begin) * 6 * sizeof(float);
+    
+    renderThread.invoke([&]() {
+        if (!entry.vao) {
+            entry.vao = GPU_CREATE(GPU_VERTEX_ARRAY, entry.object->name);
+            entry.vbo = GPU_CREATE(GPU_BUFFER, entry.object->name);
+            entry.ebo = GPU_CREATE(GPU_BUFFER, entry.object->name);
+            
+            glBindVertexArray(entry.vao);
+            glBindBuffer(GL_ARRAY_BUFFER, entry.vbo);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, entry.ebo);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
+            glEnableVertexAttribArray(1);
+            glBindVertexArray(0);
+        }
+        
+        glBindBuffer(GL_COPY_WRITE_BUFFER, entry.vbo);
+        if (growVertices) {
+            glBufferData(GL_COPY_WRITE_BUFFER, entry.vertexCapacity * 6 * sizeof(float), NULL, GL_DYNAMIC_DRAW);
+        }
+        for (const DirtyRanges::Range& r : ranges) {
+            glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<size_t>(r.begin) * 6 * sizeof(float),
+                            static_cast<size_t>(r.end - r.begin) * 6 * sizeof(float), &vertices[r.begin * 6]);
+        }
+        
+        if (full) {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, entry.ebo);
+            if (growIndices) {
+                glBufferData(GL_COPY_WRITE_BUFFER, entry.indexCapacity * sizeof(unsigned int), NULL, GL_DYNAMIC_DRAW);
+            }
+            glBufferSubData(GL_COPY_WRITE_BUFFER, 0, indexCount * sizeof(unsigned int), indices.data());
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    });
+    entry.indexCount = static_cast<int>(indexCount);
+    subdivision.lastUpdateBytes = bytes;
+}
+
+// Frames already built may still draw the surface, so the release waits until they have
+void releaseSubdivisionBuffers(const SubdivisionEntry& entry) {
+    GLuint vao = entry.vao, vbo = entry.vbo, ebo = entry.ebo;
+    if (!vao) return;
+    renderThread.defer([vao, vbo, ebo]() {
+        GpuMemory::release(GPU_VERTEX_ARRAY, vao);
+        GpuMemory::release(GPU_BUFFER, vbo);
+        GpuMemory::release(GPU_BUFFER, ebo);
+    });
+}
+
+// The buffer was rewritten in place: read it again at the next restart
+void invalidatePathTraceMesh(GLuint vbo) {
+    auto it = pathTrace.meshes.find(vbo);
+    if (it == pathTrace.meshes.end()) return;
+    if (it->second.id >= 0) pathTrace.staleMeshes.push_back(it->second.id);
+    pathTrace.meshes.erase(it);
+    pathTrace.sceneHash = 0;
+}
+
+// FNV-1a over the bytes of each value
+static uint64_t hashPathTraceBytes(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+// Buffer an object is drawn from, with the CPU copy of it when it is a subdivision surface
+static GLuint pathTraceSource(const GameObject& obj, const SubdivisionSurface*& surface, int& vertexCount, int& indexCount) {
+    const SubdivisionEntry* entry = subdivision.entries.empty() ? NULL : findSubdivision(&obj);
+    surface = entry && entry->level >= 0 ? entry->levels[entry->level].get() : NULL;
+    if (surface) {
+        vertexCount = surface->vertexCount();
+        indexCount = surface->indexCount();
+        return entry->vbo;
+    }
+    vertexCount = obj.vertexCount;
+    indexCount = obj.indexCount;
+    return obj.vbo;
+}
+
+static uint64_t hashPathTraceScene(const SceneView& sceneView) {
+    uint64_t hash = 14695981039346656037ull;
+    for (const auto& obj : objects) {
+        if (!obj->visible) continue;
+        const SubdivisionSurface* surface;
+        int vertexCount, indexCount;
+        GLuint vbo = pathTraceSource(*obj, surface, vertexCount, indexCount);
+        glm::mat4 model = obj->getModelMatrix();
+        hash = hashPathTraceBytes(hash, &vbo, sizeof(vbo));
+        hash = hashPathTraceBytes(hash, &vertexCount, sizeof(vertexCount));
+        hash = hashPathTraceBytes(hash, &indexCount, sizeof(indexCount));
+        hash = hashPathTraceBytes(hash, glm::value_ptr(model), sizeof(model));
+        hash = hashPathTraceBytes(hash, glm::value_ptr(obj->color), sizeof(obj->color));
+    }
+    hash = hashPathTraceBytes(hash, glm::value_ptr(sceneView.view), sizeof(sceneView.view));
+    hash = hashPathTraceBytes(hash, glm::value_ptr(sceneView.projection), sizeof(sceneView.projection));
+    hash = hashPathTraceBytes(hash, &sceneView.screenSize, sizeof(sceneView.screenSize));
+    hash = hashPathTraceBytes(hash, glm::value_ptr(lightPos), sizeof(lightPos));
+    hash = hashPathTraceBytes(hash, lightColor, sizeof(lightColor));
+    hash = hashPathTraceBytes(hash, backgroundColor, sizeof(backgroundColor));
+    hash = hashPathTraceBytes(hash, &pathTrace.maxSamples, sizeof(pathTrace.maxSamples));
+    hash = hashPathTraceBytes(hash, &pathTrace.maxBounces, sizeof(pathTrace.maxBounces));
+    hash = hashPathTraceBytes(hash, &pathTrace.groundPlane, sizeof(pathTrace.groundPlane));
+    hash = hashPathTraceBytes(hash, &pathTrace.exposure, sizeof(pathTrace.exposure));
+    return hash | 1;
+}
+
+// Lighting as the viewport shader does it; the sky stands in for its ambient term
+static void setPathTraceLighting(PathTracer::Settings& settings) {
+    for (int k = 0; k < 3; ++k) {
+        settings.lightPosition[k] = lightPos[k];
+        settings.lightColor[k] = lightColor[k];
+        settings.skyColor[k] = 0.2f * lightColor[k];
+        settings.background[k] = backgroundColor[k];
+    }
+}
+
+// Stops the passes, brings meshes and instances up to date and starts again from no samples.
+// Meshes not read yet are read back once; subdivision surfaces come from their CPU copy.
+void restartPathTrace(const SceneView& sceneView) {
+    TRACE_FUNCTION();
+    auto start = std::chrono::steady_clock::now();
+    PathTracer& tracer = pathTrace.tracer;
+    tracer.stop();
+    for (int id : pathTrace.staleMeshes) {
+        tracer.removeMesh(id);
+    }
+    pathTrace.staleMeshes.clear();
+    
+    // Drop the meshes no object uses anymore
+    std::vector<GLuint> used;
+    for (const auto& obj : objects) {
+        const SubdivisionSurface* surface;
+        int vertexCount, indexCount;
+        used.push_back(pathTraceSource(*obj, surface, vertexCount, indexCount));
+        used.push_back(obj->vbo);
+    }
+    std::sort(used.begin(), used.end());
+    for (auto it = pathTrace.meshes.begin(); it != pathTrace.meshes.end();) {
+        if (std::binary_search(used.begin(), used.end(), it->first)) {
+            ++it;
+            continue;
+        }
+        if (it->second.id >= 0) tracer.removeMesh(it->second.id);
+        it = pathTrace.meshes.erase(it);
+    }
+    
+    tracer.clearInstances();
+    glm::vec3 sceneMin(FLT_MAX), sceneMax(-FLT_MAX);
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    for (const auto& obj : objects) {
+        if (!obj->visible) continue;
+        const SubdivisionSurface* surface;
+        int vertexCount, indexCount;
+        GLuint vbo = pathTraceSource(*obj, surface, vertexCount, indexCount);
+        if (vbo == 0 || indexCount == 0) continue;
+        
+        PathTraceMesh& mesh = pathTrace.meshes[vbo];
+        if (mesh.id >= 0 && (mesh.vertexCount != vertexCount || mesh.indexCount != indexCount)) {
+            tracer.removeMesh(mesh.id);
+            mesh.id = -1;
+        }
+        if (mesh.id < 0) {
+            if (surface) {
+                mesh.id = tracer.addMesh(surface->vertexData().data(), vertexCount, 6,
+                                         surface->indexData().data(), indexCount);
+            } else {
+                size_t gpuBytes = 0;
+                if (!readbackMesh(*obj, vertices, indices, gpuBytes)) continue;
+                mesh.id = tracer.addMesh(vertices.data(), vertices.size() / 6, 6, indices.data(), indices.size());
+            }
+            mesh.vertexCount = vertexCount;
+            mesh.indexCount = indexCount;
+        }
+        
+        glm::mat4 model = obj->getModelMatrix();
+        tracer.addInstance(mesh.id, glm::value_ptr(model), glm::value_ptr(obj->color));
+        for (int corner = 0; corner < 8; ++corner) {
+            glm::vec3 local((corner & 1) ? obj->bboxMax.x : obj->bboxMin.x,
+                            (corner & 2) ? obj->bboxMax.y : obj->bboxMin.y,
+                            (corner & 4) ? obj->bboxMax.z : obj->bboxMin.z);
+            glm::vec3 world = glm::vec3(model * glm::vec4(local, 1.0f));
+            sceneMin = glm::min(sceneMin, world);
+            sceneMax = glm::max(sceneMax, world);
+        }
+    }
+    
+    PathTracer::Settings settings;
+    setPathTraceLighting(settings);
+    settings.maxBounces = pathTrace.maxBounces;
+    settings.groundPlane = pathTrace.groundPlane && sceneMin.y <= sceneMax.y;
+    settings.groundHeight = sceneMin.y;
+    settings.exposure = pathTrace.exposure;
+    tracer.setSettings(settings);
+    
+    glm::mat4 inverseViewProjection = glm::inverse(sceneView.projection * sceneView.view);
+    tracer.setCamera(glm::value_ptr(inverseViewProjection), static_cast<int>(sceneView.screenSize.x),
+                     static_cast<int>(sceneView.screenSize.y));
+    tracer.start(pathTrace.maxSamples);
+    pathTrace.displayed = false;
+    pathTrace.restartMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Main thread, after buildScenePacket(): restart on any change and hand the newest image to the
+// packet. Until the first pass after a restart lands, the view is rasterized as usual.
+void updatePathTrace(FramePacket& packet) {
+    TRACE_FUNCTION();
+    packet.pathTraced = false;
+    packet.pathTraceImage.clear();
+    if (!pathTrace.enabled) {
+        if (pathTrace.sceneHash != 0 || pathTrace.tracer.running()) {
+            pathTrace.tracer.stop();
+            pathTrace.tracer.clearMeshes();
+            pathTrace.meshes.clear();
+            pathTrace.staleMeshes.clear();
+            pathTrace.sceneHash = 0;
+            pathTrace.displayed = false;
+        }
+        return;
+    }
+    if (packet.viewCount == 0) return;
+    
+    const SceneView& sceneView = sceneViews[0];
+    if (static_cast<int>(sceneView.screenSize.x) <= 0 || static_cast<int>(sceneView.screenSize.y) <= 0) return;
+    uint64_t hash = hashPathTraceScene(sceneView);
+    if (hash != pathTrace.sceneHash) {
+        restartPathTrace(sceneView);
+        pathTrace.sceneHash = hash;
+    }
+    
+    if (pathTrace.tracer.takeImage(packet.pathTraceImage, pathTrace.imageVersion, true)) {
+        packet.pathTraceWidth = pathTrace.tracer.width();
+        packet.pathTraceHeight = pathTrace.tracer.height();
+        pathTrace.displayed = true;
+    }
+    packet.pathTraced = pathTrace.displayed;
+}
+
+// Render thread: the traced image goes straight into the view's texture, which keeps it until
+// the next one arrives
+void uploadPathTraceImage(const FramePacket& packet, SceneViewTarget& target) {
+    if (packet.pathTraceImage.empty()) return;
+    if (target.width != packet.pathTraceWidth || target.height != packet.pathTraceHeight) {
+        resizeViewportFramebuffer(target, packet.pathTraceWidth, packet.pathTraceHeight);
+    }
+    glBindTexture(GL_TEXTURE_2D, target.texture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, packet.pathTraceWidth, packet.pathTraceHeight,
+                    GL_RGBA, GL_UNSIGNED_BYTE, packet.pathTraceImage.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+// --path-trace out.png [--size WxH] [--samples N] [--bounces N] [--no-ground] [model.obj ...]
+// Renders a still without a window or GL, for machines without a GPU. The scene is the
+// models given (or the default scene), framed the way "Center All" frames it.
+int renderPathTraceCommandLine(int argc, char** argv) {
+    const char* output = NULL;
+    int width = 1280, height = 720, samples = 256;
+    PathTracer::Settings settings;
+    std::vector<const char*> models;
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--path-trace") == 0 && hasValue) {
+            output = argv[++i];
+        } else if (strcmp(argv[i], "--size") == 0 && hasValue) {
+            if (sscanf(argv[++i], "%dx%d", &width, &height) != 2) width = height = 0;
+        } else if (strcmp(argv[i], "--samples") == 0 && hasValue) {
+            samples = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--bounces") == 0 && hasValue) {
+            settings.maxBounces = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--no-ground") == 0) {
+            settings.groundPlane = false;
+        } else if (argv[i][0] == '-') {
+            output = NULL;
+            break;
+        } else {
+            models.push_back(argv[i]);
+        }
+    }
+    if (!output || width <= 0 || height <= 0 || samples <= 0) {
+        fprintf(stderr, "Usage: %s --path-trace out.png [--size WxH] [--samples N] [--bounces N] [--no-ground] [model.obj ...]\n", argv[0]);
+        return 1;
+    }
+    
+    // The same scene the editor starts with, unless models are given
+    std::vector<ObjMeshData> meshes;
+    std::vector<glm::vec3> colors;
+    if (models.empty()) {
+        meshes.resize(3);
+        buildCubeMesh(meshes[0]);
+        buildSphereMesh(meshes[1]);
+        buildCylinderMesh(meshes[2]);
+        colors = { glm::vec3(0.8f, 0.4f, 0.4f), glm::vec3(0.4f, 0.8f, 0.4f), glm::vec3(0.4f, 0.4f, 0.8f) };
+    }
+    for (const char* path : models) {
+        ObjMeshData mesh;
+        if (!importOBJMesh(path, mesh)) {
+            fprintf(stderr, "%s: %s\n", path, mesh.message.c_str());
+            return 1;
+        }
+        meshes.push_back(std::move(mesh));
+        colors.push_back(glm::vec3(0.8f));
+    }
+    
+    PathTracer tracer;
+    glm::vec3 sceneMin(FLT_MAX), sceneMax(-FLT_MAX);
+    glm::mat4 identity(1.0f);
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        const ObjMeshData& mesh = meshes[i];
+        int id = tracer.addMesh(mesh.vertices.data(), mesh.vertices.size() / 6, 6, mesh.indices.data(), mesh.indices.size());
+        tracer.addInstance(id, glm::value_ptr(identity), glm::value_ptr(colors[i]));
+        sceneMin = glm::min(sceneMin, mesh.bboxMin);
+        sceneMax = glm::max(sceneMax, mesh.bboxMax);
+    }
+    
+    // Camera as centerAllModels() and updateSceneViewMatrices() place it
+    glm::vec3 center = (sceneMin + sceneMax) * 0.5f;
+    glm::vec3 size = sceneMax - sceneMin;
+    float distance = glm::clamp(glm::max(5.0f, glm::max(glm::max(size.x, size.y), size.z) * 2.0f), 0.5f, 100.0f);
+    glm::vec3 eye = center + glm::vec3(sin(cameraYaw) * cos(cameraPitch), sin(cameraPitch),
+                                       cos(cameraYaw) * cos(cameraPitch)) * distance;
+    glm::mat4 view = glm::lookAt(eye, center, glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), static_cast<float>(width) / height, 0.1f, 100.0f);
+    glm::mat4 inverseViewProjection = glm::inverse(projection * view);
+    tracer.setCamera(glm::value_ptr(inverseViewProjection), width, height);
+    
+    setPathTraceLighting(settings);
+    settings.groundHeight = sceneMin.y;
+    tracer.setSettings(settings);
+    
+    auto start = std::chrono::steady_clock::now();
+    tracer.prepare();
+    float buildMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("%zu triangles, trees built in %.1f ms\n", tracer.triangleCount(), buildMs);
+    
+    tracer.reset();
+    for (int i = 0; i < samples; ++i) {
+        tracer.renderPass();
+        printf("\rSample %d/%d, %.1f ms/pass, %.2f Mrays/s", i + 1, samples, tracer.lastPassMs(),
+               tracer.lastRaysPerSecond() / 1e6);
+        fflush(stdout);
+    }
+    float totalSeconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+    printf("\n");
+    
+    std::vector<uint8_t> image;
+    uint64_t version = 0;
+    tracer.takeImage(image, version, false);
+    if (!stbi_write_png(output, width, height, 4, image.data(), width * 4)) {
+        fprintf(stderr, "Could not write %s\n", output);
+        return 1;
+    }
+    printf("Wrote %s (%dx%d, %d samples) in %.1f s\n", output, width, height, samples, totalSeconds);
+    return 0;
+}
+
+LightmapEntry* findLightmap(const GameObject* obj) {
+    auto it = lightmaps.entries.find(obj);
+    return it == lightmaps.entries.end() ? NULL : it->second.get();
+}
+
+// The light a bake is made under; moving it or changing its color leaves every lightmap stale
+static uint64_t hashLightmapLight() {
+    uint64_t hash = 14695981039346656037ull;
+    hash = hashPathTraceBytes(hash, glm::value_ptr(lightPos), sizeof(lightPos));
+    hash = hashPathTraceBytes(hash, lightColor, sizeof(lightColor));
+    return hash;
+}
+
+static uint64_t hashLightmapSettings(const LightmapSettings& settings) {
+    uint64_t hash = 14695981039346656037ull;
+    hash = hashPathTraceBytes(hash, &settings.texelsPerUnit, sizeof(settings.texelsPerUnit));
+    hash = hashPathTraceBytes(hash, &settings.maxBlockSize, sizeof(settings.maxBlockSize));
+    hash = hashPathTraceBytes(hash, &settings.samples, sizeof(settings.samples));
+    hash = hashPathTraceBytes(hash, &settings.indirect, sizeof(settings.indirect));
+    hash = hashPathTraceBytes(hash, &settings.aoDistance, sizeof(settings.aoDistance));
+    return hash;
+}
+
+// Whether the baked copy still shows the object as it is now
+static bool lightmapMatches(const LightmapEntry& entry, const GameObject& obj, const glm::mat4& model, uint64_t lightHash) {
+    return entry.vao != 0 && entry.sourceVbo == obj.vbo && entry.sourceIndexCount == obj.indexCount &&
+           entry.lightHash == lightHash && entry.model == model;
+}
+
+// The buffer was rewritten in place: its lightmaps no longer fit it
+void invalidateLightmap(GLuint vbo) {
+    for (auto& pair : lightmaps.entries) {
+        if (pair.second->sourceVbo == vbo) pair.second->sourceVbo = 0;
+    }
+}
+
+static bool makeDirectory(const std::string& path) {
+#ifdef _WIN32
+    return _mkdir(path.c_str()) == 0 || errno == EEXIST;
+#else
+    return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+#endif
+}
+
+// Worker: loads what the cache has and traces the rest. The scene is built only when
+// something has to be traced, so a bake that is all cache hits never touches a BVH.
+static std::vector<LightmapResult> runLightmapBake(const LightmapJob& job) {
+    std::vector<LightmapResult> results;
+    PathTracer scene;
+    bool prepared = false;
+    for (const LightmapJobObject& source : job.objects) {
+        if (!source.bake) continue;
+        if (lightmaps.cancel) break;
+        const LightmapJobMesh& mesh = job.meshes[source.mesh];
+        size_t vertexCount = mesh.vertices.size() / 6;
+        
+        LightmapResult result;
+        result.source = source;
+        result.lightHash = job.lightHash;
+        result.settingsHash = job.settingsHash;
+        result.bake.key = LightmapBaker::bakeKey(mesh.vertices.data(), vertexCount, mesh.indices.data(), mesh.indices.size(),
+                                                 glm::value_ptr(source.model), job.light, job.settings);
+        char name[32];
+        snprintf(name, sizeof(name), "%016llx.lmap", static_cast<unsigned long long>(result.bake.key));
+        std::string path = job.cacheDirectory + PATH_SEPARATOR + name;
+        if (LightmapBaker::load(path, result.bake.key, result.bake)) {
+            result.valid = true;
+            result.fromCache = true;
+            results.push_back(std::move(result));
+            lightmaps.objectsDone++;
+            continue;
+        }
+        
+        if (!prepared) {
+            std::vector<int> ids;
+            for (const LightmapJobMesh& m : job.meshes) {
+                ids.push_back(scene.addMesh(m.vertices.data(), m.vertices.size() / 6, 6, m.indices.data(), m.indices.size()));
+            }
+            for (const LightmapJobObject& o : job.objects) {
+                scene.addInstance(ids[o.mesh], glm::value_ptr(o.model), glm::value_ptr(o.color));
+            }
+            scene.setSettings(job.light);
+            scene.prepare();
+            prepared = true;
+        }
+        
+        lightmaps.rowsDone = 0;
+        if (LightmapBaker::unwrap(mesh.vertices.data(), vertexCount, mesh.indices.data(), mesh.indices.size(),
+                                  glm::value_ptr(source.model), job.settings, result.bake)) {
+            if (!LightmapBaker::bake(scene, glm::value_ptr(source.model), job.settings, result.bake,
+                                     &lightmaps.cancel, &lightmaps.rowsDone)) break;
+            LightmapBaker::save(path, result.bake);
+            result.valid = true;
+        }
+        results.push_back(std::move(result));
+        lightmaps.objectsDone++;
+    }
+    return results;
+}
+
+// Bakes the visible objects whose lightmap is missing or out of date. Meshes are read back here,
+// on the main thread; everything after that runs on the worker.
+void startLightmapBake() {
+    TRACE_FUNCTION();
+    if (lightmaps.job.valid()) return;
+    
+    std::shared_ptr<LightmapJob> job = std::make_shared<LightmapJob>();
+    job->settings = lightmaps.settings;
+    setPathTraceLighting(job->light);
+    job->light.groundPlane = false;
+    job->lightHash = hashLightmapLight();
+    job->settingsHash = hashLightmapSettings(job->settings);
+    job->cacheDirectory = lightmaps.cacheDirectory;
+    
+    std::map<GLuint, int> meshOfBuffer;
+    int toBake = 0;
+    for (const auto& obj : objects) {
+        if (!obj->visible) continue;
+        const SubdivisionSurface* surface;
+        int vertexCount, indexCount;
+        GLuint vbo = pathTraceSource(*obj, surface, vertexCount, indexCount);
+        if (vbo == 0 || indexCount == 0) continue;
+        
+        LightmapJobObject source;
+        source.object = obj;
+        source.sourceVbo = obj->vbo;
+        source.sourceIndexCount = obj->indexCount;
+        source.model = obj->getModelMatrix();
+        source.color = obj->color;
+        
+        auto known = meshOfBuffer.find(vbo);
+        if (known != meshOfBuffer.end()) {
+            source.mesh = known->second;
+        } else {
+            LightmapJobMesh mesh;
+            if (surface) {
+                mesh.vertices = surface->vertexData();
+                mesh.indices = surface->indexData();
+                mesh.vertices.resize(static_cast<size_t>(vertexCount) * 6);
+                mesh.indices.resize(indexCount);
+            } else {
+                size_t gpuBytes = 0;
+                if (!readbackMesh(*obj, mesh.vertices, mesh.indices, gpuBytes)) continue;
+            }
+            source.mesh = static_cast<int>(job->meshes.size());
+            meshOfBuffer[vbo] = source.mesh;
+            job->meshes.push_back(std::move(mesh));
+        }
+        
+        // Subdivision surfaces have no lightmap uvs to draw with; they still cast shadows
+        const LightmapEntry* entry = findLightmap(obj.get());
+        bool current = entry && entry->settingsHash == job->settingsHash &&
+                       lightmapMatches(*entry, *obj, source.model, job->lightHash);
+        source.bake = !surface && !current;
+        if (source.bake) toBake++;
+        job->objects.push_back(std::move(source));
+    }
+    
+    if (toBake == 0) {
+        snprintf(statusMessage, sizeof(statusMessage), "Lightmaps are up to date");
+        return;
+    }
+    makeDirectory(job->cacheDirectory);
+    lightmaps.cancel = false;
+    lightmaps.objectsDone = 0;
+    lightmaps.rowsDone = 0;
+    lightmaps.objectsTotal = toBake;
+    lightmaps.bakeStart = std::chrono::steady_clock::now();
+    lightmaps.job = std::async(std::launch::async, [job]() { return runLightmapBake(*job); });
+    snprintf(statusMessage, sizeof(statusMessage), "Baking lightmaps for %d objects", toBake);
+}
+
+// Runs at the top of the frame: drops the lightmaps of deleted objects and takes in a finished bake
+void updateLightmaps() {
+    TRACE_FUNCTION();
+    for (auto it = lightmaps.entries.begin(); it != lightmaps.entries.end();) {
+        if (std::find(objects.begin(), objects.end(), it->second->object) != objects.end()) {
+            ++it;
+            continue;
+        }
+        releaseLightmapBuffers(*it->second);
+        it = lightmaps.entries.erase(it);
+    }
+    
+    if (!futureReady(lightmaps.job)) return;
+    std::vector<LightmapResult> results = lightmaps.job.get();
+    bool cancelled = lightmaps.cancel;
+    lightmaps.bakeMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - lightmaps.bakeStart).count();
+    lightmaps.traced = lightmaps.loaded = lightmaps.failed = 0;
+    
+    for (LightmapResult& result : results) {
+        const LightmapJobObject& source = result.source;
+        if (!result.valid) {
+            lightmaps.failed++;
+            continue;
+        }
+        if (result.fromCache) {
+            lightmaps.loaded++;
+        } else {
+            lightmaps.traced++;
+        }
+        if (std::find(objects.begin(), objects.end(), source.object) == objects.end()) continue;
+        
+        std::unique_ptr<LightmapEntry>& entry = lightmaps.entries[source.object.get()];
+        if (!entry) entry.reset(new LightmapEntry());
+        entry->object = source.object;
+        entry->sourceVbo = source.sourceVbo;
+        entry->sourceIndexCount = source.sourceIndexCount;
+        entry->model = source.model;
+        entry->lightHash = result.lightHash;
+        entry->settingsHash = result.settingsHash;
+        entry->width = result.bake.width;
+        entry->height = result.bake.height;
+        entry->chartCount = result.bake.chartCount;
+        entry->texelsPerUnit = result.bake.texelsPerUnit;
+        entry->fromCache = result.fromCache;
+        uploadLightmapMesh(*entry, result.bake);
+        entry->texels = std::move(result.bake.texels);
+    }
+    
+    // Entries keep the light and settings the bake started with, so if those changed
+    // meanwhile the new lightmaps show up as stale, which is what they are
+    if (!results.empty()) packLightmapAtlas();
+    snprintf(statusMessage, sizeof(statusMessage), "%s lightmaps: %d traced, %d from cache%s in %.1f s",
+             cancelled ? "Cancelled" : "Baked", lightmaps.traced, lightmaps.loaded,
+             lightmaps.failed ? ", some could not be unwrapped" : "", lightmaps.bakeMs / 1000.0f);
+}
+
+void uploadLightmapMesh(LightmapEntry& entry, const LightmapBake& bake) {
+    const GLsizei stride = LightmapBaker::FLOATS_PER_VERTEX * sizeof(float);
+    renderThread.invoke([&]() {
+        if (!entry.vao) {
+            entry.vao = GPU_CREATE(GPU_VERTEX_ARRAY, entry.object->name);
+            entry.vbo = GPU_CREATE(GPU_BUFFER, entry.object->name);
+            entry.ebo = GPU_CREATE(GPU_BUFFER, entry.object->name);
+            
+            glBindVertexArray(entry.vao);
+            glBindBuffer(GL_ARRAY_BUFFER, entry.vbo);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, entry.ebo);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
+            glEnableVertexAttribArray(1);
+            glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(6 * sizeof(float)));
+            glEnableVertexAttribArray(2);
+            glBindVertexArray(0);
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, entry.vbo);
+        glBufferData(GL_COPY_WRITE_BUFFER, bake.vertices.size() * sizeof(float), bake.vertices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, entry.ebo);
+        glBufferData(GL_COPY_WRITE_BUFFER, bake.indices.size() * sizeof(unsigned int), bake.indices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    });
+    entry.indexCount = static_cast<int>(bake.indices.size());
+}
+
+// Every block goes into a new atlas, shelf-packed; the old one is released once the frames
+// drawing with it are done. Blocks keep their texels on the CPU for this.
+void packLightmapAtlas() {
+    TRACE_FUNCTION();
+    std::vector<LightmapEntry*> blocks;
+    std::vector<int> widths, heights, x, y;
+    double area = 0.0;
+    int widest = 0;
+    for (auto& pair : lightmaps.entries) {
+        LightmapEntry& entry = *pair.second;
+        if (entry.texels.empty()) continue;
+        blocks.push_back(&entry);
+        widths.push_back(entry.width);
+        heights.push_back(entry.height);
+        area += static_cast<double>(entry.width) * entry.height;
+        widest = std::max(widest, entry.width);
+    }
+    
+    GLuint previous = lightmaps.atlas;
+    if (previous) {
+        renderThread.defer([previous]() { GpuMemory::release(GPU_TEXTURE, previous); });
+    }
+    lightmaps.atlas = 0;
+    lightmaps.atlasWidth = lightmaps.atlasHeight = 0;
+    if (blocks.empty()) return;
+    
+    int width = std::max(widest, static_cast<int>(ceil(sqrt(area) * 1.1)));
+    int height = LightmapBaker::packShelves(widths, heights, width, x, y);
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        blocks[i]->atlasX = x[i];
+        blocks[i]->atlasY = y[i];
+    }
+    
+    GLuint atlas = 0;
+    renderThread.invoke([&]() {
+        atlas = GPU_CREATE(GPU_TEXTURE, "Lightmap Atlas");
+        glBindTexture(GL_TEXTURE_2D, atlas);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, width, height, 0, GL_RGB, GL_FLOAT, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        for (const LightmapEntry* entry : blocks) {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, entry->atlasX, entry->atlasY, entry->width, entry->height,
+                            GL_RGB, GL_FLOAT, entry->texels.data());
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+    });
+    lightmaps.atlas = atlas;
+    lightmaps.atlasWidth = width;
+    lightmaps.atlasHeight = height;
+}
+
+// Frames already built may still draw the baked copy, so the release waits until they have
+void releaseLightmapBuffers(const LightmapEntry& entry) {
+    GLuint vao = entry.vao, vbo = entry.vbo, ebo = entry.ebo;
+    if (!vao) return;
+    renderThread.defer([vao, vbo, ebo]() {
+        GpuMemory::release(GPU_VERTEX_ARRAY, vao);
+        GpuMemory::release(GPU_BUFFER, vbo);
+        GpuMemory::release(GPU_BUFFER, ebo);
+    });
+}
+
+// Drops every lightmap; the cache on disk stays, so baking again loads them back
+void clearLightmaps() {
+    for (auto& pair : lightmaps.entries) {
+        releaseLightmapBuffers(*pair.second);
+    }
+    lightmaps.entries.clear();
+    packLightmapAtlas();
+}
+
+void createViewportFramebuffer(SceneViewTarget& target, int width, int height) {
+    // Create framebuffer
+    target.framebuffer = GPU_CREATE(GPU_FRAMEBUFFER, "Viewport");
+    glBindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+    
+    // Create texture for framebuffer
+    target.texture = GPU_CREATE(GPU_TEXTURE, "Viewport");
+    glBindTexture(GL_TEXTURE_2D, target.texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    
+    // Attach texture to framebuffer
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target.texture, 0);
+    
+    // Create renderbuffer for depth and stencil
+    target.renderbuffer = GPU_CREATE(GPU_RENDERBUFFER, "Viewport");
+    glBindRenderbuffer(GL_RENDERBUFFER, target.renderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, target.renderbuffer);
+    
+    // Check framebuffer completeness
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        fprintf(stderr, "Framebuffer is not complete!\n");
+    }
+    
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    target.width = width;
+    target.height = height;
+}
+
+void resizeViewportFramebuffer(SceneViewTarget& target, int width, int height) {
+    if (width <= 0 || height <= 0) return;
+    
+    glBindTexture(GL_TEXTURE_2D, target.texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+    
+    // Depth/stencil has to match the color attachment
+    glBindRenderbuffer(GL_RENDERBUFFER, target.renderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    
+    target.width = width;
+    target.height = height;
+}
+
+int sceneViewCount() {
+    return quadView ? MAX_SCENE_VIEWS : 1;
+}
+
+// Split the viewport area between the active views: top, front / side, perspective in quad view
+void layoutSceneViews() {
+    if (!quadView) {
+        sceneViews[0].screenPos = viewportPos;
+        sceneViews[0].screenSize = viewportSize;
+        return;
+    }
+    
+    const float gap = 2.0f;
+    static const int column[VIEW_TYPE_COUNT] = { 1, 0, 1, 0 };
+    static const int row[VIEW_TYPE_COUNT] = { 1, 0, 0, 1 };
+    ImVec2 cellSize((viewportSize.x - gap) * 0.5f, (viewportSize.y - gap) * 0.5f);
+    for (auto& sceneView : sceneViews) {
+        sceneView.screenPos = ImVec2(viewportPos.x + column[sceneView.type] * (cellSize.x + gap),
+                                     viewportPos.y + row[sceneView.type] * (cellSize.y + gap));
+        sceneView.screenSize = cellSize;
+    }
+}
+
+static void updateSceneViewMatrices(SceneView& sceneView) {
+    float aspect = sceneView.screenSize.x / sceneView.screenSize.y;
+    
+    if (sceneView.type == VIEW_PERSPECTIVE) {
+        sceneView.eye = cameraTarget + glm::vec3(
+            sin(cameraYaw) * cos(cameraPitch) * cameraDistance,
+            sin(cameraPitch) * cameraDistance,
+            cos(cameraYaw) * cos(cameraPitch) * cameraDistance
+        );
+        sceneView.view = glm::lookAt(sceneView.eye, cameraTarget, glm::vec3(0.0f, 1.0f, 0.0f));
+        sceneView.projection = glm::perspective(glm::radians(45.0f), aspect, 0.1f, 100.0f);
+        return;
+    }
+    
+    // Orthographic views look down a world axis from outside the scene
+    static const glm::vec3 directions[VIEW_TYPE_COUNT] = {
+        glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(1.0f, 0.0f, 0.0f)
+    };
+    static const glm::vec3 ups[VIEW_TYPE_COUNT] = {
+        glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f)
+    };
+    const float eyeDistance = 100.0f;
+    float halfHeight = sceneView.orthoHeight * 0.5f;
+    sceneView.eye = sceneView.orthoCenter + directions[sceneView.type] * eyeDistance;
+    sceneView.view = glm::lookAt(sceneView.eye, sceneView.orthoCenter, ups[sceneView.type]);
+    sceneView.projection = glm::ortho(-halfHeight * aspect, halfHeight * aspect, -halfHeight, halfHeight,
+                                      0.1f, eyeDistance * 2.0f);
+}
+
+// Sphere around the local bounding box, scaled by the largest axis of the transform
+static void objectBoundingSphere(const GameObject& obj, const glm::mat4& model, glm::vec3& center, float& radius) {
+    float maxScale = glm::max(glm::max(glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1]))),
+                              glm::length(glm::vec3(model[2])));
+    center = glm::vec3(model * glm::vec4((obj.bboxMin + obj.bboxMax) * 0.5f, 1.0f));
+    radius = glm::length(obj.bboxMax - obj.bboxMin) * 0.5f * maxScale;
+}
+
+// HLOD cluster an object belongs to; false for objects that are always drawn on their own
+static bool hlodCell(const GameObject& obj, const glm::vec3& center, float radius, uint64_t& cell) {
+    if (!obj.visible || !obj.isStatic || obj.vbo == 0 || obj.indexCount == 0) return false;
+    if (!HlodBuilder::fitsCell(radius, hlod.settings)) return false;
+    const SubdivisionEntry* surface = subdivision.entries.empty() ? NULL : findSubdivision(&obj);
+    if (surface && surface->level >= 0) return false;
+    cell = HlodBuilder::cellKey(glm::value_ptr(center), hlod.settings.cellSize);
+    return true;
+}
+
+// FNV-1a over 32-bit words of what a proxy is built from; cheap enough to run over every
+// clustered object each frame
+static uint64_t hashHlodWords(uint64_t hash, const void* data, size_t bytes) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i + sizeof(uint32_t) <= bytes; i += sizeof(uint32_t)) {
+        uint32_t word;
+        memcpy(&word, p + i, sizeof(word));
+        hash = (hash ^ word) * 1099511628211ull;
+    }
+    return hash;
+}
+
+static uint64_t hashHlodMember(uint64_t hash, const GameObject& obj, const glm::mat4& model) {
+    uint32_t mesh[3] = { obj.vbo, static_cast<uint32_t>(obj.vertexCount), static_cast<uint32_t>(obj.indexCount) };
+    hash = hashHlodWords(hash, mesh, sizeof(mesh));
+    hash = hashHlodWords(hash, glm::value_ptr(model), sizeof(model));
+    return hashHlodWords(hash, glm::value_ptr(obj.color), sizeof(obj.color));
+}
+
+// Settings a proxy depends on; the seed of every cluster's hash, so changing them rebuilds
+static uint64_t hashHlodSettings() {
+    const HlodSettings& settings = hlod.settings;
+    uint64_t hash = 14695981039346656037ull;
+    hash = hashHlodWords(hash, &settings.cellSize, sizeof(settings.cellSize));
+    hash = hashHlodWords(hash, &settings.proxyGrid, sizeof(settings.proxyGrid));
+    return hashHlodWords(hash, &settings.maxTriangles, sizeof(settings.maxTriangles));
+}
+
+// One pass over the scene per frame; every view draws from this list
+void buildSceneDrawList() {
+    TRACE_FUNCTION();
+    bool tessellate = useTessellation && tessellationSupported;
+    bool useLightmaps = lightmaps.enabled && lightmaps.atlas != 0;
+    uint64_t lightHash = useLightmaps ? hashLightmapLight() : 0;
+    
+    // HLOD clusters are regrouped from scratch every frame. The list of this frame's clusters
+    // is main-thread scratch that never reaches the packet, so it lives in the frame arena.
+    uint64_t hlodSeed = hlod.enabled ? hashHlodSettings() : 0;
+    hlod.frame++;
+    ArenaVector<HlodCluster*> frameClusters;
+    
+    sceneDrawList.clear();
+    for (const auto& obj : objects) {
+        if (!obj->visible) continue;
+        
+        SceneDrawItem item;
+        item.vao = obj->vao;
+        item.indexCount = obj->indexCount;
+        item.shape = obj->shape;
+        item.color = obj->color;
+        item.model = obj->getModelMatrix();
+        item.tessellated = tessellate && obj->shape != SHAPE_MESH;
+        item.lightmapped = false;
+        
+        // The surface stays inside its cage's bounds, so those still cull it
+        const SubdivisionEntry* surface = subdivision.entries.empty() ? NULL : findSubdivision(obj.get());
+        if (surface && surface->level >= 0) {
+            item.vao = surface->vao;
+            item.indexCount = surface->indexCount;
+            item.tessellated = false;
+        } else if (useLightmaps) {
+            const LightmapEntry* baked = findLightmap(obj.get());
+            if (baked && lightmapMatches(*baked, *obj, item.model, lightHash)) {
+                item.vao = baked->vao;
+                item.indexCount = baked->indexCount;
+                item.tessellated = false;
+                item.lightmapped = true;
+                item.lightmapScaleOffset = glm::vec4(
+                    static_cast<float>(baked->width) / lightmaps.atlasWidth, static_cast<float>(baked->height) / lightmaps.atlasHeight,
+                    static_cast<float>(baked->atlasX) / lightmaps.atlasWidth, static_cast<float>(baked->atlasY) / lightmaps.atlasHeight);
+            }
+        }
+        
+        objectBoundingSphere(*obj, item.model, item.center, item.radius);
+        
+        // Members refer to their cluster's slot until the proxies are known
+        item.hlodProxy = -1;
+        uint64_t cell;
+        if (hlod.enabled && hlodCell(*obj, item.center, item.radius, cell)) {
+            HlodCluster& cluster = hlod.clusters[cell];
+            if (cluster.frame != hlod.frame) {
+                cluster.frame = hlod.frame;
+                cluster.memberCount = 0;
+                cluster.membersHash = hlodSeed;
+                cluster.slot = static_cast<int>(frameClusters.size());
+                frameClusters.push_back(&cluster);
+            }
+            cluster.memberCount++;
+            cluster.membersHash = hashHlodMember(cluster.membersHash, *obj, item.model);
+            item.hlodProxy = cluster.slot;
+        }
+        sceneDrawList.push_back(item);
+    }
+    
+    // A cluster's proxy goes after the objects while it was built from exactly these members
+    size_t objectItems = sceneDrawList.size();
+    for (HlodCluster* cluster : frameClusters) {
+        if (cluster->membersHash != cluster->settledHash) {
+            cluster->settledHash = cluster->membersHash;
+            cluster->stableFrames = 0;
+        } else {
+            cluster->stableFrames++;
+        }
+        
+        cluster->drawItem = -1;
+        if (!cluster->vao || cluster->proxyHash != cluster->membersHash ||
+            cluster->memberCount < hlod.settings.minMembers) continue;
+        
+        SceneDrawItem proxy;
+        proxy.vao = cluster->vao;
+        proxy.indexCount = cluster->indexCount;
+        proxy.shape = SHAPE_MESH;
+        proxy.color = glm::vec3(1.0f);                  // member colors are in the vertices
+        proxy.model = glm::mat4(1.0f);
+        proxy.center = cluster->center;
+        proxy.radius = cluster->radius;
+        proxy.tessellated = false;
+        proxy.lightmapped = false;
+        cluster->drawItem = static_cast<int>(sceneDrawList.size());
+        proxy.hlodProxy = cluster->drawItem;
+        sceneDrawList.push_back(proxy);
+    }
+    for (size_t i = 0; i < objectItems; ++i) {
+        SceneDrawItem& item = sceneDrawList[i];
+        if (item.hlodProxy >= 0) item.hlodProxy = frameClusters[item.hlodProxy]->drawItem;
+    }
+}
+
+// Planes from the rows of the view-projection matrix, normalised so distances are in world units
+static void extractFrustumPlanes(const glm::mat4& viewProjection, glm::vec4 planes[6]) {
+    glm::vec4 rows[4];
+    for (int i = 0; i < 4; ++i) {
+        rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+    }
+    for (int i = 0; i < 3; ++i) {
+        planes[i * 2] = rows[3] + rows[i];
+        planes[i * 2 + 1] = rows[3] - rows[i];
+    }
+    for (int i = 0; i < 6; ++i) {
+        planes[i] /= glm::length(glm::vec3(planes[i]));
+    }
+}
+
+// Height of a bounding sphere on screen in pixels; unbounded from inside it
+static float sceneViewPixels(const SceneView& sceneView, const glm::vec3& center, float radius) {
+    float scale = sceneView.projection[1][1] * sceneView.screenSize.y;
+    if (sceneView.projection[3][3] != 0.0f) return radius * scale;     // orthographic
+    float distance = glm::length(center - sceneView.eye);
+    return distance > radius ? radius * scale / distance : FLT_MAX;
+}
+
+// Frustum test of every draw item's bounding sphere against one view. An HLOD cluster is
+// drawn either as its members or as its proxy, by its size in this view.
+void cullSceneView(SceneView& sceneView) {
+    TRACE_ZONE("Cull View");
+    
+    glm::vec4 planes[6];
+    extractFrustumPlanes(sceneView.projection * sceneView.view, planes);
+    
+    sceneView.visibleItems.clear();
+    for (int i = 0; i < static_cast<int>(sceneDrawList.size()); ++i) {
+        const SceneDrawItem& item = sceneDrawList[i];
+        if (item.hlodProxy >= 0) {
+            const SceneDrawItem& proxy = sceneDrawList[item.hlodProxy];
+            bool far = sceneViewPixels(sceneView, proxy.center, proxy.radius) < hlod.screenPixels;
+            if (far != (item.hlodProxy == i)) continue;
+        }
+        
+        bool inside = true;
+        for (const auto& plane : planes) {
+            if (glm::dot(glm::vec3(plane), item.center) + plane.w < -item.radius) {
+                inside = false;
+                break;
+            }
+        }
+        if (inside) sceneView.visibleItems.push_back(i);
+    }
+}
+
+// Runs at the top of the frame: takes in a finished proxy, drops clusters that lost their
+// members, and starts rebuilding the next cluster whose members changed and then held still
+void updateHlod() {
+    TRACE_FUNCTION();
+    if (futureReady(hlod.job)) {
+        HlodResult result = hlod.job.get();
+        hlod.rebuilds++;
+        hlod.lastBuildMs = result.buildMs;
+        auto built = hlod.clusters.find(result.cell);
+        if (built != hlod.clusters.end()) uploadHlodProxy(built->second, result);
+    }
+    
+    // Clusters with members were all seen by the last draw list
+    for (auto it = hlod.clusters.begin(); it != hlod.clusters.end();) {
+        if (hlod.enabled && it->second.frame == hlod.frame) {
+            ++it;
+            continue;
+        }
+        releaseHlodBuffers(it->second);
+        it = hlod.clusters.erase(it);
+    }
+    if (!hlod.enabled) {
+        hlod.meshes.clear();
+        return;
+    }
+    if (hlod.job.valid()) return;
+    
+    for (auto& pair : hlod.clusters) {
+        HlodCluster& cluster = pair.second;
+        if (cluster.memberCount >= hlod.settings.minMembers && cluster.proxyHash != cluster.membersHash &&
+            cluster.stableFrames >= HlodState::SETTLE_FRAMES) {
+            startHlodBuild(pair.first, cluster);
+            return;
+        }
+    }
+}
+
+// Gathers the cluster's members as they are now and merges them on a worker. Meshes are
+// read back once per buffer and kept for the next rebuild.
+void startHlodBuild(uint64_t cell, HlodCluster& cluster) {
+    TRACE_FUNCTION();
+    auto members = std::make_shared<std::vector<HlodMember>>();
+    auto meshes = std::make_shared<std::vector<std::shared_ptr<HlodMesh>>>();
+    uint64_t hash = hashHlodSettings();
+    cluster.sourceBuffers.clear();
+    for (const auto& obj : objects) {
+        glm::mat4 model = obj->getModelMatrix();
+        glm::vec3 center;
+        float radius;
+        uint64_t objectCell;
+        objectBoundingSphere(*obj, model, center, radius);
+        if (!hlodCell(*obj, center, radius, objectCell) || objectCell != cell) continue;
+        
+        std::shared_ptr<HlodMesh>& mesh = hlod.meshes[obj->vbo];
+        if (!mesh || mesh->vertexCount != obj->vertexCount || mesh->indexCount != obj->indexCount) {
+            mesh = std::make_shared<HlodMesh>();
+            size_t gpuBytes = 0;
+            readbackMesh(*obj, mesh->vertices, mesh->indices, gpuBytes);
+            mesh->vertexCount = obj->vertexCount;
+            mesh->indexCount = obj->indexCount;
+        }
+        if (std::find(cluster.sourceBuffers.begin(), cluster.sourceBuffers.end(), obj->vbo) == cluster.sourceBuffers.end()) {
+            cluster.sourceBuffers.push_back(obj->vbo);
+            meshes->push_back(mesh);
+        }
+        
+        HlodMember member;
+        member.vertices = mesh->vertices.data();
+        member.vertexCount = mesh->vertices.size() / 6;
+        member.indices = mesh->indices.data();
+        member.indexCount = mesh->indices.size();
+        memcpy(member.model, glm::value_ptr(model), sizeof(member.model));
+        memcpy(member.color, glm::value_ptr(obj->color), sizeof(member.color));
+        members->push_back(member);
+        hash = hashHlodMember(hash, *obj, model);
+    }
+    
+    // Meshes no cluster refers to any more are dropped
+    for (auto it = hlod.meshes.begin(); it != hlod.meshes.end();) {
+        bool used = false;
+        for (const auto& pair : hlod.clusters) {
+            const std::vector<GLuint>& buffers = pair.second.sourceBuffers;
+            if (std::find(buffers.begin(), buffers.end(), it->first) != buffers.end()) {
+                used = true;
+                break;
+            }
+        }
+        it = used ? std::next(it) : hlod.meshes.erase(it);
+    }
+    
+    HlodSettings settings = hlod.settings;
+    hlod.job = std::async(std::launch::async, [cell, hash, settings, members, meshes]() {
+        TRACE_ZONE("HLOD Proxy");
+        auto start = std::chrono::steady_clock::now();
+        HlodResult result;
+        result.cell = cell;
+        result.membersHash = hash;
+        HlodBuilder::build(*members, settings, result.proxy);
+        result.buildMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return result;
+    });
+}
+
+// A proxy that merged nothing keeps the cluster on its members, and is still marked as built
+void uploadHlodProxy(HlodCluster& cluster, const HlodResult& result) {
+    const HlodProxy& proxy = result.proxy;
+    cluster.proxyHash = result.membersHash;
+    cluster.sourceTriangles = proxy.sourceTriangles;
+    cluster.center = glm::make_vec3(proxy.center);
+    cluster.radius = proxy.radius;
+    if (proxy.indices.empty()) {
+        releaseHlodBuffers(cluster);
+        cluster.vao = cluster.vbo = cluster.ebo = 0;
+        cluster.indexCount = 0;
+        return;
+    }
+    
+    const GLsizei stride = HlodBuilder::FLOATS_PER_VERTEX * sizeof(float);
+    renderThread.invoke([&]() {
+        if (!cluster.vao) {
+            cluster.vao = GPU_CREATE(GPU_VERTEX_ARRAY, "HLOD Proxy");
+            cluster.vbo = GPU_CREATE(GPU_BUFFER, "HLOD Proxy");
+            cluster.ebo = GPU_CREATE(GPU_BUFFER, "HLOD Proxy");
+            
+            glBindVertexArray(cluster.vao);
+            glBindBuffer(GL_ARRAY_BUFFER, cluster.vbo);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cluster.ebo);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
+            glEnableVertexAttribArray(1);
+            glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, stride, (void*)(6 * sizeof(float)));
+            glEnableVertexAttribArray(4);
+            glBindVertexArray(0);
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, cluster.vbo);
+        glBufferData(GL_COPY_WRITE_BUFFER, proxy.vertices.size() * sizeof(float), proxy.vertices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, cluster.ebo);
+        glBufferData(GL_COPY_WRITE_BUFFER, proxy.indices.size() * sizeof(unsigned int), proxy.indices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    });
+    cluster.indexCount = static_cast<int>(proxy.indices.size());
+}
+
+void releaseHlodBuffers(const HlodCluster& cluster) {
+    GLuint vao = cluster.vao, vbo = cluster.vbo, ebo = cluster.ebo;
+    if (!vao) return;
+    renderThread.defer([vao, vbo, ebo]() {
+        GpuMemory::release(GPU_VERTEX_ARRAY, vao);
+        GpuMemory::release(GPU_BUFFER, vbo);
+        GpuMemory::release(GPU_BUFFER, ebo);
+    });
+}
+
+// The buffer was rewritten in place: proxies made from it are rebuilt once the edits stop
+void invalidateHlodMesh(GLuint vbo) {
+    hlod.meshes.erase(vbo);
+    for (auto& pair : hlod.clusters) {
+        HlodCluster& cluster = pair.second;
+        if (std::find(cluster.sourceBuffers.begin(), cluster.sourceBuffers.end(), vbo) == cluster.sourceBuffers.end()) continue;
+        cluster.proxyHash = 0;
+        cluster.stableFrames = 0;
+    }
+}
+
+void clearHlod() {
+    for (auto& pair : hlod.clusters) {
+        releaseHlodBuffers(pair.second);
+    }
+    hlod.clusters.clear();
+    hlod.meshes.clear();
+}
+
+// Render thread: draws one view of a packet into the view's framebuffer
+void renderSceneView(const FramePacket& packet, const SceneView& sceneView, SceneViewTarget& target) {
+    TRACE_ZONE("Render View");
+    int viewportWidth = static_cast<int>(sceneView.screenSize.x);
+    int viewportHeight = static_cast<int>(sceneView.screenSize.y);
+    if (viewportWidth <= 0 || viewportHeight <= 0) return;
+    
+    // Resize the framebuffer if needed
+    if (target.width != viewportWidth || target.height != viewportHeight) {
+        resizeViewportFramebuffer(target, viewportWidth, viewportHeight);
+    }
+    
+    // Bind the view's framebuffer
+    glBindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+    glViewport(0, 0, viewportWidth, viewportHeight);
+    
+    // Clear the framebuffer
+    const float* background = packet.backgroundColor;
+    glClearColor(background[0], background[1], background[2], background[3]);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    
+    // Enable depth testing
+    glEnable(GL_DEPTH_TEST);
+    
+    // Set polygon mode for wireframe
+    glPolygonMode(GL_FRONT_AND_BACK, packet.wireframe ? GL_LINE : GL_FILL);
+    
+    const glm::mat4& view = sceneView.view;
+    const glm::mat4& projection = sceneView.projection;
+    const glm::vec3& cameraPos = sceneView.eye;
+    const glm::vec3& light = packet.lightPos;
+    const glm::vec3& lightTint = packet.lightColor;
+    
+    // Render grid and axes
+    if (packet.showGrid || packet.showAxes) {
+        glUseProgram(gridShader);
+        glUniformMatrix4fv(glGetUniformLocation(gridShader, "view"), 1, GL_FALSE, glm::value_ptr(view));
+        glUniformMatrix4fv(glGetUniformLocation(gridShader, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+        if (packet.showGrid) renderGrid(gridShader, packet.gridSize);
+        if (packet.showAxes) renderAxes(gridShader);
+    }
+    
+    // Render the objects that survived culling for this view
+    glUseProgram(modelShader);
+    glUniformMatrix4fv(glGetUniformLocation(modelShader, "view"), 1, GL_FALSE, glm::value_ptr(view));
+    glUniformMatrix4fv(glGetUniformLocation(modelShader, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+    glUniform3f(glGetUniformLocation(modelShader, "lightPos"), light.x, light.y, light.z);
+    glUniform3f(glGetUniformLocation(modelShader, "viewPos"), cameraPos.x, cameraPos.y, cameraPos.z);
+    glUniform3f(glGetUniformLocation(modelShader, "lightColor"), lightTint.r, lightTint.g, lightTint.b);
+    glUniform1i(glGetUniformLocation(modelShader, "useUniformColor"), 1);
+    GLint modelLocation = glGetUniformLocation(modelShader, "model");
+    GLint colorLocation = glGetUniformLocation(modelShader, "objectColor");
+    
+    bool anyTessellated = false, anyLightmapped = false;
+    for (int index : sceneView.visibleItems) {
+        const SceneDrawItem& item = packet.drawItems[index];
+        if (item.tessellated) {
+            anyTessellated = true;
+        } else if (item.lightmapped) {
+            anyLightmapped = true;
+        } else {
+            renderObject(item, modelLocation, colorLocation);
+        }
+    }
+    renderOutOfCoreMesh(packet, modelLocation, colorLocation);
+    
+    // Baked objects take their lighting from the atlas
+    if (anyLightmapped && packet.lightmapAtlas) {
+        glUseProgram(lightmapShader);
+        glUniformMatrix4fv(glGetUniformLocation(lightmapShader, "view"), 1, GL_FALSE, glm::value_ptr(view));
+        glUniformMatrix4fv(glGetUniformLocation(lightmapShader, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+        glUniform1i(glGetUniformLocation(lightmapShader, "lightmap"), 0);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, packet.lightmapAtlas);
+        GLint lightmapModelLocation = glGetUniformLocation(lightmapShader, "model");
+        GLint lightmapColorLocation = glGetUniformLocation(lightmapShader, "objectColor");
+        GLint scaleOffsetLocation = glGetUniformLocation(lightmapShader, "lightmapScaleOffset");
+        
+        for (int index : sceneView.visibleItems) {
+            const SceneDrawItem& item = packet.drawItems[index];
+            if (item.lightmapped) {
+                glUniform4fv(scaleOffsetLocation, 1, glm::value_ptr(item.lightmapScaleOffset));
+                renderObject(item, lightmapModelLocation, lightmapColorLocation);
+            }
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    
+    // Analytic primitives go through the tessellation path when it is enabled
+    if (anyTessellated) {
+        glUseProgram(tessShader);
+        glUniformMatrix4fv(glGetUniformLocation(tessShader, "view"), 1, GL_FALSE, glm::value_ptr(view));
+        glUniformMatrix4fv(glGetUniformLocation(tessShader, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+        glUniform3f(glGetUniformLocation(tessShader, "lightPos"), light.x, light.y, light.z);
+        glUniform3f(glGetUniformLocation(tessShader, "viewPos"), cameraPos.x, cameraPos.y, cameraPos.z);
+        glUniform3f(glGetUniformLocation(tessShader, "lightColor"), lightTint.r, lightTint.g, lightTint.b);
+        glUniform2f(glGetUniformLocation(tessShader, "viewportSize"), sceneView.screenSize.x, sceneView.screenSize.y);
+        glUniform1f(glGetUniformLocation(tessShader, "edgePixels"), packet.tessEdgePixels);
+        glPatchParameteri(GL_PATCH_VERTICES, 4);
+        GLint tessModelLocation = glGetUniformLocation(tessShader, "model");
+        GLint tessColorLocation = glGetUniformLocation(tessShader, "objectColor");
+        
+        for (int index : sceneView.visibleItems) {
+            const SceneDrawItem& item = packet.drawItems[index];
+            if (item.tessellated) {
+                renderTessellatedObject(item, tessModelLocation, tessColorLocation);
+            }
+        }
+    }
+    
+    // Render transform gizmo for selected object
+    if (packet.drawGizmo) {
+        glUseProgram(gizmoShader);
+        glUniformMatrix4fv(glGetUniformLocation(gizmoShader, "view"), 1, GL_FALSE, glm::value_ptr(view));
+        glUniformMatrix4fv(glGetUniformLocation(gizmoShader, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+        renderGizmo(gizmoShader, packet);
+    }
+    
+    // Reset polygon mode
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+}
+
+// Main thread: the work shared by every view (camera, layout, transforms, bounds, culling,
+// gizmo geometry) plus the render settings, copied into the packet
+void buildScenePacket(FramePacket& packet) {
+    TRACE_FUNCTION();
+    packet.wireframe = wireframeMode;
+    packet.showGrid = showGrid;
+    packet.showAxes = showAxes;
+    packet.gridSize = gridSize;
+    memcpy(packet.backgroundColor, backgroundColor, sizeof(packet.backgroundColor));
+    packet.lightPos = lightPos;
+    packet.lightColor = glm::vec3(lightColor[0], lightColor[1], lightColor[2]);
+    packet.tessEdgePixels = tessEdgePixels;
+    packet.outOfCoreVisible = outOfCore.visible;
+    packet.outOfCoreColor = outOfCore.color;
+    packet.outOfCorePixelError = outOfCore.pixelError;
+    packet.lightmapAtlas = lightmaps.atlas;
+    packet.viewCount = 0;
+    packet.drawGizmo = false;
+    if (viewportSize.x <= 0 || viewportSize.y <= 0) return;
+    
+    // Update camera
+    updateCamera();
+    
+    int viewCount = sceneViewCount();
+    layoutSceneViews();
+    buildSceneDrawList();
+    if (selectedObjectIndex >= 0 && selectedObjectIndex < objects.size() && objects[selectedObjectIndex]->visible) {
+        buildGizmoGeometry(packet);
+    }
+    for (int i = 0; i < viewCount; ++i) {
+        updateSceneViewMatrices(sceneViews[i]);
+    }
+    
+    // Culling is independent per view; big scenes cull the extra views on worker threads
+    if (viewCount > 1 && sceneDrawList.size() >= PARALLEL_CULL_THRESHOLD) {
+        std::future<void> jobs[MAX_SCENE_VIEWS];
+        for (int i = 1; i < viewCount; ++i) {
+            jobs[i] = std::async(std::launch::async, [i]() { cullSceneView(sceneViews[i]); });
+        }
+        cullSceneView(sceneViews[0]);
+        for (int i = 1; i < viewCount; ++i) {
+            jobs[i].wait();
+        }
+    } else {
+        for (int i = 0; i < viewCount; ++i) {
+            cullSceneView(sceneViews[i]);
+        }
+    }
+    
+    // The lists are swapped rather than copied; the ones coming back from the packet are
+    // reused by the next frame's traversal
+    packet.drawItems.swap(sceneDrawList);
+    packet.viewCount = viewCount;
+    for (int i = 0; i < viewCount; ++i) {
+        const SceneView& sceneView = sceneViews[i];
+        SceneView& copy = packet.views[i];
+        copy.type = sceneView.type;
+        copy.orthoCenter = sceneView.orthoCenter;
+        copy.orthoHeight = sceneView.orthoHeight;
+        copy.screenPos = sceneView.screenPos;
+        copy.screenSize = sceneView.screenSize;
+        copy.view = sceneView.view;
+        copy.projection = sceneView.projection;
+        copy.eye = sceneView.eye;
+        copy.visibleItems.swap(sceneViews[i].visibleItems);
+    }
+}
+
+// Render thread: draws every view of a packet into its framebuffer
+void render3DSceneToViewport(const FramePacket& packet) {
+    TRACE_FUNCTION();
+    if (packet.viewCount == 0) return;
+    
+    if (packet.drawGizmo) uploadGizmoGeometry(packet);
+    updateOutOfCoreMesh(packet);
+    
+    for (int i = 0; i < packet.viewCount; ++i) {
+        if (i == 0 && packet.pathTraced) {
+            uploadPathTraceImage(packet, sceneViewTargets[i]);
+        } else {
+            renderSceneView(packet, packet.views[i], sceneViewTargets[i]);
+        }
+    }
+    
+    // Unbind framebuffer
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+// Switch between drawing on the render thread and drawing on the main thread. Called
+// between frames, when nothing is queued, so the context is free to move.
+void setRenderThreadEnabled(bool enabled) {
+    if (enabled) {
+        glfwMakeContextCurrent(NULL);
+        renderThread.start([]() {
+            glfwMakeContextCurrent(window);
+            GLCapture::setContextThread();
+            CpuTrace::setThreadName("Render");
+        }, []() {
+            glfwMakeContextCurrent(NULL);
+        });
+    } else {
+        renderThread.stop();
+        glfwMakeContextCurrent(window);
+        GLCapture::setContextThread();
+    }
+}
+
+// Main thread: pick up what the render thread reported while drawing the last frames
+void collectRenderFeedback() {
+    std::lock_guard<std::mutex> lock(renderFeedback.mutex);
+    renderStats = renderFeedback.stats;
+    if (!renderFeedback.status.empty()) {
+        snprintf(statusMessage, sizeof(statusMessage), "%s", renderFeedback.status.c_str());
+        renderFeedback.status.clear();
+    }
+}
+
+// Render thread: status line text, shown from the next frame the main thread builds
+void setRenderStatus(const char* message) {
+    std::lock_guard<std::mutex> lock(renderFeedback.mutex);
+    renderFeedback.status = message;
+}
+
+static void publishRenderStats() {
+    RenderStats stats;
+    stats.outOfCoreChunksDrawn = outOfCore.drawList.size();
+    stats.outOfCoreTriangles = outOfCore.trianglesDrawn;
+    stats.outOfCoreWanted = outOfCore.wanted.size();
+    stats.outOfCoreUploads = outOfCore.uploadsLastFrame;
+    for (uint32_t node : outOfCore.slotNode) {
+        if (node != UINT32_MAX) stats.outOfCoreResident++;
+    }
+    stats.readbacksPending = viewportCapture.readback.pending();
+    stats.readbackStalls = viewportCapture.readback.stallCount();
+    
+    std::lock_guard<std::mutex> lock(renderFeedback.mutex);
+    renderFeedback.stats = stats;
+}
+
+// Copy the command, index and vertex buffers the way ImDrawList::CloneOutput() does,
+// into lists owned by the packet
+void copyImGuiDrawData(const ImDrawData* source, ImGuiDrawCopy& copy) {
+    TRACE_FUNCTION();
+    copy.data.Clear();
+    copy.data.Valid = source->Valid;
+    copy.data.DisplayPos = source->DisplayPos;
+    copy.data.DisplaySize = source->DisplaySize;
+    copy.data.FramebufferScale = source->FramebufferScale;
+    copy.data.OwnerViewport = source->OwnerViewport;
+    
+    for (int i = 0; i < source->CmdListsCount; ++i) {
+        const ImDrawList* list = source->CmdLists[i];
+        if (i == static_cast<int>(copy.lists.size())) {
+            copy.lists.push_back(IM_NEW(ImDrawList)(list->_Data));
+        }
+        ImDrawList* target = copy.lists[i];
+        target->CmdBuffer = list->CmdBuffer;
+        target->IdxBuffer = list->IdxBuffer;
+        target->VtxBuffer = list->VtxBuffer;
+        target->Flags = list->Flags;
+        copy.data.CmdLists.push_back(target);
+    }
+    copy.data.CmdListsCount = source->CmdListsCount;
+    copy.data.TotalIdxCount = source->TotalIdxCount;
+    copy.data.TotalVtxCount = source->TotalVtxCount;
+}
+
+// Render thread: draws one packet and presents it
+void renderFrame(FramePacket& packet) {
+    TRACE_FUNCTION();
+    GLCapture::beginFrame(packet.displayWidth, packet.displayHeight);
+    
+    // Meshes whose upload fence has signalled get their vertex arrays; the main
+    // thread adds them to the scene at the top of its next frame
+    uploadThread.attachUploads();
+    
+    // Render 3D scene to framebuffers (GPU-timed during playback)
+    bool timedFrame = packet.benchmarkFrame >= 0;
+    if (timedFrame) beginBenchmarkQuery(packet.benchmarkFrame);
+    render3DSceneToViewport(packet);
+    if (timedFrame) uncapturedEndQuery(GL_TIME_ELAPSED);
+    updateViewportCapture(packet);
+    
+    {
+        TRACE_ZONE("ImGui Render");
+        const float* background = packet.backgroundColor;
+        glViewport(0, 0, packet.displayWidth, packet.displayHeight);
+        glClearColor(background[0], background[1], background[2], background[3]);
+        glClear(GL_COLOR_BUFFER_BIT);
+        ImGui_ImplOpenGL3_RenderDrawData(&packet.ui.data);
+    }
+    
+    if (GLCapture::endFrame()) {
+        char message[1100];
+        snprintf(message, sizeof(message), "GL capture saved: %s", GLCapture::lastCapturePath());
+        setRenderStatus(message);
+    }
+    publishRenderStats();
+    
+    TRACE_ZONE("Swap Buffers");
+    glfwSwapBuffers(window);
+}
+
+// Converted meshes are cached next to the source as <name>.obj.oocm and reused while newer
+void openOutOfCoreMesh(const char* path) {
+    if (outOfCore.convertJob.valid()) {
+        snprintf(statusMessage, sizeof(statusMessage), "Still converting %s", outOfCore.convertTarget.c_str());
+        return;
+    }
+    
+    size_t length = strlen(path);
+    if (length > 5 && strcasecmp(path + length - 5, ".oocm") == 0) {
+        openConvertedMesh(path);
+        return;
+    }
+    
+    std::string source = path;
+    std::string target = source + ".oocm";
+    struct stat sourceStat, targetStat;
+    if (stat(source.c_str(), &sourceStat) == 0 && stat(target.c_str(), &targetStat) == 0 &&
+        targetStat.st_mtime >= sourceStat.st_mtime) {
+        openConvertedMesh(target.c_str());
+        if (outOfCore.mesh.isOpen()) return;
+    }
+    
+    outOfCore.convertTarget = target;
+    outOfCore.convertProgress = 0.0f;
+    outOfCore.convertCancel = false;
+    outOfCore.convertJob = std::async(std::launch::async, [source, target]() {
+        TRACE_ZONE("Out-of-Core Conversion");
+        std::string error;
+        OutOfCoreBuilder::build(source, target, &outOfCore.convertProgress, &outOfCore.convertCancel, error);
+        return error;
+    });
+    showOutOfCoreWindow = true;
+    snprintf(statusMessage, sizeof(statusMessage), "Converting %s for streaming...", path);
+}
+
+// The mesh and its cache are used by the render thread, so they are opened and closed there
+void openConvertedMesh(const char* path) {
+    renderThread.invoke([&]() {
+        closeOutOfCoreMesh();
+        
+        std::string error;
+        if (!outOfCore.mesh.open(path, error)) {
+            snprintf(statusMessage, sizeof(statusMessage), "%s", error.c_str());
+            return;
+        }
+        
+        // Fit the root cube into the same 2-unit box imported models are scaled to
+        const OocFileHeader& info = outOfCore.mesh.info();
+        glm::vec3 center = glm::vec3(info.boundsMin[0], info.boundsMin[1], info.boundsMin[2]) + info.boundsSize * 0.5f;
+        outOfCore.modelScale = info.boundsSize > 0.0f ? 2.0f / info.boundsSize : 1.0f;
+        outOfCore.model = glm::scale(glm::mat4(1.0f), glm::vec3(outOfCore.modelScale)) *
+                          glm::translate(glm::mat4(1.0f), -center);
+        
+        strncpy(outOfCore.path, path, sizeof(outOfCore.path) - 1);
+        outOfCore.path[sizeof(outOfCore.path) - 1] = '\0';
+        createOutOfCoreCache();
+        outOfCore.loader.start(&outOfCore.mesh);
+        showOutOfCoreWindow = true;
+        
+        snprintf(statusMessage, sizeof(statusMessage), "Streaming %s: %llu triangles in %u chunks", path,
+                 (unsigned long long)info.triangleCount, outOfCore.mesh.nodeCount());
+    });
+}
+
+void closeOutOfCoreMesh() {
+    renderThread.invoke([]() {
+        outOfCore.loader.stop();
+        releaseOutOfCoreCache();
+        outOfCore.mesh.close();
+        outOfCore.path[0] = '\0';
+        outOfCore.drawList.clear();
+        outOfCore.wanted.clear();
+        outOfCore.trianglesDrawn = 0;
+    });
+}
+
+// One vertex and one index buffer split into equal slots, each big enough for any chunk
+void createOutOfCoreCache() {
+    renderThread.invoke([]() {
+        releaseOutOfCoreCache();
+        
+        const size_t slotBytes = (size_t)OutOfCoreState::SLOT_VERTICES * sizeof(OocVertex) +
+                                 (size_t)OutOfCoreState::SLOT_INDICES * sizeof(uint16_t);
+        outOfCore.slotCount = std::max(4, (int)((size_t)outOfCore.cacheMegabytes * 1024 * 1024 / slotBytes));
+        
+        outOfCore.vao = GPU_CREATE(GPU_VERTEX_ARRAY, "Out-of-Core Cache");
+        outOfCore.vbo = GPU_CREATE(GPU_BUFFER, "Out-of-Core Cache");
+        outOfCore.ebo = GPU_CREATE(GPU_BUFFER, "Out-of-Core Cache");
+        
+        glBindVertexArray(outOfCore.vao);
+        
+        glBindBuffer(GL_ARRAY_BUFFER, outOfCore.vbo);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)outOfCore.slotCount * OutOfCoreState::SLOT_VERTICES * sizeof(OocVertex),
+                     NULL, GL_DYNAMIC_DRAW);
+        
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, outOfCore.ebo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)outOfCore.slotCount * OutOfCoreState::SLOT_INDICES * sizeof(uint16_t),
+                     NULL, GL_DYNAMIC_DRAW);
+        
+        // Quantized position in the chunk's unit cube; the chunk transform scales it back
+        glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(OocVertex), (void*)offsetof(OocVertex, position));
+        glEnableVertexAttribArray(0);
+        
+        // Normal attribute
+        glVertexAttribPointer(1, 3, GL_BYTE, GL_TRUE, sizeof(OocVertex), (void*)offsetof(OocVertex, normal));
+        glEnableVertexAttribArray(1);
+        
+        glBindVertexArray(0);
+        
+        outOfCore.nodeSlot.assign(outOfCore.mesh.nodeCount(), -1);
+        outOfCore.slotNode.assign(outOfCore.slotCount, UINT32_MAX);
+        outOfCore.slotLastUsed.assign(outOfCore.slotCount, 0);
+        outOfCore.frame = 0;
+    });
+}
+
+void releaseOutOfCoreCache() {
+    GpuMemory::release(GPU_VERTEX_ARRAY, outOfCore.vao);
+    GpuMemory::release(GPU_BUFFER, outOfCore.vbo);
+    GpuMemory::release(GPU_BUFFER, outOfCore.ebo);
+    outOfCore.vao = outOfCore.vbo = outOfCore.ebo = 0;
+    outOfCore.slotCount = 0;
+    outOfCore.nodeSlot.clear();
+    outOfCore.slotNode.clear();
+    outOfCore.slotLastUsed.clear();
+}
+
+// A free slot, else the least recently used one that the last frame did not draw from
+static int acquireOutOfCoreSlot() {
+    int best = -1;
+    for (int slot = 0; slot < outOfCore.slotCount; ++slot) {
+        if (outOfCore.slotNode[slot] == UINT32_MAX) return slot;
+        if (outOfCore.slotLastUsed[slot] + 1 < outOfCore.frame &&
+            (best < 0 || outOfCore.slotLastUsed[slot] < outOfCore.slotLastUsed[best])) {
+            best = slot;
+        }
+    }
+    return best;
+}
+
+// Bounding sphere of the node's cube in world space against the frustum, and its
+// geometric error projected to pixels
+static bool outOfCoreNodeVisible(const OocNode& node, const glm::vec4 planes[6], const glm::vec3& eye,
+                                 float projectionScale, float& screenError) {
+    glm::vec3 center = glm::vec3(outOfCore.model * glm::vec4(node.boundsMin[0] + node.boundsSize * 0.5f,
+                                                               node.boundsMin[1] + node.boundsSize * 0.5f,
+                                                               node.boundsMin[2] + node.boundsSize * 0.5f, 1.0f));
+    float radius = node.boundsSize * 0.8660254f * outOfCore.modelScale;
+    for (int i = 0; i < 6; ++i) {
+        if (glm::dot(glm::vec3(planes[i]), center) + planes[i].w < -radius) return false;
+    }
+    float distance = std::max(glm::length(center - eye) - radius, 0.01f);
+    screenError = node.error * outOfCore.modelScale * projectionScale / distance;
+    return true;
+}
+
+// Refine while the node's error is above the threshold. A node is only replaced by its
+// children once all the visible ones are resident, so the coarser chunk fills in meanwhile.
+static void selectOutOfCoreNode(uint32_t index, float screenError, float pixelError, const glm::vec4 planes[6],
+                                const glm::vec3& eye, float projectionScale) {
+    const OocNode& node = outOfCore.mesh.node(index);
+    int slot = outOfCore.nodeSlot[index];
+    if (slot >= 0) outOfCore.slotLastUsed[slot] = outOfCore.frame;
+    
+    if (node.childCount > 0 && screenError > pixelError) {
+        uint32_t children[8];
+        float childErrors[8];
+        int visibleCount = 0;
+        bool allResident = true;
+        for (uint32_t c = 0; c < node.childCount; ++c) {
+            uint32_t child = node.children[c];
+            float childError = 0.0f;
+            if (!outOfCoreNodeVisible(outOfCore.mesh.node(child), planes, eye, projectionScale, childError)) continue;
+            children[visibleCount] = child;
+            childErrors[visibleCount] = childError;
+            visibleCount++;
+            
+            int childSlot = outOfCore.nodeSlot[child];
+            if (childSlot >= 0) {
+                outOfCore.slotLastUsed[childSlot] = outOfCore.frame;
+            } else {
+                allResident = false;
+                outOfCore.wanted.push_back(std::make_pair(screenError, child));
+            }
+        }
+        if (allResident) {
+            for (int c = 0; c < visibleCount; ++c) {
+                selectOutOfCoreNode(children[c], childErrors[c], pixelError, planes, eye, projectionScale);
+            }
+            return;
+        }
+    }
+    
+    if (slot >= 0) {
+        outOfCore.drawList.push_back(index);
+        outOfCore.trianglesDrawn += node.indexCount / 3;
+    } else {
+        outOfCore.wanted.push_back(std::make_pair(FLT_MAX, index));
+    }
 }
 
-bool loadGLBModel(const char* path) {
-    // For now, create a simple placeholder
-    snprintf(statusMessage, sizeof(statusMessage), 
-             "GLB loading not implemented. Creating placeholder cube.");
-    
-    createPrimitive("Cube", glm::vec3(0.8f, 0.6f, 0.2f));
-    strcpy_s(objects.back()->name, "GLB_Placeholder");
-    
-    return false; // Not implemented
+// Main thread: opens the mesh once its conversion has finished
+void collectOutOfCoreConversion() {
+    if (outOfCore.convertJob.valid() &&
+        outOfCore.convertJob.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        std::string error = outOfCore.convertJob.get();
+        if (error.empty()) {
+            openConvertedMesh(outOfCore.convertTarget.c_str());
+        } else {
+            snprintf(statusMessage, sizeof(statusMessage), "%s", error.c_str());
+        }
+    }
 }
 
-void centerAllModels() {
-    if (objects.empty()) return;
-    
-    // Calculate collective bounding box
-    glm::vec3 bboxMin = glm::vec3(FLT_MAX);
-    glm::vec3 bboxMax = glm::vec3(-FLT_MAX);
-    
-    for (const auto& obj : objects) {
-        glm::vec3 objMin = obj->bboxMin + obj->position;
-        glm::vec3 objMax = obj->bboxMax + obj->position;
+// Render thread: uploads chunks that arrived and picks this frame's chunks from the
+// packet's perspective view
+void updateOutOfCoreMesh(const FramePacket& packet) {
+    outOfCore.drawList.clear();
+    outOfCore.wanted.clear();
+    outOfCore.trianglesDrawn = 0;
+    outOfCore.uploadsLastFrame = 0;
+    if (!outOfCore.mesh.isOpen() || !packet.outOfCoreVisible || outOfCore.slotCount == 0) return;
+    TRACE_ZONE("Out-of-Core Update");
+    outOfCore.frame++;
+    
+    // A bounded number of uploads per frame keeps a burst of arrivals from stalling it
+    while (outOfCore.uploadsLastFrame < OutOfCoreState::UPLOADS_PER_FRAME) {
+        int slot = acquireOutOfCoreSlot();
+        if (slot < 0) break;
+        OocLoadedChunk chunk;
+        if (!outOfCore.loader.popReady(chunk)) break;
+        if (outOfCore.nodeSlot[chunk.node] >= 0) continue;
         
-        bboxMin.x = glm::min(bboxMin.x, objMin.x);
-        bboxMin.y = glm::min(bboxMin.y, objMin.y);
-        bboxMin.z = glm::min(bboxMin.z, objMin.z);
+        if (outOfCore.slotNode[slot] != UINT32_MAX) outOfCore.nodeSlot[outOfCore.slotNode[slot]] = -1;
+        outOfCore.slotNode[slot] = chunk.node;
+        outOfCore.nodeSlot[chunk.node] = slot;
+        outOfCore.slotLastUsed[slot] = outOfCore.frame;
         
-        bboxMax.x = glm::max(bboxMax.x, objMax.x);
-        bboxMax.y = glm::max(bboxMax.y, objMax.y);
-        bboxMax.z = glm::max(bboxMax.z, objMax.z);
+        const OocNode& node = outOfCore.mesh.node(chunk.node);
+        size_t vertexBytes = (size_t)node.vertexCount * sizeof(OocVertex);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, outOfCore.vbo);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)slot * OutOfCoreState::SLOT_VERTICES * sizeof(OocVertex),
+                        vertexBytes, chunk.data.data());
+        glBindBuffer(GL_COPY_WRITE_BUFFER, outOfCore.ebo);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)slot * OutOfCoreState::SLOT_INDICES * sizeof(uint16_t),
+                        (size_t)node.indexCount * sizeof(uint16_t), chunk.data.data() + vertexBytes);
+        outOfCore.uploadsLastFrame++;
     }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
     
-    // Calculate center
-    glm::vec3 center = (bboxMin + bboxMax) * 0.5f;
+    const SceneView& sceneView = packet.views[VIEW_PERSPECTIVE];
+    glm::vec4 planes[6];
+    extractFrustumPlanes(sceneView.projection * sceneView.view, planes);
+    float projectionScale = sceneView.screenSize.y / (2.0f * tanf(glm::radians(22.5f)));
     
-    // Move camera target to center
-    cameraTarget = center;
+    uint32_t root = outOfCore.mesh.rootNode();
+    float rootError = 0.0f;
+    if (outOfCoreNodeVisible(outOfCore.mesh.node(root), planes, sceneView.eye, projectionScale, rootError)) {
+        selectOutOfCoreNode(root, rootError, packet.outOfCorePixelError, planes, sceneView.eye, projectionScale);
+    }
     
-    // Adjust camera distance based on bounding box size
-    glm::vec3 size = bboxMax - bboxMin;
-    float maxSize = glm::max(glm::max(size.x, size.y), size.z);
-    cameraDistance = glm::max(5.0f, maxSize * 2.0f);
-}
-
-void autoCenterSelectedModel() {
-    if (selectedObjectIndex >= 0 && selectedObjectIndex < objects.size()) {
-        auto& obj = objects[selectedObjectIndex];
-        
-        // Move camera to look at the object
-        cameraTarget = obj->position;
-        
-        // Calculate appropriate camera distance based on object size
-        glm::vec3 size = obj->bboxMax - obj->bboxMin;
-        float maxSize = glm::max(glm::max(size.x, size.y), size.z);
-        cameraDistance = glm::max(3.0f, maxSize * 2.0f);
-        
-        snprintf(statusMessage, sizeof(statusMessage), "Centered on: %s", obj->name);
+    // Biggest on-screen error first; missing fallbacks are requested at FLT_MAX
+    std::sort(outOfCore.wanted.begin(), outOfCore.wanted.end(),
+              [](const std::pair<float, uint32_t>& a, const std::pair<float, uint32_t>& b) { return a.first > b.first; });
+    std::vector<uint32_t> requests;
+    for (size_t i = 0; i < outOfCore.wanted.size() && i < (size_t)OutOfCoreState::MAX_REQUESTS; ++i) {
+        requests.push_back(outOfCore.wanted[i].second);
     }
+    outOfCore.loader.setRequests(requests);
 }
 
-void createViewportFramebuffer() {
-    // Create framebuffer
-    glGenFramebuffers(1, &viewportFramebuffer);
-    glBindFramebuffer(GL_FRAMEBUFFER, viewportFramebuffer);
-    
-    // Create texture for framebuffer
-    glGenTextures(1, &viewportTexture);
-    glBindTexture(GL_TEXTURE_2D, viewportTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 800, 600, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    
-    // Attach texture to framebuffer
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, viewportTexture, 0);
-    
-    // Create renderbuffer for depth and stencil
-    GLuint rbo;
-    glGenRenderbuffers(1, &rbo);
-    glBindRenderbuffer(GL_RENDERBUFFER, rbo);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, 800, 600);
-    glBindRenderbuffer(GL_RENDERBUFFER, 0);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, rbo);
-    
-    // Check framebuffer completeness
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-        fprintf(stderr, "Framebuffer is not complete!\n");
+void renderOutOfCoreMesh(const FramePacket& packet, GLint modelLocation, GLint colorLocation) {
+    if (outOfCore.drawList.empty()) return;
+    
+    const glm::vec3& color = packet.outOfCoreColor;
+    glUniform3f(colorLocation, color.r, color.g, color.b);
+    glBindVertexArray(outOfCore.vao);
+    for (uint32_t index : outOfCore.drawList) {
+        const OocNode& node = outOfCore.mesh.node(index);
+        int slot = outOfCore.nodeSlot[index];
+        glm::mat4 chunkModel = outOfCore.model *
+                               glm::translate(glm::mat4(1.0f), glm::vec3(node.boundsMin[0], node.boundsMin[1], node.boundsMin[2])) *
+                               glm::scale(glm::mat4(1.0f), glm::vec3(node.boundsSize));
+        glUniformMatrix4fv(modelLocation, 1, GL_FALSE, glm::value_ptr(chunkModel));
+        glDrawElementsBaseVertex(GL_TRIANGLES, node.indexCount, GL_UNSIGNED_SHORT,
+                                 (void*)((size_t)slot * OutOfCoreState::SLOT_INDICES * sizeof(uint16_t)),
+                                 slot * OutOfCoreState::SLOT_VERTICES);
     }
-    
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glBindVertexArray(0);
 }
 
-void resizeViewportFramebuffer(int width, int height) {
-    if (width <= 0 || height <= 0) return;
-    
-    glBindTexture(GL_TEXTURE_2D, viewportTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
-    
-    // Note: In a complete implementation, you'd also resize the renderbuffer
+// Encoding is the slow part (PNG deflate, RGB to YUV), so it gets a few threads of its own
+static void startCaptureEncoder() {
+    if (viewportCapture.encoder.running()) return;
+    int threads = static_cast<int>(std::thread::hardware_concurrency()) / 2;
+    viewportCapture.encoder.start(glm::clamp(threads, 1, 4));
 }
 
-void render3DSceneToViewport() {
-    if (viewportSize.x <= 0 || viewportSize.y <= 0) return;
-    
-    // Bind the viewport framebuffer
-    glBindFramebuffer(GL_FRAMEBUFFER, viewportFramebuffer);
-    
-    // Resize framebuffer if needed
-    static int lastViewportWidth = 0, lastViewportHeight = 0;
-    int viewportWidth = static_cast<int>(viewportSize.x);
-    int viewportHeight = static_cast<int>(viewportSize.y);
-    
-    if (lastViewportWidth != viewportWidth || lastViewportHeight != viewportHeight) {
-        resizeViewportFramebuffer(viewportWidth, viewportHeight);
-        lastViewportWidth = viewportWidth;
-        lastViewportHeight = viewportHeight;
+// Hand a finished readback to the encoder according to what it was queued for
+static void dispatchCapturedFrame(std::vector<uint8_t>& pixels, int width, int height, uint64_t tag) {
+    ViewportCaptureState& capture = viewportCapture;
+    
+    if (tag & ViewportCaptureState::TAG_SCREENSHOT) {
+        char stamp[32];
+        time_t now = time(NULL);
+        strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", localtime(&now));
+        char path[1200];
+        snprintf(path, sizeof(path), "%s/screenshot_%s_%03d.png", currentDirectory, stamp, ++capture.screenshotCount);
+        
+        bool alsoRecorded = (tag & ViewportCaptureState::TAG_RECORD) != 0;
+        capture.encoder.submitImage(path, alsoRecorded ? std::vector<uint8_t>(pixels) : std::move(pixels), width, height);
+        char message[1300];
+        snprintf(message, sizeof(message), "Saving screenshot: %s", path);
+        setRenderStatus(message);
+        if (!alsoRecorded) return;
     }
     
-    // Set viewport size
-    glViewport(0, 0, viewportWidth, viewportHeight);
-    
-    // Clear the framebuffer
-    glClearColor(backgroundColor[0], backgroundColor[1], backgroundColor[2], backgroundColor[3]);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    
-    // Enable depth testing
-    glEnable(GL_DEPTH_TEST);
-    
-    // Set polygon mode for wireframe
-    glPolygonMode(GL_FRONT_AND_BACK, wireframeMode ? GL_LINE : GL_FILL);
-    
-    // Update camera
-    updateCamera();
-    
-    // Get view and projection matrices
-    glm::vec3 cameraPos = cameraTarget + glm::vec3(
-        sin(cameraYaw) * cos(cameraPitch) * cameraDistance,
-        sin(cameraPitch) * cameraDistance,
-        cos(cameraYaw) * cos(cameraPitch) * cameraDistance
-    );
-    
-    glm::mat4 view = glm::lookAt(
-        cameraPos,
-        cameraTarget,
-        glm::vec3(0.0f, 1.0f, 0.0f)
-    );
-    
-    glm::mat4 projection = glm::perspective(
-        glm::radians(45.0f),
-        viewportSize.x / viewportSize.y,
-        0.1f, 100.0f
-    );
-    
-    // Render grid
-    if (showGrid) {
-        glUseProgram(gridShader);
-        glUniformMatrix4fv(glGetUniformLocation(gridShader, "view"), 1, GL_FALSE, glm::value_ptr(view));
-        glUniformMatrix4fv(glGetUniformLocation(gridShader, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
-        renderGrid(gridShader);
+    // Frames built before the stop can arrive after it
+    if (!capture.writing) return;
+    capture.framesEncoded++;
+    if (capture.mode == CAPTURE_VIDEO) {
+        capture.encoder.submitVideoFrame(std::move(pixels), width, height);
+    } else {
+        char path[1200];
+        snprintf(path, sizeof(path), "%s_%06llu.png", capture.outputBase, (unsigned long long)capture.framesEncoded);
+        capture.encoder.submitImage(path, std::move(pixels), width, height);
     }
-    
-    // Render axes
-    if (showAxes) {
-        renderAxes(gridShader);
+}
+
+static void collectCapturedFrames(bool wait) {
+    std::vector<uint8_t> pixels = viewportCapture.encoder.takeBuffer();
+    int width, height;
+    uint64_t tag;
+    while (viewportCapture.readback.collect(pixels, width, height, tag, wait)) {
+        dispatchCapturedFrame(pixels, width, height, tag);
+        pixels = viewportCapture.encoder.takeBuffer();
     }
-    
-    // Render all objects
-    glUseProgram(modelShader);
-    glUniformMatrix4fv(glGetUniformLocation(modelShader, "view"), 1, GL_FALSE, glm::value_ptr(view));
-    glUniformMatrix4fv(glGetUniformLocation(modelShader, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
-    glUniform3f(glGetUniformLocation(modelShader, "lightPos"), lightPos.x, lightPos.y, lightPos.z);
-    glUniform3f(glGetUniformLocation(modelShader, "viewPos"), cameraPos.x, cameraPos.y, cameraPos.z);
-    glUniform3f(glGetUniformLocation(modelShader, "lightColor"), lightColor[0], lightColor[1], lightColor[2]);
-    glUniform1i(glGetUniformLocation(modelShader, "useUniformColor"), 1);
-    
-    for (const auto& obj : objects) {
-        if (obj->visible) {
-            renderObject(*obj, modelShader);
+}
+
+void requestScreenshot() {
+    startCaptureEncoder();
+    viewportCapture.screenshotRequested = true;
+}
+
+// Main thread: what the packet being built is read back for
+uint64_t takeCaptureTag() {
+    ViewportCaptureState& capture = viewportCapture;
+    uint64_t tag = 0;
+    if (capture.screenshotRequested) tag |= ViewportCaptureState::TAG_SCREENSHOT;
+    if (capture.recording) {
+        tag |= ViewportCaptureState::TAG_RECORD;
+        capture.framesQueued++;
+    }
+    capture.screenshotRequested = false;
+    return tag;
+}
+
+void startViewportRecording() {
+    ViewportCaptureState& capture = viewportCapture;
+    if (capture.recording) return;
+    startCaptureEncoder();
+    
+    char stamp[32];
+    time_t now = time(NULL);
+    strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", localtime(&now));
+    snprintf(capture.outputBase, sizeof(capture.outputBase), "%s/capture_%s", currentDirectory, stamp);
+    
+    // The video takes the view's size as the render thread last drew it
+    bool opened = true;
+    renderThread.invoke([&]() {
+        const SceneViewTarget& target = sceneViewTargets[VIEW_PERSPECTIVE];
+        if (capture.mode == CAPTURE_VIDEO) {
+            std::string path = std::string(capture.outputBase) + ".y4m";
+            opened = capture.encoder.openVideo(path, target.width, target.height, capture.framesPerSecond);
         }
+        capture.framesEncoded = 0;
+        capture.writing = opened;
+    });
+    if (!opened) {
+        snprintf(statusMessage, sizeof(statusMessage), "Cannot write %s.y4m", capture.outputBase);
+        return;
     }
     
-    // Render transform gizmo for selected object
-    if (selectedObjectIndex >= 0 && selectedObjectIndex < objects.size()) {
-        auto& obj = objects[selectedObjectIndex];
-        if (obj->visible) {
-            glUseProgram(gizmoShader);
-            glUniformMatrix4fv(glGetUniformLocation(gizmoShader, "view"), 1, GL_FALSE, glm::value_ptr(view));
-            glUniformMatrix4fv(glGetUniformLocation(gizmoShader, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
-            renderGizmo(gizmoShader);
+    capture.framesQueued = 0;
+    capture.recording = true;
+    snprintf(statusMessage, sizeof(statusMessage), "Recording to %s%s", capture.outputBase,
+             capture.mode == CAPTURE_VIDEO ? ".y4m" : "_*.png");
+}
+
+// Waits for the frames still in flight, so the file is complete when this returns
+void stopViewportRecording() {
+    ViewportCaptureState& capture = viewportCapture;
+    if (!capture.recording) return;
+    TRACE_FUNCTION();
+    capture.recording = false;
+    renderThread.invoke([&]() {
+        collectCapturedFrames(true);
+        capture.encoder.drain();
+        capture.encoder.closeVideo();
+        capture.writing = false;
+    });
+    snprintf(statusMessage, sizeof(statusMessage), "Recorded %llu frames to %s%s",
+             (unsigned long long)capture.framesEncoded, capture.outputBase,
+             capture.mode == CAPTURE_VIDEO ? ".y4m" : "_*.png");
+}
+
+// Render thread, once the scene is drawn: collects readbacks whose fences have signalled
+// and queues this frame's if the packet asks for it. Only a full ring waits for the GPU.
+void updateViewportCapture(const FramePacket& packet) {
+    ViewportCaptureState& capture = viewportCapture;
+    if (capture.readback.pending() > 0) collectCapturedFrames(false);
+    if (packet.captureTag == 0 || packet.viewCount == 0) return;
+    
+    const SceneViewTarget& target = sceneViewTargets[VIEW_PERSPECTIVE];
+    TRACE_ZONE("Viewport Capture");
+    
+    if (capture.readback.full()) {
+        std::vector<uint8_t> pixels = capture.encoder.takeBuffer();
+        int width, height;
+        uint64_t tag;
+        if (capture.readback.collect(pixels, width, height, tag, true)) {
+            dispatchCapturedFrame(pixels, width, height, tag);
         }
     }
     
-    // Reset polygon mode
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    
-    // Unbind framebuffer
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    capture.readback.queue(target.framebuffer, target.width, target.height, packet.captureTag);
 }
 
 void loadFileList() {
+    TRACE_FUNCTION();
     fileEntries.clear();
     
     #ifdef _WIN32
@@ -1393,97 +5210,111 @@ void loadFileList() {
     snprintf(statusMessage, sizeof(statusMessage), "Loaded %zu files", fileEntries.size());
 }
 
-void renderObject(const GameObject& obj, GLuint shaderProgram) {
-    if (!obj.visible || obj.vao == 0) return;
+void renderObject(const SceneDrawItem& item, GLint modelLocation, GLint colorLocation) {
+    if (item.vao == 0) return;
     
-    glm::mat4 model = obj.getModelMatrix();
-    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "model"), 1, GL_FALSE, glm::value_ptr(model));
-    glUniform3f(glGetUniformLocation(shaderProgram, "objectColor"), obj.color.r, obj.color.g, obj.color.b);
+    glUniformMatrix4fv(modelLocation, 1, GL_FALSE, glm::value_ptr(item.model));
+    glUniform3f(colorLocation, item.color.r, item.color.g, item.color.b);
     
-    glBindVertexArray(obj.vao);
-    glDrawElements(GL_TRIANGLES, obj.indexCount, GL_UNSIGNED_INT, 0);
+    glBindVertexArray(item.vao);
+    glDrawElements(GL_TRIANGLES, item.indexCount, GL_UNSIGNED_INT, 0);
     glBindVertexArray(0);
 }
 
-void renderGrid(GLuint shaderProgram) {
-    // Generate grid vertices
-    std::vector<float> vertices;
-    std::vector<float> colors;
+void renderTessellatedObject(const SceneDrawItem& item, GLint modelLocation, GLint colorLocation) {
+    const TessPatchMesh& patches = tessPatchMeshes[item.shape];
+    if (patches.vao == 0) return;
     
-    int lines = static_cast<int>(gridSize * 2 + 1);
-    float halfSize = gridSize / 2.0f;
+    glUniformMatrix4fv(modelLocation, 1, GL_FALSE, glm::value_ptr(item.model));
+    glUniform3f(colorLocation, item.color.r, item.color.g, item.color.b);
     
-    // X-axis lines (vertical in XZ plane)
-    for (int i = 0; i < lines; i++) {
-        float x = -halfSize + i;
-        
-        // Choose color based on position
-        glm::vec3 color = (x == 0) ? glm::vec3(1.0f, 0.3f, 0.3f) : 
-                         (fmod(x, 5.0f) == 0) ? glm::vec3(0.5f, 0.5f, 0.5f) : 
-                                                glm::vec3(0.3f, 0.3f, 0.3f);
-        
-        vertices.push_back(x); vertices.push_back(0.0f); vertices.push_back(-halfSize);
-        vertices.push_back(x); vertices.push_back(0.0f); vertices.push_back(halfSize);
-        
-        colors.push_back(color.x); colors.push_back(color.y); colors.push_back(color.z);
-        colors.push_back(color.x); colors.push_back(color.y); colors.push_back(color.z);
-    }
+    glBindVertexArray(patches.vao);
+    glDrawElements(GL_PATCHES, patches.indexCount, GL_UNSIGNED_INT, 0);
+    glBindVertexArray(0);
+}
+
+void renderGrid(GLuint shaderProgram, float size) {
+    // The geometry only depends on the grid size, so it is rebuilt and uploaded only when that changes
+    static float lastGridSize = 0;
+    static GLsizei gridVertexCount = 0;
     
-    // Z-axis lines (horizontal in XZ plane)
-    for (int i = 0; i < lines; i++) {
-        float z = -halfSize + i;
-        
-        // Choose color based on position
-        glm::vec3 color = (z == 0) ? glm::vec3(0.3f, 0.3f, 1.0f) : 
-                         (fmod(z, 5.0f) == 0) ? glm::vec3(0.5f, 0.5f, 0.5f) : 
-                                                glm::vec3(0.3f, 0.3f, 0.3f);
+    if (gridVAO == 0 || lastGridSize != size) {
+        int lines = static_cast<int>(size * 2 + 1);
+        float halfSize = size / 2.0f;
         
-        vertices.push_back(-halfSize); vertices.push_back(0.0f); vertices.push_back(z);
-        vertices.push_back(halfSize); vertices.push_back(0.0f); vertices.push_back(z);
+        // Generate grid vertices (two endpoints per line, lines in both directions).
+        // Plain vectors: this runs on the render thread, and the frame arena is the main thread's.
+        std::vector<float> vertices;
+        std::vector<float> colors;
+        vertices.reserve(lines * 12);
+        colors.reserve(lines * 12);
         
-        colors.push_back(color.x); colors.push_back(color.y); colors.push_back(color.z);
-        colors.push_back(color.x); colors.push_back(color.y); colors.push_back(color.z);
-    }
-    
-    // Create VAO and VBOs
-    static GLuint gridVAO = 0, gridVBO = 0, gridColorVBO = 0;
-    if (gridVAO == 0) {
-        glGenVertexArrays(1, &gridVAO);
-        glGenBuffers(1, &gridVBO);
-        glGenBuffers(1, &gridColorVBO);
-        
-        glBindVertexArray(gridVAO);
+        // X-axis lines (vertical in XZ plane)
+        for (int i = 0; i < lines; i++) {
+            float x = -halfSize + i;
+            
+            // Choose color based on position
+            glm::vec3 color = (x == 0) ? glm::vec3(1.0f, 0.3f, 0.3f) : 
+                             (fmod(x, 5.0f) == 0) ? glm::vec3(0.5f, 0.5f, 0.5f) : 
+                                                    glm::vec3(0.3f, 0.3f, 0.3f);
+            
+            vertices.push_back(x); vertices.push_back(0.0f); vertices.push_back(-halfSize);
+            vertices.push_back(x); vertices.push_back(0.0f); vertices.push_back(halfSize);
+            
+            colors.push_back(color.x); colors.push_back(color.y); colors.push_back(color.z);
+            colors.push_back(color.x); colors.push_back(color.y); colors.push_back(color.z);
+        }
         
-        // Position buffer
-        glBindBuffer(GL_ARRAY_BUFFER, gridVBO);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-        glEnableVertexAttribArray(0);
+        // Z-axis lines (horizontal in XZ plane)
+        for (int i = 0; i < lines; i++) {
+            float z = -halfSize + i;
+            
+            // Choose color based on position
+            glm::vec3 color = (z == 0) ? glm::vec3(0.3f, 0.3f, 1.0f) : 
+                             (fmod(z, 5.0f) == 0) ? glm::vec3(0.5f, 0.5f, 0.5f) : 
+                                                    glm::vec3(0.3f, 0.3f, 0.3f);
+            
+            vertices.push_back(-halfSize); vertices.push_back(0.0f); vertices.push_back(z);
+            vertices.push_back(halfSize); vertices.push_back(0.0f); vertices.push_back(z);
+            
+            colors.push_back(color.x); colors.push_back(color.y); colors.push_back(color.z);
+            colors.push_back(color.x); colors.push_back(color.y); colors.push_back(color.z);
+        }
         
-        // Color buffer
-        glBindBuffer(GL_ARRAY_BUFFER, gridColorVBO);
-        glBufferData(GL_ARRAY_BUFFER, colors.size() * sizeof(float), colors.data(), GL_STATIC_DRAW);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-        glEnableVertexAttribArray(1);
+        // Create VAO and VBOs
+        if (gridVAO == 0) {
+            gridVAO = GPU_CREATE(GPU_VERTEX_ARRAY, "Grid");
+            gridVBO = GPU_CREATE(GPU_BUFFER, "Grid");
+            gridColorVBO = GPU_CREATE(GPU_BUFFER, "Grid");
+            
+            glBindVertexArray(gridVAO);
+            
+            // Position buffer
+            glBindBuffer(GL_ARRAY_BUFFER, gridVBO);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+            glEnableVertexAttribArray(0);
+            
+            // Color buffer
+            glBindBuffer(GL_ARRAY_BUFFER, gridColorVBO);
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+            glEnableVertexAttribArray(1);
+            
+            glBindVertexArray(0);
+        }
         
-        glBindVertexArray(0);
-    }
-    
-    // Update data if grid size changed
-    static float lastGridSize = 0;
-    if (lastGridSize != gridSize) {
         glBindBuffer(GL_ARRAY_BUFFER, gridVBO);
         glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
         
         glBindBuffer(GL_ARRAY_BUFFER, gridColorVBO);
         glBufferData(GL_ARRAY_BUFFER, colors.size() * sizeof(float), colors.data(), GL_STATIC_DRAW);
         
-        lastGridSize = gridSize;
+        gridVertexCount = static_cast<GLsizei>(vertices.size() / 3);
+        lastGridSize = size;
     }
     
     // Render grid
     glBindVertexArray(gridVAO);
-    glDrawArrays(GL_LINES, 0, static_cast<GLsizei>(vertices.size() / 3));
+    glDrawArrays(GL_LINES, 0, gridVertexCount);
     glBindVertexArray(0);
 }
 
@@ -1508,11 +5339,10 @@ void renderAxes(GLuint shaderProgram) {
     };
     
     // Create VAO and VBOs
-    static GLuint axesVAO = 0, axesVBO = 0, axesColorVBO = 0;
     if (axesVAO == 0) {
-        glGenVertexArrays(1, &axesVAO);
-        glGenBuffers(1, &axesVBO);
-        glGenBuffers(1, &axesColorVBO);
+        axesVAO = GPU_CREATE(GPU_VERTEX_ARRAY, "Axes");
+        axesVBO = GPU_CREATE(GPU_BUFFER, "Axes");
+        axesColorVBO = GPU_CREATE(GPU_BUFFER, "Axes");
         
         glBindVertexArray(axesVAO);
         
@@ -1539,15 +5369,24 @@ void renderAxes(GLuint shaderProgram) {
     glLineWidth(1.0f);
 }
 
-void renderGizmo(GLuint shaderProgram) {
-    if (selectedObjectIndex < 0 || selectedObjectIndex >= objects.size()) return;
-    
-    auto& obj = objects[selectedObjectIndex];
-    glm::mat4 model = obj->getModelMatrix();
+// Gizmo geometry depends only on the transform mode and size; it is built into the packet,
+// uploaded once per frame and drawn by every view
+static GLsizei gizmoVertexCount = 0;
+
+void buildGizmoGeometry(FramePacket& packet) {
+    // While its mesh is edited the object shows its selected faces instead of handles
+    if (meshEdit.object && meshEdit.object == objects[selectedObjectIndex]) {
+        buildMeshEditHighlight(packet);
+        return;
+    }
     
-    // Create gizmo geometry based on transform mode
-    std::vector<float> vertices;
-    std::vector<float> colors;
+    // Create gizmo geometry based on transform mode (rotation rings are the largest: 33 points x 3 rings)
+    std::vector<float>& vertices = packet.gizmoVertices;
+    std::vector<float>& colors = packet.gizmoColors;
+    vertices.clear();
+    colors.clear();
+    vertices.reserve(33 * 9);
+    colors.reserve(33 * 9);
     
     float size = gizmoSize;
     
@@ -1617,14 +5456,21 @@ void renderGizmo(GLuint shaderProgram) {
         colors.push_back(0.0f); colors.push_back(0.0f); colors.push_back(1.0f);
     }
     
+    packet.drawGizmo = true;
+    packet.gizmoLineStrip = transformMode == TRANSFORM_ROTATE;
+    packet.gizmoModel = objects[selectedObjectIndex]->getModelMatrix();
+}
+
+void uploadGizmoGeometry(const FramePacket& packet) {
     // Create VAO and VBOs
-    static GLuint gizmoVAO = 0, gizmoVBO = 0, gizmoColorVBO = 0;
     if (gizmoVAO == 0) {
-        glGenVertexArrays(1, &gizmoVAO);
-        glGenBuffers(1, &gizmoVBO);
-        glGenBuffers(1, &gizmoColorVBO);
+        gizmoVAO = GPU_CREATE(GPU_VERTEX_ARRAY, "Gizmo");
+        gizmoVBO = GPU_CREATE(GPU_BUFFER, "Gizmo");
+        gizmoColorVBO = GPU_CREATE(GPU_BUFFER, "Gizmo");
     }
     
+    const std::vector<float>& vertices = packet.gizmoVertices;
+    const std::vector<float>& colors = packet.gizmoColors;
     glBindVertexArray(gizmoVAO);
     
     // Position buffer
@@ -1639,15 +5485,23 @@ void renderGizmo(GLuint shaderProgram) {
     glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
     glEnableVertexAttribArray(1);
     
+    glBindVertexArray(0);
+    gizmoVertexCount = static_cast<GLsizei>(vertices.size() / 3);
+}
+
+void renderGizmo(GLuint shaderProgram, const FramePacket& packet) {
+    if (gizmoVAO == 0) return;
+    
     // Set model matrix
-    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "model"), 1, GL_FALSE, glm::value_ptr(model));
+    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "model"), 1, GL_FALSE, glm::value_ptr(packet.gizmoModel));
     
     // Render gizmo
+    glBindVertexArray(gizmoVAO);
     glLineWidth(2.0f);
-    if (transformMode == TRANSFORM_ROTATE) {
-        glDrawArrays(GL_LINE_STRIP, 0, static_cast<GLsizei>(vertices.size() / 3));
+    if (packet.gizmoLineStrip) {
+        glDrawArrays(GL_LINE_STRIP, 0, gizmoVertexCount);
     } else {
-        glDrawArrays(GL_LINES, 0, static_cast<GLsizei>(vertices.size() / 3));
+        glDrawArrays(GL_LINES, 0, gizmoVertexCount);
     }
     glLineWidth(1.0f);
     
@@ -1673,11 +5527,10 @@ void showMainMenuBar() {
             if (ImGui::MenuItem("New Scene", "Ctrl+N")) {
                 // Clear all objects
                 for (auto& obj : objects) {
-                    if (obj->vao) glDeleteVertexArrays(1, &obj->vao);
-                    if (obj->vbo) glDeleteBuffers(1, &obj->vbo);
-                    if (obj->ebo) glDeleteBuffers(1, &obj->ebo);
+                    releaseObjectBuffers(*obj);
                 }
                 objects.clear();
+                outliner.valid = false;
                 selectedObjectIndex = -1;
                 cameraTarget = glm::vec3(0.0f);
                 cameraDistance = 10.0f;
@@ -1693,6 +5546,15 @@ void showMainMenuBar() {
                 }
             }
             
+            if (ImGui::BeginMenu("Vertex AO on Import")) {
+                ImGui::MenuItem("Bake Occlusion", NULL, &vertexOcclusion.enabled);
+                ImGui::SliderInt("Rays", &vertexOcclusion.settings.rays, 4, 256);
+                ImGui::SliderFloat("Distance", &vertexOcclusion.settings.distance, 0.01f, 1.0f, "%.2f");
+                ImGui::TextColored(COLOR_TEXT_DIM, "Distance is a fraction of the model's size.");
+                ImGui::TextColored(COLOR_TEXT_DIM, "Bakes are saved next to the model as .ao.");
+                ImGui::EndMenu();
+            }
+            
             if (ImGui::MenuItem("Import GLB...", "Ctrl+Shift+O")) {
                 std::string path = openFileDialog("GLB Files\0*.glb\0All Files\0*.*\0");
                 if (!path.empty()) {
@@ -1700,6 +5562,13 @@ void showMainMenuBar() {
                 }
             }
             
+            if (ImGui::MenuItem("Open Large OBJ (Out-of-Core)...")) {
+                std::string path = openFileDialog("Large Meshes\0*.obj;*.oocm\0All Files\0*.*\0");
+                if (!path.empty()) {
+                    openOutOfCoreMesh(path.c_str());
+                }
+            }
+            
             ImGui::Separator();
             
             if (ImGui::MenuItem("Exit", "Alt+F4")) {
@@ -1715,12 +5584,9 @@ void showMainMenuBar() {
                     auto original = objects[selectedObjectIndex];
                     auto copy = std::make_shared<GameObject>(*original);
                     
-                    // Generate new OpenGL buffers for the copy
-                    glGenVertexArrays(1, &copy->vao);
-                    glGenBuffers(1, &copy->vbo);
-                    glGenBuffers(1, &copy->ebo);
+                    // The copy shares the original's mesh buffers
+                    retainObjectBuffers(*copy);
                     
-                    // Copy the buffer data (in a real implementation, you'd copy the actual data)
                     copy->position.x += 1.0f; // Offset the copy
                     
                     char newName[256];
@@ -1729,6 +5595,7 @@ void showMainMenuBar() {
                     
                     objects.push_back(copy);
                     selectedObjectIndex = objects.size() - 1;
+                    outlinerObjectAdded(selectedObjectIndex);
                     
                     snprintf(statusMessage, sizeof(statusMessage), "Duplicated object: %s", original->name);
                 }
@@ -1740,11 +5607,10 @@ void showMainMenuBar() {
                     snprintf(statusMessage, sizeof(statusMessage), "Deleted object: %s", obj->name);
                     
                     // Delete OpenGL resources
-                    if (obj->vao) glDeleteVertexArrays(1, &obj->vao);
-                    if (obj->vbo) glDeleteBuffers(1, &obj->vbo);
-                    if (obj->ebo) glDeleteBuffers(1, &obj->ebo);
+                    releaseObjectBuffers(*obj);
                     
                     objects.erase(objects.begin() + selectedObjectIndex);
+                    outlinerObjectRemoved(selectedObjectIndex);
                     selectedObjectIndex = -1;
                 }
             }
@@ -1763,6 +5629,20 @@ void showMainMenuBar() {
             ImGui::MenuItem("Show Grid", "G", &showGrid);
             ImGui::MenuItem("Show Axes", "A", &showAxes);
             ImGui::MenuItem("Show Bounding Boxes", "B", &showBoundingBoxes);
+            ImGui::MenuItem("Hardware Tessellation", NULL, &useTessellation, tessellationSupported);
+            ImGui::MenuItem("Quad View", "V", &quadView);
+            ImGui::MenuItem("Reload Changed Models", NULL, &hotReload.enabled);
+            ImGui::MenuItem("Render Thread", NULL, &useRenderThread);
+            
+            ImGui::Separator();
+            
+            if (ImGui::MenuItem("Screenshot", "F10")) {
+                requestScreenshot();
+            }
+            
+            if (ImGui::MenuItem(viewportCapture.recording ? "Stop Recording" : "Start Recording", "F9")) {
+                if (viewportCapture.recording) stopViewportRecording(); else startViewportRecording();
+            }
             
             ImGui::Separator();
             
@@ -1771,6 +5651,7 @@ void showMainMenuBar() {
                 cameraYaw = 0.0f;
                 cameraPitch = 0.3f;
                 cameraTarget = glm::vec3(0.0f);
+                frameOrthographicViews(glm::vec3(0.0f), 8.0f);
                 snprintf(statusMessage, sizeof(statusMessage), "Camera reset");
             }
             
@@ -1784,6 +5665,16 @@ void showMainMenuBar() {
             ImGui::MenuItem("Show Transform", NULL, &showTransformWindow);
             ImGui::MenuItem("Show Lighting", NULL, &showLightWindow);
             ImGui::MenuItem("Show Stats", NULL, &showStatsWindow);
+            ImGui::MenuItem("Show Mesh Inspector", NULL, &showMeshInspectorWindow);
+            ImGui::MenuItem("Show Mesh Edit", NULL, &showMeshEditWindow);
+            ImGui::MenuItem("Show Subdivision", NULL, &showSubdivisionWindow);
+            ImGui::MenuItem("Show Path Tracing", NULL, &showPathTraceWindow);
+            ImGui::MenuItem("Show Lightmaps", NULL, &showLightmapWindow);
+            ImGui::MenuItem("Show HLOD", NULL, &showHlodWindow);
+            ImGui::MenuItem("Show GPU Memory", NULL, &showGpuMemoryWindow);
+            ImGui::MenuItem("Show Camera Path", NULL, &showCameraPathWindow);
+            ImGui::MenuItem("Show Out-of-Core Mesh", NULL, &showOutOfCoreWindow);
+            ImGui::MenuItem("Show Capture", NULL, &showCaptureWindow);
             
             ImGui::EndMenu();
         }
@@ -1814,6 +5705,22 @@ void showMainMenuBar() {
                 snprintf(statusMessage, sizeof(statusMessage), "Created plane");
             }
             
+            ImGui::MenuItem("Bake Vertex AO", NULL, &vertexOcclusion.enabled);
+            
+            ImGui::Separator();
+            
+            if (ImGui::BeginMenu("Stress Scene")) {
+                static const int stressCounts[] = { 1000, 10000, 100000 };
+                for (int count : stressCounts) {
+                    char label[32];
+                    snprintf(label, sizeof(label), "%d Objects", count);
+                    if (ImGui::MenuItem(label)) {
+                        createStressScene(count);
+                    }
+                }
+                ImGui::EndMenu();
+            }
+            
             ImGui::EndMenu();
         }
         
@@ -1868,6 +5775,11 @@ void showMainMenuBar() {
             ImGui::BulletText("A: Toggle axes");
             ImGui::BulletText("F: Frame selected object");
             ImGui::BulletText("R: Reset camera");
+            ImGui::BulletText("V: Toggle quad view");
+            ImGui::BulletText("F9: Start/stop recording");
+            ImGui::BulletText("F10: Screenshot");
+            ImGui::BulletText("F11: Export CPU trace");
+            ImGui::BulletText("F12: Capture GL frame (Shift: 10 frames)");
             
             if (ImGui::Button("OK", ImVec2(120, 0))) {
                 ImGui::CloseCurrentPopup();
@@ -1879,6 +5791,96 @@ void showMainMenuBar() {
     }
 }
 
+// Case-insensitive substring test against an already lowercase needle
+static bool containsLowercase(const char* haystack, const char* needle) {
+    if (!needle[0]) return true;
+    for (; *haystack; ++haystack) {
+        const char* h = haystack;
+        const char* n = needle;
+        while (*h && *n && tolower(static_cast<unsigned char>(*h)) == *n) {
+            ++h;
+            ++n;
+        }
+        if (!*n) return true;
+    }
+    return false;
+}
+
+// Display order; ties (and scene order) fall back to the object index
+static bool outlinerRowLess(int a, int b) {
+    if (outliner.sortMode == OUTLINER_SORT_NAME) {
+        int order = strcasecmp(objects[a]->name, objects[b]->name);
+        if (order != 0) return order < 0;
+    }
+    return a < b;
+}
+
+static void insertOutlinerRow(int index) {
+    if (!containsLowercase(objects[index]->name, outliner.activeFilter)) return;
+    outliner.rows.insert(std::upper_bound(outliner.rows.begin(), outliner.rows.end(), index, outlinerRowLess), index);
+}
+
+// Bring the rows in line with the filter and sort mode. Typing more of a search
+// only narrows the current rows; anything else rescans the scene.
+void rebuildOutlinerIndex() {
+    TRACE_FUNCTION();
+    char filter[sizeof(outliner.filter)];
+    size_t length = 0;
+    for (; outliner.filter[length]; ++length) {
+        filter[length] = static_cast<char>(tolower(static_cast<unsigned char>(outliner.filter[length])));
+    }
+    filter[length] = '\0';
+    
+    bool narrowing = outliner.valid && outliner.indexedObjects == objects.size() &&
+                     strstr(filter, outliner.activeFilter) != NULL;
+    strcpy_s(outliner.activeFilter, sizeof(outliner.activeFilter), filter);
+    
+    if (narrowing) {
+        outliner.rows.erase(std::remove_if(outliner.rows.begin(), outliner.rows.end(), [&](int index) {
+            return !containsLowercase(objects[index]->name, filter);
+        }), outliner.rows.end());
+    } else {
+        outliner.rows.clear();
+        for (int i = 0; i < static_cast<int>(objects.size()); i++) {
+            if (containsLowercase(objects[i]->name, filter)) outliner.rows.push_back(i);
+        }
+        if (outliner.sortMode != OUTLINER_SORT_SCENE) {
+            std::sort(outliner.rows.begin(), outliner.rows.end(), outlinerRowLess);
+        }
+    }
+    
+    outliner.indexedObjects = objects.size();
+    outliner.valid = true;
+}
+
+// Call after appending objects[index]
+void outlinerObjectAdded(int index) {
+    if (!outliner.valid) return;
+    if (index != static_cast<int>(outliner.indexedObjects)) {
+        outliner.valid = false;
+        return;
+    }
+    insertOutlinerRow(index);
+    outliner.indexedObjects++;
+}
+
+// Call after erasing objects[index]; later objects shifted down by one
+void outlinerObjectRemoved(int index) {
+    if (!outliner.valid) return;
+    outliner.rows.erase(std::remove(outliner.rows.begin(), outliner.rows.end(), index), outliner.rows.end());
+    for (int& row : outliner.rows) {
+        if (row > index) row--;
+    }
+    outliner.indexedObjects--;
+}
+
+// Call after objects[index]->name changed
+void outlinerObjectRenamed(int index) {
+    if (!outliner.valid) return;
+    outliner.rows.erase(std::remove(outliner.rows.begin(), outliner.rows.end(), index), outliner.rows.end());
+    insertOutlinerRow(index);
+}
+
 void showLeftPanel() {
     if (!showObjectListWindow && !showTransformWindow) return;
     
@@ -1899,70 +5901,129 @@ void showLeftPanel() {
         
         if (showObjectListWindow) {
             if (ImGui::CollapsingHeader("Objects", ImGuiTreeNodeFlags_DefaultOpen)) {
+                TRACE_ZONE("Outliner");
+                if (!outliner.valid || outliner.indexedObjects != objects.size()) {
+                    rebuildOutlinerIndex();
+                }
+                
+                // Search and sort order
+                ImGui::SetNextItemWidth(-80.0f);
+                if (ImGui::InputTextWithHint("##Search", "Search", outliner.filter, sizeof(outliner.filter))) {
+                    rebuildOutlinerIndex();
+                }
+                ImGui::SameLine();
+                ImGui::SetNextItemWidth(-1);
+                const char* sortModes[] = { "Scene", "Name" };
+                if (ImGui::Combo("##Sort", &outliner.sortMode, sortModes, IM_ARRAYSIZE(sortModes))) {
+                    outliner.valid = false;
+                    rebuildOutlinerIndex();
+                }
+                
                 if (objects.empty()) {
                     ImGui::TextColored(COLOR_TEXT_DIM, "No objects in scene");
-                    ImGui::TextColored(COLOR_TEXT_DIM, "Use Create menu to add objects");
-                } else {
-                    for (size_t i = 0; i < objects.size(); i++) {
-                        ImGui::PushID(static_cast<int>(i));
-                        
-                        bool isSelected = (selectedObjectIndex == static_cast<int>(i));
-                        auto& obj = objects[i];
-                        
-                        // Create selectable with eye icon for visibility
-                        char label[512];
-                        const char* icon = obj->visible ? "👁" : "👁‍🗨";
-                        snprintf(label, sizeof(label), "%s %s", icon, obj->name);
-                        
-                        if (ImGui::Selectable(label, isSelected)) {
-                            selectedObjectIndex = static_cast<int>(i);
-                        }
-                        
-                        // Right-click context menu
-                        if (ImGui::BeginPopupContextItem()) {
-                            if (ImGui::MenuItem("Rename")) {
-                                ImGui::OpenPopup("Rename Object");
+                    ImGui::TextColored(COLOR_TEXT_DIM, "Use Create menu to add objects");
+                } else {
+                    ImGui::TextColored(COLOR_TEXT_DIM, "%zu of %zu objects", outliner.rows.size(), objects.size());
+                    
+                    // Only the rows inside the scroll region are laid out and labelled
+                    const int maxVisibleRows = 16;
+                    float rowHeight = ImGui::GetTextLineHeightWithSpacing();
+                    int shownRows = glm::clamp(static_cast<int>(outliner.rows.size()), 1, maxVisibleRows);
+                    ImGui::BeginChild("Object Rows", ImVec2(0, rowHeight * shownRows));
+                    
+                    // Scroll a selection made elsewhere (viewport, menus) into view
+                    if (selectedObjectIndex != outliner.lastSelection) {
+                        outliner.lastSelection = selectedObjectIndex;
+                        auto row = std::find(outliner.rows.begin(), outliner.rows.end(), selectedObjectIndex);
+                        if (row != outliner.rows.end()) {
+                            float rowTop = (row - outliner.rows.begin()) * rowHeight;
+                            float scrollY = ImGui::GetScrollY();
+                            float windowHeight = ImGui::GetWindowHeight();
+                            if (rowTop < scrollY || rowTop + rowHeight > scrollY + windowHeight) {
+                                ImGui::SetScrollY(rowTop - (windowHeight - rowHeight) * 0.5f);
                             }
+                        }
+                    }
+                    
+                    bool openRename = false;
+                    int deleteObject = -1;
+                    ImGuiListClipper clipper;
+                    clipper.Begin(static_cast<int>(outliner.rows.size()), rowHeight);
+                    while (clipper.Step()) {
+                        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+                            int i = outliner.rows[row];
+                            auto& obj = objects[i];
+                            ImGui::PushID(i);
                             
-                            if (ImGui::MenuItem(obj->visible ? "Hide" : "Show")) {
-                                obj->visible = !obj->visible;
-                            }
+                            // Create selectable with eye icon for visibility
+                            char label[512];
+                            const char* icon = obj->visible ? "👁" : "👁‍🗨";
+                            snprintf(label, sizeof(label), "%s %s", icon, obj->name);
                             
-                            if (ImGui::MenuItem("Center View")) {
-                                autoCenterSelectedModel();
+                            if (ImGui::Selectable(label, selectedObjectIndex == i)) {
+                                selectedObjectIndex = i;
+                                outliner.lastSelection = i;
                             }
                             
-                            if (ImGui::MenuItem("Delete")) {
-                                if (obj->vao) glDeleteVertexArrays(1, &obj->vao);
-                                if (obj->vbo) glDeleteBuffers(1, &obj->vbo);
-                                if (obj->ebo) glDeleteBuffers(1, &obj->ebo);
-                                objects.erase(objects.begin() + i);
-                                selectedObjectIndex = -1;
-                                ImGui::CloseCurrentPopup();
+                            // Right-click context menu
+                            if (ImGui::BeginPopupContextItem()) {
+                                if (ImGui::MenuItem("Rename")) {
+                                    outliner.renameObject = i;
+                                    strcpy_s(outliner.renameBuffer, sizeof(outliner.renameBuffer), obj->name);
+                                    openRename = true;
+                                }
+                                
+                                if (ImGui::MenuItem(obj->visible ? "Hide" : "Show")) {
+                                    obj->visible = !obj->visible;
+                                }
+                                
+                                if (ImGui::MenuItem("Center View")) {
+                                    selectedObjectIndex = i;
+                                    autoCenterSelectedModel();
+                                }
+                                
+                                if (ImGui::MenuItem("Delete")) {
+                                    deleteObject = i;
+                                    ImGui::CloseCurrentPopup();
+                                }
+                                
+                                ImGui::EndPopup();
                             }
                             
-                            ImGui::EndPopup();
+                            ImGui::PopID();
                         }
+                    }
+                    ImGui::EndChild();
+                    
+                    // Deferred so the rows are not modified while they are being drawn
+                    if (deleteObject >= 0) {
+                        releaseObjectBuffers(*objects[deleteObject]);
+                        objects.erase(objects.begin() + deleteObject);
+                        outlinerObjectRemoved(deleteObject);
+                        selectedObjectIndex = -1;
+                    }
+                    
+                    // Rename popup
+                    if (openRename) {
+                        ImGui::OpenPopup("Rename Object");
+                    }
+                    if (ImGui::BeginPopupModal("Rename Object", NULL, ImGuiWindowFlags_AlwaysAutoResize)) {
+                        ImGui::InputText("Name", outliner.renameBuffer, sizeof(outliner.renameBuffer));
                         
-                        // Rename popup
-                        if (ImGui::BeginPopupModal("Rename Object", NULL, ImGuiWindowFlags_AlwaysAutoResize)) {
-                            static char newName[256];
-                            strcpy_s(newName, sizeof(newName), obj->name);
-                            
-                            ImGui::InputText("Name", newName, sizeof(newName));
-                            
-                            if (ImGui::Button("OK", ImVec2(120, 0))) {
-                                strcpy_s(obj->name, sizeof(obj->name), newName);
-                                ImGui::CloseCurrentPopup();
-                            }
-                            ImGui::SameLine();
-                            if (ImGui::Button("Cancel", ImVec2(120, 0))) {
-                                ImGui::CloseCurrentPopup();
+                        if (ImGui::Button("OK", ImVec2(120, 0))) {
+                            if (outliner.renameObject >= 0 && outliner.renameObject < objects.size()) {
+                                auto& obj = objects[outliner.renameObject];
+                                strcpy_s(obj->name, sizeof(obj->name), outliner.renameBuffer);
+                                setObjectGpuOwner(*obj);
+                                outlinerObjectRenamed(outliner.renameObject);
                             }
-                            ImGui::EndPopup();
+                            ImGui::CloseCurrentPopup();
                         }
-                        
-                        ImGui::PopID();
+                        ImGui::SameLine();
+                        if (ImGui::Button("Cancel", ImVec2(120, 0))) {
+                            ImGui::CloseCurrentPopup();
+                        }
+                        ImGui::EndPopup();
                     }
                 }
                 
@@ -2042,6 +6103,9 @@ void showLeftPanel() {
                     obj->color.b = color[2];
                 }
                 
+                ImGui::Checkbox("Static", &obj->isStatic);
+                if (ImGui::IsItemHovered()) ImGui::SetTooltip("Can be merged into an HLOD proxy with its neighbours");
+                
                 ImGui::Separator();
                 
                 // Reset buttons
@@ -2064,7 +6128,7 @@ void showLeftPanel() {
 }
 
 void showRightPanel() {
-    if (!showLightWindow && !showStatsWindow) return;
+    if (!showLightWindow && !showStatsWindow && !showMeshInspectorWindow && !showGpuMemoryWindow) return;
     
     ImGuiViewport* mainViewport = ImGui::GetMainViewport();
     float menuBarHeight = ImGui::GetFrameHeight();
@@ -2108,6 +6172,16 @@ void showRightPanel() {
                 if (snapToGrid) {
                     ImGui::DragFloat("Snap Size", &gridSnapSize, 0.1f, 0.1f, 5.0f);
                 }
+                
+                if (tessellationSupported) {
+                    ImGui::Separator();
+                    
+                    ImGui::Text("Tessellation:");
+                    ImGui::Checkbox("Hardware Tessellation", &useTessellation);
+                    if (useTessellation) {
+                        ImGui::DragFloat("Edge Length (px)", &tessEdgePixels, 0.5f, 2.0f, 64.0f);
+                    }
+                }
             }
         }
         
@@ -2147,12 +6221,755 @@ void showRightPanel() {
                 ImGui::Text("Performance:");
                 ImGui::Text("FPS: %.1f", ImGui::GetIO().Framerate);
                 ImGui::Text("Frame Time: %.2f ms", 1000.0f / ImGui::GetIO().Framerate);
+                ImGui::Text("Render: %.2f ms", renderThread.lastRenderMs());
+                ImGui::SameLine();
+                ImGui::TextColored(COLOR_TEXT_DIM, renderThread.threaded() ? "(wait %.2f ms)" : "(inline)",
+                                   renderThread.lastSubmitWaitMs());
+                ImGui::Text("Uploads: %zu pending, %s sent", uploadThread.pending(),
+                            formatFileSize(uploadThread.bytesUploaded()).c_str());
+                if (!uploadThread.sharedContext()) {
+                    ImGui::SameLine();
+                    ImGui::TextColored(COLOR_TEXT_DIM, "(render thread)");
+                }
+                ImGui::Text("Frame Arena: %s / %s", formatFileSize(FrameArena::used()).c_str(),
+                            formatFileSize(FrameArena::capacity()).c_str());
+                ImGui::SameLine();
+                ImGui::TextColored(COLOR_TEXT_DIM, "(high %s)", formatFileSize(FrameArena::highWater()).c_str());
+                ImGui::TextColored(FrameArena::frameHeapAllocations() ? COLOR_WARNING : COLOR_TEXT,
+                                   "Heap Allocs/Frame: %llu", (unsigned long long)FrameArena::frameHeapAllocations());
+                ImGui::SameLine();
+                ImGui::TextColored(COLOR_TEXT_DIM, "(clean %llu)", (unsigned long long)FrameArena::cleanFrameStreak());
             }
         }
+        
+        if (showMeshInspectorWindow) {
+            showMeshInspector();
+        }
+        
+        if (showMeshEditWindow) {
+            showMeshEdit();
+        }
+        
+        if (showSubdivisionWindow) {
+            showSubdivision();
+        }
+        
+        if (showPathTraceWindow) {
+            showPathTrace();
+        }
+        
+        if (showLightmapWindow) {
+            showLightmaps();
+        }
+        
+        if (showHlodWindow) {
+            showHlod();
+        }
+        
+        if (showGpuMemoryWindow) {
+            showGpuMemory();
+        }
+        
+        if (showCameraPathWindow) {
+            showCameraPath();
+        }
+        
+        if (showOutOfCoreWindow) {
+            showOutOfCoreMesh();
+        }
+        
+        if (showCaptureWindow) {
+            showCapture();
+        }
     }
     ImGui::End();
 }
 
+void showGpuMemory() {
+    if (!ImGui::CollapsingHeader("GPU Memory")) return;
+    
+    // Largest meshes first; shared buffers are counted once per user
+    struct ObjectMemory {
+        int index;
+        size_t bytes;
+        int references;
+    };
+    
+    // The registry belongs to the render thread and sizes are GL queries, so a snapshot is
+    // taken there a few times per second, or when the object list changes size
+    static double lastRefresh = -1.0;
+    static size_t totalBytes = 0;
+    static GpuCategoryStats categories[GPU_RESOURCE_TYPE_COUNT];
+    static std::vector<ObjectMemory> perObject;
+    static std::vector<std::pair<std::string, size_t>> owners;
+    double now = glfwGetTime();
+    if (now - lastRefresh > 0.5 || perObject.size() != objects.size()) {
+        renderThread.invoke([&]() {
+            GpuMemory::refreshSizes();
+            totalBytes = GpuMemory::totalBytes();
+            for (int t = 0; t < GPU_RESOURCE_TYPE_COUNT; ++t) {
+                categories[t] = GpuMemory::category(static_cast<GpuResourceType>(t));
+            }
+            
+            perObject.clear();
+            perObject.reserve(objects.size());
+            for (int i = 0; i < static_cast<int>(objects.size()); ++i) {
+                const GpuAllocation* vbo = GpuMemory::find(GPU_BUFFER, objects[i]->vbo);
+                const GpuAllocation* ebo = GpuMemory::find(GPU_BUFFER, objects[i]->ebo);
+                size_t bytes = (vbo ? vbo->bytes : 0) + (ebo ? ebo->bytes : 0);
+                perObject.push_back({ i, bytes, vbo ? vbo->references : 1 });
+            }
+            owners = GpuMemory::bytesByOwner();
+        });
+        std::sort(perObject.begin(), perObject.end(),
+                  [](const ObjectMemory& a, const ObjectMemory& b) { return a.bytes > b.bytes; });
+        lastRefresh = now;
+    }
+    
+    ImGui::Text("Total: %s", formatFileSize(totalBytes).c_str());
+    ImGui::Separator();
+    
+    for (int t = 0; t < GPU_RESOURCE_TYPE_COUNT; ++t) {
+        GpuResourceType type = static_cast<GpuResourceType>(t);
+        const GpuCategoryStats& stats = categories[t];
+        if (type == GPU_VERTEX_ARRAY || type == GPU_FRAMEBUFFER) {
+            ImGui::Text("%s: %zu", GpuMemory::typeName(type), stats.count);
+        } else {
+            ImGui::Text("%s: %zu, %s", GpuMemory::typeName(type), stats.count, formatFileSize(stats.bytes).c_str());
+            ImGui::SameLine();
+            ImGui::TextColored(COLOR_TEXT_DIM, "(peak %s)", formatFileSize(stats.peakBytes).c_str());
+        }
+    }
+    
+    ImGui::Separator();
+    ImGui::Text("By Object:");
+    
+    ImGui::BeginChild("##GpuObjects", ImVec2(0, 120), true);
+    for (const auto& entry : perObject) {
+        const auto& obj = objects[entry.index];
+        ImGui::PushID(entry.index);
+        char label[320];
+        snprintf(label, sizeof(label), "%s: %s", obj->name, formatFileSize(entry.bytes).c_str());
+        if (ImGui::Selectable(label, entry.index == selectedObjectIndex)) {
+            selectedObjectIndex = entry.index;
+        }
+        if (entry.references > 1) {
+            ImGui::SameLine();
+            ImGui::TextColored(COLOR_TEXT_DIM, "(shared x%d)", entry.references);
+        }
+        ImGui::PopID();
+    }
+    ImGui::EndChild();
+    
+    ImGui::Text("By Owner:");
+    for (size_t i = 0; i < owners.size() && i < 8; ++i) {
+        ImGui::BulletText("%s: %s", owners[i].first.c_str(), formatFileSize(owners[i].second).c_str());
+    }
+}
+
+void setCameraPathFileForScene(const char* scenePath) {
+    CameraBenchmarkState& bench = cameraBenchmark;
+    snprintf(bench.pathFile, sizeof(bench.pathFile), "%s", scenePath);
+    char* dot = strrchr(bench.pathFile, '.');
+    char* slash = strrchr(bench.pathFile, '/');
+    char* backslash = strrchr(bench.pathFile, '\\');
+    if (dot && (!slash || dot > slash) && (!backslash || dot > backslash)) *dot = '\0';
+    strncat(bench.pathFile, ".campath", sizeof(bench.pathFile) - strlen(bench.pathFile) - 1);
+    
+    // Pick up a path recorded earlier for this scene
+    if (!bench.recording && !bench.playing) bench.path.load(bench.pathFile);
+}
+
+bool loadCameraPath(const char* path) {
+    CameraBenchmarkState& bench = cameraBenchmark;
+    if (bench.recording || bench.playing) return false;
+    if (!bench.path.load(path)) {
+        snprintf(statusMessage, sizeof(statusMessage), "Failed to load camera path: %s", path);
+        return false;
+    }
+    snprintf(bench.pathFile, sizeof(bench.pathFile), "%s", path);
+    snprintf(statusMessage, sizeof(statusMessage), "Loaded camera path: %zu keyframes, %.1f s",
+             bench.path.keyframes.size(), bench.path.duration());
+    return true;
+}
+
+// Blocks on the query for frame `frame`; called QUERY_COUNT frames late, so the result is normally ready
+static void readBenchmarkGpuTime(CameraBenchmarkState& bench) {
+    GLuint64 elapsed = 0;
+    int frame = static_cast<int>(bench.gpuMs.size());
+    uncapturedGetQueryObjectui64v(bench.gpuQueries[frame % CameraBenchmarkState::QUERY_COUNT], GL_QUERY_RESULT, &elapsed);
+    bench.gpuMs.push_back(static_cast<float>(elapsed / 1.0e6));
+}
+
+// Render thread: start the timer query of a benchmark frame, collecting the result of the
+// frame that used the same query QUERY_COUNT frames earlier first
+void beginBenchmarkQuery(int frame) {
+    CameraBenchmarkState& bench = cameraBenchmark;
+    while (static_cast<int>(bench.gpuMs.size()) <= frame - CameraBenchmarkState::QUERY_COUNT) {
+        readBenchmarkGpuTime(bench);
+    }
+    uncapturedBeginQuery(GL_TIME_ELAPSED, bench.gpuQueries[frame % CameraBenchmarkState::QUERY_COUNT]);
+}
+
+void updateCameraPath() {
+    CameraBenchmarkState& bench = cameraBenchmark;
+    if (bench.recording) {
+        float target[3] = { cameraTarget.x, cameraTarget.y, cameraTarget.z };
+        bench.path.record(static_cast<float>(glfwGetTime() - bench.recordStart), target,
+                          cameraYaw, cameraPitch, cameraDistance);
+        return;
+    }
+    if (!bench.playing) return;
+    
+    // A frame's time is the period from its start to the next frame's start
+    double now = glfwGetTime();
+    if (bench.frame > 0) bench.cpuMs.push_back(static_cast<float>((now - bench.lastFrameStart) * 1000.0));
+    bench.lastFrameStart = now;
+    
+    if (bench.frame >= bench.frameCount) {
+        finishCameraBenchmark(true);
+        return;
+    }
+    
+    CameraKeyframe pose = bench.path.sampleFrame(std::max(bench.frame, 0), bench.frameCount);
+    cameraTarget = glm::vec3(pose.target[0], pose.target[1], pose.target[2]);
+    cameraYaw = pose.yaw;
+    cameraPitch = pose.pitch;
+    cameraDistance = pose.distance;
+}
+
+void startCameraBenchmark() {
+    CameraBenchmarkState& bench = cameraBenchmark;
+    if (bench.path.empty() || bench.playing || bench.recording) return;
+    
+    bench.savedTarget = cameraTarget;
+    bench.savedYaw = cameraYaw;
+    bench.savedPitch = cameraPitch;
+    bench.savedDistance = cameraDistance;
+    
+    bench.cpuMs.clear();
+    bench.cpuMs.reserve(bench.frameCount);
+    bench.frame = -CameraBenchmarkState::WARMUP_FRAMES;
+    bench.playing = true;
+    bench.hasSummary = false;
+    
+    // The queries and GPU times belong to the render thread.
+    // Measure the renderer, not the display refresh.
+    renderThread.invoke([&]() {
+        if (bench.gpuQueries[0] == 0) uncapturedGenQueries(CameraBenchmarkState::QUERY_COUNT, bench.gpuQueries);
+        bench.gpuMs.clear();
+        bench.gpuMs.reserve(bench.frameCount);
+        glfwSwapInterval(0);
+    });
+    snprintf(statusMessage, sizeof(statusMessage), "Playing camera path (%d frames)...", bench.frameCount);
+}
+
+void finishCameraBenchmark(bool completed) {
+    CameraBenchmarkState& bench = cameraBenchmark;
+    bench.playing = false;
+    
+    // Every timed frame has been submitted; their queries are read once they are drawn
+    renderThread.invoke([&]() {
+        glfwSwapInterval(1);
+        while (completed && static_cast<int>(bench.gpuMs.size()) < bench.frameCount) {
+            readBenchmarkGpuTime(bench);
+        }
+    });
+    
+    cameraTarget = bench.savedTarget;
+    cameraYaw = bench.savedYaw;
+    cameraPitch = bench.savedPitch;
+    cameraDistance = bench.savedDistance;
+    
+    if (!completed) {
+        snprintf(statusMessage, sizeof(statusMessage), "Camera benchmark cancelled");
+        return;
+    }
+    
+    bench.summary = CameraPath::summarize(bench.cpuMs, bench.gpuMs);
+    bench.hasSummary = true;
+    
+    if (!bench.pathFile[0]) snprintf(bench.pathFile, sizeof(bench.pathFile), "%s/flythrough.campath", currentDirectory);
+    bool written = CameraPath::writeReport(bench.pathFile, bench.cpuMs, bench.gpuMs, bench.summary);
+    snprintf(statusMessage, sizeof(statusMessage), "Benchmark: mean %.2f ms, p99 %.2f ms, GPU %.2f ms%s",
+             bench.summary.meanMs, bench.summary.p99Ms, bench.summary.gpuMeanMs,
+             written ? " (report saved next to the path)" : "");
+}
+
+void showCameraPath() {
+    if (!ImGui::CollapsingHeader("Camera Path")) return;
+    
+    CameraBenchmarkState& bench = cameraBenchmark;
+    ImGui::Text("Keyframes: %zu (%.1f s)", bench.path.keyframes.size(), bench.path.duration());
+    ImGui::TextColored(COLOR_TEXT_DIM, "%s", bench.pathFile[0] ? bench.pathFile : "(not saved)");
+    
+    if (bench.playing) {
+        float progress = bench.frame < 0 ? 0.0f : static_cast<float>(bench.frame) / bench.frameCount;
+        ImGui::ProgressBar(progress, ImVec2(-1, 0), bench.frame < 0 ? "Warming up" : NULL);
+        if (ImGui::Button("Cancel", ImVec2(-1, 0))) {
+            finishCameraBenchmark(false);
+        }
+        return;
+    }
+    
+    if (ImGui::Button(bench.recording ? "Stop Recording" : "Record", ImVec2(-1, 0))) {
+        if (bench.recording) {
+            float target[3] = { cameraTarget.x, cameraTarget.y, cameraTarget.z };
+            bench.path.record(static_cast<float>(glfwGetTime() - bench.recordStart), target,
+                              cameraYaw, cameraPitch, cameraDistance, true);
+            bench.recording = false;
+            snprintf(statusMessage, sizeof(statusMessage), "Recorded %zu camera keyframes",
+                     bench.path.keyframes.size());
+        } else {
+            bench.path.clear();
+            bench.recordStart = glfwGetTime();
+            bench.recording = true;
+            snprintf(statusMessage, sizeof(statusMessage), "Recording camera path: orbit, pan and zoom the viewport");
+        }
+    }
+    if (bench.recording) return;
+    
+    ImGui::InputInt("Frames", &bench.frameCount, 60, 600);
+    bench.frameCount = glm::clamp(bench.frameCount, 2, 100000);
+    
+    if (ImGui::Button("Run Benchmark", ImVec2(-1, 0)) && !bench.path.empty()) {
+        startCameraBenchmark();
+    }
+    
+    if (ImGui::Button("Save", ImVec2(120, 0)) && !bench.path.empty()) {
+        if (!bench.pathFile[0]) snprintf(bench.pathFile, sizeof(bench.pathFile), "%s/flythrough.campath", currentDirectory);
+        if (bench.path.save(bench.pathFile)) {
+            snprintf(statusMessage, sizeof(statusMessage), "Saved camera path: %s", bench.pathFile);
+        } else {
+            snprintf(statusMessage, sizeof(statusMessage), "Failed to save camera path: %s", bench.pathFile);
+        }
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Load", ImVec2(120, 0))) {
+        char path[1024];
+        snprintf(path, sizeof(path), "%s", bench.pathFile[0] ? bench.pathFile : "flythrough.campath");
+        std::string chosen = openFileDialog("Camera Paths\0*.campath\0All Files\0*.*\0");
+        loadCameraPath(chosen.empty() ? path : chosen.c_str());
+    }
+    
+    if (bench.hasSummary) {
+        const FrameTimingSummary& summary = bench.summary;
+        ImGui::Separator();
+        ImGui::Text("Last Run: %d frames", summary.frames);
+        ImGui::Text("Mean: %.2f ms (%.0f FPS)", summary.meanMs, summary.meanMs > 0.0 ? 1000.0 / summary.meanMs : 0.0);
+        ImGui::Text("p50 / p95 / p99: %.2f / %.2f / %.2f ms", summary.p50Ms, summary.p95Ms, summary.p99Ms);
+        ImGui::Text("Min / Max: %.2f / %.2f ms", summary.minMs, summary.maxMs);
+        ImGui::Text("GPU Scene: %.2f ms (max %.2f)", summary.gpuMeanMs, summary.gpuMaxMs);
+        ImGui::TextColored(summary.over33Ms ? COLOR_WARNING : COLOR_TEXT_DIM,
+                           "Over 16.7 ms: %d, over 33.3 ms: %d", summary.over16Ms, summary.over33Ms);
+    }
+}
+
+void showOutOfCoreMesh() {
+    if (!outOfCore.mesh.isOpen() && !outOfCore.convertJob.valid()) return;
+    if (!ImGui::CollapsingHeader("Out-of-Core Mesh")) return;
+    
+    if (outOfCore.convertJob.valid()) {
+        ImGui::TextColored(COLOR_TEXT_DIM, "%s", outOfCore.convertTarget.c_str());
+        ImGui::ProgressBar(outOfCore.convertProgress.load(), ImVec2(-1, 0), "Converting");
+        if (ImGui::Button("Cancel", ImVec2(-1, 0))) {
+            outOfCore.convertCancel = true;
+        }
+        return;
+    }
+    
+    const OocFileHeader& info = outOfCore.mesh.info();
+    const size_t slotBytes = (size_t)OutOfCoreState::SLOT_VERTICES * sizeof(OocVertex) +
+                             (size_t)OutOfCoreState::SLOT_INDICES * sizeof(uint16_t);
+    
+    ImGui::TextColored(COLOR_TEXT_DIM, "%s", outOfCore.path);
+    ImGui::Text("Triangles: %llu in %u chunks", (unsigned long long)info.triangleCount, outOfCore.mesh.nodeCount());
+    ImGui::Text("GPU Cache: %d / %d slots (%s)", renderStats.outOfCoreResident, outOfCore.slotCount,
+                formatFileSize(slotBytes * outOfCore.slotCount).c_str());
+    ImGui::Text("Drawn: %zu chunks, %zu triangles", renderStats.outOfCoreChunksDrawn, renderStats.outOfCoreTriangles);
+    ImGui::TextColored(renderStats.outOfCoreWanted == 0 ? COLOR_TEXT_DIM : COLOR_WARNING,
+                       "Streaming: %zu wanted, %d uploads, %llu loaded", renderStats.outOfCoreWanted,
+                       renderStats.outOfCoreUploads, (unsigned long long)outOfCore.loader.loadedChunks());
+    
+    ImGui::Checkbox("Visible##OutOfCore", &outOfCore.visible);
+    ImGui::ColorEdit3("Color##OutOfCore", glm::value_ptr(outOfCore.color), ImGuiColorEditFlags_NoInputs);
+    ImGui::DragFloat("Pixel Error", &outOfCore.pixelError, 0.1f, 0.5f, 32.0f);
+    
+    // Resizing the cache drops every resident chunk, so it only happens once editing ends
+    ImGui::InputInt("Cache (MB)", &outOfCore.cacheMegabytes, 16, 128);
+    outOfCore.cacheMegabytes = glm::clamp(outOfCore.cacheMegabytes, 16, 4096);
+    if (ImGui::IsItemDeactivatedAfterEdit()) {
+        createOutOfCoreCache();
+    }
+    
+    if (ImGui::Button("Close", ImVec2(-1, 0))) {
+        closeOutOfCoreMesh();
+        snprintf(statusMessage, sizeof(statusMessage), "Closed out-of-core mesh");
+    }
+}
+
+void showCapture() {
+    if (!ImGui::CollapsingHeader("Capture")) return;
+    
+    ViewportCaptureState& capture = viewportCapture;
+    if (ImGui::Button("Screenshot (F10)", ImVec2(-1, 0))) {
+        requestScreenshot();
+    }
+    
+    if (!capture.recording) {
+        ImGui::RadioButton("Video (.y4m)", &capture.mode, CAPTURE_VIDEO);
+        ImGui::SameLine();
+        ImGui::RadioButton("PNG Sequence", &capture.mode, CAPTURE_PNG_SEQUENCE);
+        if (capture.mode == CAPTURE_VIDEO) {
+            ImGui::InputInt("FPS", &capture.framesPerSecond, 1, 10);
+            capture.framesPerSecond = glm::clamp(capture.framesPerSecond, 1, 240);
+        }
+        if (ImGui::Button("Start Recording (F9)", ImVec2(-1, 0))) {
+            startViewportRecording();
+        }
+    } else {
+        ImGui::TextColored(COLOR_ACCENT, "Recording: %llu frames", (unsigned long long)capture.framesQueued);
+        if (ImGui::Button("Stop Recording (F9)", ImVec2(-1, 0))) {
+            stopViewportRecording();
+        }
+    }
+    
+    // One frame is recorded per rendered frame; the .y4m frame rate only sets playback speed
+    if (capture.encoder.running()) {
+        ImGui::Text("Readbacks in Flight: %d", renderStats.readbacksPending);
+        ImGui::Text("Encoder Queue: %zu", capture.encoder.queuedFrames());
+        ImGui::Text("Written: %llu (%s video)", (unsigned long long)capture.encoder.writtenCount(),
+                    formatFileSize(static_cast<size_t>(capture.encoder.bytesWritten())).c_str());
+        uint64_t stalls = renderStats.readbackStalls + capture.encoder.stallCount();
+        ImGui::TextColored(stalls ? COLOR_WARNING : COLOR_TEXT_DIM, "Stalls: %llu GPU, %llu encoder",
+                           (unsigned long long)renderStats.readbackStalls,
+                           (unsigned long long)capture.encoder.stallCount());
+        if (capture.encoder.failedCount()) {
+            ImGui::TextColored(COLOR_WARNING, "Failed Writes: %llu", (unsigned long long)capture.encoder.failedCount());
+        }
+    }
+}
+
+void showMeshInspector() {
+    if (selectedObjectIndex < 0 || selectedObjectIndex >= static_cast<int>(objects.size())) return;
+    if (!ImGui::CollapsingHeader("Mesh Inspector", ImGuiTreeNodeFlags_DefaultOpen)) return;
+    
+    auto& obj = objects[selectedObjectIndex];
+    bool optimizing = meshInspector.optimizeJob.valid();
+    
+    if (!meshInspector.statsValid || meshInspector.statsObject != obj) {
+        ImGui::TextColored(COLOR_TEXT_DIM, optimizing ? "Optimizing..." : "Analyzing...");
+        return;
+    }
+    
+    const MeshStats& stats = meshInspector.stats;
+    ImGui::Text("Vertices: %zu", stats.vertexCount);
+    ImGui::Text("Indices: %zu", stats.indexCount);
+    ImGui::Text("GPU Memory: %s", formatFileSize(stats.gpuBytes).c_str());
+    
+    ImGui::Separator();
+    
+    // Colour each metric by how far it is from ideal
+    auto metricColor = [](float value, float good, float bad) {
+        if (value <= good) return COLOR_SUCCESS;
+        if (value >= bad) return COLOR_ACCENT;
+        return COLOR_WARNING;
+    };
+    
+    ImGui::TextColored(metricColor(stats.acmr, 0.8f, 1.5f), "ACMR: %.3f", stats.acmr);
+    if (ImGui::IsItemHovered()) ImGui::SetTooltip("Vertex shader runs per triangle (16-entry FIFO cache)");
+    ImGui::TextColored(metricColor(stats.atvr, 1.3f, 2.0f), "ATVR: %.3f", stats.atvr);
+    if (ImGui::IsItemHovered()) ImGui::SetTooltip("Vertex shader runs per unique vertex (1.0 is ideal)");
+    ImGui::TextColored(metricColor(stats.overdraw, 1.3f, 2.0f), "Overdraw: %.2fx", stats.overdraw);
+    if (ImGui::IsItemHovered()) ImGui::SetTooltip("Shaded / covered pixels, sampled from 6 axis views");
+    ImGui::TextColored(metricColor(stats.overfetch, 1.5f, 3.0f), "Vertex Overfetch: %.2fx", stats.overfetch);
+    if (ImGui::IsItemHovered()) ImGui::SetTooltip("Bytes fetched through 64-byte lines / vertex buffer size");
+    
+    ImGui::TextColored(stats.degenerateTriangles ? COLOR_WARNING : COLOR_TEXT, "Degenerate Triangles: %zu", stats.degenerateTriangles);
+    ImGui::TextColored(stats.duplicateTriangles ? COLOR_WARNING : COLOR_TEXT, "Duplicate Triangles: %zu", stats.duplicateTriangles);
+    ImGui::TextColored(stats.unusedVertices ? COLOR_WARNING : COLOR_TEXT, "Unused Vertices: %zu", stats.unusedVertices);
+    
+    ImGui::Separator();
+    
+    if (optimizing) {
+        ImGui::TextColored(COLOR_TEXT_DIM, "Optimizing...");
+        return;
+    }
+    
+    if (ImGui::Button("Optimize All", ImVec2(-1, 0))) startMeshOptimization(obj, OPTIMIZE_ALL);
+    if (ImGui::Button("Weld", ImVec2(125, 0))) startMeshOptimization(obj, OPTIMIZE_WELD);
+    ImGui::SameLine();
+    if (ImGui::Button("Clean Up", ImVec2(-1, 0))) startMeshOptimization(obj, OPTIMIZE_CLEANUP);
+    if (ImGui::Button("Vertex Cache", ImVec2(125, 0))) startMeshOptimization(obj, OPTIMIZE_VERTEX_CACHE);
+    ImGui::SameLine();
+    if (ImGui::Button("Vertex Fetch", ImVec2(-1, 0))) startMeshOptimization(obj, OPTIMIZE_VERTEX_FETCH);
+}
+
+void showMeshEdit() {
+    if (!ImGui::CollapsingHeader("Mesh Edit")) return;
+    
+    if (meshEdit.buildJob.valid()) {
+        ImGui::TextColored(COLOR_TEXT_DIM, "Preparing %s...", meshEdit.buildingObject->name);
+        return;
+    }
+    
+    if (!meshEdit.object) {
+        if (selectedObjectIndex < 0 || selectedObjectIndex >= static_cast<int>(objects.size())) {
+            ImGui::TextColored(COLOR_TEXT_DIM, "Select an object to edit its mesh");
+        } else if (ImGui::Button("Edit Mesh", ImVec2(-1, 0))) {
+            beginMeshEdit(objects[selectedObjectIndex]);
+        }
+        return;
+    }
+    
+    HalfEdgeMesh& mesh = meshEdit.mesh;
+    const auto& obj = meshEdit.object;
+    std::vector<int>& selection = meshEdit.selectedFaces;
+    ImGui::Text("Editing: %s", obj->name);
+    ImGui::Text("Vertices: %d, Faces: %d", mesh.vertexCount(), mesh.faceCount());
+    ImGui::Text("Selected Faces: %zu", selection.size());
+    ImGui::TextColored(COLOR_TEXT_DIM, "Ctrl+click selects, Ctrl+Shift+click toggles");
+    
+    if (ImGui::Button("Grow", ImVec2(125, 0))) selection = mesh.growFaces(selection);
+    ImGui::SameLine();
+    if (ImGui::Button("Clear", ImVec2(-1, 0))) selection.clear();
+    
+    ImGui::Separator();
+    
+    // Widgets work in world units; the mesh lives in object space
+    auto start = std::chrono::steady_clock::now();
+    bool edited = false;
+    bool reshaped = false;
+    glm::mat3 toObject = glm::inverse(glm::mat3(obj->getModelMatrix()));
+    
+    ImGui::SetNextItemWidth(125);
+    ImGui::DragFloat("##ExtrudeDistance", &meshEdit.extrudeDistance, 0.01f, -10.0f, 10.0f, "%.2f");
+    ImGui::SameLine();
+    if (ImGui::Button("Extrude", ImVec2(-1, 0)) && !selection.empty()) {
+        float scale = (obj->scale.x + obj->scale.y + obj->scale.z) / 3.0f;
+        mesh.extrudeFaces(selection, meshEdit.extrudeDistance / glm::max(scale, 1e-6f));
+        edited = true;
+        reshaped = true;
+    }
+    
+    // The pieces are appended, so they join the selection as one range; the triangles
+    // cut from the faces around the selection come after them and stay unselected
+    if (ImGui::Button("Subdivide", ImVec2(-1, 0)) && !selection.empty()) {
+        int firstNewFace = mesh.faceCount();
+        int piecesEnd = mesh.subdivideFaces(selection);
+        for (int f = firstNewFace; f < piecesEnd; ++f) selection.push_back(f);
+        edited = true;
+        reshaped = true;
+    }
+    
+    glm::vec3 previous = meshEdit.moveOffset;
+    if (ImGui::DragFloat3("Move", glm::value_ptr(meshEdit.moveOffset), 0.01f) && !selection.empty()) {
+        glm::vec3 delta = toObject * (meshEdit.moveOffset - previous);
+        mesh.translate(mesh.faceVertices(selection), glm::value_ptr(delta));
+        edited = true;
+    }
+    if (ImGui::IsItemDeactivatedAfterEdit()) meshEdit.moveOffset = glm::vec3(0.0f);
+    
+    if (edited) {
+        // Before the upload, which clears the dirty ranges the surface reads
+        if (reshaped) {
+            if (findSubdivision(obj.get())) reshapeSubdivisionCage(*obj, mesh);
+        } else {
+            moveSubdivisionCage(*obj, mesh);
+        }
+        uploadMeshEdits();
+        meshEdit.lastEditMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+    
+    ImGui::TextColored(COLOR_TEXT_DIM, "Last Edit: %.2f ms, %s in %d uploads", meshEdit.lastEditMs,
+                       formatFileSize(meshEdit.lastUploadBytes).c_str(), meshEdit.lastUploadCalls);
+    
+    if (ImGui::Button("Done", ImVec2(-1, 0))) endMeshEdit();
+}
+
+void showSubdivision() {
+    if (!ImGui::CollapsingHeader("Subdivision")) return;
+    
+    if (selectedObjectIndex < 0 || selectedObjectIndex >= static_cast<int>(objects.size())) {
+        ImGui::TextColored(COLOR_TEXT_DIM, "Select an object to subdivide it");
+        return;
+    }
+    const auto& obj = objects[selectedObjectIndex];
+    SubdivisionEntry* entry = findSubdivision(obj.get());
+    if (!entry) {
+        if (ImGui::Button("Subdivide", ImVec2(-1, 0))) enableSubdivision(obj);
+        return;
+    }
+    if (entry->cage.faceCount() == 0) {
+        ImGui::TextColored(COLOR_TEXT_DIM, "Preparing cage...");
+        return;
+    }
+    
+    static const char* schemeNames[] = { "Catmull-Clark", "Loop" };
+    int scheme = entry->scheme;
+    if (ImGui::Combo("Scheme", &scheme, schemeNames, IM_ARRAYSIZE(schemeNames))) {
+        entry->scheme = static_cast<SubdivisionScheme>(scheme);
+        invalidateSubdivision(*entry);
+    }
+    ImGui::SliderFloat("Crease Angle", &entry->creaseAngle, 0.0f, 180.0f, "%.0f deg");
+    if (ImGui::IsItemDeactivatedAfterEdit()) invalidateSubdivision(*entry);
+    
+    ImGui::Checkbox("Adaptive", &entry->adaptive);
+    if (entry->adaptive) {
+        ImGui::DragFloat("Pixel Tolerance", &subdivision.pixelTolerance, 0.05f, 0.1f, 8.0f, "%.2f px");
+        ImGui::SliderInt("Max Level", &subdivision.maxLevel, 0, SubdivisionSurface::MAX_LEVEL);
+    } else {
+        ImGui::SliderInt("Level", &entry->fixedLevel, 0, SubdivisionSurface::MAX_LEVEL);
+    }
+    
+    ImGui::Separator();
+    
+    ImGui::Text("Cage: %d vertices, %d faces", entry->cage.vertexCount(), entry->cage.faceCount());
+    if (entry->level >= 0 && entry->levels[entry->level]) {
+        const SubdivisionSurface& surface = *entry->levels[entry->level];
+        ImGui::Text("Level %d: %d triangles, %d vertices", surface.level(), surface.indexCount() / 3, surface.vertexCount());
+        ImGui::TextColored(COLOR_TEXT_DIM, "Stencils: %zu terms, %s", surface.stencilEntries(),
+                           formatFileSize(surface.tableBytes()).c_str());
+    }
+    if (entry->buildJob.valid()) {
+        ImGui::TextColored(COLOR_WARNING, "Building level %d...", entry->buildLevel);
+    }
+    ImGui::TextColored(COLOR_TEXT_DIM, "Build: %.1f ms, Update: %.2f ms, %s", entry->buildMs,
+                       subdivision.lastUpdateMs, formatFileSize(subdivision.lastUpdateBytes).c_str());
+    if (obj != meshEdit.object) ImGui::TextColored(COLOR_TEXT_DIM, "Edit the mesh to move the cage");
+    
+    if (ImGui::Button("Remove", ImVec2(-1, 0))) removeSubdivision(obj.get());
+}
+
+void showPathTrace() {
+    if (!ImGui::CollapsingHeader("Path Tracing")) return;
+    
+    ImGui::Checkbox("Path Traced Preview", &pathTrace.enabled);
+    ImGui::SliderInt("Samples", &pathTrace.maxSamples, 1, 4096, "%d", ImGuiSliderFlags_Logarithmic);
+    ImGui::SliderInt("Bounces", &pathTrace.maxBounces, 0, 8);
+    ImGui::Checkbox("Ground Plane", &pathTrace.groundPlane);
+    ImGui::SliderFloat("Exposure", &pathTrace.exposure, 0.1f, 4.0f, "%.2f");
+    
+    if (!pathTrace.enabled) {
+        ImGui::TextColored(COLOR_TEXT_DIM, "Traces the perspective view on every core");
+        return;
+    }
+    
+    ImGui::Separator();
+    
+    const PathTracer& tracer = pathTrace.tracer;
+    int samples = tracer.samples();
+    char progress[64];
+    snprintf(progress, sizeof(progress), "%d / %d samples", samples, pathTrace.maxSamples);
+    ImGui::ProgressBar(static_cast<float>(samples) / pathTrace.maxSamples, ImVec2(-1, 0), progress);
+    if (!pathTrace.displayed) ImGui::TextColored(COLOR_WARNING, "Tracing first pass...");
+    ImGui::Text("%dx%d, %u threads", tracer.width(), tracer.height(), std::max(1u, std::thread::hardware_concurrency()));
+    ImGui::Text("Pass: %.1f ms, %.2f Mrays/s", tracer.lastPassMs(), tracer.lastRaysPerSecond() / 1e6);
+    ImGui::TextColored(COLOR_TEXT_DIM, "%zu triangles, %zu meshes, %s", tracer.triangleCount(), tracer.meshCount(),
+                       formatFileSize(tracer.memoryBytes()).c_str());
+    ImGui::TextColored(COLOR_TEXT_DIM, "Restart: %.1f ms", pathTrace.restartMs);
+}
+
+void showLightmaps() {
+    if (!ImGui::CollapsingHeader("Lightmaps")) return;
+    ImGui::PushID("Lightmaps");
+    
+    LightmapSettings& settings = lightmaps.settings;
+    ImGui::Checkbox("Use Lightmaps", &lightmaps.enabled);
+    ImGui::SliderFloat("Texels/Unit", &settings.texelsPerUnit, 1.0f, 256.0f, "%.0f", ImGuiSliderFlags_Logarithmic);
+    ImGui::SliderInt("Max Block", &settings.maxBlockSize, 64, 2048);
+    ImGui::SliderInt("Samples", &settings.samples, 1, 1024, "%d", ImGuiSliderFlags_Logarithmic);
+    ImGui::Checkbox("Indirect Light", &settings.indirect);
+    if (!settings.indirect) ImGui::SliderFloat("AO Distance", &settings.aoDistance, 0.1f, 20.0f, "%.1f");
+    
+    if (lightmaps.job.valid()) {
+        int done = lightmaps.objectsDone;
+        char progress[64];
+        snprintf(progress, sizeof(progress), "%d / %d objects", done, lightmaps.objectsTotal);
+        ImGui::ProgressBar(static_cast<float>(done) / std::max(1, lightmaps.objectsTotal), ImVec2(-1, 0), progress);
+        ImGui::TextColored(COLOR_TEXT_DIM, "%d rows of the current object", lightmaps.rowsDone.load());
+        if (ImGui::Button("Cancel")) lightmaps.cancel = true;
+    } else {
+        if (ImGui::Button("Bake")) startLightmapBake();
+        ImGui::SameLine();
+        if (ImGui::Button("Clear")) clearLightmaps();
+    }
+    
+    ImGui::Separator();
+    
+    // Stale lightmaps are not drawn; the next bake redoes exactly those objects
+    uint64_t lightHash = hashLightmapLight();
+    int current = 0, stale = 0, charts = 0;
+    for (const auto& pair : lightmaps.entries) {
+        const LightmapEntry& entry = *pair.second;
+        if (lightmapMatches(entry, *entry.object, entry.object->getModelMatrix(), lightHash)) {
+            current++;
+        } else {
+            stale++;
+        }
+        charts += entry.chartCount;
+    }
+    ImGui::Text("Baked: %d objects, %d charts", current, charts);
+    if (stale > 0) ImGui::TextColored(COLOR_WARNING, "%d stale (moved or edited), lit live until rebaked", stale);
+    ImGui::Text("Atlas: %dx%d, %s", lightmaps.atlasWidth, lightmaps.atlasHeight,
+                formatFileSize(static_cast<size_t>(lightmaps.atlasWidth) * lightmaps.atlasHeight * 6).c_str());
+    if (lightmaps.bakeMs > 0.0f) {
+        ImGui::TextColored(COLOR_TEXT_DIM, "Last bake: %.1f s, %d traced, %d from cache", lightmaps.bakeMs / 1000.0f,
+                           lightmaps.traced, lightmaps.loaded);
+    }
+    if (lightmaps.failed > 0) ImGui::TextColored(COLOR_WARNING, "%d objects could not be unwrapped", lightmaps.failed);
+    ImGui::TextColored(COLOR_TEXT_DIM, "Cache: %s", lightmaps.cacheDirectory.c_str());
+    
+    ImGui::PopID();
+}
+
+void showHlod() {
+    if (!ImGui::CollapsingHeader("HLOD")) return;
+    ImGui::PushID("HLOD");
+    
+    HlodSettings& settings = hlod.settings;
+    ImGui::Checkbox("Use HLOD", &hlod.enabled);
+    ImGui::SliderFloat("Screen Size", &hlod.screenPixels, 8.0f, 512.0f, "%.0f px", ImGuiSliderFlags_Logarithmic);
+    if (ImGui::IsItemHovered()) ImGui::SetTooltip("Clusters smaller than this on screen draw their proxy");
+    ImGui::SliderFloat("Cell Size", &settings.cellSize, 0.5f, 64.0f, "%.1f", ImGuiSliderFlags_Logarithmic);
+    ImGui::SliderInt("Min Members", &settings.minMembers, 2, 64);
+    ImGui::SliderInt("Proxy Grid", &settings.proxyGrid, 4, HlodBuilder::MAX_GRID);
+    ImGui::SliderInt("Max Triangles", &settings.maxTriangles, 64, 65536, "%d", ImGuiSliderFlags_Logarithmic);
+    
+    ImGui::Separator();
+    
+    // Clusters too small for a proxy are not counted
+    int clusters = 0, current = 0, waiting = 0, members = 0;
+    size_t proxyTriangles = 0, sourceTriangles = 0;
+    for (const auto& pair : hlod.clusters) {
+        const HlodCluster& cluster = pair.second;
+        if (cluster.memberCount < settings.minMembers) continue;
+        clusters++;
+        if (cluster.proxyHash == cluster.membersHash) {
+            current++;
+            members += cluster.memberCount;
+            proxyTriangles += cluster.indexCount / 3;
+            sourceTriangles += cluster.sourceTriangles;
+        } else {
+            waiting++;
+        }
+    }
+    ImGui::Text("Clusters: %d, %d with proxies (%d objects)", clusters, current, members);
+    if (sourceTriangles > 0) {
+        ImGui::Text("Proxy Triangles: %zu of %zu (%.1f%%)", proxyTriangles, sourceTriangles,
+                    100.0 * proxyTriangles / sourceTriangles);
+    }
+    if (waiting > 0) {
+        ImGui::TextColored(COLOR_WARNING, "%d changed, members drawn until rebuilt%s", waiting,
+                           hlod.job.valid() ? " (building)" : "");
+    }
+    if (hlod.rebuilds > 0) {
+        ImGui::TextColored(COLOR_TEXT_DIM, "%d rebuilds, last %.1f ms", hlod.rebuilds, hlod.lastBuildMs);
+    }
+    
+    ImGui::PopID();
+}
+
 void showViewport() {
     ImGuiViewport* mainViewport = ImGui::GetMainViewport();
     float menuBarHeight = ImGui::GetFrameHeight();
@@ -2180,15 +6997,34 @@ void showViewport() {
         isViewportHovered = ImGui::IsWindowHovered();
         isViewportFocused = ImGui::IsWindowFocused();
         
-        // Get the actual content region available
-        ImVec2 contentSize = ImGui::GetContentRegionAvail();
-        
-        // Display the rendered texture
-        if (viewportTexture != 0) {
-            ImGui::Image((void*)(intptr_t)viewportTexture, contentSize, ImVec2(0, 1), ImVec2(1, 0));
-        } else {
-            ImGui::TextColored(COLOR_TEXT_DIM, "Viewport not initialized");
+        // Display each view's texture where layoutSceneViews() placed it
+        static const char* viewNames[VIEW_TYPE_COUNT] = { "Perspective", "Top", "Front", "Side" };
+        ImVec2 mousePos = ImGui::GetIO().MousePos;
+        for (int i = 0; i < sceneViewCount(); ++i) {
+            const SceneView& sceneView = sceneViews[i];
+            ImVec2 localPos(sceneView.screenPos.x - vpPos.x, sceneView.screenPos.y - vpPos.y);
+            ImGui::SetCursorPos(localPos);
+            // Texture names are fixed at init; the render thread only resizes their storage
+            GLuint texture = sceneViewTargets[i].texture;
+            if (texture != 0) {
+                ImGui::Image((void*)(intptr_t)texture, sceneView.screenSize, ImVec2(0, 1), ImVec2(1, 0));
+            } else {
+                ImGui::TextColored(COLOR_TEXT_DIM, "Viewport not initialized");
+            }
+            
+            if (quadView) {
+                ImGui::SetCursorPos(ImVec2(localPos.x + 8, localPos.y + sceneView.screenSize.y - 22));
+                ImGui::TextColored(i == activeSceneView ? COLOR_ACCENT : COLOR_TEXT_DIM, "%s", viewNames[sceneView.type]);
+            }
+            
+            // Camera input goes to the view under the mouse; a drag stays with the view it started in
+            if (!isMouseDragging &&
+                mousePos.x >= sceneView.screenPos.x && mousePos.x < sceneView.screenPos.x + sceneView.screenSize.x &&
+                mousePos.y >= sceneView.screenPos.y && mousePos.y < sceneView.screenPos.y + sceneView.screenSize.y) {
+                activeSceneView = i;
+            }
         }
+        if (!quadView) activeSceneView = 0;
         
         // Display viewport info overlay
         ImGui::SetCursorPos(ImVec2(10, 10));
@@ -2280,6 +7116,14 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
 void mouse_button_callback(GLFWwindow* window, int button, int action, int mods) {
     if (!isViewportHovered) return;
     
+    // Ctrl+click selects faces of the mesh being edited instead of orbiting
+    if (meshEdit.object && button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS && (mods & GLFW_MOD_CONTROL)) {
+        double xpos, ypos;
+        glfwGetCursorPos(window, &xpos, &ypos);
+        pickMeshEditFace(xpos, ypos, (mods & GLFW_MOD_SHIFT) != 0);
+        return;
+    }
+    
     if (button == GLFW_MOUSE_BUTTON_LEFT || button == GLFW_MOUSE_BUTTON_RIGHT) {
         if (action == GLFW_PRESS) {
             isMouseDragging = true;
@@ -2300,6 +7144,17 @@ void cursor_pos_callback(GLFWwindow* window, double xpos, double ypos) {
     glm::vec2 currentMousePos(static_cast<float>(xpos), static_cast<float>(ypos));
     glm::vec2 delta = currentMousePos - lastMousePos;
     
+    // Orthographic views pan with either button; one pixel moves one pixel's worth of world
+    SceneView& sceneView = sceneViews[activeSceneView];
+    if (sceneView.type != VIEW_PERSPECTIVE) {
+        float unitsPerPixel = sceneView.orthoHeight / glm::max(sceneView.screenSize.y, 1.0f);
+        glm::vec3 right(sceneView.view[0][0], sceneView.view[1][0], sceneView.view[2][0]);
+        glm::vec3 up(sceneView.view[0][1], sceneView.view[1][1], sceneView.view[2][1]);
+        sceneView.orthoCenter += (-right * delta.x + up * delta.y) * unitsPerPixel;
+        lastMousePos = currentMousePos;
+        return;
+    }
+    
     if (dragButton == GLFW_MOUSE_BUTTON_LEFT) {
         // Rotate camera
         cameraYaw -= delta.x * 0.01f;
@@ -2318,6 +7173,13 @@ void cursor_pos_callback(GLFWwindow* window, double xpos, double ypos) {
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {
     if (!isViewportHovered) return;
     
+    SceneView& sceneView = sceneViews[activeSceneView];
+    if (sceneView.type != VIEW_PERSPECTIVE) {
+        sceneView.orthoHeight *= 1.0f - static_cast<float>(yoffset) * 0.1f;
+        sceneView.orthoHeight = glm::clamp(sceneView.orthoHeight, 0.5f, 200.0f);
+        return;
+    }
+    
     // Zoom camera
     float zoomSpeed = cameraDistance * 0.1f;
     cameraDistance -= static_cast<float>(yoffset) * zoomSpeed;
@@ -2327,6 +7189,31 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
     if (action != GLFW_PRESS) return;
     
+    // Frame capture works regardless of focus
+    if (key == GLFW_KEY_F12) {
+        int frames = (mods & GLFW_MOD_SHIFT) ? 10 : 1;
+        renderThread.invoke([frames]() { GLCapture::requestCapture(frames); });
+        return;
+    }
+    
+    if (key == GLFW_KEY_F10) {
+        requestScreenshot();
+        return;
+    }
+    
+    if (key == GLFW_KEY_F9) {
+        if (viewportCapture.recording) stopViewportRecording(); else startViewportRecording();
+        return;
+    }
+    
+    if (key == GLFW_KEY_F11) {
+        if (CpuTrace::exportChromeTrace()) {
+            snprintf(statusMessage, sizeof(statusMessage), "CPU trace saved: %s (%zu zones)",
+                     CpuTrace::lastExportPath(), CpuTrace::lastExportEvents());
+        }
+        return;
+    }
+    
     if (!isViewportHovered && !isViewportFocused) return;
     
     // Camera movement with WASD
@@ -2380,16 +7267,20 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
             autoCenterSelectedModel();
             break;
             
+        case GLFW_KEY_V:
+            quadView = !quadView;
+            snprintf(statusMessage, sizeof(statusMessage), "%s", quadView ? "Quad view" : "Single view");
+            break;
+            
         case GLFW_KEY_DELETE:
             if (selectedObjectIndex >= 0 && selectedObjectIndex < objects.size()) {
                 auto obj = objects[selectedObjectIndex];
                 snprintf(statusMessage, sizeof(statusMessage), "Deleted object: %s", obj->name);
                 
-                if (obj->vao) glDeleteVertexArrays(1, &obj->vao);
-                if (obj->vbo) glDeleteBuffers(1, &obj->vbo);
-                if (obj->ebo) glDeleteBuffers(1, &obj->ebo);
+                releaseObjectBuffers(*obj);
                 
                 objects.erase(objects.begin() + selectedObjectIndex);
+                outlinerObjectRemoved(selectedObjectIndex);
                 selectedObjectIndex = -1;
             }
             break;
@@ -2412,6 +7303,8 @@ void drop_callback(GLFWwindow* window, int count, const char** paths) {
             
             if (strcasecmp(ext, "obj") == 0) {
                 loadOBJModel(path);
+            } else if (strcasecmp(ext, "campath") == 0) {
+                loadCameraPath(path);
             } else if (strcasecmp(ext, "glb") == 0 || strcasecmp(ext, "gltf") == 0) {
                 loadGLBModel(path);
             } else {
@@ -0,0 +1,206 @@
+// src/camera_path.h - Recorded camera flythroughs for repeatable benchmarks
+//
+// A path is a list of orbit-camera keyframes (target, yaw, pitch, distance)
+// sampled at a fixed interval while recording. Playback evaluates the path
+// at a fixed number of evenly spaced frames, so every run renders exactly the
+// same views no matter how fast the frames come. Frame times collected during
+// playback are reduced to a FrameTimingSummary and written next to the path.
+//
+// No OpenGL here; the editor owns the timing queries.
+
+#pragma once
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+
+struct CameraKeyframe {
+    float time = 0.0f;          // seconds since recording started
+    float target[3] = { 0.0f, 0.0f, 0.0f };
+    float yaw = 0.0f;
+    float pitch = 0.0f;
+    float distance = 0.0f;
+};
+
+struct FrameTimingSummary {
+    int frames = 0;
+    double meanMs = 0.0;
+    double minMs = 0.0;
+    double maxMs = 0.0;
+    double p50Ms = 0.0;
+    double p95Ms = 0.0;
+    double p99Ms = 0.0;
+    double gpuMeanMs = 0.0;     // 0 when no GPU timings were collected
+    double gpuMaxMs = 0.0;
+    int over16Ms = 0;           // frames that would miss 60 Hz
+    int over33Ms = 0;           // frames that would miss 30 Hz
+};
+
+class CameraPath {
+public:
+    static constexpr float KEYFRAME_INTERVAL = 0.1f;
+
+    std::vector<CameraKeyframe> keyframes;
+
+    void clear() { keyframes.clear(); }
+    bool empty() const { return keyframes.empty(); }
+    float duration() const { return keyframes.empty() ? 0.0f : keyframes.back().time; }
+
+    // Append a keyframe if KEYFRAME_INTERVAL has passed since the last one (or force it)
+    void record(float time, const float target[3], float yaw, float pitch, float distance, bool force = false) {
+        if (!force && !keyframes.empty() && time - keyframes.back().time < KEYFRAME_INTERVAL) return;
+        if (!keyframes.empty() && time <= keyframes.back().time) return;
+        CameraKeyframe key;
+        key.time = time;
+        memcpy(key.target, target, sizeof(key.target));
+        key.yaw = yaw;
+        key.pitch = pitch;
+        key.distance = distance;
+        keyframes.push_back(key);
+    }
+
+    // Catmull-Rom through the keyframes; yaw is unbounded, so no angle wrapping is needed
+    CameraKeyframe sample(float time) const {
+        if (keyframes.empty()) return CameraKeyframe();
+        if (keyframes.size() == 1 || time <= keyframes.front().time) return keyframes.front();
+        if (time >= keyframes.back().time) return keyframes.back();
+
+        size_t i = std::upper_bound(keyframes.begin(), keyframes.end(), time,
+                                    [](float t, const CameraKeyframe& key) { return t < key.time; }) - keyframes.begin() - 1;
+        const CameraKeyframe& k0 = keyframes[i > 0 ? i - 1 : i];
+        const CameraKeyframe& k1 = keyframes[i];
+        const CameraKeyframe& k2 = keyframes[i + 1];
+        const CameraKeyframe& k3 = keyframes[i + 2 < keyframes.size() ? i + 2 : i + 1];
+        float u = (time - k1.time) / (k2.time - k1.time);
+
+        CameraKeyframe result;
+        result.time = time;
+        for (int c = 0; c < 3; ++c) {
+            result.target[c] = catmullRom(k0.target[c], k1.target[c], k2.target[c], k3.target[c], u);
+        }
+        result.yaw = catmullRom(k0.yaw, k1.yaw, k2.yaw, k3.yaw, u);
+        result.pitch = catmullRom(k0.pitch, k1.pitch, k2.pitch, k3.pitch, u);
+        result.distance = std::max(catmullRom(k0.distance, k1.distance, k2.distance, k3.distance, u), 0.01f);
+        return result;
+    }
+
+    // Pose for frame `frame` of a playback that spreads the path over frameCount frames
+    CameraKeyframe sampleFrame(int frame, int frameCount) const {
+        float t = frameCount > 1 ? duration() * (float)frame / (float)(frameCount - 1) : 0.0f;
+        return sample(t);
+    }
+
+    // Plain text: one "key time tx ty tz yaw pitch distance" line per keyframe
+    bool save(const char* path) const {
+        FILE* file = fopen(path, "w");
+        if (!file) return false;
+        fprintf(file, "# camera path v1\n");
+        for (const auto& key : keyframes) {
+            fprintf(file, "key %.4f %.6f %.6f %.6f %.6f %.6f %.6f\n", key.time,
+                    key.target[0], key.target[1], key.target[2], key.yaw, key.pitch, key.distance);
+        }
+        fclose(file);
+        return true;
+    }
+
+    bool load(const char* path) {
+        FILE* file = fopen(path, "r");
+        if (!file) return false;
+        std::vector<CameraKeyframe> loaded;
+        char line[256];
+        while (fgets(line, sizeof(line), file)) {
+            CameraKeyframe key;
+            if (sscanf(line, "key %f %f %f %f %f %f %f", &key.time, &key.target[0], &key.target[1],
+                       &key.target[2], &key.yaw, &key.pitch, &key.distance) == 7) {
+                if (loaded.empty() || key.time > loaded.back().time) loaded.push_back(key);
+            }
+        }
+        fclose(file);
+        if (loaded.empty()) return false;
+        keyframes.swap(loaded);
+        return true;
+    }
+
+    static FrameTimingSummary summarize(const std::vector<float>& cpuMs, const std::vector<float>& gpuMs) {
+        FrameTimingSummary summary;
+        summary.frames = (int)cpuMs.size();
+        if (cpuMs.empty()) return summary;
+
+        std::vector<float> sorted(cpuMs);
+        std::sort(sorted.begin(), sorted.end());
+        double total = 0.0;
+        for (float ms : sorted) {
+            total += ms;
+            if (ms > 16.7f) summary.over16Ms++;
+            if (ms > 33.3f) summary.over33Ms++;
+        }
+        summary.meanMs = total / sorted.size();
+        summary.minMs = sorted.front();
+        summary.maxMs = sorted.back();
+        summary.p50Ms = percentile(sorted, 0.50);
+        summary.p95Ms = percentile(sorted, 0.95);
+        summary.p99Ms = percentile(sorted, 0.99);
+
+        if (!gpuMs.empty()) {
+            double gpuTotal = 0.0;
+            for (float ms : gpuMs) {
+                gpuTotal += ms;
+                summary.gpuMaxMs = std::max(summary.gpuMaxMs, (double)ms);
+            }
+            summary.gpuMeanMs = gpuTotal / gpuMs.size();
+        }
+        return summary;
+    }
+
+    // Per-frame CSV at <base>.bench.csv (overwritten) and one summary line appended to
+    // <base>.bench.txt, so successive runs of the same path can be compared
+    static bool writeReport(const char* pathFile, const std::vector<float>& cpuMs, const std::vector<float>& gpuMs,
+                            const FrameTimingSummary& summary) {
+        char base[1024];
+        snprintf(base, sizeof(base), "%s", pathFile);
+        char* ext = strrchr(base, '.');
+        char* slash = strrchr(base, '/');
+        char* backslash = strrchr(base, '\\');
+        if (ext && (!slash || ext > slash) && (!backslash || ext > backslash)) *ext = '\0';
+
+        char csvPath[1100];
+        snprintf(csvPath, sizeof(csvPath), "%s.bench.csv", base);
+        FILE* csv = fopen(csvPath, "w");
+        if (!csv) return false;
+        fprintf(csv, "frame,cpu_ms,gpu_ms\n");
+        for (size_t i = 0; i < cpuMs.size(); ++i) {
+            fprintf(csv, "%zu,%.3f,%.3f\n", i, cpuMs[i], i < gpuMs.size() ? gpuMs[i] : 0.0f);
+        }
+        fclose(csv);
+
+        char logPath[1100];
+        snprintf(logPath, sizeof(logPath), "%s.bench.txt", base);
+        FILE* log = fopen(logPath, "a");
+        if (!log) return false;
+        char stamp[32];
+        time_t now = time(NULL);
+        strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", localtime(&now));
+        fprintf(log, "%s frames=%d mean=%.3f p50=%.3f p95=%.3f p99=%.3f max=%.3f gpu_mean=%.3f gpu_max=%.3f over16=%d over33=%d\n",
+                stamp, summary.frames, summary.meanMs, summary.p50Ms, summary.p95Ms, summary.p99Ms, summary.maxMs,
+                summary.gpuMeanMs, summary.gpuMaxMs, summary.over16Ms, summary.over33Ms);
+        fclose(log);
+        return true;
+    }
+
+private:
+    static float catmullRom(float p0, float p1, float p2, float p3, float u) {
+        float u2 = u * u;
+        float u3 = u2 * u;
+        return 0.5f * ((2.0f * p1) + (-p0 + p2) * u + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * u2 +
+                       (-p0 + 3.0f * p1 - 3.0f * p2 + p3) * u3);
+    }
+
+    // Nearest-rank percentile of an ascending array
+    static double percentile(const std::vector<float>& sorted, double fraction) {
+        size_t rank = (size_t)ceil(fraction * sorted.size());
+        return sorted[rank > 0 ? rank - 1 : 0];
+    }
+};
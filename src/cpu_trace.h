@@ -0,0 +1,239 @@
+#pragma once
+
+// CPU trace recorder.
+//
+// TRACE_ZONE("Name") times the enclosing scope. Every thread writes finished
+// zones into its own ring buffer without locking, so recording is always on
+// and the last few thousand zones per thread are available when a hitch is
+// noticed. exportChromeTrace() writes them as Chrome trace JSON, which opens
+// in chrome://tracing and ui.perfetto.dev.
+//
+// Zone names must be string literals (only the pointer is stored).
+// Timestamps are rdtsc ticks on x86 (assumes an invariant TSC) and
+// steady_clock elsewhere; ticks are converted to microseconds on export.
+// Define CPU_TRACE_DISABLED to compile the zones out.
+
+#include <cstdio>
+#include <cstdint>
+#include <ctime>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include <string>
+#include <map>
+#include <algorithm>
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+#endif
+
+struct CpuTraceEvent {
+    const char* name;
+    uint64_t start;
+    uint64_t end;
+    uint32_t threadId;
+};
+
+// Single-writer ring; the owning thread publishes with a release store on head
+struct CpuTraceBuffer {
+    static const uint64_t CAPACITY = 16384;     // power of two
+    std::atomic<uint64_t> head{0};
+    uint32_t threadId = 0;
+    CpuTraceEvent events[CAPACITY];
+};
+
+class CpuTrace {
+public:
+    static uint64_t now() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        return __rdtsc();
+#elif defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    static void record(const char* name, uint64_t start, uint64_t end) {
+        CpuTraceBuffer* buffer = threadBuffer();
+        uint64_t index = buffer->head.load(std::memory_order_relaxed);
+        CpuTraceEvent& event = buffer->events[index & (CpuTraceBuffer::CAPACITY - 1)];
+        event.name = name;
+        event.start = start;
+        event.end = end;
+        event.threadId = buffer->threadId;
+        buffer->head.store(index + 1, std::memory_order_release);
+    }
+
+    // Label the calling thread in exported traces
+    static void setThreadName(const char* name) {
+        CpuTraceBuffer* buffer = threadBuffer();
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.threadNames[buffer->threadId] = name;
+    }
+
+    // Write every buffered zone to path, or to trace_<timestamp>.json when path is NULL.
+    // Zones recorded while the export runs may be torn; this is a debugging aid.
+    static bool exportChromeTrace(const char* path = NULL) {
+        Registry& r = registry();
+        if (path) {
+            snprintf(r.path, sizeof(r.path), "%s", path);
+        } else {
+            time_t t = time(NULL);
+            strftime(r.path, sizeof(r.path), "trace_%Y%m%d_%H%M%S.json", localtime(&t));
+        }
+
+        FILE* file = fopen(r.path, "w");
+        if (!file) {
+            fprintf(stderr, "CPU trace: cannot write %s\n", r.path);
+            return false;
+        }
+
+        double ticksPerMicrosecond = calibrate();
+
+        std::lock_guard<std::mutex> lock(r.mutex);
+        uint64_t origin = UINT64_MAX;
+        for (CpuTraceBuffer* buffer : r.buffers) {
+            uint64_t head = buffer->head.load(std::memory_order_acquire);
+            uint64_t begin = head > CpuTraceBuffer::CAPACITY ? head - CpuTraceBuffer::CAPACITY : 0;
+            for (uint64_t i = begin; i < head; ++i) {
+                origin = std::min(origin, buffer->events[i & (CpuTraceBuffer::CAPACITY - 1)].start);
+            }
+        }
+
+        fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        bool first = true;
+        for (const auto& entry : r.threadNames) {
+            fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                    first ? "" : ",\n", entry.first, entry.second.c_str());
+            first = false;
+        }
+
+        size_t written = 0;
+        for (CpuTraceBuffer* buffer : r.buffers) {
+            uint64_t head = buffer->head.load(std::memory_order_acquire);
+            uint64_t begin = head > CpuTraceBuffer::CAPACITY ? head - CpuTraceBuffer::CAPACITY : 0;
+            for (uint64_t i = begin; i < head; ++i) {
+                const CpuTraceEvent& event = buffer->events[i & (CpuTraceBuffer::CAPACITY - 1)];
+                fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                        first ? "" : ",\n", event.name, event.threadId,
+                        (event.start - origin) / ticksPerMicrosecond,
+                        (event.end - event.start) / ticksPerMicrosecond);
+                first = false;
+                written++;
+            }
+        }
+        fprintf(file, "\n]}\n");
+        fclose(file);
+
+        r.lastExportEvents = written;
+        return true;
+    }
+
+    static const char* lastExportPath() { return registry().path; }
+    static size_t lastExportEvents() { return registry().lastExportEvents; }
+
+private:
+    struct Registry {
+        std::mutex mutex;
+        std::vector<CpuTraceBuffer*> buffers;       // never freed, reused after a thread exits
+        std::vector<CpuTraceBuffer*> freeBuffers;
+        std::map<uint32_t, std::string> threadNames;
+        uint32_t nextThreadId = 1;
+        char path[256] = "";
+        size_t lastExportEvents = 0;
+    };
+
+    struct Epoch {
+        uint64_t ticks;
+        std::chrono::steady_clock::time_point time;
+    };
+
+    // Returns the buffer to the free list when its thread exits (std::async workers come and go)
+    struct BufferHolder {
+        CpuTraceBuffer* buffer = nullptr;
+        ~BufferHolder() {
+            if (!buffer) return;
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            r.freeBuffers.push_back(buffer);
+        }
+    };
+
+    static Registry& registry() {
+        static Registry r;
+        return r;
+    }
+
+    static const Epoch& epoch() {
+        static const Epoch e = { now(), std::chrono::steady_clock::now() };
+        return e;
+    }
+
+    // The plain pointer keeps the hot path free of TLS init guards; the holder only runs at thread exit
+    static CpuTraceBuffer* threadBuffer() {
+        static thread_local CpuTraceBuffer* buffer = nullptr;
+        if (!buffer) {
+            static thread_local BufferHolder holder;
+            buffer = holder.buffer = acquireBuffer();
+        }
+        return buffer;
+    }
+
+    static CpuTraceBuffer* acquireBuffer() {
+        epoch();
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        CpuTraceBuffer* buffer;
+        if (!r.freeBuffers.empty()) {
+            buffer = r.freeBuffers.back();
+            r.freeBuffers.pop_back();
+        } else {
+            buffer = new CpuTraceBuffer();
+            r.buffers.push_back(buffer);
+        }
+        buffer->threadId = r.nextThreadId++;
+        return buffer;
+    }
+
+    // Tick rate measured against steady_clock over the whole run so far
+    static double calibrate() {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+        const Epoch& e = epoch();
+        uint64_t ticks = now();
+        double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - e.time).count();
+        return micros > 0.0 && ticks > e.ticks ? (ticks - e.ticks) / micros : 1000.0;
+#else
+        return 1000.0;      // steady_clock nanoseconds
+#endif
+    }
+};
+
+// Times its own lifetime
+class CpuTraceZone {
+public:
+    explicit CpuTraceZone(const char* name) : name(name), start(CpuTrace::now()) {}
+    ~CpuTraceZone() { CpuTrace::record(name, start, CpuTrace::now()); }
+
+    CpuTraceZone(const CpuTraceZone&) = delete;
+    CpuTraceZone& operator=(const CpuTraceZone&) = delete;
+
+private:
+    const char* name;
+    uint64_t start;
+};
+
+#define CPU_TRACE_CONCAT_INNER(a, b) a##b
+#define CPU_TRACE_CONCAT(a, b) CPU_TRACE_CONCAT_INNER(a, b)
+
+#ifdef CPU_TRACE_DISABLED
+    #define TRACE_ZONE(name) ((void)0)
+#else
+    #define TRACE_ZONE(name) CpuTraceZone CPU_TRACE_CONCAT(traceZone, __LINE__)(name)
+#endif
+#define TRACE_FUNCTION() TRACE_ZONE(__func__)
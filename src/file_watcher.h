@@ -0,0 +1,182 @@
+#pragma once
+
+// Change notification for files on disk.
+//
+// watch() registers a file and poll() returns the watched files that were
+// written since the last call. On Linux the file's directory is watched with
+// inotify, so tools that save by writing a temporary file and renaming it
+// over the original are caught too. Elsewhere (or if inotify is unavailable)
+// modification times are checked once a second.
+//
+// A file is reported only after it has been quiet for SETTLE_SECONDS, so an
+// exporter that writes in several passes triggers a single change.
+// Main thread only.
+
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <map>
+#include <sys/stat.h>
+
+#ifdef __linux__
+    #include <sys/inotify.h>
+    #include <unistd.h>
+    #include <cerrno>
+#endif
+
+class FileWatcher {
+public:
+    static constexpr double SETTLE_SECONDS = 0.25;
+    static constexpr double POLL_INTERVAL = 1.0;
+
+    static bool watch(const std::string& path) {
+        State& s = state();
+        if (s.files.count(path)) return true;
+
+        WatchedFile file;
+        size_t slash = path.find_last_of("/\\");
+        file.directory = slash == std::string::npos ? "." : path.substr(0, slash);
+        file.name = slash == std::string::npos ? path : path.substr(slash + 1);
+        readStat(path, file.modifiedTime, file.size);
+
+#ifdef __linux__
+        if (s.fd < 0 && !s.inotifyFailed) {
+            s.fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+            if (s.fd < 0) {
+                fprintf(stderr, "File watcher: inotify unavailable (%s), polling instead\n", strerror(errno));
+                s.inotifyFailed = true;
+            }
+        }
+        if (s.fd >= 0) {
+            file.watchDescriptor = inotify_add_watch(s.fd, file.directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+            if (file.watchDescriptor < 0) {
+                fprintf(stderr, "File watcher: cannot watch %s (%s), polling instead\n",
+                        file.directory.c_str(), strerror(errno));
+            }
+        }
+#endif
+
+        s.files[path] = file;
+        return true;
+    }
+
+    static void unwatch(const std::string& path) {
+        State& s = state();
+        auto it = s.files.find(path);
+        if (it == s.files.end()) return;
+        int wd = it->second.watchDescriptor;
+        s.files.erase(it);
+
+#ifdef __linux__
+        // Directory watches are shared by every file in the directory
+        if (wd < 0) return;
+        for (const auto& entry : s.files) {
+            if (entry.second.watchDescriptor == wd) return;
+        }
+        inotify_rm_watch(s.fd, wd);
+#else
+        (void)wd;
+#endif
+    }
+
+    static bool watching(const std::string& path) { return state().files.count(path) != 0; }
+    static size_t watchedCount() { return state().files.size(); }
+
+    // Watched files that changed and have since been quiet for SETTLE_SECONDS
+    static std::vector<std::string> poll() {
+        State& s = state();
+        double now = seconds();
+        readEvents(now);
+
+        if (now - s.lastPoll >= POLL_INTERVAL) {
+            s.lastPoll = now;
+            for (auto& entry : s.files) {
+                WatchedFile& file = entry.second;
+                if (file.watchDescriptor >= 0) continue;
+                time_t modifiedTime;
+                long long size;
+                if (!readStat(entry.first, modifiedTime, size)) continue;
+                if (modifiedTime != file.modifiedTime || size != file.size) {
+                    file.modifiedTime = modifiedTime;
+                    file.size = size;
+                    file.pending = true;
+                    file.changedAt = now;
+                }
+            }
+        }
+
+        std::vector<std::string> changed;
+        for (auto& entry : s.files) {
+            WatchedFile& file = entry.second;
+            if (file.pending && now - file.changedAt >= SETTLE_SECONDS) {
+                file.pending = false;
+                changed.push_back(entry.first);
+            }
+        }
+        return changed;
+    }
+
+private:
+    struct WatchedFile {
+        std::string directory;
+        std::string name;
+        int watchDescriptor = -1;   // -1 when polled
+        time_t modifiedTime = 0;
+        long long size = -1;
+        bool pending = false;
+        double changedAt = 0.0;
+    };
+
+    struct State {
+        std::map<std::string, WatchedFile> files;
+        int fd = -1;
+        bool inotifyFailed = false;
+        double lastPoll = 0.0;
+    };
+
+    static State& state() {
+        static State s;
+        return s;
+    }
+
+    static double seconds() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static bool readStat(const std::string& path, time_t& modifiedTime, long long& size) {
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0) return false;
+        modifiedTime = info.st_mtime;
+        size = (long long)info.st_size;
+        return true;
+    }
+
+    // Drain queued inotify events and mark the watched files they name
+    static void readEvents(double now) {
+#ifdef __linux__
+        State& s = state();
+        if (s.fd < 0) return;
+        alignas(struct inotify_event) char buffer[4096];
+        for (;;) {
+            ssize_t length = read(s.fd, buffer, sizeof(buffer));
+            if (length <= 0) break;
+            for (char* p = buffer; p < buffer + length;) {
+                const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(p);
+                p += sizeof(struct inotify_event) + event->len;
+                if (event->len == 0) continue;
+                for (auto& entry : s.files) {
+                    WatchedFile& file = entry.second;
+                    if (file.watchDescriptor == event->wd && file.name == event->name) {
+                        file.pending = true;
+                        file.changedAt = now;
+                    }
+                }
+            }
+        }
+#else
+        (void)now;
+#endif
+    }
+};
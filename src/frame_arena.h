@@ -0,0 +1,208 @@
+#pragma once
+
+// Per-frame linear allocator for transient data.
+//
+// FrameArena hands out memory by bumping an offset and forgets everything at
+// beginFrame(). When a frame needs more than the current block, overflow
+// blocks are used for the rest of that frame and the main block is grown to
+// the high-water mark at the next reset, so steady-state frames never touch
+// the heap. Past MAX_OVERFLOW_BLOCKS a frame falls back to chained heap
+// blocks, which count as heap allocations of the frame. Main thread only, and
+// so is the heap count: other threads (render, uploads, bakers) allocate as
+// they like without showing up in its frames.
+//
+// ArenaVector / ArenaString are standard containers backed by the arena; they
+// must not outlive the frame they were created in.
+//
+// Define FRAME_ARENA_IMPLEMENTATION in exactly one translation unit to install
+// a global operator new that counts allocations per thread, which makes the
+// main thread's heap allocations per frame visible. Define FRAME_ARENA_ASSERT_NO_HEAP as well to assert that
+// steady-state frames allocate nothing from the general heap.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cassert>
+#include <new>
+#include <string>
+#include <vector>
+
+class FrameArena {
+public:
+    static const size_t INITIAL_CAPACITY = 256 * 1024;
+    static const int MAX_OVERFLOW_BLOCKS = 32;
+    static const int WARMUP_FRAMES = 60;     // frames before the heap assert arms
+
+    static void* allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+        State& s = state();
+        if (!s.base) grow(INITIAL_CAPACITY);
+
+        size_t offset = (s.offset + alignment - 1) & ~(alignment - 1);
+        if (offset + size <= s.capacity) {
+            s.offset = offset + size;
+            if (s.offset > s.framePeak) s.framePeak = s.offset;
+            return s.base + offset;
+        }
+        return allocateOverflow(size, alignment);
+    }
+
+    // Give back the most recent allocation (lets a growing vector reuse its tail)
+    static void deallocate(void* ptr, size_t size) {
+        State& s = state();
+        char* p = static_cast<char*>(ptr);
+        if (p >= s.base && p + size == s.base + s.offset) s.offset = p - s.base;
+    }
+
+    // Drop everything allocated last frame and start counting heap allocations
+    static void beginFrame() {
+        State& s = state();
+        size_t needed = s.framePeak + s.overflowBytes;
+        s.highWater = needed > s.highWater ? needed : s.highWater;
+
+        for (int i = 0; i < s.overflowCount; ++i) free(s.overflow[i]);
+        while (s.heapBlocks) {
+            char* next = *reinterpret_cast<char**>(s.heapBlocks);
+            free(s.heapBlocks);
+            s.heapBlocks = next;
+        }
+        if (s.overflowCount > 0) grow(s.highWater + s.highWater / 2);
+        s.overflowCount = 0;
+        s.overflowBytes = 0;
+        s.offset = 0;
+        s.framePeak = 0;
+
+        s.frameStartHeap = heapAllocations();
+    }
+
+    static void endFrame() {
+        State& s = state();
+        s.lastFrameHeap = heapAllocations() - s.frameStartHeap;
+        s.frames++;
+        s.cleanFrames = s.lastFrameHeap == 0 ? s.cleanFrames + 1 : 0;
+#ifdef FRAME_ARENA_ASSERT_NO_HEAP
+        assert(s.frames <= WARMUP_FRAMES || s.lastFrameHeap == 0);
+#endif
+    }
+
+    static size_t used() { return state().offset; }
+    static size_t capacity() { return state().capacity; }
+    static size_t highWater() { return state().highWater; }
+
+    // General-heap allocations in the last completed frame; always 0 without FRAME_ARENA_IMPLEMENTATION
+    static uint64_t frameHeapAllocations() { return state().lastFrameHeap; }
+
+    // Consecutive frames without a general-heap allocation
+    static uint64_t cleanFrameStreak() { return state().cleanFrames; }
+
+    // General-heap allocations made so far by the calling thread
+    static uint64_t& heapAllocations() {
+        static thread_local uint64_t count = 0;
+        return count;
+    }
+
+private:
+    struct State {
+        char* base = nullptr;
+        size_t capacity = 0;
+        size_t offset = 0;
+        size_t framePeak = 0;
+        size_t highWater = 0;
+        char* overflow[MAX_OVERFLOW_BLOCKS];
+        int overflowCount = 0;
+        char* heapBlocks = nullptr;     // past MAX_OVERFLOW_BLOCKS, chained through their first pointer
+        size_t overflowBytes = 0;
+        uint64_t frameStartHeap = 0;
+        uint64_t lastFrameHeap = 0;
+        uint64_t frames = 0;
+        uint64_t cleanFrames = 0;
+    };
+
+    static State& state() {
+        static State s;
+        return s;
+    }
+
+    // Blocks come from malloc so they never show up in the heap counter
+    static void grow(size_t capacity) {
+        State& s = state();
+        if (capacity <= s.capacity) return;
+        free(s.base);
+        s.base = static_cast<char*>(malloc(capacity));
+        if (!s.base) throw std::bad_alloc();
+        s.capacity = capacity;
+    }
+
+    static void* allocateOverflow(size_t size, size_t alignment) {
+        State& s = state();
+        if (s.overflowCount == MAX_OVERFLOW_BLOCKS) return allocateHeapBlock(size, alignment);
+        char* block = static_cast<char*>(malloc(size + alignment));
+        if (!block) throw std::bad_alloc();
+        s.overflow[s.overflowCount++] = block;
+        s.overflowBytes += size;
+        uintptr_t aligned = (reinterpret_cast<uintptr_t>(block) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    // Out of overflow slots: a plain heap block, counted so the frame shows it, freed at the next reset
+    static void* allocateHeapBlock(size_t size, size_t alignment) {
+        State& s = state();
+        char* block = static_cast<char*>(malloc(sizeof(char*) + size + alignment));
+        if (!block) throw std::bad_alloc();
+        heapAllocations()++;
+        *reinterpret_cast<char**>(block) = s.heapBlocks;
+        s.heapBlocks = block;
+        s.overflowBytes += size;
+        uintptr_t start = reinterpret_cast<uintptr_t>(block) + sizeof(char*);
+        uintptr_t aligned = (start + alignment - 1) & ~(uintptr_t)(alignment - 1);
+        return reinterpret_cast<void*>(aligned);
+    }
+};
+
+// Standard allocator over FrameArena
+template <typename T>
+struct ArenaAllocator {
+    typedef T value_type;
+
+    ArenaAllocator() noexcept {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(FrameArena::allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept {
+        FrameArena::deallocate(ptr, n * sizeof(T));
+    }
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>&, const ArenaAllocator<U>&) { return true; }
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>&, const ArenaAllocator<U>&) { return false; }
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+typedef std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>> ArenaString;
+
+#ifdef FRAME_ARENA_IMPLEMENTATION
+
+// Counting replacements for the global allocation functions. The array and
+// nothrow forms forward to these.
+void* operator new(size_t size) {
+    FrameArena::heapAllocations()++;
+    void* ptr = malloc(size ? size : 1);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+#endif // FRAME_ARENA_IMPLEMENTATION
@@ -0,0 +1,364 @@
+#pragma once
+
+// Asynchronous viewport screenshots and video.
+//
+// PixelReadback reads a framebuffer into one of a small ring of pixel pack
+// buffers and fences it. glReadPixels into a bound PBO returns immediately;
+// the pixels are mapped a frame or two later, once the fence has signalled,
+// so the CPU never waits for the GPU to catch up.
+//
+// FrameEncoder takes the copied pixels to worker threads: PNG files through
+// stb_image_write, or 4:2:0 frames appended to a YUV4MPEG2 (.y4m) stream that
+// ffmpeg and most players read directly. Frames are converted in parallel and
+// written in submission order. When the queue is full, submitting waits instead
+// of dropping a frame, and the wait is counted.
+//
+// Include after the GL headers. Pixels are RGBA8 rows, bottom row first.
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+
+#include "gpu_memory.h"
+#include "cpu_trace.h"
+#include "stb_image_write.h"
+
+class PixelReadback {
+public:
+    static const int RING_SIZE = 3;
+
+    ~PixelReadback() { release(); }
+
+    bool full() const { return count == RING_SIZE; }
+    int pending() const { return count; }
+
+    // Start reading the color attachment of framebuffer; call collect() first when full()
+    bool queue(GLuint framebuffer, int width, int height, uint64_t tag) {
+        if (full() || width <= 0 || height <= 0) return false;
+        Slot& slot = slots[(first + count) % RING_SIZE];
+        size_t bytes = (size_t)width * height * 4;
+
+        if (slot.pbo == 0) slot.pbo = GPU_CREATE(GPU_BUFFER, "Frame Readback");
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        if (slot.capacity < bytes) {
+            glBufferData(GL_PIXEL_PACK_BUFFER, bytes, NULL, GL_STREAM_READ);
+            slot.capacity = bytes;
+        }
+
+        GLint previousFramebuffer = 0;
+        glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousFramebuffer);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+        glReadBuffer(GL_COLOR_ATTACHMENT0);
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, (GLuint)previousFramebuffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        slot.width = width;
+        slot.height = height;
+        slot.tag = tag;
+        count++;
+        return true;
+    }
+
+    // Copy out the oldest readback if its fence has signalled (or, with wait, once it does)
+    bool collect(std::vector<uint8_t>& pixels, int& width, int& height, uint64_t& tag, bool wait = false) {
+        if (count == 0) return false;
+        Slot& slot = slots[first];
+
+        GLenum status = glClientWaitSync(slot.fence, 0, 0);
+        if (status == GL_TIMEOUT_EXPIRED) {
+            if (!wait) return false;
+            TRACE_ZONE("Frame Readback Stall");
+            stalls++;
+            status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+        }
+        if (status == GL_TIMEOUT_EXPIRED || status == GL_WAIT_FAILED) {
+            fprintf(stderr, "Frame readback: fence wait failed, mapping synchronously\n");
+        }
+        glDeleteSync(slot.fence);
+        slot.fence = 0;
+
+        bool copied = false;
+        size_t bytes = (size_t)slot.width * slot.height * 4;
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        const void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bytes, GL_MAP_READ_BIT);
+        if (mapped) {
+            pixels.resize(bytes);
+            memcpy(pixels.data(), mapped, bytes);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            width = slot.width;
+            height = slot.height;
+            tag = slot.tag;
+            copied = true;
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        first = (first + 1) % RING_SIZE;
+        count--;
+        return copied;
+    }
+
+    // Readbacks that had to wait for the GPU because the ring was full
+    uint64_t stallCount() const { return stalls; }
+
+    void release() {
+        for (Slot& slot : slots) {
+            if (slot.fence) glDeleteSync(slot.fence);
+            GpuMemory::release(GPU_BUFFER, slot.pbo);
+            slot = Slot();
+        }
+        first = count = 0;
+    }
+
+private:
+    struct Slot {
+        GLuint pbo = 0;
+        size_t capacity = 0;
+        GLsync fence = 0;
+        int width = 0;
+        int height = 0;
+        uint64_t tag = 0;
+    };
+
+    Slot slots[RING_SIZE];
+    int first = 0;
+    int count = 0;
+    uint64_t stalls = 0;
+};
+
+class FrameEncoder {
+public:
+    static const size_t MAX_QUEUED = 8;     // frames waiting for a worker, about 265 MB at 4K
+
+    ~FrameEncoder() { stop(); }
+
+    void start(int threadCount) {
+        stop();
+        quit = false;
+        threadCount = std::max(threadCount, 1);
+        for (int i = 0; i < threadCount; ++i) {
+            workers.emplace_back([this]() { run(); });
+        }
+    }
+
+    // Finishes every queued frame, then joins the workers
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quit = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers) worker.join();
+        workers.clear();
+        closeVideo();
+    }
+
+    bool running() const { return !workers.empty(); }
+
+    // Frames with a size other than the stream's are cropped or padded with black.
+    // Odd sizes are rounded down, 4:2:0 needs even dimensions.
+    bool openVideo(const std::string& path, int width, int height, int framesPerSecond) {
+        drain();
+        closeVideo();
+        video = fopen(path.c_str(), "wb");
+        if (!video) return false;
+        videoWidth = std::max(width & ~1, 2);
+        videoHeight = std::max(height & ~1, 2);
+        fprintf(video, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", videoWidth, videoHeight, framesPerSecond);
+        return true;
+    }
+
+    void closeVideo() {
+        if (video) fclose(video);
+        video = nullptr;
+    }
+
+    bool videoOpen() const { return video != nullptr; }
+
+    // A buffer from the pool, so steady recording does not allocate per frame
+    std::vector<uint8_t> takeBuffer() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (freeBuffers.empty()) return std::vector<uint8_t>();
+        std::vector<uint8_t> buffer = std::move(freeBuffers.back());
+        freeBuffers.pop_back();
+        return buffer;
+    }
+
+    void submitImage(const std::string& path, std::vector<uint8_t>&& pixels, int width, int height) {
+        Job job;
+        job.path = path;
+        job.pixels = std::move(pixels);
+        job.width = width;
+        job.height = height;
+        push(std::move(job));
+    }
+
+    void submitVideoFrame(std::vector<uint8_t>&& pixels, int width, int height) {
+        Job job;
+        job.video = true;
+        job.pixels = std::move(pixels);
+        job.width = width;
+        job.height = height;
+        push(std::move(job));
+    }
+
+    // Block until every submitted frame is written
+    void drain() {
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this]() { return framesWritten + framesFailed == nextSequence; });
+    }
+
+    size_t queuedFrames() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return (size_t)(nextSequence - framesWritten - framesFailed);
+    }
+
+    uint64_t writtenCount() const { return framesWritten; }
+    uint64_t failedCount() const { return framesFailed; }
+    uint64_t stallCount() const { return stalls; }
+    uint64_t bytesWritten() const { return outputBytes; }
+
+private:
+    struct Job {
+        bool video = false;
+        std::string path;
+        std::vector<uint8_t> pixels;
+        int width = 0;
+        int height = 0;
+        uint64_t sequence = 0;
+        uint64_t videoSequence = 0;
+    };
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;       // workers: a job arrived or quit
+    std::condition_variable done;       // submitters and ordered writers: a job finished
+    std::deque<Job> jobs;
+    std::vector<std::vector<uint8_t>> freeBuffers;
+    bool quit = false;
+
+    FILE* video = nullptr;
+    int videoWidth = 0;
+    int videoHeight = 0;
+
+    uint64_t nextSequence = 0;          // guarded by mutex
+    uint64_t nextVideoSequence = 0;
+    uint64_t nextVideoWrite = 0;        // videoSequence of the next frame allowed to write
+    std::atomic<uint64_t> framesWritten{0};
+    std::atomic<uint64_t> framesFailed{0};
+    std::atomic<uint64_t> stalls{0};
+    std::atomic<uint64_t> outputBytes{0};
+
+    void push(Job&& job) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (jobs.size() >= MAX_QUEUED) {
+            TRACE_ZONE("Frame Encoder Stall");
+            stalls++;
+            done.wait(lock, [this]() { return jobs.size() < MAX_QUEUED; });
+        }
+        job.sequence = nextSequence++;
+        if (job.video) job.videoSequence = nextVideoSequence++;
+        jobs.push_back(std::move(job));
+        lock.unlock();
+        wake.notify_one();
+    }
+
+    void run() {
+        CpuTrace::setThreadName("Frame Encoder");
+        std::vector<uint8_t> scratch;
+        for (;;) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this]() { return quit || !jobs.empty(); });
+                if (jobs.empty()) return;
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+            done.notify_all();
+
+            bool ok = job.video ? encodeVideoFrame(job, scratch) : encodeImage(job, scratch);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (job.video) nextVideoWrite++;
+            if (ok) framesWritten++; else framesFailed++;
+            if (freeBuffers.size() < MAX_QUEUED) freeBuffers.push_back(std::move(job.pixels));
+            done.notify_all();
+        }
+    }
+
+    // RGBA bottom-up to RGB top-down
+    static bool encodeImage(const Job& job, std::vector<uint8_t>& rgb) {
+        TRACE_ZONE("Encode PNG");
+        rgb.resize((size_t)job.width * job.height * 3);
+        for (int y = 0; y < job.height; ++y) {
+            const uint8_t* src = job.pixels.data() + (size_t)(job.height - 1 - y) * job.width * 4;
+            uint8_t* dst = rgb.data() + (size_t)y * job.width * 3;
+            for (int x = 0; x < job.width; ++x) {
+                dst[x * 3 + 0] = src[x * 4 + 0];
+                dst[x * 3 + 1] = src[x * 4 + 1];
+                dst[x * 3 + 2] = src[x * 4 + 2];
+            }
+        }
+        if (!stbi_write_png(job.path.c_str(), job.width, job.height, 3, rgb.data(), job.width * 3)) {
+            fprintf(stderr, "Frame encoder: cannot write %s\n", job.path.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    // Full-range BT.601 4:2:0, chroma averaged over each 2x2 block
+    bool encodeVideoFrame(const Job& job, std::vector<uint8_t>& yuv) {
+        {
+            TRACE_ZONE("Encode Y4M");
+            const int w = videoWidth, h = videoHeight;
+            const int cw = w / 2, ch = h / 2;
+            yuv.assign((size_t)w * h + 2 * (size_t)cw * ch, 0);
+            uint8_t* planeY = yuv.data();
+            uint8_t* planeU = planeY + (size_t)w * h;
+            uint8_t* planeV = planeU + (size_t)cw * ch;
+            memset(planeU, 128, (size_t)cw * ch * 2);
+
+            const int copyWidth = std::min(w, job.width) & ~1;
+            const int copyHeight = std::min(h, job.height) & ~1;
+            for (int y = 0; y < copyHeight; y += 2) {
+                const uint8_t* row0 = job.pixels.data() + (size_t)(job.height - 1 - y) * job.width * 4;
+                const uint8_t* row1 = row0 - (size_t)job.width * 4;
+                for (int x = 0; x < copyWidth; x += 2) {
+                    int sumR = 0, sumG = 0, sumB = 0;
+                    for (int k = 0; k < 4; ++k) {
+                        const uint8_t* p = (k < 2 ? row0 : row1) + (x + (k & 1)) * 4;
+                        int r = p[0], g = p[1], b = p[2];
+                        planeY[(size_t)(y + (k >> 1)) * w + x + (k & 1)] = (uint8_t)((77 * r + 150 * g + 29 * b + 128) >> 8);
+                        sumR += r;
+                        sumG += g;
+                        sumB += b;
+                    }
+                    int u = 128 + ((-43 * sumR - 85 * sumG + 128 * sumB + 512) >> 10);
+                    int v = 128 + ((128 * sumR - 107 * sumG - 21 * sumB + 512) >> 10);
+                    planeU[(size_t)(y / 2) * cw + x / 2] = (uint8_t)std::min(std::max(u, 0), 255);
+                    planeV[(size_t)(y / 2) * cw + x / 2] = (uint8_t)std::min(std::max(v, 0), 255);
+                }
+            }
+        }
+
+        // Conversion runs in parallel; writes go out in submission order
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this, &job]() { return nextVideoWrite == job.videoSequence; });
+        lock.unlock();
+        TRACE_ZONE("Write Y4M");
+        bool ok = video && fwrite("FRAME\n", 1, 6, video) == 6 && fwrite(yuv.data(), 1, yuv.size(), video) == yuv.size();
+        outputBytes += yuv.size() + 6;
+        return ok;
+    }
+};
@@ -0,0 +1,1275 @@
+#pragma once
+
+// GL command capture.
+//
+// Include after the GL headers. Every GL call the editor and the game make to
+// create, bind, describe or draw with objects is routed through a wrapper.
+// State and info-log queries (glGet*, glCheckFramebufferStatus) go straight
+// to the driver, and timer queries use the uncaptured* entry points below.
+// While idle, a wrapper tests one flag, and those that create, bind or
+// describe objects also store into the registry: an index into a table kept
+// by GL name, plus a thread check in debug builds. Apart from a table growing
+// to reach a new name, only shader sources and texture parameters allocate.
+// When a capture is requested, the next frame starts with a snapshot of all
+// live buffers, textures, renderbuffers, framebuffers, programs (with their
+// uniform values) and vertex arrays, followed by every call of the captured
+// frames. The file is replayed headless by gl_replay.
+//
+// Calls made from other translation units (the ImGui backend) are not seen.
+// Define GL_CAPTURE_NO_HOOKS to use the file format without the wrappers.
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <thread>
+#include <cassert>
+
+// Record opcodes, stored as uint16 in the file. Never renumber.
+enum GLCaptureOp {
+    CAPTURE_FRAME_BEGIN = 1,
+    CAPTURE_FRAME_END,
+    CAPTURE_ACTIVE_TEXTURE,
+    CAPTURE_ATTACH_SHADER,
+    CAPTURE_BIND_BUFFER,
+    CAPTURE_BIND_FRAMEBUFFER,
+    CAPTURE_BIND_RENDERBUFFER,
+    CAPTURE_BIND_TEXTURE,
+    CAPTURE_BIND_VERTEX_ARRAY,
+    CAPTURE_BLEND_FUNC,
+    CAPTURE_BUFFER_DATA,
+    CAPTURE_BUFFER_SUB_DATA,
+    CAPTURE_CLEAR,
+    CAPTURE_CLEAR_COLOR,
+    CAPTURE_COMPILE_SHADER,
+    CAPTURE_CREATE_PROGRAM,
+    CAPTURE_CREATE_SHADER,
+    CAPTURE_CULL_FACE,
+    CAPTURE_DELETE_BUFFERS,
+    CAPTURE_DELETE_FRAMEBUFFERS,
+    CAPTURE_DELETE_PROGRAM,
+    CAPTURE_DELETE_RENDERBUFFERS,
+    CAPTURE_DELETE_SHADER,
+    CAPTURE_DELETE_TEXTURES,
+    CAPTURE_DELETE_VERTEX_ARRAYS,
+    CAPTURE_DISABLE,
+    CAPTURE_DISABLE_VERTEX_ATTRIB_ARRAY,
+    CAPTURE_DRAW_ARRAYS,
+    CAPTURE_DRAW_ARRAYS_INSTANCED,
+    CAPTURE_DRAW_ELEMENTS,
+    CAPTURE_DRAW_ELEMENTS_INSTANCED,
+    CAPTURE_ENABLE,
+    CAPTURE_ENABLE_VERTEX_ATTRIB_ARRAY,
+    CAPTURE_FRAMEBUFFER_RENDERBUFFER,
+    CAPTURE_FRAMEBUFFER_TEXTURE_2D,
+    CAPTURE_GEN_BUFFERS,
+    CAPTURE_GEN_FRAMEBUFFERS,
+    CAPTURE_GEN_RENDERBUFFERS,
+    CAPTURE_GEN_TEXTURES,
+    CAPTURE_GEN_VERTEX_ARRAYS,
+    CAPTURE_GET_BUFFER_SUB_DATA,
+    CAPTURE_GET_UNIFORM_LOCATION,
+    CAPTURE_LINE_WIDTH,
+    CAPTURE_LINK_PROGRAM,
+    CAPTURE_PATCH_PARAMETER,
+    CAPTURE_POLYGON_MODE,
+    CAPTURE_RENDERBUFFER_STORAGE,
+    CAPTURE_SHADER_SOURCE,
+    CAPTURE_TEX_IMAGE_2D,
+    CAPTURE_TEX_PARAMETER,
+    CAPTURE_UNIFORM_1F,
+    CAPTURE_UNIFORM_1I,
+    CAPTURE_UNIFORM_2F,
+    CAPTURE_UNIFORM_3F,
+    CAPTURE_UNIFORM_4F,
+    CAPTURE_UNIFORM_MATRIX_4FV,
+    CAPTURE_UNIFORM_VALUE,          // snapshot of an active uniform (GL type + raw data)
+    CAPTURE_USE_PROGRAM,
+    CAPTURE_VERTEX_ATTRIB_DIVISOR,
+    CAPTURE_VERTEX_ATTRIB_POINTER,
+    CAPTURE_VIEWPORT,
+    CAPTURE_VERTEX_ATTRIB_1F,
+    CAPTURE_VERTEX_ATTRIB_4F,       // snapshot of a generic attribute's current value
+    CAPTURE_VERTEX_ATTRIB_3F,
+    CAPTURE_DRAW_ELEMENTS_BASE_VERTEX,
+    CAPTURE_TEX_SUB_IMAGE_2D,
+    CAPTURE_UNIFORM_4FV,
+    CAPTURE_OP_COUNT
+};
+
+// File layout: header, then records of { uint16 op, uint32 size, payload }.
+// Payload fields are written in call argument order; blobs are uint32 length
+// followed by the bytes.
+struct GLCaptureHeader {
+    char magic[4];              // "GLCP"
+    uint32_t version;
+    uint32_t framebufferWidth;
+    uint32_t framebufferHeight;
+    uint32_t glMajor;
+    uint32_t glMinor;
+    uint32_t frameCount;
+};
+
+static const uint32_t GL_CAPTURE_VERSION = 1;
+
+class GLCapture {
+public:
+    // Capture the next frameCount frames to capture_<date>_<time>.glcap
+    static void requestCapture(int frameCount) {
+        State& s = state();
+        if (s.capturing || frameCount <= 0) return;
+        s.requestedFrames = frameCount;
+    }
+
+    static bool isCapturing() { return state().capturing; }
+
+    // Call before the first GL call of a frame
+    static void beginFrame(int framebufferWidth, int framebufferHeight) {
+        State& s = state();
+        if (!s.capturing && s.requestedFrames > 0) {
+            s.capturing = true;
+            s.framesLeft = s.requestedFrames;
+            s.framesCaptured = 0;
+            s.requestedFrames = 0;
+            s.data.clear();
+            s.width = framebufferWidth;
+            s.height = framebufferHeight;
+            writeSnapshot();
+        }
+        if (s.capturing) record(CAPTURE_FRAME_BEGIN, (uint32_t)s.framesCaptured);
+    }
+
+    // Call after the last GL call of a frame. Returns true when a capture file was just written.
+    static bool endFrame() {
+        State& s = state();
+        if (!s.capturing) return false;
+
+        record(CAPTURE_FRAME_END, (uint32_t)s.framesCaptured);
+        s.framesCaptured++;
+        if (--s.framesLeft > 0) return false;
+
+        s.capturing = false;
+        return writeFile();
+    }
+
+    static const char* lastCapturePath() { return state().path; }
+
+    // Bytes per row for pixel data, honouring the row alignment
+    static size_t imageSize(GLsizei width, GLsizei height, GLenum format, GLenum type, GLint alignment) {
+        size_t components = 4;
+        switch (format) {
+            case GL_RED: case GL_DEPTH_COMPONENT: case GL_STENCIL_INDEX: components = 1; break;
+            case GL_RG: components = 2; break;
+            case GL_RGB: case GL_BGR: components = 3; break;
+            case GL_DEPTH_STENCIL: components = 1; break;
+            default: components = 4; break;
+        }
+        size_t componentSize = 1;
+        switch (type) {
+            case GL_UNSIGNED_SHORT: case GL_SHORT: case GL_HALF_FLOAT: componentSize = 2; break;
+            case GL_UNSIGNED_INT: case GL_INT: case GL_FLOAT: case GL_UNSIGNED_INT_24_8: componentSize = 4; break;
+            default: componentSize = 1; break;
+        }
+        size_t row = (size_t)width * components * componentSize;
+        if (alignment > 1) row = (row + alignment - 1) / alignment * alignment;
+        return row * (size_t)height;
+    }
+
+    // Recording helpers used by the wrappers
+    static bool active() { return state().capturing; }
+
+    template <typename... Args>
+    static void record(GLCaptureOp op, const Args&... args) {
+        size_t start = beginRecord(op);
+        int unused[] = { 0, (put(args), 0)... };
+        (void)unused;
+        endRecord(start);
+    }
+
+    template <typename... Args>
+    static void recordBlob(GLCaptureOp op, const void* blob, size_t blobSize, const Args&... args) {
+        size_t start = beginRecord(op);
+        int unused[] = { 0, (put(args), 0)... };
+        (void)unused;
+        putBlob(blob, blobSize);
+        endRecord(start);
+    }
+
+    // Resource registry, kept up to date whether or not a capture is running.
+    // Objects live in tables indexed by their GL name, which drivers hand out
+    // densely from 1, so gen and bind are an index and a store rather than a
+    // tree walk. A table only allocates when a name beyond its end shows up.
+    struct TextureInfo {
+        bool live = false;
+        GLenum target = GL_TEXTURE_2D;
+        GLint internalFormat = 0;
+        GLsizei width = 0, height = 0;
+        GLenum format = GL_RGBA, type = GL_UNSIGNED_BYTE;
+        std::vector<std::pair<GLenum, GLint>> parameters;
+    };
+
+    struct RenderbufferInfo {
+        bool live = false;
+        GLenum internalFormat = 0;
+        GLsizei width = 0, height = 0;
+    };
+
+    struct FramebufferAttachment {
+        GLenum attachment;
+        GLenum textureTarget;   // 0 for renderbuffers
+        GLuint name;
+        GLint level;
+    };
+
+    struct FramebufferInfo {
+        bool live = false;
+        std::vector<FramebufferAttachment> attachments;
+    };
+
+    struct VertexAttribute {
+        bool used = false;      // touched since the vertex array was created
+        GLuint buffer = 0;
+        GLint size = 4;
+        GLenum type = GL_FLOAT;
+        GLboolean normalized = GL_FALSE;
+        GLsizei stride = 0;
+        uint64_t offset = 0;
+        bool enabled = false;
+        GLuint divisor = 0;
+    };
+
+    // Value a disabled attribute array reads; context state, not part of a vertex array
+    struct GenericAttribute {
+        bool set = false;
+        GLfloat value[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+    };
+
+    struct VertexArrayInfo {
+        bool live = false;
+        std::vector<VertexAttribute> attributes;    // by attribute index
+        GLuint elementBuffer = 0;
+    };
+
+    struct ShaderInfo {
+        bool live = false;
+        GLenum type = 0;
+        std::string source;
+    };
+
+    struct ProgramInfo {
+        bool live = false;
+        std::vector<GLuint> attached;
+        std::vector<ShaderInfo> stages;     // sources at last link
+    };
+
+    struct Registry {
+        std::vector<uint8_t> buffers;       // 1 while the name is live
+        std::vector<TextureInfo> textures;
+        std::vector<RenderbufferInfo> renderbuffers;
+        std::vector<FramebufferInfo> framebuffers;
+        std::vector<VertexArrayInfo> vertexArrays;
+        std::vector<ShaderInfo> shaders;
+        std::vector<ProgramInfo> programs;
+        std::vector<GenericAttribute> genericAttributes;    // by attribute index
+
+        GLuint vertexArray = 0;
+        GLuint arrayBuffer = 0;
+        GLuint framebuffer = 0;
+        GLuint renderbuffer = 0;
+        GLuint texture2D = 0;
+        GLuint textureCubeMap = 0;
+    };
+
+    // The registry and the command stream belong to the one thread the tracked
+    // context is current on; they are not locked. Call this on the new thread
+    // after moving the context. Until the first call, the first thread through a
+    // hook owns them. Other threads with a shared context must not call the hooks;
+    // see the uncaptured* entry points below.
+    static void setContextThread() { state().owner = std::this_thread::get_id(); }
+
+    static Registry& registry() {
+        State& s = state();
+        checkThread(s);
+        return s.registry;
+    }
+
+    // Entry for name in a registry table, growing the table to reach it
+    template <typename T>
+    static T& slot(std::vector<T>& table, GLuint name) {
+        if (name >= table.size()) table.resize(std::max<size_t>((size_t)name + 1, table.size() * 2));
+        return table[name];
+    }
+
+    template <typename T>
+    static void release(std::vector<T>& table, GLuint name) {
+        if (name < table.size()) table[name] = T();
+    }
+
+    // Current binding for a texture target, or NULL for targets that are not tracked
+    static GLuint* boundTexture(Registry& reg, GLenum target) {
+        if (target == GL_TEXTURE_2D) return &reg.texture2D;
+        if (target == GL_TEXTURE_CUBE_MAP) return &reg.textureCubeMap;
+        return NULL;
+    }
+
+    // Attribute index of the bound vertex array, or NULL with none bound
+    static VertexAttribute* boundAttribute(Registry& reg, GLuint index) {
+        if (!reg.vertexArray) return NULL;
+        VertexAttribute& attr = slot(slot(reg.vertexArrays, reg.vertexArray).attributes, index);
+        attr.used = true;
+        return &attr;
+    }
+
+    // Gen and contents of one buffer, read back through the copy read target. Both
+    // copy bindings are left as they were, live and in the recording.
+    static void snapshotBuffer(GLuint name) {
+        recordBlob(CAPTURE_GEN_BUFFERS, &name, sizeof(GLuint));
+
+        GLint readBinding = 0, writeBinding = 0;
+        glGetIntegerv(GL_COPY_READ_BUFFER_BINDING, &readBinding);
+        glGetIntegerv(GL_COPY_WRITE_BUFFER_BINDING, &writeBinding);
+        GLint size = 0, usage = GL_STATIC_DRAW;
+        glBindBuffer(GL_COPY_READ_BUFFER, name);
+        glGetBufferParameteriv(GL_COPY_READ_BUFFER, GL_BUFFER_SIZE, &size);
+        glGetBufferParameteriv(GL_COPY_READ_BUFFER, GL_BUFFER_USAGE, &usage);
+        if (size > 0) {
+            std::vector<unsigned char> contents(size);
+            glGetBufferSubData(GL_COPY_READ_BUFFER, 0, size, contents.data());
+            record(CAPTURE_BIND_BUFFER, (GLenum)GL_COPY_WRITE_BUFFER, name);
+            recordBlob(CAPTURE_BUFFER_DATA, contents.data(), contents.size(),
+                       (GLenum)GL_COPY_WRITE_BUFFER, (int64_t)size, (GLenum)usage);
+            record(CAPTURE_BIND_BUFFER, (GLenum)GL_COPY_WRITE_BUFFER, (GLuint)writeBinding);
+        }
+        glBindBuffer(GL_COPY_READ_BUFFER, (GLuint)readBinding);
+    }
+
+private:
+    struct State {
+        bool capturing = false;
+        int requestedFrames = 0;
+        int framesLeft = 0;
+        int framesCaptured = 0;
+        int width = 0, height = 0;
+        std::vector<unsigned char> data;
+        char path[256] = "";
+        Registry registry;
+        std::thread::id owner;
+    };
+
+    static State& state() {
+        static State s;
+        return s;
+    }
+
+    static void checkThread(State& s) {
+#ifndef NDEBUG
+        std::thread::id self = std::this_thread::get_id();
+        if (s.owner == std::thread::id()) s.owner = self;
+        assert(s.owner == self && "GL capture hooks called from a thread that does not own the context");
+#else
+        (void)s;
+#endif
+    }
+
+    static size_t beginRecord(GLCaptureOp op) {
+        State& s = state();
+        checkThread(s);
+        std::vector<unsigned char>& data = s.data;
+        size_t start = data.size();
+        uint16_t code = (uint16_t)op;
+        uint32_t size = 0;
+        data.insert(data.end(), (const unsigned char*)&code, (const unsigned char*)&code + sizeof(code));
+        data.insert(data.end(), (const unsigned char*)&size, (const unsigned char*)&size + sizeof(size));
+        return start;
+    }
+
+    static void endRecord(size_t start) {
+        std::vector<unsigned char>& data = state().data;
+        uint32_t size = (uint32_t)(data.size() - start - sizeof(uint16_t) - sizeof(uint32_t));
+        memcpy(&data[start + sizeof(uint16_t)], &size, sizeof(size));
+    }
+
+    template <typename T>
+    static void put(const T& value) {
+        std::vector<unsigned char>& data = state().data;
+        data.insert(data.end(), (const unsigned char*)&value, (const unsigned char*)&value + sizeof(T));
+    }
+
+    static void put(const std::string& value) {
+        putBlob(value.data(), value.size());
+    }
+
+    static void putBlob(const void* blob, size_t size) {
+        std::vector<unsigned char>& data = state().data;
+        uint32_t length = blob ? (uint32_t)size : 0;
+        put(length);
+        if (length) data.insert(data.end(), (const unsigned char*)blob, (const unsigned char*)blob + length);
+    }
+
+    // Recreate every live resource and the current state at the start of the capture.
+    // Uses the real entry points: the hook macros are defined after this class.
+    static void writeSnapshot() {
+        Registry& reg = registry();
+
+        for (GLuint name = 1; name < reg.buffers.size(); ++name) {
+            if (reg.buffers[name]) snapshotBuffer(name);
+        }
+
+        GLint packAlignment = 4;
+        glGetIntegerv(GL_PACK_ALIGNMENT, &packAlignment);
+        for (GLuint name = 1; name < reg.textures.size(); ++name) {
+            const TextureInfo& tex = reg.textures[name];
+            if (!tex.live) continue;
+            recordBlob(CAPTURE_GEN_TEXTURES, &name, sizeof(GLuint));
+            record(CAPTURE_BIND_TEXTURE, tex.target, name);
+            if (tex.width > 0 && tex.height > 0 && tex.target == GL_TEXTURE_2D) {
+                std::vector<unsigned char> pixels(imageSize(tex.width, tex.height, tex.format, tex.type, packAlignment));
+                glBindTexture(GL_TEXTURE_2D, name);
+                glGetTexImage(GL_TEXTURE_2D, 0, tex.format, tex.type, pixels.data());
+                recordBlob(CAPTURE_TEX_IMAGE_2D, pixels.data(), pixels.size(),
+                           tex.target, (GLint)0, tex.internalFormat, tex.width, tex.height, (GLint)0,
+                           tex.format, tex.type, packAlignment);
+            }
+            for (auto& param : tex.parameters) {
+                record(CAPTURE_TEX_PARAMETER, tex.target, param.first, param.second);
+            }
+        }
+        glBindTexture(GL_TEXTURE_2D, reg.texture2D);
+        record(CAPTURE_BIND_TEXTURE, (GLenum)GL_TEXTURE_2D, reg.texture2D);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, reg.textureCubeMap);
+        record(CAPTURE_BIND_TEXTURE, (GLenum)GL_TEXTURE_CUBE_MAP, reg.textureCubeMap);
+
+        for (GLuint name = 1; name < reg.renderbuffers.size(); ++name) {
+            const RenderbufferInfo& rb = reg.renderbuffers[name];
+            if (!rb.live) continue;
+            recordBlob(CAPTURE_GEN_RENDERBUFFERS, &name, sizeof(GLuint));
+            record(CAPTURE_BIND_RENDERBUFFER, (GLenum)GL_RENDERBUFFER, name);
+            if (rb.width > 0 && rb.height > 0) {
+                record(CAPTURE_RENDERBUFFER_STORAGE, (GLenum)GL_RENDERBUFFER, rb.internalFormat, rb.width, rb.height);
+            }
+        }
+        record(CAPTURE_BIND_RENDERBUFFER, (GLenum)GL_RENDERBUFFER, reg.renderbuffer);
+
+        for (GLuint name = 1; name < reg.framebuffers.size(); ++name) {
+            const FramebufferInfo& fb = reg.framebuffers[name];
+            if (!fb.live) continue;
+            recordBlob(CAPTURE_GEN_FRAMEBUFFERS, &name, sizeof(GLuint));
+            record(CAPTURE_BIND_FRAMEBUFFER, (GLenum)GL_FRAMEBUFFER, name);
+            for (const auto& att : fb.attachments) {
+                if (att.textureTarget) {
+                    record(CAPTURE_FRAMEBUFFER_TEXTURE_2D, (GLenum)GL_FRAMEBUFFER, att.attachment,
+                           att.textureTarget, att.name, att.level);
+                } else {
+                    record(CAPTURE_FRAMEBUFFER_RENDERBUFFER, (GLenum)GL_FRAMEBUFFER, att.attachment,
+                           (GLenum)GL_RENDERBUFFER, att.name);
+                }
+            }
+        }
+        record(CAPTURE_BIND_FRAMEBUFFER, (GLenum)GL_FRAMEBUFFER, reg.framebuffer);
+
+        // Programs are rebuilt from the sources they were linked with, using
+        // synthetic shader names that only live inside the snapshot
+        GLuint syntheticShader = 0x80000000u;
+        GLint currentProgram = 0;
+        glGetIntegerv(GL_CURRENT_PROGRAM, &currentProgram);
+        for (GLuint program = 1; program < reg.programs.size(); ++program) {
+            if (!reg.programs[program].live) continue;
+            record(CAPTURE_CREATE_PROGRAM, program);
+            std::vector<GLuint> stages;
+            for (const auto& stage : reg.programs[program].stages) {
+                GLuint shader = syntheticShader++;
+                record(CAPTURE_CREATE_SHADER, stage.type, shader);
+                record(CAPTURE_SHADER_SOURCE, shader, stage.source);
+                record(CAPTURE_COMPILE_SHADER, shader);
+                record(CAPTURE_ATTACH_SHADER, program, shader);
+                stages.push_back(shader);
+            }
+            if (stages.empty()) continue;
+            record(CAPTURE_LINK_PROGRAM, program);
+            for (GLuint shader : stages) record(CAPTURE_DELETE_SHADER, shader);
+
+            GLint linked = 0;
+            glGetProgramiv(program, GL_LINK_STATUS, &linked);
+            if (linked) snapshotUniforms(program);
+        }
+        glUseProgram(currentProgram);
+        record(CAPTURE_USE_PROGRAM, (GLuint)currentProgram);
+
+        for (GLuint name = 1; name < reg.vertexArrays.size(); ++name) {
+            const VertexArrayInfo& vao = reg.vertexArrays[name];
+            if (!vao.live) continue;
+            recordBlob(CAPTURE_GEN_VERTEX_ARRAYS, &name, sizeof(GLuint));
+            record(CAPTURE_BIND_VERTEX_ARRAY, name);
+            for (GLuint index = 0; index < vao.attributes.size(); ++index) {
+                const VertexAttribute& a = vao.attributes[index];
+                if (!a.used) continue;
+                record(CAPTURE_BIND_BUFFER, (GLenum)GL_ARRAY_BUFFER, a.buffer);
+                record(CAPTURE_VERTEX_ATTRIB_POINTER, index, a.size, a.type, a.normalized, a.stride, a.offset);
+                if (a.enabled) record(CAPTURE_ENABLE_VERTEX_ATTRIB_ARRAY, index);
+                if (a.divisor) record(CAPTURE_VERTEX_ATTRIB_DIVISOR, index, a.divisor);
+            }
+            record(CAPTURE_BIND_BUFFER, (GLenum)GL_ELEMENT_ARRAY_BUFFER, vao.elementBuffer);
+        }
+        record(CAPTURE_BIND_VERTEX_ARRAY, reg.vertexArray);
+        for (GLuint index = 0; index < reg.genericAttributes.size(); ++index) {
+            const GLfloat* v = reg.genericAttributes[index].value;
+            if (reg.genericAttributes[index].set) record(CAPTURE_VERTEX_ATTRIB_4F, index, v[0], v[1], v[2], v[3]);
+        }
+        record(CAPTURE_BIND_BUFFER, (GLenum)GL_ARRAY_BUFFER, reg.arrayBuffer);
+
+        // Fixed-function state the frame may rely on
+        const GLenum caps[] = { GL_DEPTH_TEST, GL_CULL_FACE, GL_BLEND, GL_MULTISAMPLE, GL_SCISSOR_TEST };
+        for (GLenum cap : caps) {
+            record(glIsEnabled(cap) ? CAPTURE_ENABLE : CAPTURE_DISABLE, cap);
+        }
+        GLint value[4] = { 0, 0, 0, 0 };
+        glGetIntegerv(GL_CULL_FACE_MODE, value);
+        record(CAPTURE_CULL_FACE, (GLenum)value[0]);
+        glGetIntegerv(GL_BLEND_SRC_RGB, &value[0]);
+        glGetIntegerv(GL_BLEND_DST_RGB, &value[1]);
+        record(CAPTURE_BLEND_FUNC, (GLenum)value[0], (GLenum)value[1]);
+        glGetIntegerv(GL_VIEWPORT, value);
+        record(CAPTURE_VIEWPORT, value[0], value[1], (GLsizei)value[2], (GLsizei)value[3]);
+        GLfloat color[4];
+        glGetFloatv(GL_COLOR_CLEAR_VALUE, color);
+        record(CAPTURE_CLEAR_COLOR, color[0], color[1], color[2], color[3]);
+        glGetIntegerv(GL_ACTIVE_TEXTURE, value);
+        record(CAPTURE_ACTIVE_TEXTURE, (GLenum)value[0]);
+    }
+
+    static void snapshotUniforms(GLuint program) {
+        record(CAPTURE_USE_PROGRAM, program);
+        glUseProgram(program);
+
+        GLint count = 0;
+        glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+        for (GLint i = 0; i < count; ++i) {
+            char name[256];
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(program, i, sizeof(name), &length, &size, &type, name);
+
+            // Arrays are visited element by element through "name[i]"
+            std::string base(name, length);
+            size_t bracket = base.find('[');
+            if (bracket != std::string::npos) base.resize(bracket);
+
+            for (GLint element = 0; element < size; ++element) {
+                std::string uniformName = size > 1 ? base + "[" + std::to_string(element) + "]" : std::string(name, length);
+                GLint location = glGetUniformLocation(program, uniformName.c_str());
+                if (location < 0) continue;
+                record(CAPTURE_GET_UNIFORM_LOCATION, program, uniformName, location);
+
+                // Large enough for a mat4, read as raw 32-bit words
+                union { GLfloat f[16]; GLint i[16]; GLuint u[16]; } values;
+                memset(&values, 0, sizeof(values));
+                bool integer = type == GL_INT || type == GL_BOOL || type == GL_UNSIGNED_INT ||
+                               type == GL_INT_VEC2 || type == GL_INT_VEC3 || type == GL_INT_VEC4 ||
+                               type == GL_BOOL_VEC2 || type == GL_BOOL_VEC3 || type == GL_BOOL_VEC4 ||
+                               type == GL_SAMPLER_2D || type == GL_SAMPLER_CUBE || type == GL_SAMPLER_3D;
+                if (integer) glGetUniformiv(program, location, values.i);
+                else glGetUniformfv(program, location, values.f);
+                recordBlob(CAPTURE_UNIFORM_VALUE, &values, sizeof(values), location, type);
+            }
+        }
+    }
+
+    static bool writeFile() {
+        State& s = state();
+        time_t now = time(NULL);
+        struct tm* local = localtime(&now);
+        strftime(s.path, sizeof(s.path), "capture_%Y%m%d_%H%M%S.glcap", local);
+
+        FILE* file = fopen(s.path, "wb");
+        if (!file) {
+            fprintf(stderr, "Failed to write GL capture: %s\n", s.path);
+            s.path[0] = '\0';
+            return false;
+        }
+
+        GLint major = 3, minor = 3;
+        glGetIntegerv(GL_MAJOR_VERSION, &major);
+        glGetIntegerv(GL_MINOR_VERSION, &minor);
+
+        GLCaptureHeader header;
+        memcpy(header.magic, "GLCP", 4);
+        header.version = GL_CAPTURE_VERSION;
+        header.framebufferWidth = (uint32_t)s.width;
+        header.framebufferHeight = (uint32_t)s.height;
+        header.glMajor = (uint32_t)major;
+        header.glMinor = (uint32_t)minor;
+        header.frameCount = (uint32_t)s.framesCaptured;
+
+        fwrite(&header, sizeof(header), 1, file);
+        fwrite(s.data.data(), 1, s.data.size(), file);
+        fclose(file);
+
+        printf("GL capture written: %s (%d frames, %.1f KB)\n", s.path, s.framesCaptured, s.data.size() / 1024.0);
+        s.data.clear();
+        s.data.shrink_to_fit();
+        return true;
+    }
+};
+
+// Real entry points for a thread that has its own context sharing objects with
+// the tracked one (the upload thread). Its calls are not part of the tracked
+// command stream and the registry is not locked, so they skip the hooks. Buffers
+// made this way join the registry when the context thread first binds them.
+inline void uncapturedGenBuffers(GLsizei n, GLuint* buffers) {
+    glGenBuffers(n, buffers);
+}
+
+inline void uncapturedBindBuffer(GLenum target, GLuint buffer) {
+    glBindBuffer(target, buffer);
+}
+
+inline void uncapturedBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) {
+    glBufferData(target, size, data, usage);
+}
+
+inline void uncapturedBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) {
+    glBufferSubData(target, offset, size, data);
+}
+
+// Timer queries measure the frame they bracket and are left out of the stream:
+// gl_replay times each replayed frame with its own GL_TIME_ELAPSED query, and
+// queries of the same target cannot nest.
+inline void uncapturedGenQueries(GLsizei n, GLuint* ids) {
+    glGenQueries(n, ids);
+}
+
+inline void uncapturedBeginQuery(GLenum target, GLuint id) {
+    glBeginQuery(target, id);
+}
+
+inline void uncapturedEndQuery(GLenum target) {
+    glEndQuery(target);
+}
+
+inline void uncapturedGetQueryObjectui64v(GLuint id, GLenum pname, GLuint64* params) {
+    glGetQueryObjectui64v(id, pname, params);
+}
+
+inline void uncapturedDeleteQueries(GLsizei n, const GLuint* ids) {
+    glDeleteQueries(n, ids);
+}
+
+#ifndef GL_CAPTURE_NO_HOOKS
+
+// Wrappers. Each one updates the registry, records the call while a capture
+// is running and forwards to the real entry point.
+typedef GLCapture::Registry GLCaptureRegistry;
+
+inline void captureActiveTexture(GLenum texture) {
+    if (GLCapture::active()) GLCapture::record(CAPTURE_ACTIVE_TEXTURE, texture);
+    glActiveTexture(texture);
+}
+
+inline void captureAttachShader(GLuint program, GLuint shader) {
+    GLCaptureRegistry& reg = GLCapture::registry();
+    GLCapture::slot(reg.programs, program).attached.push_back(shader);
+    if (GLCapture::active()) GLCapture::record(CAPTURE_ATTACH_SHADER, program, shader);
+    glAttachShader(program, shader);
+}
+
+inline void captureBindBuffer(GLenum target, GLuint buffer) {
+    GLCaptureRegistry& reg = GLCapture::registry();
+    if (buffer) {
+        // A buffer filled on another context is new to a capture in progress
+        uint8_t& live = GLCapture::slot(reg.buffers, buffer);
+        if (!live && GLCapture::active()) GLCapture::snapshotBuffer(buffer);
+        live = 1;
+    }
+    if (target == GL_ARRAY_BUFFER) reg.arrayBuffer = buffer;
+    if (target == GL_ELEMENT_ARRAY_BUFFER && reg.vertexArray) GLCapture::slot(reg.vertexArrays, reg.vertexArray).elementBuffer = buffer;
+    if (GLCapture::active()) GLCapture::record(CAPTURE_BIND_BUFFER, target, buffer);
+    glBindBuffer(target, buffer);
+}
+
+inline void captureBindFramebuffer(GLenum target, GLuint framebuffer) {
+    GLCaptureRegistry& reg = GLCapture::registry();
+    if (framebuffer) GLCapture::slot(reg.framebuffers, framebuffer).live = true;
+    reg.framebuffer = framebuffer;
+    if (GLCapture::active()) GLCapture::record(CAPTURE_BIND_FRAMEBUFFER, target, framebuffer);
+    glBindFramebuffer(target, framebuffer);
+}
+
+inline void captureBindRenderbuffer(GLenum target, GLuint renderbuffer) {
+    GLCaptureRegistry& reg = GLCapture::registry();
+    if (renderbuffer) GLCapture::slot(reg.renderbuffers, renderbuffer).live = true;
+    reg.renderbuffer = renderbuffer;
+    if (GLCapture::active()) GLCapture::record(CAPTURE_BIND_RENDERBUFFER, target, renderbuffer);
+    glBindRenderbuffer(target, renderbuffer);
+}
+
+inline void captureBindTexture(GLenum target, GLuint texture) {
+    GLCaptureRegistry& reg = GLCapture::registry();
+    if (texture) {
+        GLCapture::TextureInfo& info = GLCapture::slot(reg.textures, texture);
+        info.live = true;
+        info.target = target;
+    }
+    if (GLuint* bound = GLCapture::boundTexture(reg, target)) *bound = texture;
+    if (GLCapture::active()) GLCapture::record(CAPTURE_BIND_TEXTURE, target, texture);
+    glBindTexture(target, texture);
+}
+
+inline void captureBindVertexArray(GLuint array) {
+    GLCaptureRegistry& reg = GLCapture::registry();
+    if (array) GLCapture::slot(reg.vertexArrays, array).live = true;
+    reg.vertexArray = array;
+    if (GLCapture::active()) GLCapture::record(CAPTURE_BIND_VERTEX_ARRAY, array);
+    glBindVertexArray(array);
+}
+
+inline void captureBlendFunc(GLenum sfactor, GLenum dfactor) {
+    if (GLCapture::active()) GLCapture::record(CAPTURE_BLEND_FUNC, sfactor, dfactor);
+    glBlendFunc(sfactor, dfactor);
+}
+
+inline void captureBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) {
+    if (GLCapture::active()) GLCapture::recordBlob(CAPTURE_BUFFER_DATA, data, data ? size : 0, target, (int64_t)size, usage);
+    glBufferData(target, size, data, usage);
+}
+
+inline void captureBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) {
+    if (GLCapture::active()) GLCapture::recordBlob(CAPTURE_BUFFER_SUB_DATA, data, size, target, (int64_t)offset);
+    glBufferSubData(target, offset, size, data);
+}
+
+inline void captureClear(GLbitfield mask) {
+    if (GLCapture::active()) GLCapture::record(CAPTURE_CLEAR, mask);
+    glClear(mask);
+}
+
+inline void captureClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
+    if (GLCapture::active()) GLCapture::record(CAPTURE_CLEAR_COLOR, red, green, blue, alpha);
+    glClearColor(red, green, blue, alpha);
+}
+
+inline void captureCompileShader(GLuint shader) {
+    if (GLCapture::active()) GLCapture::record(CAPTURE_COMPILE_SHADER, shader);
+    glCompileShader(shader);
+}
+
+inline GLuint captureCreateProgram() {
+    GLuint program = glCreateProgram();
+    GLCapture::slot(GLCapture::registry().programs, program).live = true;
+    if (GLCapture::active()) GLCapture::record(CAPTURE_CREATE_PROGRAM, program);
+    return program;
+}
+
+inline GLuint captureCreateShader(GLenum type) {
+    GLuint shader = glCreateShader(type);
+    GLCapture::ShaderInfo& info = GLCapture::slot(GLCapture::registry().shaders, shader);
+    info.live = true;
+    info.type = type;
+    if (GLCapture::active()) GLCapture::record(CAPTURE_CREATE_SHADER, type, shader);
+    return shader;
+}
+
+inline void captureCullFace(GLenum mode) {
+    if (GLCapture::active()) GLCapture::record(CAPTURE_CULL_FACE, mode);
+    glCullFace(mode);
+}
+
+inline void captureDeleteBuffers(GLsizei n, const GLuint* buffers) {
+    GLCaptureRegistry& reg = GLCapture::registry();
+    for (GLsizei i = 0; i < n; ++i) GLCapture::release(reg.buffers, buffers[i]);
+    if (GLCapture::active()) GLCapture::recordBlob(CAPTURE_DELETE_BUFFERS, buffers, n * sizeof(GLuint));
+    glDeleteBuffers(n, buffers);
+}
+
+inline void captureDeleteFramebuffers(GLsizei n, const GLuint* framebuffers) {
+    GLCaptureRegistry& reg = GLCapture::registry();
+    for (GLsizei i = 0; i < n; ++i) GLCapture::release(reg.framebuffers, framebuffers[i]);
+    if (GLCapture::active()) GLCapture::recordBlob(CAPTURE_DELETE_FRAMEBUFFERS, framebuffers, n * sizeof(GLuint));
+    glDeleteFramebuffers(n, framebuffers);
+}
+
+inline void captureDeleteProgram(GLuint program) {
+    GLCapture::release(GLCapture::registry().programs, program);
+    if (GLCapture::active()) GLCapture::record(CAPTURE_DELETE_PROGRAM, program);
+    glDeleteProgram(program);
+}
+
+inline void captureDeleteRenderbuffers(GLsizei n, const GLuint* renderbuffers) {
+    GLCaptureRegistry& reg = GLCapture::registry();
+    for (GLsizei i = 0; i < n; ++i) GLCapture::release(reg.renderbuffers, renderbuffers[i]);
+    if (GLCapture::active()) GLCapture::recordBlob(CAPTURE_DELETE_RENDERBUFFERS, renderbuffers, n * sizeof(GLuint));
+    glDeleteRenderbuffers(n, renderbuffers);
+}
+
+inline void captureDeleteShader(GLuint shader) {
+    GLCapture::release(GLCapture::registry().shaders, shader);
+    if (GLCapture::active()) GLCapture::record(CAPTURE_DELETE_SHADER, shader);
+    glDeleteShader(shader);
+}
+
+inline void captureDeleteTextures(GLsizei n, const GLuint* textures) {
+    GLCaptureRegistry& reg = GLCapture::registry();
+    for (GLsizei i = 0; i < n; ++i) {
+        GLCapture::release(reg.textures, textures[i]);
+        if (reg.texture2D == textures[i]) reg.texture2D = 0;
+        if (reg.textureCubeMap == textures[i]) reg.textureCubeMap = 0;
+    }
+    if (GLCapture::active()) GLCapture::recordBlob(CAPTURE_DELETE_TEXTURES, textures, n * sizeof(GLuint));
+    glDeleteTextures(n, textures);
+}
+
+inline void captureDeleteVertexArrays(GLsizei n, const GLuint* arrays) {
+    GLCaptureRegistry& reg = GLCapture::registry();
+    for (GLsizei i = 0; i < n; ++i) {
+        GLCapture::release(reg.vertexArrays, arrays[i]);
+        if (reg.vertexArray == arrays[i]) reg.vertexArray = 0;
+    }
+    if (GLCapture::active()) GLCapture::recordBlob(CAPTURE_DELETE_VERTEX_ARRAYS, arrays, n * sizeof(GLuint));
+    glDeleteVertexArrays(n, arrays);
+}
+
+inline void captureDisable(GLenum cap) {
+    if (GLCapture::active()) GLCapture::record(CAPTURE_DISABLE, cap);
+    glDisable(cap);
+}
+
+inline void captureDisableVertexAttribArray(GLuint index) {
+    GLCaptureRegistry& reg = GLCapture::registry();
+    if (GLCapture::VertexAttribute* attr = GLCapture::boundAttribute(reg, index)) attr->enabled = false;
+    if (GLCapture::active()) GLCapture::record(CAPTURE_DISABLE_VERTEX_ATTRIB_ARRAY, index);
+    glDisableVertexAttribArray(index);
+}
+
+inline void captureDrawArrays(GLenum mode, GLint first, GLsizei count) {
+    if (GLCapture::active()) GLCapture::record(CAPTURE_DRAW_ARRAYS, mode, first, count);
+    glDrawArrays(mode, first, count);
+}
+
+inline void captureDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instances) {
+    if (GLCapture::active()) GLCapture::record(CAPTURE_DRAW_ARRAYS_INSTANCED, mode, first, count, instances);
+    glDrawArraysInstanced(mode, first, count, instances);
+}
+
+// Index data is always read from the bound element buffer, so the pointer is an offset
+inline void captureDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices) {
+    if (GLCapture::active()) GLCapture::record(CAPTURE_DRAW_ELEMENTS, mode, count, type, (uint64_t)(uintptr_t)indices);
+    glDrawElements(mode, count, type, indices);
+}
+
+inline void captureDrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLint baseVertex) {
+    if (GLCapture::active()) GLCapture::record(CAPTURE_DRAW_ELEMENTS_BASE_VERTEX, mode, count, type, (uint64_t)(uintptr_t)indices, baseVertex);
+    glDrawElementsBaseVertex(mode, count, type, indices, baseVertex);
+}
+
+inline void captureDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instances) {
+    if (GLCapture::active()) GLCapture::record(CAPTURE_DRAW_ELEMENTS_INSTANCED, mode, count, type, (uint64_t)(uintptr_t)indices, instances);
+    glDrawElementsInstanced(mode, count, type, indices, instances);
+}
+
+inline void captureEnable(GLenum cap) {
+    if (GLCapture::active()) GLCapture::record(CAPTURE_ENABLE, cap);
+    glEnable(cap);
+}
+
+inline void captureEnableVertexAttribArray(GLuint index) {
+    GLCaptureRegistry& reg = GLCapture::registry();
+    if (GLCapture::VertexAttribute* attr = GLCapture::boundAttribute(reg, index)) attr->enabled = true;
+    if (GLCapture::active()) GLCapture::record(CAPTURE_ENABLE_VERTEX_ATTRIB_ARRAY, index);
+    glEnableVertexAttribArray(index);
+}
+
+inline void captureFramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer) {
+    GLCaptureRegistry& reg = GLCapture::registry();
+    if (reg.framebuffer) {
+        auto& attachments = GLCapture::slot(reg.framebuffers, reg.framebuffer).attachments;
+        for (size_t i = 0; i < attachments.size(); ++i) {
+            if (attachments[i].attachment == attachment) { attachments.erase(attachments.begin() + i); break; }
+        }
+        attachments.push_back({ attachment, 0, renderbuffer, 0 });
+    }
+    if (GLCapture::active()) GLCapture::record(CAPTURE_FRAMEBUFFER_RENDERBUFFER, target, attachment, renderbuffertarget, renderbuffer);
+    glFramebufferRenderbuffer(target, attachment, renderbuffertarget, renderbuffer);
+}
+
+inline void captureFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level) {
+    GLCaptureRegistry& reg = GLCapture::registry();
+    if (reg.framebuffer) {
+        auto& attachments = GLCapture::slot(reg.framebuffers, reg.framebuffer).attachments;
+        for (size_t i = 0; i < attachments.size(); ++i) {
+            if (attachments[i].attachment == attachment) { attachments.erase(attachments.begin() + i); break; }
+        }
+        attachments.push_back({ attachment, textarget, texture, level });
+    }
+    if (GLCapture::active()) GLCapture::record(CAPTURE_FRAMEBUFFER_TEXTURE_2D, target, attachment, textarget, texture, level);
+    glFramebufferTexture2D(target, attachment, textarget, texture, level);
+}
+
+inline void captureGenBuffers(GLsizei n, GLuint* buffers) {
+    glGenBuffers(n, buffers);
+    GLCaptureRegistry& reg = GLCapture::registry();
+    for (GLsizei i = 0; i < n; ++i) GLCapture::slot(reg.buffers, buffers[i]) = 1;
+    if (GLCapture::active()) GLCapture::recordBlob(CAPTURE_GEN_BUFFERS, buffers, n * sizeof(GLuint));
+}
+
+inline void captureGenFramebuffers(GLsizei n, GLuint* framebuffers) {
+    glGenFramebuffers(n, framebuffers);
+    GLCaptureRegistry& reg = GLCapture::registry();
+    for (GLsizei i = 0; i < n; ++i) GLCapture::slot(reg.framebuffers, framebuffers[i]).live = true;
+    if (GLCapture::active()) GLCapture::recordBlob(CAPTURE_GEN_FRAMEBUFFERS, framebuffers, n * sizeof(GLuint));
+}
+
+inline void captureGenRenderbuffers(GLsizei n, GLuint* renderbuffers) {
+    glGenRenderbuffers(n, renderbuffers);
+    GLCaptureRegistry& reg = GLCapture::registry();
+    for (GLsizei i = 0; i < n; ++i) GLCapture::slot(reg.renderbuffers, renderbuffers[i]).live = true;
+    if (GLCapture::active()) GLCapture::recordBlob(CAPTURE_GEN_RENDERBUFFERS, renderbuffers, n * sizeof(GLuint));
+}
+
+inline void captureGenTextures(GLsizei n, GLuint* textures) {
+    glGenTextures(n, textures);
+    GLCaptureRegistry& reg = GLCapture::registry();
+    for (GLsizei i = 0; i < n; ++i) GLCapture::slot(reg.textures, textures[i]).live = true;
+    if (GLCapture::active()) GLCapture::recordBlob(CAPTURE_GEN_TEXTURES, textures, n * sizeof(GLuint));
+}
+
+inline void captureGenVertexArrays(GLsizei n, GLuint* arrays) {
+    glGenVertexArrays(n, arrays);
+    GLCaptureRegistry& reg = GLCapture::registry();
+    for (GLsizei i = 0; i < n; ++i) GLCapture::slot(reg.vertexArrays, arrays[i]).live = true;
+    if (GLCapture::active()) GLCapture::recordBlob(CAPTURE_GEN_VERTEX_ARRAYS, arrays, n * sizeof(GLuint));
+}
+
+// Readbacks are replayed too, since the stall is part of the frame cost
+inline void captureGetBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, void* data) {
+    if (GLCapture::active()) GLCapture::record(CAPTURE_GET_BUFFER_SUB_DATA, target, (int64_t)offset, (int64_t)size);
+    glGetBufferSubData(target, offset, size, data);
+}
+
+inline GLint captureGetUniformLocation(GLuint program, const GLchar* name) {
+    GLint location = glGetUniformLocation(program, name);
+    if (GLCapture::active()) GLCapture::record(CAPTURE_GET_UNIFORM_LOCATION, program, std::string(name), location);
+    return location;
+}
+
+inline void captureLineWidth(GLfloat width) {
+    if (GLCapture::active()) GLCapture::record(CAPTURE_LINE_WIDTH, width);
+    glLineWidth(width);
+}
+
+inline void captureLinkProgram(GLuint program) {
+    // Remember the stage sources so the program can be rebuilt after its shaders are deleted
+    GLCaptureRegistry& reg = GLCapture::registry();
+    GLCapture::ProgramInfo& info = GLCapture::slot(reg.programs, program);
+    info.stages.clear();
+    for (GLuint shader : info.attached) {
+        if (shader < reg.shaders.size() && reg.shaders[shader].live) info.stages.push_back(reg.shaders[shader]);
+    }
+    if (GLCapture::active()) GLCapture::record(CAPTURE_LINK_PROGRAM, program);
+    glLinkProgram(program);
+}
+
+inline void capturePatchParameteri(GLenum pname, GLint value) {
+    if (GLCapture::active()) GLCapture::record(CAPTURE_PATCH_PARAMETER, pname, value);
+    glPatchParameteri(pname, value);
+}
+
+inline void capturePolygonMode(GLenum face, GLenum mode) {
+    if (GLCapture::active()) GLCapture::record(CAPTURE_POLYGON_MODE, face, mode);
+    glPolygonMode(face, mode);
+}
+
+inline void captureRenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width, GLsizei height) {
+    GLCaptureRegistry& reg = GLCapture::registry();
+    if (reg.renderbuffer) {
+        GLCapture::RenderbufferInfo& info = GLCapture::slot(reg.renderbuffers, reg.renderbuffer);
+        info.internalFormat = internalformat;
+        info.width = width;
+        info.height = height;
+    }
+    if (GLCapture::active()) GLCapture::record(CAPTURE_RENDERBUFFER_STORAGE, target, internalformat, width, height);
+    glRenderbufferStorage(target, internalformat, width, height);
+}
+
+inline void captureShaderSource(GLuint shader, GLsizei count, const GLchar* const* strings, const GLint* lengths) {
+    std::string source;
+    for (GLsizei i = 0; i < count; ++i) {
+        source.append(strings[i], lengths && lengths[i] >= 0 ? (size_t)lengths[i] : strlen(strings[i]));
+    }
+    GLCapture::slot(GLCapture::registry().shaders, shader).source = source;
+    if (GLCapture::active()) GLCapture::record(CAPTURE_SHADER_SOURCE, shader, source);
+    glShaderSource(shader, count, strings, lengths);
+}
+
+inline void captureTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height,
+                              GLint border, GLenum format, GLenum type, const void* pixels) {
+    GLCaptureRegistry& reg = GLCapture::registry();
+    GLuint* bound = GLCapture::boundTexture(reg, target);
+    GLuint texture = bound ? *bound : 0;
+    if (texture && level == 0) {
+        GLCapture::TextureInfo& info = GLCapture::slot(reg.textures, texture);
+        info.target = target;
+        info.internalFormat = internalformat;
+        info.width = width;
+        info.height = height;
+        info.format = format;
+        info.type = type;
+    }
+    if (GLCapture::active()) {
+        GLint alignment = 4;
+        glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+        size_t size = pixels ? GLCapture::imageSize(width, height, format, type, alignment) : 0;
+        GLCapture::recordBlob(CAPTURE_TEX_IMAGE_2D, pixels, size, target, level, internalformat,
+                              width, height, border, format, type, alignment);
+    }
+    glTexImage2D(target, level, internalformat, width, height, border, format, type, pixels);
+}
+
+inline void captureTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width,
+                                 GLsizei height, GLenum format, GLenum type, const void* pixels) {
+    if (GLCapture::active()) {
+        GLint alignment = 4;
+        glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+        size_t size = pixels ? GLCapture::imageSize(width, height, format, type, alignment) : 0;
+        GLCapture::recordBlob(CAPTURE_TEX_SUB_IMAGE_2D, pixels, size, target, level, xoffset, yoffset,
+                              width, height, format, type, alignment);
+    }
+    glTexSubImage2D(target, level, xoffset, yoffset, width, height, format, type, pixels);
+}
+
+inline void captureTexParameteri(GLenum target, GLenum pname, GLint param) {
+    GLCaptureRegistry& reg = GLCapture::registry();
+    GLuint* bound = GLCapture::boundTexture(reg, target);
+    if (bound && *bound) {
+        auto& parameters = GLCapture::slot(reg.textures, *bound).parameters;
+        size_t i = 0;
+        while (i < parameters.size() && parameters[i].first != pname) ++i;
+        if (i == parameters.size()) parameters.push_back(std::make_pair(pname, param));
+        else parameters[i].second = param;
+    }
+    if (GLCapture::active()) GLCapture::record(CAPTURE_TEX_PARAMETER, target, pname, param);
+    glTexParameteri(target, pname, param);
+}
+
+inline void captureUniform1f(GLint location, GLfloat v0) {
+    if (GLCapture::active()) GLCapture::record(CAPTURE_UNIFORM_1F, location, v0);
+    glUniform1f(location, v0);
+}
+
+inline void captureUniform1i(GLint location, GLint v0) {
+    if (GLCapture::active()) GLCapture::record(CAPTURE_UNIFORM_1I, location, v0);
+    glUniform1i(location, v0);
+}
+
+inline void captureUniform2f(GLint location, GLfloat v0, GLfloat v1) {
+    if (GLCapture::active()) GLCapture::record(CAPTURE_UNIFORM_2F, location, v0, v1);
+    glUniform2f(location, v0, v1);
+}
+
+inline void captureUniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2) {
+    if (GLCapture::active()) GLCapture::record(CAPTURE_UNIFORM_3F, location, v0, v1, v2);
+    glUniform3f(location, v0, v1, v2);
+}
+
+inline void captureUniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3) {
+    if (GLCapture::active()) GLCapture::record(CAPTURE_UNIFORM_4F, location, v0, v1, v2, v3);
+    glUniform4f(location, v0, v1, v2, v3);
+}
+
+inline void captureUniform4fv(GLint location, GLsizei count, const GLfloat* value) {
+    if (GLCapture::active()) GLCapture::recordBlob(CAPTURE_UNIFORM_4FV, value, count * 4 * sizeof(GLfloat), location);
+    glUniform4fv(location, count, value);
+}
+
+inline void captureUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+    if (GLCapture::active()) GLCapture::recordBlob(CAPTURE_UNIFORM_MATRIX_4FV, value, count * 16 * sizeof(GLfloat), location, transpose);
+    glUniformMatrix4fv(location, count, transpose, value);
+}
+
+inline void captureUseProgram(GLuint program) {
+    if (GLCapture::active()) GLCapture::record(CAPTURE_USE_PROGRAM, program);
+    glUseProgram(program);
+}
+
+inline void captureVertexAttrib1f(GLuint index, GLfloat x) {
+    GLCapture::GenericAttribute& attr = GLCapture::slot(GLCapture::registry().genericAttributes, index);
+    attr.set = true;
+    attr.value[0] = x;
+    attr.value[1] = 0.0f;
+    attr.value[2] = 0.0f;
+    attr.value[3] = 1.0f;
+    if (GLCapture::active()) GLCapture::record(CAPTURE_VERTEX_ATTRIB_1F, index, x);
+    glVertexAttrib1f(index, x);
+}
+
+inline void captureVertexAttrib3f(GLuint index, GLfloat x, GLfloat y, GLfloat z) {
+    GLCapture::GenericAttribute& attr = GLCapture::slot(GLCapture::registry().genericAttributes, index);
+    attr.set = true;
+    attr.value[0] = x;
+    attr.value[1] = y;
+    attr.value[2] = z;
+    attr.value[3] = 1.0f;
+    if (GLCapture::active()) GLCapture::record(CAPTURE_VERTEX_ATTRIB_3F, index, x, y, z);
+    glVertexAttrib3f(index, x, y, z);
+}
+
+inline void captureVertexAttribDivisor(GLuint index, GLuint divisor) {
+    GLCaptureRegistry& reg = GLCapture::registry();
+    if (GLCapture::VertexAttribute* attr = GLCapture::boundAttribute(reg, index)) attr->divisor = divisor;
+    if (GLCapture::active()) GLCapture::record(CAPTURE_VERTEX_ATTRIB_DIVISOR, index, divisor);
+    glVertexAttribDivisor(index, divisor);
+}
+
+inline void captureVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer) {
+    GLCaptureRegistry& reg = GLCapture::registry();
+    if (GLCapture::VertexAttribute* attr = GLCapture::boundAttribute(reg, index)) {
+        attr->buffer = reg.arrayBuffer;
+        attr->size = size;
+        attr->type = type;
+        attr->normalized = normalized;
+        attr->stride = stride;
+        attr->offset = (uint64_t)(uintptr_t)pointer;
+    }
+    if (GLCapture::active()) GLCapture::record(CAPTURE_VERTEX_ATTRIB_POINTER, index, size, type, normalized, stride, (uint64_t)(uintptr_t)pointer);
+    glVertexAttribPointer(index, size, type, normalized, stride, pointer);
+}
+
+inline void captureViewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+    if (GLCapture::active()) GLCapture::record(CAPTURE_VIEWPORT, x, y, width, height);
+    glViewport(x, y, width, height);
+}
+
+// Route the entry points through the wrappers. GLEW defines most of these as
+// macros, so they are undefined first.
+#undef glActiveTexture
+#undef glAttachShader
+#undef glBindBuffer
+#undef glBindFramebuffer
+#undef glBindRenderbuffer
+#undef glBindTexture
+#undef glBindVertexArray
+#undef glBlendFunc
+#undef glBufferData
+#undef glBufferSubData
+#undef glClear
+#undef glClearColor
+#undef glCompileShader
+#undef glCreateProgram
+#undef glCreateShader
+#undef glCullFace
+#undef glDeleteBuffers
+#undef glDeleteFramebuffers
+#undef glDeleteProgram
+#undef glDeleteRenderbuffers
+#undef glDeleteShader
+#undef glDeleteTextures
+#undef glDeleteVertexArrays
+#undef glDisable
+#undef glDisableVertexAttribArray
+#undef glDrawArrays
+#undef glDrawArraysInstanced
+#undef glDrawElements
+#undef glDrawElementsBaseVertex
+#undef glDrawElementsInstanced
+#undef glEnable
+#undef glEnableVertexAttribArray
+#undef glFramebufferRenderbuffer
+#undef glFramebufferTexture2D
+#undef glGenBuffers
+#undef glGenFramebuffers
+#undef glGenRenderbuffers
+#undef glGenTextures
+#undef glGenVertexArrays
+#undef glGetBufferSubData
+#undef glGetUniformLocation
+#undef glLineWidth
+#undef glLinkProgram
+#undef glPatchParameteri
+#undef glPolygonMode
+#undef glRenderbufferStorage
+#undef glShaderSource
+#undef glTexImage2D
+#undef glTexParameteri
+#undef glTexSubImage2D
+#undef glUniform1f
+#undef glUniform1i
+#undef glUniform2f
+#undef glUniform3f
+#undef glUniform4f
+#undef glUniform4fv
+#undef glUniformMatrix4fv
+#undef glUseProgram
+#undef glVertexAttrib1f
+#undef glVertexAttrib3f
+#undef glVertexAttribDivisor
+#undef glVertexAttribPointer
+#undef glViewport
+
+#define glActiveTexture captureActiveTexture
+#define glAttachShader captureAttachShader
+#define glBindBuffer captureBindBuffer
+#define glBindFramebuffer captureBindFramebuffer
+#define glBindRenderbuffer captureBindRenderbuffer
+#define glBindTexture captureBindTexture
+#define glBindVertexArray captureBindVertexArray
+#define glBlendFunc captureBlendFunc
+#define glBufferData captureBufferData
+#define glBufferSubData captureBufferSubData
+#define glClear captureClear
+#define glClearColor captureClearColor
+#define glCompileShader captureCompileShader
+#define glCreateProgram captureCreateProgram
+#define glCreateShader captureCreateShader
+#define glCullFace captureCullFace
+#define glDeleteBuffers captureDeleteBuffers
+#define glDeleteFramebuffers captureDeleteFramebuffers
+#define glDeleteProgram captureDeleteProgram
+#define glDeleteRenderbuffers captureDeleteRenderbuffers
+#define glDeleteShader captureDeleteShader
+#define glDeleteTextures captureDeleteTextures
+#define glDeleteVertexArrays captureDeleteVertexArrays
+#define glDisable captureDisable
+#define glDisableVertexAttribArray captureDisableVertexAttribArray
+#define glDrawArrays captureDrawArrays
+#define glDrawArraysInstanced captureDrawArraysInstanced
+#define glDrawElements captureDrawElements
+#define glDrawElementsBaseVertex captureDrawElementsBaseVertex
+#define glDrawElementsInstanced captureDrawElementsInstanced
+#define glEnable captureEnable
+#define glEnableVertexAttribArray captureEnableVertexAttribArray
+#define glFramebufferRenderbuffer captureFramebufferRenderbuffer
+#define glFramebufferTexture2D captureFramebufferTexture2D
+#define glGenBuffers captureGenBuffers
+#define glGenFramebuffers captureGenFramebuffers
+#define glGenRenderbuffers captureGenRenderbuffers
+#define glGenTextures captureGenTextures
+#define glGenVertexArrays captureGenVertexArrays
+#define glGetBufferSubData captureGetBufferSubData
+#define glGetUniformLocation captureGetUniformLocation
+#define glLineWidth captureLineWidth
+#define glLinkProgram captureLinkProgram
+#define glPatchParameteri capturePatchParameteri
+#define glPolygonMode capturePolygonMode
+#define glRenderbufferStorage captureRenderbufferStorage
+#define glShaderSource captureShaderSource
+#define glTexImage2D captureTexImage2D
+#define glTexParameteri captureTexParameteri
+#define glTexSubImage2D captureTexSubImage2D
+#define glUniform1f captureUniform1f
+#define glUniform1i captureUniform1i
+#define glUniform2f captureUniform2f
+#define glUniform3f captureUniform3f
+#define glUniform4f captureUniform4f
+#define glUniform4fv captureUniform4fv
+#define glUniformMatrix4fv captureUniformMatrix4fv
+#define glUseProgram captureUseProgram
+#define glVertexAttrib1f captureVertexAttrib1f
+#define glVertexAttrib3f captureVertexAttrib3f
+#define glVertexAttribDivisor captureVertexAttribDivisor
+#define glVertexAttribPointer captureVertexAttribPointer
+#define glViewport captureViewport
+
+#endif // GL_CAPTURE_NO_HOOKS
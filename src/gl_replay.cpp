@@ -0,0 +1,788 @@
+// Headless replayer for GL captures written by gl_capture.h
+//
+// Usage: GLReplay <capture.glcap> [--loops N] [--warmup N] [--sync] [--top N]
+//
+// The snapshot prologue is replayed once to recreate the captured resources,
+// the frames are run untimed --warmup times (shader and driver first-use
+// costs), then re-issued back to back as fast as possible.
+// Reports CPU submit, GPU (timer query) and wall time per frame, and count,
+// total and worst time per call type. --sync finishes the GPU after every
+// call so per-call times include execution rather than just submission.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <map>
+#include <algorithm>
+#include <chrono>
+
+// OpenGL headers
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+// Capture file format only, no hooks
+#define GL_CAPTURE_NO_HOOKS
+#include "gl_capture.h"
+
+static const char* captureOpName(uint16_t op) {
+    static const char* names[CAPTURE_OP_COUNT] = {
+        "?", "FrameBegin", "FrameEnd",
+        "glActiveTexture", "glAttachShader", "glBindBuffer", "glBindFramebuffer", "glBindRenderbuffer",
+        "glBindTexture", "glBindVertexArray", "glBlendFunc", "glBufferData", "glBufferSubData",
+        "glClear", "glClearColor", "glCompileShader", "glCreateProgram", "glCreateShader", "glCullFace",
+        "glDeleteBuffers", "glDeleteFramebuffers", "glDeleteProgram", "glDeleteRenderbuffers",
+        "glDeleteShader", "glDeleteTextures", "glDeleteVertexArrays", "glDisable",
+        "glDisableVertexAttribArray", "glDrawArrays", "glDrawArraysInstanced", "glDrawElements",
+        "glDrawElementsInstanced", "glEnable", "glEnableVertexAttribArray", "glFramebufferRenderbuffer",
+        "glFramebufferTexture2D", "glGenBuffers", "glGenFramebuffers", "glGenRenderbuffers",
+        "glGenTextures", "glGenVertexArrays", "glGetBufferSubData", "glGetUniformLocation",
+        "glLineWidth", "glLinkProgram", "glPatchParameteri", "glPolygonMode", "glRenderbufferStorage",
+        "glShaderSource", "glTexImage2D", "glTexParameteri", "glUniform1f", "glUniform1i",
+        "glUniform2f", "glUniform3f", "glUniform4f", "glUniformMatrix4fv", "glUniform (snapshot)",
+        "glUseProgram", "glVertexAttribDivisor", "glVertexAttribPointer", "glViewport",
+        "glVertexAttrib1f", "glVertexAttrib4f (snapshot)", "glVertexAttrib3f",
+        "glDrawElementsBaseVertex", "glTexSubImage2D", "glUniform4fv"
+    };
+    return op < CAPTURE_OP_COUNT ? names[op] : "?";
+}
+
+// One record in the capture file
+struct CaptureRecord {
+    uint16_t op;
+    const unsigned char* payload;
+    uint32_t size;
+};
+
+// Sequential reader over a record payload
+class PayloadReader {
+public:
+    PayloadReader(const CaptureRecord& record) : ptr(record.payload), end(record.payload + record.size) {}
+
+    template <typename T>
+    T get() {
+        T value;
+        memset(&value, 0, sizeof(T));
+        if (ptr + sizeof(T) <= end) memcpy(&value, ptr, sizeof(T));
+        ptr += sizeof(T);
+        return value;
+    }
+
+    // Returns NULL for an empty blob, matching a NULL data pointer at capture time
+    const void* getBlob(uint32_t& length) {
+        length = get<uint32_t>();
+        if (ptr + length > end) length = 0;
+        const void* data = length ? ptr : NULL;
+        ptr += length;
+        return data;
+    }
+
+    std::string getString() {
+        uint32_t length = 0;
+        const void* data = getBlob(length);
+        return data ? std::string((const char*)data, length) : std::string();
+    }
+
+private:
+    const unsigned char* ptr;
+    const unsigned char* end;
+};
+
+// Re-issues records against the current context, translating object names
+class CaptureReplayer {
+public:
+    int unmappedNames = 0;
+    int drawCalls = 0;
+
+    void execute(const CaptureRecord& record) {
+        PayloadReader in(record);
+        switch (record.op) {
+            case CAPTURE_FRAME_BEGIN:
+            case CAPTURE_FRAME_END:
+                break;
+            case CAPTURE_ACTIVE_TEXTURE:
+                glActiveTexture(in.get<GLenum>());
+                break;
+            case CAPTURE_ATTACH_SHADER: {
+                GLuint program = map(programs, in.get<GLuint>());
+                glAttachShader(program, map(shaders, in.get<GLuint>()));
+                break;
+            }
+            case CAPTURE_BIND_BUFFER: {
+                GLenum target = in.get<GLenum>();
+                glBindBuffer(target, map(buffers, in.get<GLuint>()));
+                break;
+            }
+            case CAPTURE_BIND_FRAMEBUFFER: {
+                GLenum target = in.get<GLenum>();
+                glBindFramebuffer(target, map(framebuffers, in.get<GLuint>()));
+                break;
+            }
+            case CAPTURE_BIND_RENDERBUFFER: {
+                GLenum target = in.get<GLenum>();
+                glBindRenderbuffer(target, map(renderbuffers, in.get<GLuint>()));
+                break;
+            }
+            case CAPTURE_BIND_TEXTURE: {
+                GLenum target = in.get<GLenum>();
+                glBindTexture(target, map(textures, in.get<GLuint>()));
+                break;
+            }
+            case CAPTURE_BIND_VERTEX_ARRAY:
+                glBindVertexArray(map(vertexArrays, in.get<GLuint>()));
+                break;
+            case CAPTURE_BLEND_FUNC: {
+                GLenum sfactor = in.get<GLenum>();
+                glBlendFunc(sfactor, in.get<GLenum>());
+                break;
+            }
+            case CAPTURE_BUFFER_DATA: {
+                GLenum target = in.get<GLenum>();
+                int64_t size = in.get<int64_t>();
+                GLenum usage = in.get<GLenum>();
+                uint32_t length = 0;
+                const void* data = in.getBlob(length);
+                glBufferData(target, (GLsizeiptr)size, data, usage);
+                break;
+            }
+            case CAPTURE_BUFFER_SUB_DATA: {
+                GLenum target = in.get<GLenum>();
+                int64_t offset = in.get<int64_t>();
+                uint32_t length = 0;
+                const void* data = in.getBlob(length);
+                glBufferSubData(target, (GLintptr)offset, length, data);
+                break;
+            }
+            case CAPTURE_CLEAR:
+                glClear(in.get<GLbitfield>());
+                break;
+            case CAPTURE_CLEAR_COLOR: {
+                GLfloat r = in.get<GLfloat>(), g = in.get<GLfloat>(), b = in.get<GLfloat>(), a = in.get<GLfloat>();
+                glClearColor(r, g, b, a);
+                break;
+            }
+            case CAPTURE_COMPILE_SHADER:
+                glCompileShader(map(shaders, in.get<GLuint>()));
+                break;
+            case CAPTURE_CREATE_PROGRAM:
+                programs[in.get<GLuint>()] = glCreateProgram();
+                break;
+            case CAPTURE_CREATE_SHADER: {
+                GLenum type = in.get<GLenum>();
+                shaders[in.get<GLuint>()] = glCreateShader(type);
+                break;
+            }
+            case CAPTURE_CULL_FACE:
+                glCullFace(in.get<GLenum>());
+                break;
+            case CAPTURE_DELETE_BUFFERS:
+                deleteNames(in, buffers, glDeleteBuffers);
+                break;
+            case CAPTURE_DELETE_FRAMEBUFFERS:
+                deleteNames(in, framebuffers, glDeleteFramebuffers);
+                break;
+            case CAPTURE_DELETE_RENDERBUFFERS:
+                deleteNames(in, renderbuffers, glDeleteRenderbuffers);
+                break;
+            case CAPTURE_DELETE_TEXTURES:
+                deleteNames(in, textures, glDeleteTextures);
+                break;
+            case CAPTURE_DELETE_VERTEX_ARRAYS:
+                deleteNames(in, vertexArrays, glDeleteVertexArrays);
+                break;
+            case CAPTURE_DELETE_PROGRAM: {
+                GLuint name = in.get<GLuint>();
+                glDeleteProgram(map(programs, name));
+                programs.erase(name);
+                break;
+            }
+            case CAPTURE_DELETE_SHADER: {
+                GLuint name = in.get<GLuint>();
+                glDeleteShader(map(shaders, name));
+                shaders.erase(name);
+                break;
+            }
+            case CAPTURE_DISABLE:
+                glDisable(in.get<GLenum>());
+                break;
+            case CAPTURE_DISABLE_VERTEX_ATTRIB_ARRAY:
+                glDisableVertexAttribArray(in.get<GLuint>());
+                break;
+            case CAPTURE_DRAW_ARRAYS: {
+                GLenum mode = in.get<GLenum>();
+                GLint first = in.get<GLint>();
+                glDrawArrays(mode, first, in.get<GLsizei>());
+                drawCalls++;
+                break;
+            }
+            case CAPTURE_DRAW_ARRAYS_INSTANCED: {
+                GLenum mode = in.get<GLenum>();
+                GLint first = in.get<GLint>();
+                GLsizei count = in.get<GLsizei>();
+                glDrawArraysInstanced(mode, first, count, in.get<GLsizei>());
+                drawCalls++;
+                break;
+            }
+            case CAPTURE_DRAW_ELEMENTS: {
+                GLenum mode = in.get<GLenum>();
+                GLsizei count = in.get<GLsizei>();
+                GLenum type = in.get<GLenum>();
+                glDrawElements(mode, count, type, (const void*)(uintptr_t)in.get<uint64_t>());
+                drawCalls++;
+                break;
+            }
+            case CAPTURE_DRAW_ELEMENTS_INSTANCED: {
+                GLenum mode = in.get<GLenum>();
+                GLsizei count = in.get<GLsizei>();
+                GLenum type = in.get<GLenum>();
+                const void* offset = (const void*)(uintptr_t)in.get<uint64_t>();
+                glDrawElementsInstanced(mode, count, type, offset, in.get<GLsizei>());
+                drawCalls++;
+                break;
+            }
+            case CAPTURE_ENABLE:
+                glEnable(in.get<GLenum>());
+                break;
+            case CAPTURE_ENABLE_VERTEX_ATTRIB_ARRAY:
+                glEnableVertexAttribArray(in.get<GLuint>());
+                break;
+            case CAPTURE_FRAMEBUFFER_RENDERBUFFER: {
+                GLenum target = in.get<GLenum>();
+                GLenum attachment = in.get<GLenum>();
+                GLenum rbTarget = in.get<GLenum>();
+                glFramebufferRenderbuffer(target, attachment, rbTarget, map(renderbuffers, in.get<GLuint>()));
+                break;
+            }
+            case CAPTURE_FRAMEBUFFER_TEXTURE_2D: {
+                GLenum target = in.get<GLenum>();
+                GLenum attachment = in.get<GLenum>();
+                GLenum texTarget = in.get<GLenum>();
+                GLuint texture = map(textures, in.get<GLuint>());
+                glFramebufferTexture2D(target, attachment, texTarget, texture, in.get<GLint>());
+                break;
+            }
+            case CAPTURE_GEN_BUFFERS:
+                genNames(in, buffers, glGenBuffers);
+                break;
+            case CAPTURE_GEN_FRAMEBUFFERS:
+                genNames(in, framebuffers, glGenFramebuffers);
+                break;
+            case CAPTURE_GEN_RENDERBUFFERS:
+                genNames(in, renderbuffers, glGenRenderbuffers);
+                break;
+            case CAPTURE_GEN_TEXTURES:
+                genNames(in, textures, glGenTextures);
+                break;
+            case CAPTURE_GEN_VERTEX_ARRAYS:
+                genNames(in, vertexArrays, glGenVertexArrays);
+                break;
+            case CAPTURE_GET_BUFFER_SUB_DATA: {
+                GLenum target = in.get<GLenum>();
+                int64_t offset = in.get<int64_t>();
+                int64_t size = in.get<int64_t>();
+                if (readback.size() < (size_t)size) readback.resize((size_t)size);
+                glGetBufferSubData(target, (GLintptr)offset, (GLsizeiptr)size, readback.data());
+                break;
+            }
+            case CAPTURE_GET_UNIFORM_LOCATION: {
+                GLuint program = in.get<GLuint>();
+                std::string name = in.getString();
+                GLint captured = in.get<GLint>();
+                if (captured >= 0) {
+                    uniformLocations[std::make_pair(program, captured)] = glGetUniformLocation(map(programs, program), name.c_str());
+                }
+                break;
+            }
+            case CAPTURE_LINE_WIDTH:
+                glLineWidth(in.get<GLfloat>());
+                break;
+            case CAPTURE_LINK_PROGRAM:
+                glLinkProgram(map(programs, in.get<GLuint>()));
+                break;
+            case CAPTURE_PATCH_PARAMETER: {
+                GLenum pname = in.get<GLenum>();
+                GLint value = in.get<GLint>();
+                if (GLEW_VERSION_4_0) glPatchParameteri(pname, value);
+                break;
+            }
+            case CAPTURE_POLYGON_MODE: {
+                GLenum face = in.get<GLenum>();
+                glPolygonMode(face, in.get<GLenum>());
+                break;
+            }
+            case CAPTURE_RENDERBUFFER_STORAGE: {
+                GLenum target = in.get<GLenum>();
+                GLenum format = in.get<GLenum>();
+                GLsizei width = in.get<GLsizei>();
+                glRenderbufferStorage(target, format, width, in.get<GLsizei>());
+                break;
+            }
+            case CAPTURE_SHADER_SOURCE: {
+                GLuint shader = map(shaders, in.get<GLuint>());
+                std::string source = in.getString();
+                const char* text = source.c_str();
+                glShaderSource(shader, 1, &text, NULL);
+                break;
+            }
+            case CAPTURE_TEX_IMAGE_2D: {
+                GLenum target = in.get<GLenum>();
+                GLint level = in.get<GLint>();
+                GLint internalFormat = in.get<GLint>();
+                GLsizei width = in.get<GLsizei>();
+                GLsizei height = in.get<GLsizei>();
+                GLint border = in.get<GLint>();
+                GLenum format = in.get<GLenum>();
+                GLenum type = in.get<GLenum>();
+                GLint alignment = in.get<GLint>();
+                uint32_t length = 0;
+                const void* pixels = in.getBlob(length);
+                glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+                glTexImage2D(target, level, internalFormat, width, height, border, format, type, pixels);
+                break;
+            }
+            case CAPTURE_TEX_PARAMETER: {
+                GLenum target = in.get<GLenum>();
+                GLenum pname = in.get<GLenum>();
+                glTexParameteri(target, pname, in.get<GLint>());
+                break;
+            }
+            case CAPTURE_UNIFORM_1F: {
+                GLint location = uniform(in.get<GLint>());
+                glUniform1f(location, in.get<GLfloat>());
+                break;
+            }
+            case CAPTURE_UNIFORM_1I: {
+                GLint location = uniform(in.get<GLint>());
+                glUniform1i(location, in.get<GLint>());
+                break;
+            }
+            case CAPTURE_UNIFORM_2F: {
+                GLint location = uniform(in.get<GLint>());
+                GLfloat x = in.get<GLfloat>(), y = in.get<GLfloat>();
+                glUniform2f(location, x, y);
+                break;
+            }
+            case CAPTURE_UNIFORM_3F: {
+                GLint location = uniform(in.get<GLint>());
+                GLfloat x = in.get<GLfloat>(), y = in.get<GLfloat>(), z = in.get<GLfloat>();
+                glUniform3f(location, x, y, z);
+                break;
+            }
+            case CAPTURE_UNIFORM_4F: {
+                GLint location = uniform(in.get<GLint>());
+                GLfloat x = in.get<GLfloat>(), y = in.get<GLfloat>(), z = in.get<GLfloat>(), w = in.get<GLfloat>();
+                glUniform4f(location, x, y, z, w);
+                break;
+            }
+            case CAPTURE_UNIFORM_MATRIX_4FV: {
+                GLint location = uniform(in.get<GLint>());
+                GLboolean transpose = in.get<GLboolean>();
+                uint32_t length = 0;
+                const GLfloat* value = (const GLfloat*)in.getBlob(length);
+                if (value) glUniformMatrix4fv(location, length / (16 * sizeof(GLfloat)), transpose, value);
+                break;
+            }
+            case CAPTURE_UNIFORM_VALUE: {
+                GLint location = uniform(in.get<GLint>());
+                GLenum type = in.get<GLenum>();
+                uint32_t length = 0;
+                const void* value = in.getBlob(length);
+                if (value && length >= 16 * sizeof(GLfloat)) setUniformValue(location, type, value);
+                break;
+            }
+            case CAPTURE_USE_PROGRAM:
+                currentProgram = in.get<GLuint>();
+                glUseProgram(map(programs, currentProgram));
+                break;
+            case CAPTURE_VERTEX_ATTRIB_DIVISOR: {
+                GLuint index = in.get<GLuint>();
+                glVertexAttribDivisor(index, in.get<GLuint>());
+                break;
+            }
+            case CAPTURE_VERTEX_ATTRIB_POINTER: {
+                GLuint index = in.get<GLuint>();
+                GLint size = in.get<GLint>();
+                GLenum type = in.get<GLenum>();
+                GLboolean normalized = in.get<GLboolean>();
+                GLsizei stride = in.get<GLsizei>();
+                const void* offset = (const void*)(uintptr_t)in.get<uint64_t>();
+                glVertexAttribPointer(index, size, type, normalized, stride, offset);
+                break;
+            }
+            case CAPTURE_VIEWPORT: {
+                GLint x = in.get<GLint>(), y = in.get<GLint>();
+                GLsizei width = in.get<GLsizei>();
+                glViewport(x, y, width, in.get<GLsizei>());
+                break;
+            }
+            case CAPTURE_VERTEX_ATTRIB_1F: {
+                GLuint index = in.get<GLuint>();
+                glVertexAttrib1f(index, in.get<GLfloat>());
+                break;
+            }
+            case CAPTURE_VERTEX_ATTRIB_4F: {
+                GLuint index = in.get<GLuint>();
+                GLfloat x = in.get<GLfloat>(), y = in.get<GLfloat>(), z = in.get<GLfloat>(), w = in.get<GLfloat>();
+                glVertexAttrib4f(index, x, y, z, w);
+                break;
+            }
+            case CAPTURE_VERTEX_ATTRIB_3F: {
+                GLuint index = in.get<GLuint>();
+                GLfloat x = in.get<GLfloat>(), y = in.get<GLfloat>(), z = in.get<GLfloat>();
+                glVertexAttrib3f(index, x, y, z);
+                break;
+            }
+            case CAPTURE_DRAW_ELEMENTS_BASE_VERTEX: {
+                GLenum mode = in.get<GLenum>();
+                GLsizei count = in.get<GLsizei>();
+                GLenum type = in.get<GLenum>();
+                const void* offset = (const void*)(uintptr_t)in.get<uint64_t>();
+                glDrawElementsBaseVertex(mode, count, type, offset, in.get<GLint>());
+                drawCalls++;
+                break;
+            }
+            case CAPTURE_TEX_SUB_IMAGE_2D: {
+                GLenum target = in.get<GLenum>();
+                GLint level = in.get<GLint>();
+                GLint xoffset = in.get<GLint>();
+                GLint yoffset = in.get<GLint>();
+                GLsizei width = in.get<GLsizei>();
+                GLsizei height = in.get<GLsizei>();
+                GLenum format = in.get<GLenum>();
+                GLenum type = in.get<GLenum>();
+                GLint alignment = in.get<GLint>();
+                uint32_t length = 0;
+                const void* pixels = in.getBlob(length);
+                glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+                glTexSubImage2D(target, level, xoffset, yoffset, width, height, format, type, pixels);
+                break;
+            }
+            case CAPTURE_UNIFORM_4FV: {
+                GLint location = uniform(in.get<GLint>());
+                uint32_t length = 0;
+                const GLfloat* value = (const GLfloat*)in.getBlob(length);
+                if (value) glUniform4fv(location, length / (4 * sizeof(GLfloat)), value);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+private:
+    std::map<GLuint, GLuint> buffers, textures, renderbuffers, framebuffers, vertexArrays, programs, shaders;
+    std::map<std::pair<GLuint, GLint>, GLint> uniformLocations;
+    GLuint currentProgram = 0;
+    std::vector<unsigned char> readback;
+
+    // Name 0 always maps to 0. Names created outside the capture (ImGui's) also fall back to 0.
+    GLuint map(const std::map<GLuint, GLuint>& names, GLuint captured) {
+        if (captured == 0) return 0;
+        auto it = names.find(captured);
+        if (it == names.end()) {
+            unmappedNames++;
+            return 0;
+        }
+        return it->second;
+    }
+
+    GLint uniform(GLint captured) {
+        if (captured < 0) return captured;
+        auto it = uniformLocations.find(std::make_pair(currentProgram, captured));
+        return it != uniformLocations.end() ? it->second : -1;
+    }
+
+    template <typename GenFunc>
+    void genNames(PayloadReader& in, std::map<GLuint, GLuint>& names, GenFunc gen) {
+        uint32_t length = 0;
+        const GLuint* captured = (const GLuint*)in.getBlob(length);
+        GLsizei count = length / sizeof(GLuint);
+        std::vector<GLuint> created(count);
+        if (count) gen(count, created.data());
+        for (GLsizei i = 0; i < count; ++i) names[captured[i]] = created[i];
+    }
+
+    template <typename DeleteFunc>
+    void deleteNames(PayloadReader& in, std::map<GLuint, GLuint>& names, DeleteFunc del) {
+        uint32_t length = 0;
+        const GLuint* captured = (const GLuint*)in.getBlob(length);
+        GLsizei count = length / sizeof(GLuint);
+        std::vector<GLuint> replayNames;
+        for (GLsizei i = 0; i < count; ++i) {
+            auto it = names.find(captured[i]);
+            if (it == names.end()) continue;
+            replayNames.push_back(it->second);
+            names.erase(it);
+        }
+        if (!replayNames.empty()) del((GLsizei)replayNames.size(), replayNames.data());
+    }
+
+    void setUniformValue(GLint location, GLenum type, const void* value) {
+        const GLfloat* f = (const GLfloat*)value;
+        const GLint* i = (const GLint*)value;
+        switch (type) {
+            case GL_FLOAT: glUniform1fv(location, 1, f); break;
+            case GL_FLOAT_VEC2: glUniform2fv(location, 1, f); break;
+            case GL_FLOAT_VEC3: glUniform3fv(location, 1, f); break;
+            case GL_FLOAT_VEC4: glUniform4fv(location, 1, f); break;
+            case GL_FLOAT_MAT3: glUniformMatrix3fv(location, 1, GL_FALSE, f); break;
+            case GL_FLOAT_MAT4: glUniformMatrix4fv(location, 1, GL_FALSE, f); break;
+            case GL_INT: case GL_BOOL:
+            case GL_SAMPLER_2D: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE:
+                glUniform1iv(location, 1, i); break;
+            case GL_INT_VEC2: case GL_BOOL_VEC2: glUniform2iv(location, 1, i); break;
+            case GL_INT_VEC3: case GL_BOOL_VEC3: glUniform3iv(location, 1, i); break;
+            case GL_INT_VEC4: case GL_BOOL_VEC4: glUniform4iv(location, 1, i); break;
+            case GL_UNSIGNED_INT: glUniform1uiv(location, 1, (const GLuint*)value); break;
+            default: break;
+        }
+    }
+};
+
+// Per-call-type timing
+struct CallStats {
+    uint64_t count = 0;
+    double totalMs = 0.0;
+    double maxMs = 0.0;
+};
+
+// A single slow call, for the worst-offenders list
+struct SlowCall {
+    double ms;
+    int frame;
+    size_t record;
+    uint16_t op;
+};
+
+// Load and split a capture into its snapshot prologue and frames
+bool loadCapture(const char* path, std::vector<unsigned char>& data, GLCaptureHeader& header,
+                 std::vector<CaptureRecord>& prologue, std::vector<std::vector<CaptureRecord>>& frames) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "Failed to open capture: %s\n", path);
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    data.resize(size > 0 ? (size_t)size : 0);
+    size_t read = data.empty() ? 0 : fread(data.data(), 1, data.size(), file);
+    fclose(file);
+
+    if (read < sizeof(GLCaptureHeader)) {
+        fprintf(stderr, "Capture is truncated: %s\n", path);
+        return false;
+    }
+    memcpy(&header, data.data(), sizeof(header));
+    if (memcmp(header.magic, "GLCP", 4) != 0 || header.version != GL_CAPTURE_VERSION) {
+        fprintf(stderr, "Not a supported GL capture (version %u): %s\n", header.version, path);
+        return false;
+    }
+
+    size_t offset = sizeof(GLCaptureHeader);
+    std::vector<CaptureRecord>* target = &prologue;
+    while (offset + sizeof(uint16_t) + sizeof(uint32_t) <= read) {
+        CaptureRecord record;
+        memcpy(&record.op, &data[offset], sizeof(uint16_t));
+        memcpy(&record.size, &data[offset + sizeof(uint16_t)], sizeof(uint32_t));
+        offset += sizeof(uint16_t) + sizeof(uint32_t);
+        if (offset + record.size > read) {
+            fprintf(stderr, "Capture is truncated at byte %zu\n", offset);
+            break;
+        }
+        record.payload = &data[offset];
+        offset += record.size;
+
+        if (record.op == CAPTURE_FRAME_BEGIN) {
+            frames.emplace_back();
+            target = &frames.back();
+        }
+        target->push_back(record);
+    }
+    return !frames.empty();
+}
+
+// Replay a loaded capture into the current context and print the timing report
+int runReplay(const GLCaptureHeader& header, const std::vector<CaptureRecord>& prologue,
+              const std::vector<std::vector<CaptureRecord>>& frames, int loops, int warmup, bool sync, int topCount) {
+    typedef std::chrono::high_resolution_clock Clock;
+    CaptureReplayer replayer;
+
+    Clock::time_point start = Clock::now();
+    for (const CaptureRecord& record : prologue) replayer.execute(record);
+    glFinish();
+    double prologueMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    printf("Snapshot: %zu calls replayed in %.2f ms\n", prologue.size(), prologueMs);
+
+    start = Clock::now();
+    for (int loop = 0; loop < warmup; ++loop) {
+        for (const std::vector<CaptureRecord>& frame : frames) {
+            for (const CaptureRecord& record : frame) replayer.execute(record);
+        }
+    }
+    glFinish();
+    if (warmup > 0) {
+        printf("Warm-up: %d loops in %.2f ms\n", warmup, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    }
+
+    GLuint timerQuery = 0;
+    glGenQueries(1, &timerQuery);
+
+    std::vector<CallStats> stats(CAPTURE_OP_COUNT);
+    std::vector<SlowCall> slowest;
+    std::vector<double> cpuTimes, gpuTimes, wallTimes;
+
+    printf("\n%-8s %8s %8s %10s %10s %10s\n", "Frame", "Calls", "Draws", "CPU ms", "GPU ms", "Wall ms");
+    for (int loop = 0; loop < loops; ++loop) {
+        for (size_t f = 0; f < frames.size(); ++f) {
+            const std::vector<CaptureRecord>& frame = frames[f];
+            replayer.drawCalls = 0;
+
+            glBeginQuery(GL_TIME_ELAPSED, timerQuery);
+            Clock::time_point frameStart = Clock::now();
+            for (size_t r = 0; r < frame.size(); ++r) {
+                Clock::time_point callStart = Clock::now();
+                replayer.execute(frame[r]);
+                if (sync) glFinish();
+                double ms = std::chrono::duration<double, std::milli>(Clock::now() - callStart).count();
+
+                CallStats& s = stats[frame[r].op < CAPTURE_OP_COUNT ? frame[r].op : 0];
+                s.count++;
+                s.totalMs += ms;
+                s.maxMs = std::max(s.maxMs, ms);
+                slowest.push_back({ ms, (int)f, r, frame[r].op });
+            }
+            double cpuMs = std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count();
+            glEndQuery(GL_TIME_ELAPSED);
+            glFinish();
+            double wallMs = std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count();
+
+            GLuint64 gpuNs = 0;
+            glGetQueryObjectui64v(timerQuery, GL_QUERY_RESULT, &gpuNs);
+            double gpuMs = gpuNs / 1.0e6;
+
+            cpuTimes.push_back(cpuMs);
+            gpuTimes.push_back(gpuMs);
+            wallTimes.push_back(wallMs);
+            printf("%-8s %8zu %8d %10.3f %10.3f %10.3f\n",
+                   (std::to_string(loop) + ":" + std::to_string(f)).c_str(),
+                   frame.size(), replayer.drawCalls, cpuMs, gpuMs, wallMs);
+
+            // Keep only the worst calls so long runs stay bounded
+            if (slowest.size() > (size_t)topCount * 8) {
+                std::partial_sort(slowest.begin(), slowest.begin() + topCount, slowest.end(),
+                                  [](const SlowCall& a, const SlowCall& b) { return a.ms > b.ms; });
+                slowest.resize(topCount);
+            }
+        }
+    }
+    glDeleteQueries(1, &timerQuery);
+
+    auto average = [](const std::vector<double>& v) {
+        double sum = 0.0;
+        for (double x : v) sum += x;
+        return v.empty() ? 0.0 : sum / v.size();
+    };
+    auto worst = [](const std::vector<double>& v) {
+        return v.empty() ? 0.0 : *std::max_element(v.begin(), v.end());
+    };
+    printf("\nFrames: %zu x %d loops (%ux%u, GL %u.%u capture)%s\n", frames.size(), loops,
+           header.framebufferWidth, header.framebufferHeight, header.glMajor, header.glMinor,
+           sync ? ", synchronous" : "");
+    printf("  CPU  avg %.3f ms  max %.3f ms\n", average(cpuTimes), worst(cpuTimes));
+    printf("  GPU  avg %.3f ms  max %.3f ms\n", average(gpuTimes), worst(gpuTimes));
+    printf("  Wall avg %.3f ms  max %.3f ms (%.1f FPS)\n", average(wallTimes), worst(wallTimes),
+           average(wallTimes) > 0.0 ? 1000.0 / average(wallTimes) : 0.0);
+
+    std::vector<int> order;
+    for (int op = 1; op < CAPTURE_OP_COUNT; ++op) {
+        if (stats[op].count) order.push_back(op);
+    }
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return stats[a].totalMs > stats[b].totalMs; });
+
+    printf("\n%-28s %10s %12s %12s %12s\n", "Call", "Count", "Total ms", "Avg us", "Max us");
+    for (int op : order) {
+        const CallStats& s = stats[op];
+        printf("%-28s %10llu %12.3f %12.3f %12.3f\n", captureOpName((uint16_t)op), (unsigned long long)s.count,
+               s.totalMs, s.totalMs * 1000.0 / s.count, s.maxMs * 1000.0);
+    }
+
+    size_t shown = std::min(slowest.size(), (size_t)topCount);
+    std::partial_sort(slowest.begin(), slowest.begin() + shown, slowest.end(),
+                      [](const SlowCall& a, const SlowCall& b) { return a.ms > b.ms; });
+    printf("\nSlowest calls:\n");
+    for (size_t i = 0; i < shown; ++i) {
+        printf("  %10.3f us  frame %d  call %zu  %s\n", slowest[i].ms * 1000.0, slowest[i].frame,
+               slowest[i].record, captureOpName(slowest[i].op));
+    }
+
+    if (replayer.unmappedNames) {
+        printf("\n%d references to objects created outside the capture were replaced with 0\n", replayer.unmappedNames);
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <capture.glcap> [--loops N] [--warmup N] [--sync] [--top N]\n", argv[0]);
+        return 1;
+    }
+
+    const char* path = argv[1];
+    int loops = 1;
+    int warmup = 1;
+    int topCount = 10;
+    bool sync = false;
+    for (int i = 2; i < argc; ++i) {
+        if (strcmp(argv[i], "--loops") == 0 && i + 1 < argc) loops = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) warmup = std::max(0, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--top") == 0 && i + 1 < argc) topCount = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--sync") == 0) sync = true;
+        else fprintf(stderr, "Ignoring unknown option: %s\n", argv[i]);
+    }
+
+    std::vector<unsigned char> data;
+    GLCaptureHeader header;
+    std::vector<CaptureRecord> prologue;
+    std::vector<std::vector<CaptureRecord>> frames;
+    if (!loadCapture(path, data, header, prologue, frames)) return 1;
+
+    if (!glfwInit()) {
+        fprintf(stderr, "Failed to initialize GLFW\n");
+        return 1;
+    }
+
+    // Hidden window with the captured context version and framebuffer size
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, (int)header.glMajor);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, (int)header.glMinor);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow* window = glfwCreateWindow((int)std::max(1u, header.framebufferWidth),
+                                          (int)std::max(1u, header.framebufferHeight), "GL Replay", NULL, NULL);
+    if (!window) {
+        fprintf(stderr, "Failed to create a GL %u.%u context\n", header.glMajor, header.glMinor);
+        glfwTerminate();
+        return 1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+
+    glewExperimental = GL_TRUE;
+    if (glewInit() != GLEW_OK) {
+        fprintf(stderr, "Failed to initialize GLEW\n");
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    printf("Replaying %s on %s\n", path, (const char*)glGetString(GL_RENDERER));
+    int result = runReplay(header, prologue, frames, loops, warmup, sync, topCount);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return result;
+}
@@ -0,0 +1,250 @@
+#pragma once
+
+// GPU memory accounting and leak tracking.
+//
+// Buffers, vertex arrays, textures, renderbuffers and framebuffers are created
+// through GPU_CREATE, which records the owner and the call site (GPU_TRACK
+// adopts names generated on a shared context). Objects that
+// share GL names retain them; release() deletes the name when the last
+// reference goes away. Sizes are read back from GL on refreshSizes(), so
+// uploads do not need to be instrumented. Include after the GL headers.
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+enum GpuResourceType {
+    GPU_BUFFER,
+    GPU_VERTEX_ARRAY,
+    GPU_TEXTURE,
+    GPU_RENDERBUFFER,
+    GPU_FRAMEBUFFER,
+    GPU_RESOURCE_TYPE_COUNT
+};
+
+struct GpuAllocation {
+    GpuResourceType type;
+    GLuint name;
+    std::string owner;
+    const char* file;
+    int line;
+    int references;
+    size_t bytes;       // last value seen by refreshSizes()
+};
+
+// Live totals for one resource type
+struct GpuCategoryStats {
+    size_t count = 0;
+    size_t bytes = 0;
+    size_t peakBytes = 0;
+    size_t created = 0;
+    size_t deleted = 0;
+};
+
+#define GPU_CREATE(type, owner) GpuMemory::create(type, owner, __FILE__, __LINE__)
+#define GPU_TRACK(type, name, owner) GpuMemory::track(type, name, owner, __FILE__, __LINE__)
+
+class GpuMemory {
+public:
+    static const char* typeName(GpuResourceType type) {
+        static const char* names[GPU_RESOURCE_TYPE_COUNT] = {
+            "Buffer", "Vertex Array", "Texture", "Renderbuffer", "Framebuffer"
+        };
+        return type < GPU_RESOURCE_TYPE_COUNT ? names[type] : "?";
+    }
+
+    // Generate one GL object and start tracking it with a single reference
+    static GLuint create(GpuResourceType type, const char* owner, const char* file, int line) {
+        GLuint name = 0;
+        switch (type) {
+            case GPU_BUFFER: glGenBuffers(1, &name); break;
+            case GPU_VERTEX_ARRAY: glGenVertexArrays(1, &name); break;
+            case GPU_TEXTURE: glGenTextures(1, &name); break;
+            case GPU_RENDERBUFFER: glGenRenderbuffers(1, &name); break;
+            case GPU_FRAMEBUFFER: glGenFramebuffers(1, &name); break;
+            default: return 0;
+        }
+        return track(type, name, owner, file, line);
+    }
+
+    // Start tracking a name generated elsewhere (on another context sharing this one's objects)
+    static GLuint track(GpuResourceType type, GLuint name, const char* owner, const char* file, int line) {
+        if (name == 0) return 0;
+
+        GpuAllocation& alloc = allocations(type)[name];
+        alloc.type = type;
+        alloc.name = name;
+        alloc.owner = owner ? owner : "";
+        alloc.file = file;
+        alloc.line = line;
+        alloc.references = 1;
+        alloc.bytes = 0;
+
+        GpuCategoryStats& stats = categories()[type];
+        stats.count++;
+        stats.created++;
+        return name;
+    }
+
+    // Another owner starts using an existing name
+    static void retain(GpuResourceType type, GLuint name) {
+        if (name == 0) return;
+        auto it = allocations(type).find(name);
+        if (it != allocations(type).end()) it->second.references++;
+    }
+
+    // Drop one reference; the GL object is deleted with the last one.
+    // Untracked names are deleted directly.
+    static void release(GpuResourceType type, GLuint name) {
+        if (name == 0) return;
+        auto& table = allocations(type);
+        auto it = table.find(name);
+        if (it != table.end()) {
+            if (--it->second.references > 0) return;
+            GpuCategoryStats& stats = categories()[type];
+            stats.count--;
+            stats.bytes -= std::min(stats.bytes, it->second.bytes);
+            stats.deleted++;
+            table.erase(it);
+        }
+        switch (type) {
+            case GPU_BUFFER: glDeleteBuffers(1, &name); break;
+            case GPU_VERTEX_ARRAY: glDeleteVertexArrays(1, &name); break;
+            case GPU_TEXTURE: glDeleteTextures(1, &name); break;
+            case GPU_RENDERBUFFER: glDeleteRenderbuffers(1, &name); break;
+            case GPU_FRAMEBUFFER: glDeleteFramebuffers(1, &name); break;
+            default: break;
+        }
+    }
+
+    static void setOwner(GpuResourceType type, GLuint name, const char* owner) {
+        auto it = allocations(type).find(name);
+        if (it != allocations(type).end()) it->second.owner = owner;
+    }
+
+    static const GpuAllocation* find(GpuResourceType type, GLuint name) {
+        auto it = allocations(type).find(name);
+        return it != allocations(type).end() ? &it->second : NULL;
+    }
+
+    static const GpuCategoryStats& category(GpuResourceType type) { return categories()[type]; }
+
+    static size_t totalBytes() {
+        size_t total = 0;
+        for (int t = 0; t < GPU_RESOURCE_TYPE_COUNT; ++t) total += categories()[t].bytes;
+        return total;
+    }
+
+    // Live bytes grouped by owner, largest first
+    static std::vector<std::pair<std::string, size_t>> bytesByOwner() {
+        std::map<std::string, size_t> owners;
+        for (int t = 0; t < GPU_RESOURCE_TYPE_COUNT; ++t) {
+            for (const auto& entry : allocations((GpuResourceType)t)) {
+                owners[entry.second.owner] += entry.second.bytes;
+            }
+        }
+        std::vector<std::pair<std::string, size_t>> sorted(owners.begin(), owners.end());
+        std::sort(sorted.begin(), sorted.end(),
+                  [](const std::pair<std::string, size_t>& a, const std::pair<std::string, size_t>& b) {
+                      return a.second > b.second;
+                  });
+        return sorted;
+    }
+
+    // Query the current size of every tracked buffer, texture and renderbuffer.
+    // Bindings touched here are restored afterwards.
+    static void refreshSizes() {
+        GLint previousCopyBuffer = 0, previousTexture = 0, previousRenderbuffer = 0;
+        glGetIntegerv(GL_COPY_READ_BUFFER_BINDING, &previousCopyBuffer);
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+        glGetIntegerv(GL_RENDERBUFFER_BINDING, &previousRenderbuffer);
+
+        size_t totals[GPU_RESOURCE_TYPE_COUNT] = {};
+        for (auto& entry : allocations(GPU_BUFFER)) {
+            GLint size = 0;
+            glBindBuffer(GL_COPY_READ_BUFFER, entry.first);
+            glGetBufferParameteriv(GL_COPY_READ_BUFFER, GL_BUFFER_SIZE, &size);
+            entry.second.bytes = (size_t)size;
+            totals[GPU_BUFFER] += entry.second.bytes;
+        }
+
+        for (auto& entry : allocations(GPU_TEXTURE)) {
+            glBindTexture(GL_TEXTURE_2D, entry.first);
+            GLint width = 0, height = 0;
+            glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+            glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+            const GLenum channels[] = { GL_TEXTURE_RED_SIZE, GL_TEXTURE_GREEN_SIZE, GL_TEXTURE_BLUE_SIZE,
+                                        GL_TEXTURE_ALPHA_SIZE, GL_TEXTURE_DEPTH_SIZE, GL_TEXTURE_STENCIL_SIZE };
+            entry.second.bytes = (size_t)width * height * texelBits(channels, [](GLenum pname) {
+                GLint bits = 0;
+                glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, pname, &bits);
+                return bits;
+            }) / 8;
+            totals[GPU_TEXTURE] += entry.second.bytes;
+        }
+
+        for (auto& entry : allocations(GPU_RENDERBUFFER)) {
+            glBindRenderbuffer(GL_RENDERBUFFER, entry.first);
+            GLint width = 0, height = 0, samples = 0;
+            glGetRenderbufferParameteriv(GL_RENDERBUFFER, GL_RENDERBUFFER_WIDTH, &width);
+            glGetRenderbufferParameteriv(GL_RENDERBUFFER, GL_RENDERBUFFER_HEIGHT, &height);
+            glGetRenderbufferParameteriv(GL_RENDERBUFFER, GL_RENDERBUFFER_SAMPLES, &samples);
+            const GLenum channels[] = { GL_RENDERBUFFER_RED_SIZE, GL_RENDERBUFFER_GREEN_SIZE, GL_RENDERBUFFER_BLUE_SIZE,
+                                        GL_RENDERBUFFER_ALPHA_SIZE, GL_RENDERBUFFER_DEPTH_SIZE, GL_RENDERBUFFER_STENCIL_SIZE };
+            entry.second.bytes = (size_t)width * height * std::max(samples, 1) * texelBits(channels, [](GLenum pname) {
+                GLint bits = 0;
+                glGetRenderbufferParameteriv(GL_RENDERBUFFER, pname, &bits);
+                return bits;
+            }) / 8;
+            totals[GPU_RENDERBUFFER] += entry.second.bytes;
+        }
+
+        glBindBuffer(GL_COPY_READ_BUFFER, previousCopyBuffer);
+        glBindTexture(GL_TEXTURE_2D, previousTexture);
+        glBindRenderbuffer(GL_RENDERBUFFER, previousRenderbuffer);
+
+        for (int t = 0; t < GPU_RESOURCE_TYPE_COUNT; ++t) {
+            GpuCategoryStats& stats = categories()[t];
+            stats.bytes = totals[t];
+            stats.peakBytes = std::max(stats.peakBytes, stats.bytes);
+        }
+    }
+
+    // Print everything still alive; call after all cleanup, before the context goes away.
+    // Returns the number of leaked objects.
+    static int dumpLeaks(FILE* out) {
+        refreshSizes();
+        int leaks = 0;
+        for (int t = 0; t < GPU_RESOURCE_TYPE_COUNT; ++t) {
+            for (const auto& entry : allocations((GpuResourceType)t)) {
+                const GpuAllocation& alloc = entry.second;
+                fprintf(out, "GPU leak: %s %u, %zu bytes, owner \"%s\", %d reference(s), created at %s:%d\n",
+                        typeName(alloc.type), alloc.name, alloc.bytes, alloc.owner.c_str(),
+                        alloc.references, alloc.file, alloc.line);
+                leaks++;
+            }
+        }
+        if (leaks) fprintf(out, "GPU leak check: %d object(s), %zu bytes still allocated\n", leaks, totalBytes());
+        return leaks;
+    }
+
+private:
+    static std::map<GLuint, GpuAllocation>& allocations(GpuResourceType type) {
+        static std::map<GLuint, GpuAllocation> tables[GPU_RESOURCE_TYPE_COUNT];
+        return tables[type];
+    }
+
+    static GpuCategoryStats* categories() {
+        static GpuCategoryStats stats[GPU_RESOURCE_TYPE_COUNT];
+        return stats;
+    }
+
+    template <typename Query>
+    static size_t texelBits(const GLenum (&channels)[6], Query query) {
+        size_t bits = 0;
+        for (GLenum pname : channels) bits += (size_t)query(pname);
+        return bits;
+    }
+};
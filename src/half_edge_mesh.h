@@ -0,0 +1,706 @@
+// src/half_edge_mesh.h - Editable polygon meshes with incremental GPU updates
+//
+// HalfEdgeMesh keeps connectivity in flat int arrays instead of linked
+// records: per vertex a position, a normal and one outgoing half-edge; per
+// half-edge its origin vertex, twin (-1 on a boundary) and face. The
+// half-edges of a face are stored contiguously and in order, so next and
+// prev are index arithmetic and walking a face stays within a cache line or
+// two. Edits rewrite entries in place and only ever append vertices and
+// faces, so existing indices stay valid.
+//
+// The GPU layout is one vertex per mesh vertex (position and smooth normal,
+// 6 floats) with every face fanned into triangles. Face f's triangles start
+// at index 3 * (faceStart[f] - 2 * f), so a face's index range needs no
+// table. Each edit records the vertex and face ranges it touched in
+// dirtyVertices / dirtyFaces; the editor uploads only those ranges.
+//
+// No OpenGL here.
+
+#pragma once
+
+#include <math.h>
+#include <float.h>
+#include <string.h>
+#include <stdint.h>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+
+// Sorted, disjoint half-open ranges [begin, end). Adjacent and overlapping
+// ranges are merged as they are added; past MAX_RANGES the two closest are
+// joined, uploading a few clean elements to save a call.
+class DirtyRanges {
+public:
+    static const size_t MAX_RANGES = 64;
+
+    struct Range {
+        int begin, end;
+    };
+
+    void add(int begin, int end) {
+        if (begin >= end) return;
+
+        // Edits mostly walk forward through the mesh; extending the last range is the common case
+        if (!list.empty() && begin >= list.back().begin) {
+            if (begin <= list.back().end) {
+                list.back().end = std::max(list.back().end, end);
+                return;
+            }
+            list.push_back(Range{ begin, end });
+            limit();
+            return;
+        }
+
+        auto it = std::lower_bound(list.begin(), list.end(), begin,
+                                   [](const Range& r, int value) { return r.end < value; });
+        if (it == list.end() || it->begin > end) {
+            list.insert(it, Range{ begin, end });
+        } else {
+            it->begin = std::min(it->begin, begin);
+            it->end = std::max(it->end, end);
+            auto last = it + 1;
+            while (last != list.end() && last->begin <= it->end) {
+                it->end = std::max(it->end, last->end);
+                ++last;
+            }
+            list.erase(it + 1, last);
+        }
+        limit();
+    }
+
+    void add(int index) { add(index, index + 1); }
+
+    bool empty() const { return list.empty(); }
+    void clear() { list.clear(); }
+    const std::vector<Range>& ranges() const { return list; }
+
+    // Elements covered by all ranges
+    size_t size() const {
+        size_t total = 0;
+        for (const Range& r : list) total += r.end - r.begin;
+        return total;
+    }
+
+private:
+    std::vector<Range> list;
+
+    void limit() {
+        if (list.size() > MAX_RANGES) {
+            size_t closest = 0;
+            for (size_t i = 1; i + 1 < list.size(); ++i) {
+                if (list[i + 1].begin - list[i].end < list[closest + 1].begin - list[closest].end) closest = i;
+            }
+            list[closest].end = list[closest + 1].end;
+            list.erase(list.begin() + closest + 1);
+        }
+    }
+};
+
+class HalfEdgeMesh {
+public:
+    std::vector<float> positions;       // xyz per vertex
+    std::vector<float> normals;         // xyz per vertex, area-weighted average of its faces
+    std::vector<int> vertexEdge;        // an outgoing half-edge per vertex, -1 if unused
+    std::vector<int> faceStart;         // first half-edge of each face, then one past the last
+    std::vector<int> edgeVertex;        // origin of each half-edge
+    std::vector<int> edgeTwin;          // opposite half-edge, -1 on a boundary
+    std::vector<int> edgeFace;
+
+    DirtyRanges dirtyVertices;
+    DirtyRanges dirtyFaces;
+
+    int vertexCount() const { return static_cast<int>(vertexEdge.size()); }
+    int faceCount() const { return static_cast<int>(faceStart.size()) - 1; }
+    int edgeCount() const { return static_cast<int>(edgeVertex.size()); }
+    int indexCount() const { return indexOffset(faceCount()); }
+
+    int faceSize(int f) const { return faceStart[f + 1] - faceStart[f]; }
+    int indexOffset(int f) const { return 3 * (faceStart[f] - 2 * f); }
+
+    int next(int h) const {
+        int f = edgeFace[h];
+        return h + 1 == faceStart[f + 1] ? faceStart[f] : h + 1;
+    }
+
+    int prev(int h) const {
+        int f = edgeFace[h];
+        return h == faceStart[f] ? faceStart[f + 1] - 1 : h - 1;
+    }
+
+    // Build from a triangle list, welding vertices with identical positions (normals in the
+    // source are replaced by smooth ones). Returns false if no usable triangle is left.
+    bool build(const std::vector<float>& vertices, size_t floatsPerVertex, const std::vector<unsigned int>& indices) {
+        clear();
+        size_t sourceCount = vertices.size() / floatsPerVertex;
+
+        // First occurrence of a position keeps its order, so an optimised fetch order survives
+        struct PositionKey {
+            uint32_t x, y, z;
+            bool operator==(const PositionKey& o) const { return x == o.x && y == o.y && z == o.z; }
+        };
+        struct PositionHash {
+            size_t operator()(const PositionKey& k) const {
+                return (size_t)k.x * 73856093u ^ (size_t)k.y * 19349663u ^ (size_t)k.z * 83492791u;
+            }
+        };
+        std::unordered_map<PositionKey, int, PositionHash> welded;
+        welded.reserve(sourceCount);
+        std::vector<int> remap(sourceCount);
+        for (size_t i = 0; i < sourceCount; ++i) {
+            const float* p = &vertices[i * floatsPerVertex];
+            PositionKey key;
+            memcpy(&key.x, &p[0], 4);
+            memcpy(&key.y, &p[1], 4);
+            memcpy(&key.z, &p[2], 4);
+            auto inserted = welded.insert(std::make_pair(key, vertexCount()));
+            if (inserted.second) {
+                positions.insert(positions.end(), p, p + 3);
+                vertexEdge.push_back(-1);
+            }
+            remap[i] = inserted.first->second;
+        }
+
+        // Room for edits to append to before the first reallocation
+        size_t triangleCount = indices.size() / 3;
+        size_t headroom = triangleCount / 8;
+        edgeVertex.reserve((triangleCount + headroom) * 3);
+        edgeFace.reserve((triangleCount + headroom) * 3);
+        faceStart.reserve(triangleCount + headroom + 1);
+        for (size_t t = 0; t < triangleCount; ++t) {
+            unsigned int i0 = indices[t * 3], i1 = indices[t * 3 + 1], i2 = indices[t * 3 + 2];
+            if (i0 >= sourceCount || i1 >= sourceCount || i2 >= sourceCount) continue;
+            int a = remap[i0], b = remap[i1], c = remap[i2];
+            if (a == b || b == c || a == c) continue;
+            int f = faceCount();
+            edgeVertex.push_back(a);
+            edgeVertex.push_back(b);
+            edgeVertex.push_back(c);
+            edgeFace.insert(edgeFace.end(), 3, f);
+            faceStart.push_back(edgeCount());
+        }
+        if (faceCount() == 0) {
+            clear();
+            return false;
+        }
+
+        positions.reserve(positions.size() + positions.size() / 8);
+        vertexEdge.reserve(vertexEdge.size() + vertexEdge.size() / 8);
+        linkTwins();
+        for (int h = edgeCount() - 1; h >= 0; --h) vertexEdge[edgeVertex[h]] = h;
+
+        // Every face once, rather than once per corner as computeNormal() would
+        normals.reserve(positions.capacity());
+        normals.assign(positions.size(), 0.0f);
+        for (int f = 0; f < faceCount(); ++f) {
+            float n[3];
+            faceNormal(f, n);
+            for (int h = faceStart[f]; h < faceStart[f + 1]; ++h) {
+                float* target = &normals[edgeVertex[h] * 3];
+                target[0] += n[0];
+                target[1] += n[1];
+                target[2] += n[2];
+            }
+        }
+        for (int v = 0; v < vertexCount(); ++v) normalize(&normals[v * 3]);
+        dirtyVertices.clear();
+        dirtyFaces.clear();
+        return true;
+    }
+
+    void clear() {
+        positions.clear();
+        normals.clear();
+        vertexEdge.clear();
+        faceStart.assign(1, 0);
+        edgeVertex.clear();
+        edgeTwin.clear();
+        edgeFace.clear();
+        dirtyVertices.clear();
+        dirtyFaces.clear();
+    }
+
+    // Interleaved position + normal for vertices [begin, end)
+    void writeVertices(int begin, int end, float* out) const {
+        for (int v = begin; v < end; ++v) {
+            memcpy(out, &positions[v * 3], 3 * sizeof(float));
+            memcpy(out + 3, &normals[v * 3], 3 * sizeof(float));
+            out += 6;
+        }
+    }
+
+    // Fanned triangles of faces [begin, end); writes indexOffset(end) - indexOffset(begin) indices
+    void writeIndices(int begin, int end, unsigned int* out) const {
+        for (int f = begin; f < end; ++f) {
+            int first = faceStart[f], last = faceStart[f + 1];
+            for (int h = first + 1; h + 1 < last; ++h) {
+                *out++ = edgeVertex[first];
+                *out++ = edgeVertex[h];
+                *out++ = edgeVertex[h + 1];
+            }
+        }
+    }
+
+    // Newell normal; its length is twice the face's area
+    void faceNormal(int f, float n[3]) const {
+        n[0] = n[1] = n[2] = 0.0f;
+        for (int h = faceStart[f]; h < faceStart[f + 1]; ++h) {
+            const float* a = &positions[edgeVertex[h] * 3];
+            const float* b = &positions[edgeVertex[next(h)] * 3];
+            n[0] += (a[1] - b[1]) * (a[2] + b[2]);
+            n[1] += (a[2] - b[2]) * (a[0] + b[0]);
+            n[2] += (a[0] - b[0]) * (a[1] + b[1]);
+        }
+    }
+
+    // Calls fn(face, outgoingEdge) for every face around v, in either direction across boundaries
+    template <typename Function>
+    void forEachVertexFace(int v, Function fn) const {
+        int start = vertexEdge[v];
+        if (start < 0) return;
+        int h = start;
+        for (;;) {
+            fn(edgeFace[h], h);
+            int t = edgeTwin[prev(h)];
+            if (t < 0) break;
+            if (t == start) return;
+            h = t;
+        }
+        for (h = start;;) {
+            int t = edgeTwin[h];
+            if (t < 0) return;
+            h = next(t);
+            if (h == start) return;
+            fn(edgeFace[h], h);
+        }
+    }
+
+    // Unique vertices of a set of faces
+    std::vector<int> faceVertices(const std::vector<int>& faces) const {
+        std::vector<int> result;
+        beginVisit();
+        for (int f : faces) {
+            for (int h = faceStart[f]; h < faceStart[f + 1]; ++h) {
+                if (visit(edgeVertex[h])) result.push_back(edgeVertex[h]);
+            }
+        }
+        return result;
+    }
+
+    // The faces plus every face sharing an edge with one of them
+    std::vector<int> growFaces(const std::vector<int>& faces) const {
+        std::vector<char> selected(faceCount(), 0);
+        for (int f : faces) selected[f] = 1;
+        std::vector<int> result = faces;
+        for (int f : faces) {
+            for (int h = faceStart[f]; h < faceStart[f + 1]; ++h) {
+                int t = edgeTwin[h];
+                if (t >= 0 && !selected[edgeFace[t]]) {
+                    selected[edgeFace[t]] = 1;
+                    result.push_back(edgeFace[t]);
+                }
+            }
+        }
+        return result;
+    }
+
+    void translate(const std::vector<int>& vertices, const float delta[3]) {
+        for (int v : vertices) {
+            positions[v * 3 + 0] += delta[0];
+            positions[v * 3 + 1] += delta[1];
+            positions[v * 3 + 2] += delta[2];
+        }
+        updateNormalsAround(vertices);
+    }
+
+    // Extrude the faces as one region: vertices on the region's border are split, a quad
+    // joins every border edge to its copy, and the region moves by distance along its
+    // normals. The faces keep their indices and become the cap.
+    void extrudeFaces(const std::vector<int>& faces, float distance) {
+        if (faces.empty()) return;
+        int firstNewVertex = vertexCount();
+        int firstNewFace = faceCount();
+
+        std::vector<char> selected(faceCount(), 0);
+        for (int f : faces) selected[f] = 1;
+
+        // Border edges and the direction each region vertex moves in, before anything changes
+        struct BorderEdge {
+            int edge, from, to, outside;
+        };
+        std::vector<BorderEdge> border;
+        std::unordered_map<int, int> copies;        // border vertex -> its copy
+        std::unordered_map<int, float*> directions;
+        std::vector<float> directionStorage(faceVertices(faces).size() * 3, 0.0f);
+        for (int f : faces) {
+            float n[3];
+            faceNormal(f, n);
+            normalize(n);
+            for (int h = faceStart[f]; h < faceStart[f + 1]; ++h) {
+                int v = edgeVertex[h];
+                auto it = directions.find(v);
+                if (it == directions.end()) {
+                    it = directions.insert(std::make_pair(v, &directionStorage[directions.size() * 3])).first;
+                }
+                for (int k = 0; k < 3; ++k) it->second[k] += n[k];
+
+                int t = edgeTwin[h];
+                if (t < 0 || !selected[edgeFace[t]]) {
+                    border.push_back({ h, v, edgeVertex[next(h)], t });
+                    copies[v] = -1;
+                    copies[edgeVertex[next(h)]] = -1;
+                }
+            }
+        }
+
+        // Border vertices are copied; the region's faces switch to the copies
+        for (auto& entry : copies) {
+            entry.second = vertexCount();
+            float position[3] = { positions[entry.first * 3], positions[entry.first * 3 + 1], positions[entry.first * 3 + 2] };
+            positions.insert(positions.end(), position, position + 3);
+            normals.insert(normals.end(), 3, 0.0f);
+            vertexEdge.push_back(-1);
+        }
+        for (int f : faces) {
+            for (int h = faceStart[f]; h < faceStart[f + 1]; ++h) {
+                auto it = copies.find(edgeVertex[h]);
+                if (it == copies.end()) continue;
+                edgeVertex[h] = it->second;
+                vertexEdge[it->second] = h;
+            }
+            dirtyFaces.add(f);
+        }
+
+        // One quad per border edge: from -> to along the old border, then up the copies
+        std::unordered_map<int, int> upEdges, downEdges;   // vertex -> side edge leaving / reaching it
+        for (const BorderEdge& e : border) {
+            int from = e.from, to = e.to;
+            int fromCopy = copies[from], toCopy = copies[to];
+            int f = faceCount();
+            int s = edgeCount();
+            const int quad[4] = { from, to, toCopy, fromCopy };
+            for (int k = 0; k < 4; ++k) {
+                edgeVertex.push_back(quad[k]);
+                edgeTwin.push_back(-1);
+                edgeFace.push_back(f);
+            }
+            faceStart.push_back(edgeCount());
+
+            edgeTwin[s] = e.outside;
+            if (e.outside >= 0) edgeTwin[e.outside] = s;
+            edgeTwin[s + 2] = e.edge;
+            edgeTwin[e.edge] = s + 2;
+            upEdges[to] = s + 1;
+            downEdges[from] = s + 3;
+            vertexEdge[from] = s;
+        }
+        for (const auto& up : upEdges) {
+            auto down = downEdges.find(up.first);
+            if (down == downEdges.end()) continue;
+            edgeTwin[up.second] = down->second;
+            edgeTwin[down->second] = up.second;
+        }
+
+        // Move the region; copies and interior vertices alike
+        for (const auto& entry : directions) {
+            auto copy = copies.find(entry.first);
+            int v = copy != copies.end() ? copy->second : entry.first;
+            float* d = entry.second;
+            normalize(d);
+            for (int k = 0; k < 3; ++k) positions[v * 3 + k] += d[k] * distance;
+        }
+
+        dirtyVertices.add(firstNewVertex, vertexCount());
+        dirtyFaces.add(firstNewFace, faceCount());
+
+        std::vector<int> changed = faceVertices(faces);
+        for (const auto& entry : copies) changed.push_back(entry.first);
+        updateNormalsAround(changed);
+    }
+
+    // Split the faces in place, leaving the surface where it is: every edge of the region
+    // gets a vertex at its midpoint. A quad becomes four quads around its centroid; any
+    // other face keeps the polygon through its midpoints and gains a triangle per corner.
+    // The faces keep their indices and the new ones are appended. A face outside the
+    // region that shares a split edge takes the midpoint too: the corner at the start of
+    // that edge is cut off as a triangle and the midpoint takes its place, so the face
+    // keeps its size and every edge keeps its twin. Returns one past the last piece of the
+    // region; the triangles cut from outside faces follow it.
+    int subdivideFaces(const std::vector<int>& faces) {
+        if (faces.empty()) return faceCount();
+        int firstNewVertex = vertexCount();
+        int firstNewFace = faceCount();
+
+        std::vector<char> selected(faceCount(), 0);
+        for (int f : faces) selected[f] = 1;
+
+        std::unordered_map<uint64_t, int> midpoints;   // undirected edge -> its midpoint vertex
+        std::unordered_map<int, int> outsideSplits;    // outside half-edge -> its midpoint vertex
+        std::vector<int> neighbours;                   // faces with an outside half-edge, selected[] == 2
+        std::vector<int> corners, split;
+        for (int f : faces) {
+            int first = faceStart[f], n = faceSize(f);
+            corners.resize(n);
+            split.resize(n);
+            for (int i = 0; i < n; ++i) {
+                int h = first + i;
+                int a = edgeVertex[h], b = edgeVertex[next(h)];
+                corners[i] = a;
+                auto inserted = midpoints.insert(std::make_pair(edgeKey(a, b), vertexCount()));
+                if (inserted.second) {
+                    float p[3];
+                    for (int k = 0; k < 3; ++k) p[k] = (positions[a * 3 + k] + positions[b * 3 + k]) * 0.5f;
+                    addVertex(p);
+                }
+                split[i] = inserted.first->second;
+
+                int t = edgeTwin[h];
+                if (t >= 0 && selected[edgeFace[t]] != 1) {
+                    outsideSplits[t] = split[i];
+                    if (!selected[edgeFace[t]]) {
+                        selected[edgeFace[t]] = 2;
+                        neighbours.push_back(edgeFace[t]);
+                    }
+                }
+            }
+
+            if (n == 4) {
+                float center[3] = { 0.0f, 0.0f, 0.0f };
+                for (int i = 0; i < 4; ++i) {
+                    for (int k = 0; k < 3; ++k) center[k] += positions[corners[i] * 3 + k] * 0.25f;
+                }
+                int c = addVertex(center);
+                const int quad[4] = { corners[0], split[0], c, split[3] };
+                for (int k = 0; k < 4; ++k) edgeVertex[first + k] = quad[k];
+                for (int i = 1; i < 4; ++i) {
+                    const int piece[4] = { corners[i], split[i], c, split[i - 1] };
+                    addFace(piece, 4);
+                }
+            } else {
+                for (int i = 0; i < n; ++i) edgeVertex[first + i] = split[i];
+                for (int i = 0; i < n; ++i) {
+                    const int corner[3] = { corners[i], split[i], split[(i + n - 1) % n] };
+                    addFace(corner, 3);
+                }
+            }
+            dirtyFaces.add(f);
+        }
+
+        int piecesEnd = faceCount();
+
+        // Half-edges of the neighbours that lead to untouched faces; those keep their edges
+        std::vector<int> outside;
+        for (int g : neighbours) {
+            for (int h = faceStart[g]; h < faceStart[g + 1]; ++h) {
+                int t = edgeTwin[h];
+                if (t >= 0 && !selected[edgeFace[t]]) outside.push_back(t);
+            }
+        }
+
+        for (int g : neighbours) {
+            int first = faceStart[g], n = faceSize(g);
+            corners.assign(edgeVertex.begin() + first, edgeVertex.begin() + first + n);
+            for (int i = 0; i < n; ++i) {
+                auto m = outsideSplits.find(first + i);
+                if (m == outsideSplits.end()) continue;
+                auto previous = outsideSplits.find(first + (i + n - 1) % n);
+                int before = previous != outsideSplits.end() ? previous->second : corners[(i + n - 1) % n];
+                const int corner[3] = { before, corners[i], m->second };
+                addFace(corner, 3);
+                edgeVertex[first + i] = m->second;
+            }
+            dirtyFaces.add(g);
+        }
+
+        // Every half-edge of the pieces has its twin among the pieces or the untouched faces
+        std::vector<int> pieces = faces;
+        pieces.insert(pieces.end(), neighbours.begin(), neighbours.end());
+        for (int f = firstNewFace; f < faceCount(); ++f) pieces.push_back(f);
+        std::unordered_map<uint64_t, int> directed;
+        for (int f : pieces) {
+            for (int h = faceStart[f]; h < faceStart[f + 1]; ++h) {
+                edgeTwin[h] = -1;
+                vertexEdge[edgeVertex[h]] = h;
+                directed[(uint64_t)(uint32_t)edgeVertex[h] << 32 | (uint32_t)edgeVertex[next(h)]] = h;
+            }
+        }
+        for (int t : outside) {
+            directed[(uint64_t)(uint32_t)edgeVertex[t] << 32 | (uint32_t)edgeVertex[next(t)]] = t;
+        }
+        for (int f : pieces) {
+            for (int h = faceStart[f]; h < faceStart[f + 1]; ++h) {
+                auto t = directed.find((uint64_t)(uint32_t)edgeVertex[next(h)] << 32 | (uint32_t)edgeVertex[h]);
+                if (t != directed.end()) {
+                    edgeTwin[h] = t->second;
+                    edgeTwin[t->second] = h;
+                }
+            }
+        }
+
+        dirtyVertices.add(firstNewVertex, vertexCount());
+        dirtyFaces.add(firstNewFace, faceCount());
+        updateNormalsAround(faceVertices(pieces));
+        return piecesEnd;
+    }
+
+    // Nearest face hit by the ray, or -1; distance is in units of direction's length
+    int pickFace(const float origin[3], const float direction[3], float* hitDistance = NULL) const {
+        int best = -1;
+        float bestT = FLT_MAX;
+        for (int f = 0; f < faceCount(); ++f) {
+            int first = faceStart[f];
+            const float* p0 = &positions[edgeVertex[first] * 3];
+            for (int h = first + 1; h + 1 < faceStart[f + 1]; ++h) {
+                float t;
+                if (intersectTriangle(origin, direction, p0, &positions[edgeVertex[h] * 3],
+                                      &positions[edgeVertex[h + 1] * 3], t) && t < bestT) {
+                    bestT = t;
+                    best = f;
+                }
+            }
+        }
+        if (hitDistance) *hitDistance = bestT;
+        return best;
+    }
+
+    void bounds(float minimum[3], float maximum[3]) const {
+        for (int k = 0; k < 3; ++k) {
+            minimum[k] = FLT_MAX;
+            maximum[k] = -FLT_MAX;
+        }
+        for (int v = 0; v < vertexCount(); ++v) {
+            for (int k = 0; k < 3; ++k) {
+                minimum[k] = std::min(minimum[k], positions[v * 3 + k]);
+                maximum[k] = std::max(maximum[k], positions[v * 3 + k]);
+            }
+        }
+    }
+
+private:
+    mutable std::vector<uint32_t> visitStamp;
+    mutable uint32_t currentStamp = 0;
+
+    // Visit marks without clearing a vertex-sized array for every query
+    void beginVisit() const {
+        visitStamp.resize(vertexEdge.size(), 0);
+        if (++currentStamp == 0) {
+            std::fill(visitStamp.begin(), visitStamp.end(), 0);
+            currentStamp = 1;
+        }
+    }
+
+    bool visit(int v) const {
+        if (visitStamp[v] == currentStamp) return false;
+        visitStamp[v] = currentStamp;
+        return true;
+    }
+
+    static uint64_t edgeKey(int a, int b) {
+        uint64_t lo = (uint32_t)std::min(a, b), hi = (uint32_t)std::max(a, b);
+        return lo << 32 | hi;
+    }
+
+    // Appended with no half-edge yet and a zero normal; the caller links and shades it
+    int addVertex(const float position[3]) {
+        positions.insert(positions.end(), position, position + 3);
+        normals.insert(normals.end(), 3, 0.0f);
+        vertexEdge.push_back(-1);
+        return vertexCount() - 1;
+    }
+
+    // Appended with no twins
+    int addFace(const int* vertices, int count) {
+        int f = faceCount();
+        for (int k = 0; k < count; ++k) {
+            edgeVertex.push_back(vertices[k]);
+            edgeTwin.push_back(-1);
+            edgeFace.push_back(f);
+        }
+        faceStart.push_back(edgeCount());
+        return f;
+    }
+
+    static void normalize(float v[3]) {
+        float length = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+        if (length > 0.0f) {
+            v[0] /= length;
+            v[1] /= length;
+            v[2] /= length;
+        }
+    }
+
+    // Twins by sorting undirected edge keys; an edge used by anything but exactly two
+    // opposite half-edges is left as a boundary
+    void linkTwins() {
+        edgeTwin.reserve(edgeVertex.capacity());
+        edgeTwin.assign(edgeVertex.size(), -1);
+        std::vector<std::pair<uint64_t, int>> keys(edgeVertex.size());
+        for (int h = 0; h < edgeCount(); ++h) {
+            uint64_t a = (uint32_t)edgeVertex[h], b = (uint32_t)edgeVertex[next(h)];
+            keys[h] = std::make_pair(a < b ? (a << 32 | b) : (b << 32 | a), h);
+        }
+        std::sort(keys.begin(), keys.end());
+        for (size_t i = 0; i < keys.size();) {
+            size_t j = i + 1;
+            while (j < keys.size() && keys[j].first == keys[i].first) ++j;
+            if (j - i == 2) {
+                int h0 = keys[i].second, h1 = keys[i + 1].second;
+                if (edgeVertex[h0] != edgeVertex[h1]) {
+                    edgeTwin[h0] = h1;
+                    edgeTwin[h1] = h0;
+                }
+            }
+            i = j;
+        }
+    }
+
+    void computeNormal(int v) {
+        float sum[3] = { 0.0f, 0.0f, 0.0f };
+        forEachVertexFace(v, [&](int f, int) {
+            float n[3];
+            faceNormal(f, n);
+            sum[0] += n[0];
+            sum[1] += n[1];
+            sum[2] += n[2];
+        });
+        normalize(sum);
+        memcpy(&normals[v * 3], sum, sizeof(sum));
+        dirtyVertices.add(v);
+    }
+
+    // Recompute the normals of the vertices and of everything sharing a face with them
+    void updateNormalsAround(const std::vector<int>& vertices) {
+        std::vector<int> affected;
+        beginVisit();
+        for (int v : vertices) {
+            forEachVertexFace(v, [&](int f, int) {
+                for (int h = faceStart[f]; h < faceStart[f + 1]; ++h) {
+                    if (visit(edgeVertex[h])) affected.push_back(edgeVertex[h]);
+                }
+            });
+            if (visit(v)) affected.push_back(v);
+        }
+
+        // In index order, so neighbouring vertices land in the same dirty range
+        std::sort(affected.begin(), affected.end());
+        for (int v : affected) computeNormal(v);
+    }
+
+    // Moller-Trumbore, front and back faces
+    static bool intersectTriangle(const float o[3], const float d[3], const float* a, const float* b,
+                                  const float* c, float& t) {
+        float e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+        float e2[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+        float p[3] = { d[1] * e2[2] - d[2] * e2[1], d[2] * e2[0] - d[0] * e2[2], d[0] * e2[1] - d[1] * e2[0] };
+        float det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+        if (fabsf(det) < 1e-12f) return false;
+        float inverse = 1.0f / det;
+        float s[3] = { o[0] - a[0], o[1] - a[1], o[2] - a[2] };
+        float u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * inverse;
+        if (u < 0.0f || u > 1.0f) return false;
+        float q[3] = { s[1] * e1[2] - s[2] * e1[1], s[2] * e1[0] - s[0] * e1[2], s[0] * e1[1] - s[1] * e1[0] };
+        float v = (d[0] * q[0] + d[1] * q[1] + d[2] * q[2]) * inverse;
+        if (v < 0.0f || u + v > 1.0f) return false;
+        t = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) * inverse;
+        return t > 0.0f;
+    }
+};
@@ -0,0 +1,249 @@
+// src/hlod.h - Merged, simplified proxies for clusters of small static objects
+//
+// A scene full of small props costs one draw per prop, even where a whole
+// group of them covers a few pixels. Static objects are grouped by the cell of
+// a uniform world grid that their bounding sphere's center falls in, and each
+// group gets one proxy mesh: the members' triangles moved to world space,
+// merged, and simplified by vertex clustering, with every member's color baked
+// into its vertices. A renderer draws the proxy instead of the members once the
+// cluster is small enough on screen.
+//
+// Grid cells keep membership local: an object that moves changes at most its
+// old and its new cluster, so only those two proxies are rebuilt. Objects too
+// large for a cell are left out and always drawn as they are.
+//
+// HlodBuilder::build() depends on nothing but its members and runs on a worker.
+// No OpenGL here.
+
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+
+struct HlodSettings {
+    float cellSize = 8.0f;                  // world units
+    int minMembers = 4;                     // smaller groups are not worth a proxy
+    int proxyGrid = 32;                     // first clustering resolution tried across a cluster
+    int maxTriangles = 4096;                // per proxy; the grid is halved until it fits
+};
+
+// One object of a cluster. The mesh is position + normal, 6 floats per vertex,
+// and must stay alive until build() returns.
+struct HlodMember {
+    const float* vertices = NULL;
+    size_t vertexCount = 0;
+    const unsigned int* indices = NULL;
+    size_t indexCount = 0;
+    float model[16];                        // column-major
+    float color[3];
+};
+
+struct HlodProxy {
+    std::vector<float> vertices;            // world-space position, normal, color
+    std::vector<unsigned int> indices;
+    float center[3] = { 0.0f, 0.0f, 0.0f }; // bounding sphere of the vertices
+    float radius = 0.0f;
+    float error = 0.0f;                     // clustering cell diagonal, world units
+    size_t sourceTriangles = 0;
+};
+
+class HlodBuilder {
+public:
+    static const int FLOATS_PER_VERTEX = 9;
+    static const int KEY_BITS = 21;         // per axis of a cell key
+    static const int MAX_GRID = 128;        // cell numbers stay below 2^21 for the repeat test
+
+    // Cell a bounding sphere center falls in, packed into one key
+    static uint64_t cellKey(const float center[3], float cellSize) {
+        const int64_t limit = (int64_t(1) << (KEY_BITS - 1)) - 1;
+        uint64_t key = 0;
+        for (int k = 0; k < 3; ++k) {
+            int64_t cell = static_cast<int64_t>(floorf(center[k] / cellSize));
+            cell = std::min(std::max(cell, -limit), limit);
+            key = (key << KEY_BITS) | static_cast<uint64_t>(cell + limit);
+        }
+        return key;
+    }
+
+    // Objects larger than half a cell stay out of clusters; a proxy would hide them too early
+    static bool fitsCell(float radius, const HlodSettings& settings) {
+        return radius <= settings.cellSize * 0.5f;
+    }
+
+    static void build(const std::vector<HlodMember>& members, const HlodSettings& settings, HlodProxy& proxy) {
+        proxy = HlodProxy();
+
+        // Members in world space; normals through the cofactor matrix, flipped for mirrored transforms
+        std::vector<float> positions, normals, colors;
+        std::vector<unsigned int> corners;
+        float boundsMin[3] = { INFINITY, INFINITY, INFINITY }, boundsMax[3] = { -INFINITY, -INFINITY, -INFINITY };
+        for (const HlodMember& member : members) {
+            const float* m = member.model;
+            float normalMatrix[9];
+            normalMatrix[0] = m[5] * m[10] - m[9] * m[6];
+            normalMatrix[1] = m[8] * m[6] - m[4] * m[10];
+            normalMatrix[2] = m[4] * m[9] - m[8] * m[5];
+            normalMatrix[3] = m[9] * m[2] - m[1] * m[10];
+            normalMatrix[4] = m[0] * m[10] - m[8] * m[2];
+            normalMatrix[5] = m[8] * m[1] - m[0] * m[9];
+            normalMatrix[6] = m[1] * m[6] - m[5] * m[2];
+            normalMatrix[7] = m[4] * m[2] - m[0] * m[6];
+            normalMatrix[8] = m[0] * m[5] - m[4] * m[1];
+            float det = m[0] * normalMatrix[0] + m[4] * normalMatrix[3] + m[8] * normalMatrix[6];
+            float handedness = det < 0.0f ? -1.0f : 1.0f;
+
+            unsigned int base = static_cast<unsigned int>(positions.size() / 3);
+            for (size_t v = 0; v < member.vertexCount; ++v) {
+                const float* p = member.vertices + v * 6;
+                const float* n = p + 3;
+                float world[3], normal[3];
+                for (int k = 0; k < 3; ++k) {
+                    world[k] = m[k] * p[0] + m[4 + k] * p[1] + m[8 + k] * p[2] + m[12 + k];
+                    normal[k] = (normalMatrix[k] * n[0] + normalMatrix[3 + k] * n[1] + normalMatrix[6 + k] * n[2]) *
+                                handedness;
+                    boundsMin[k] = std::min(boundsMin[k], world[k]);
+                    boundsMax[k] = std::max(boundsMax[k], world[k]);
+                }
+                float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+                if (length > 0.0f) {
+                    for (int k = 0; k < 3; ++k) normal[k] /= length;
+                }
+                positions.insert(positions.end(), world, world + 3);
+                normals.insert(normals.end(), normal, normal + 3);
+                colors.insert(colors.end(), member.color, member.color + 3);
+            }
+            for (size_t i = 0; i + 2 < member.indexCount; i += 3) {
+                const unsigned int* triangle = member.indices + i;
+                if (triangle[0] >= member.vertexCount || triangle[1] >= member.vertexCount ||
+                    triangle[2] >= member.vertexCount) continue;
+                for (int c = 0; c < 3; ++c) corners.push_back(base + triangle[c]);
+            }
+        }
+        proxy.sourceTriangles = corners.size() / 3;
+        if (corners.empty()) return;
+
+        // Cube around the cluster, so cells are cubes as well
+        float boundsSize = 0.0f;
+        for (int k = 0; k < 3; ++k) boundsSize = std::max(boundsSize, boundsMax[k] - boundsMin[k]);
+        boundsSize = std::max(boundsSize, 1e-6f);
+
+        // Coarsen until the proxy fits; the cell diagonal bounds the error
+        std::vector<unsigned int> cellOf, triangles;
+        int cellCount = 0;
+        int grid = std::max(1, settings.proxyGrid);
+        if (grid > MAX_GRID) grid = MAX_GRID;
+        for (;; grid /= 2) {
+            cellCount = clusterVertices(positions, boundsMin, boundsSize, grid, cellOf);
+            collapseTriangles(corners, cellOf, triangles);
+            if (triangles.size() / 3 <= static_cast<size_t>(settings.maxTriangles) || grid == 1) break;
+        }
+        if (triangles.size() / 3 > static_cast<size_t>(settings.maxTriangles)) {
+            triangles.resize(static_cast<size_t>(settings.maxTriangles) * 3);
+        }
+        proxy.error = boundsSize / grid * 1.7320508f;
+
+        // Every cell becomes the average of the vertices in it; only cells a triangle uses are kept
+        std::vector<float> sums(static_cast<size_t>(cellCount) * 9, 0.0f);
+        std::vector<unsigned int> counts(cellCount, 0);
+        for (size_t v = 0; v < cellOf.size(); ++v) {
+            float* sum = &sums[static_cast<size_t>(cellOf[v]) * 9];
+            for (int k = 0; k < 3; ++k) {
+                sum[k] += positions[v * 3 + k];
+                sum[3 + k] += normals[v * 3 + k];
+                sum[6 + k] += colors[v * 3 + k];
+            }
+            counts[cellOf[v]]++;
+        }
+        std::vector<int> output(cellCount, -1);
+        for (unsigned int& corner : triangles) {
+            if (output[corner] < 0) {
+                output[corner] = static_cast<int>(proxy.vertices.size() / FLOATS_PER_VERTEX);
+                const float* sum = &sums[static_cast<size_t>(corner) * 9];
+                for (int k = 0; k < 9; ++k) proxy.vertices.push_back(sum[k] / counts[corner]);
+            }
+            corner = static_cast<unsigned int>(output[corner]);
+        }
+        proxy.indices.swap(triangles);
+
+        // Opposite sides of a thin part share a cell and cancel out; those take the normal
+        // of the proxy's own triangles instead
+        size_t vertexCount = proxy.vertices.size() / FLOATS_PER_VERTEX;
+        std::vector<float> faceNormals(vertexCount * 3, 0.0f);
+        for (size_t i = 0; i + 2 < proxy.indices.size(); i += 3) {
+            const float* a = &proxy.vertices[proxy.indices[i] * FLOATS_PER_VERTEX];
+            const float* b = &proxy.vertices[proxy.indices[i + 1] * FLOATS_PER_VERTEX];
+            const float* c = &proxy.vertices[proxy.indices[i + 2] * FLOATS_PER_VERTEX];
+            float e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+            float e2[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+            float cross[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+            for (int j = 0; j < 3; ++j) {
+                for (int k = 0; k < 3; ++k) faceNormals[proxy.indices[i + j] * 3 + k] += cross[k];
+            }
+        }
+        for (size_t v = 0; v < vertexCount; ++v) {
+            float* normal = &proxy.vertices[v * FLOATS_PER_VERTEX + 3];
+            float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            if (length < 0.25f) {
+                memcpy(normal, &faceNormals[v * 3], 3 * sizeof(float));
+                length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            }
+            if (length > 0.0f) {
+                for (int k = 0; k < 3; ++k) normal[k] /= length;
+            } else {
+                normal[0] = 0.0f;
+                normal[1] = 1.0f;
+                normal[2] = 0.0f;
+            }
+        }
+
+        for (int k = 0; k < 3; ++k) proxy.center[k] = (boundsMin[k] + boundsMax[k]) * 0.5f;
+        float radiusSquared = 0.0f;
+        for (size_t v = 0; v < vertexCount; ++v) {
+            const float* p = &proxy.vertices[v * FLOATS_PER_VERTEX];
+            float d[3] = { p[0] - proxy.center[0], p[1] - proxy.center[1], p[2] - proxy.center[2] };
+            radiusSquared = std::max(radiusSquared, d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+        }
+        proxy.radius = sqrtf(radiusSquared);
+    }
+
+private:
+    // Cell of every vertex on a grid across the bounding cube, numbered densely; returns the cell count
+    static int clusterVertices(const std::vector<float>& positions, const float boundsMin[3], float boundsSize,
+                               int grid, std::vector<unsigned int>& cellOf) {
+        std::unordered_map<uint32_t, unsigned int> cellIndex;
+        cellOf.resize(positions.size() / 3);
+        float scale = grid / boundsSize;
+        for (size_t v = 0; v < cellOf.size(); ++v) {
+            const float* p = &positions[v * 3];
+            uint32_t cell = 0;
+            for (int k = 2; k >= 0; --k) {
+                int coordinate = static_cast<int>((p[k] - boundsMin[k]) * scale);
+                coordinate = std::min(std::max(coordinate, 0), grid - 1);
+                cell = cell * grid + static_cast<uint32_t>(coordinate);
+            }
+            auto inserted = cellIndex.emplace(cell, static_cast<unsigned int>(cellIndex.size()));
+            cellOf[v] = inserted.first->second;
+        }
+        return static_cast<int>(cellIndex.size());
+    }
+
+    // Triangles with their corners moved to cells; collapsed ones and repeats (of any winding) are dropped
+    static void collapseTriangles(const std::vector<unsigned int>& corners, const std::vector<unsigned int>& cellOf,
+                                  std::vector<unsigned int>& triangles) {
+        std::unordered_set<uint64_t> seen;
+        triangles.clear();
+        for (size_t i = 0; i + 2 < corners.size(); i += 3) {
+            unsigned int a = cellOf[corners[i]], b = cellOf[corners[i + 1]], c = cellOf[corners[i + 2]];
+            if (a == b || b == c || a == c) continue;
+            uint64_t sorted[3] = { a, b, c };
+            std::sort(sorted, sorted + 3);
+            if (!seen.insert((sorted[0] << 42) | (sorted[1] << 21) | sorted[2]).second) continue;
+            triangles.insert(triangles.end(), { a, b, c });
+        }
+    }
+};
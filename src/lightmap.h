@@ -0,0 +1,566 @@
+// src/lightmap.h - Baked lightmaps with automatic UV charts
+//
+// LightmapBaker gives an object a lightmap block of its own: texels covering
+// each triangle once, holding the irradiance that arrives there (direct light,
+// one bounce of indirect light and sky light).
+//
+// Unwrapping works on the object in world space. Every triangle goes to the
+// axis its normal points along most (+X, -X, ... -Z), triangles of one axis
+// sharing an edge form a chart, and each chart is projected flat onto its
+// axis' plane. All charts share one texel density (texelsPerUnit, lowered until
+// the block fits maxBlockSize), keep CHART_PADDING texels clear around them so
+// bilinear filtering never reads a neighbour, and are shelf-packed tallest
+// first. Vertices on a chart border are duplicated, one copy per chart.
+//
+// Baking rasterizes the charts into texels and traces rays from every texel
+// against a prepared PathTracer scene, whose trees serve as the BVH: a shadow
+// ray to the point light, then `samples` cosine-weighted rays that either see
+// the sky or, with indirect light on, pick up what the surface they hit
+// reflects. Rows are handed out to one worker per core; texels no triangle
+// covers are filled from their neighbours afterwards.
+//
+// A bake is keyed by a hash of what goes into it (the object's mesh and
+// transform, the light, the settings) and saved as an .lmap file, so an object
+// that has not changed loads its bake instead of tracing it again. Other
+// objects are not part of the key: moving one leaves the shadows it casts on
+// its neighbours stale until they are rebaked. packShelves() also places the
+// blocks of several objects in one atlas. No OpenGL here.
+
+#pragma once
+
+#include <math.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "path_tracer.h"
+
+static const char LMAP_MAGIC[4] = { 'L', 'M', 'A', 'P' };
+static const uint32_t LMAP_VERSION = 1;
+
+struct LightmapFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t key;
+    int32_t width;
+    int32_t height;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t chartCount;
+    float texelsPerUnit;
+};
+
+struct LightmapSettings {
+    float texelsPerUnit = 16.0f;
+    int maxBlockSize = 512;                 // texels per side of one object's block
+    int samples = 64;                       // hemisphere rays per texel
+    bool indirect = true;                   // one bounce; without it only sky occlusion
+    float aoDistance = 2.0f;                // range of the sky occlusion rays without indirect light
+};
+
+struct LightmapBake {
+    uint64_t key = 0;
+    int width = 0;
+    int height = 0;
+    int chartCount = 0;
+    float texelsPerUnit = 0.0f;             // after fitting maxBlockSize
+    std::vector<float> vertices;            // object-space position, normal, lightmap uv in [0, 1] of the block
+    std::vector<unsigned int> indices;
+    std::vector<float> texels;              // RGB irradiance, row 0 at v = 0
+};
+
+class LightmapBaker {
+public:
+    static const int FLOATS_PER_VERTEX = 8;
+    static const int CHART_PADDING = 2;
+
+    // Everything a bake depends on; vertices are position + normal, model is column-major
+    static uint64_t bakeKey(const float* vertices, size_t vertexCount, const unsigned int* indices, size_t indexCount,
+                            const float* model, const PathTracer::Settings& light, const LightmapSettings& settings) {
+        uint64_t hash = 1469598103934665603ull;
+        auto mix = [&hash](const void* data, size_t bytes) {
+            const uint8_t* p = static_cast<const uint8_t*>(data);
+            for (size_t i = 0; i < bytes; ++i) {
+                hash ^= p[i];
+                hash *= 1099511628211ull;
+            }
+        };
+        uint32_t version = LMAP_VERSION;
+        uint8_t indirect = settings.indirect ? 1 : 0;
+        mix(&version, sizeof(version));
+        mix(vertices, vertexCount * 6 * sizeof(float));
+        mix(indices, indexCount * sizeof(unsigned int));
+        mix(model, 16 * sizeof(float));
+        mix(light.lightPosition, sizeof(light.lightPosition));
+        mix(light.lightColor, sizeof(light.lightColor));
+        mix(light.skyColor, sizeof(light.skyColor));
+        mix(&settings.texelsPerUnit, sizeof(settings.texelsPerUnit));
+        mix(&settings.maxBlockSize, sizeof(settings.maxBlockSize));
+        mix(&settings.samples, sizeof(settings.samples));
+        mix(&indirect, sizeof(indirect));
+        mix(&settings.aoDistance, sizeof(settings.aoDistance));
+        return hash;
+    }
+
+    // Charts and lightmap uvs for an object. Fills everything in out but key and texels.
+    // False for an empty mesh, bad indices, or charts too many to fit maxBlockSize.
+    static bool unwrap(const float* vertices, size_t vertexCount, const unsigned int* indices, size_t indexCount,
+                       const float* model, const LightmapSettings& settings, LightmapBake& out) {
+        size_t triangleCount = indexCount / 3;
+        if (triangleCount == 0 || vertexCount == 0) return false;
+        for (size_t i = 0; i < triangleCount * 3; ++i) {
+            if (indices[i] >= vertexCount) return false;
+        }
+
+        std::vector<float> world(vertexCount * 3);
+        for (size_t v = 0; v < vertexCount; ++v) transformPoint(model, vertices + v * 6, &world[v * 3]);
+
+        // Vertices split for normals still join their triangles: weld by world position
+        std::vector<unsigned int> order(vertexCount);
+        for (size_t i = 0; i < vertexCount; ++i) order[i] = static_cast<unsigned int>(i);
+        std::sort(order.begin(), order.end(), [&world](unsigned int a, unsigned int b) {
+            return std::lexicographical_compare(&world[a * 3], &world[a * 3] + 3, &world[b * 3], &world[b * 3] + 3);
+        });
+        std::vector<unsigned int> weld(vertexCount);
+        unsigned int welded = 0;
+        for (size_t i = 0; i < vertexCount; ++i) {
+            if (i > 0 && !std::equal(&world[order[i] * 3], &world[order[i] * 3] + 3, &world[order[i - 1] * 3])) welded++;
+            weld[order[i]] = welded;
+        }
+
+        // Dominant axis of every triangle: 0..5 for +X, -X, +Y, -Y, +Z, -Z
+        std::vector<uint8_t> axis(triangleCount);
+        for (size_t t = 0; t < triangleCount; ++t) {
+            const float* p0 = &world[indices[t * 3] * 3];
+            const float* p1 = &world[indices[t * 3 + 1] * 3];
+            const float* p2 = &world[indices[t * 3 + 2] * 3];
+            float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+            float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+            float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+            int k = 0;
+            if (fabsf(n[1]) > fabsf(n[k])) k = 1;
+            if (fabsf(n[2]) > fabsf(n[k])) k = 2;
+            axis[t] = static_cast<uint8_t>(k * 2 + (n[k] < 0.0f ? 1 : 0));
+        }
+
+        // Triangles of one axis sharing an edge end up in one chart
+        std::vector<unsigned int> parent(triangleCount);
+        for (size_t t = 0; t < triangleCount; ++t) parent[t] = static_cast<unsigned int>(t);
+        auto find = [&parent](unsigned int t) {
+            while (parent[t] != t) {
+                parent[t] = parent[parent[t]];
+                t = parent[t];
+            }
+            return t;
+        };
+        std::vector<std::pair<uint64_t, unsigned int>> edges;
+        edges.reserve(triangleCount * 3);
+        for (size_t t = 0; t < triangleCount; ++t) {
+            for (int e = 0; e < 3; ++e) {
+                uint64_t a = weld[indices[t * 3 + e]], b = weld[indices[t * 3 + (e + 1) % 3]];
+                if (a == b) continue;
+                edges.push_back({ std::min(a, b) << 32 | std::max(a, b), static_cast<unsigned int>(t) });
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+        for (size_t begin = 0, end; begin < edges.size(); begin = end) {
+            for (end = begin + 1; end < edges.size() && edges[end].first == edges[begin].first; ++end) {}
+            for (size_t i = begin; i < end; ++i) {
+                for (size_t j = i + 1; j < end; ++j) {
+                    if (axis[edges[i].second] != axis[edges[j].second]) continue;
+                    unsigned int a = find(edges[i].second), b = find(edges[j].second);
+                    if (a != b) parent[std::max(a, b)] = std::min(a, b);
+                }
+            }
+        }
+
+        // Number the charts and find their extent on their planes
+        std::vector<Chart> charts;
+        std::vector<int> chartOf(triangleCount);
+        std::vector<int> rootChart(triangleCount, -1);
+        for (size_t t = 0; t < triangleCount; ++t) {
+            unsigned int root = find(static_cast<unsigned int>(t));
+            if (rootChart[root] < 0) {
+                rootChart[root] = static_cast<int>(charts.size());
+                Chart chart;
+                chart.axis = axis[t] / 2;
+                charts.push_back(chart);
+            }
+            Chart& chart = charts[rootChart[root]];
+            chartOf[t] = rootChart[root];
+            for (int c = 0; c < 3; ++c) {
+                float uv[2];
+                planeCoordinates(chart.axis, &world[indices[t * 3 + c] * 3], uv);
+                for (int k = 0; k < 2; ++k) {
+                    chart.min[k] = std::min(chart.min[k], uv[k]);
+                    chart.max[k] = std::max(chart.max[k], uv[k]);
+                }
+            }
+        }
+
+        // Lower the density until every chart fits in one block
+        int maxSize = std::max(8, settings.maxBlockSize);
+        float density = settings.texelsPerUnit > 0.0f ? settings.texelsPerUnit : 1.0f;
+        std::vector<int> widths(charts.size()), heights(charts.size()), x, y;
+        int blockWidth = 0, blockHeight = 0;
+        for (int attempt = 0;; ++attempt) {
+            if (attempt == 24) return false;
+            bool fits = true;
+            double area = 0.0;
+            int widest = 0;
+            for (size_t c = 0; c < charts.size() && fits; ++c) {
+                float w = ceilf((charts[c].max[0] - charts[c].min[0]) * density);
+                float h = ceilf((charts[c].max[1] - charts[c].min[1]) * density);
+                fits = w + 2 * CHART_PADDING <= maxSize && h + 2 * CHART_PADDING <= maxSize;
+                widths[c] = std::max(1, static_cast<int>(w)) + 2 * CHART_PADDING;
+                heights[c] = std::max(1, static_cast<int>(h)) + 2 * CHART_PADDING;
+                area += static_cast<double>(widths[c]) * heights[c];
+                widest = std::max(widest, widths[c]);
+            }
+            if (fits) {
+                int shelf = std::min(maxSize, std::max(widest, static_cast<int>(ceil(sqrt(area) * 1.1))));
+                blockHeight = packShelves(widths, heights, shelf, x, y);
+                blockWidth = 0;
+                for (size_t c = 0; c < charts.size(); ++c) blockWidth = std::max(blockWidth, x[c] + widths[c]);
+                if (blockHeight <= maxSize) break;
+            }
+            density *= 0.8f;
+        }
+        for (size_t c = 0; c < charts.size(); ++c) {
+            charts[c].x = x[c];
+            charts[c].y = y[c];
+        }
+
+        // One vertex per (vertex, chart) it is used in
+        out.width = blockWidth;
+        out.height = blockHeight;
+        out.chartCount = static_cast<int>(charts.size());
+        out.texelsPerUnit = density;
+        out.vertices.clear();
+        out.indices.resize(triangleCount * 3);
+        std::unordered_map<uint64_t, unsigned int> split;
+        split.reserve(triangleCount * 3);
+        for (size_t t = 0; t < triangleCount; ++t) {
+            const Chart& chart = charts[chartOf[t]];
+            for (int c = 0; c < 3; ++c) {
+                unsigned int v = indices[t * 3 + c];
+                unsigned int next = static_cast<unsigned int>(out.vertices.size() / FLOATS_PER_VERTEX);
+                auto inserted = split.emplace(static_cast<uint64_t>(chartOf[t]) << 32 | v, next);
+                out.indices[t * 3 + c] = inserted.first->second;
+                if (!inserted.second) continue;
+
+                float uv[2];
+                planeCoordinates(chart.axis, &world[v * 3], uv);
+                out.vertices.insert(out.vertices.end(), vertices + v * 6, vertices + v * 6 + 6);
+                out.vertices.push_back((chart.x + CHART_PADDING + (uv[0] - chart.min[0]) * density) / blockWidth);
+                out.vertices.push_back((chart.y + CHART_PADDING + (uv[1] - chart.min[1]) * density) / blockHeight);
+            }
+        }
+        return true;
+    }
+
+    // Fill target.texels for an unwrapped object, tracing against a prepared scene that holds the
+    // object too (for its own shadows); model must be the transform it was unwrapped with.
+    // rowsDone counts finished rows of texels. False if cancelled.
+    static bool bake(const PathTracer& scene, const float* model, const LightmapSettings& settings,
+                     LightmapBake& target, const std::atomic<bool>* cancel = nullptr,
+                     std::atomic<int>* rowsDone = nullptr) {
+        const int width = target.width, height = target.height;
+        const size_t texelCount = static_cast<size_t>(width) * height;
+        std::vector<float> samplePoints(texelCount * 6);     // world position and normal
+        std::vector<uint8_t> covered(texelCount, 0);
+        rasterize(target, model, samplePoints, covered);
+
+        const PathTracer::Settings light = scene.getSettings();
+        const float offset = scene.surfaceOffset();
+        const int samples = std::max(1, settings.samples);
+        target.texels.assign(texelCount * 3, 0.0f);
+
+        std::atomic<int> nextRow{0};
+        std::atomic<bool> stopped{false};
+        auto work = [&]() {
+            for (int row; (row = nextRow++) < height;) {
+                if (cancel && *cancel) {
+                    stopped = true;
+                    return;
+                }
+                for (int column = 0; column < width; ++column) {
+                    size_t texel = static_cast<size_t>(row) * width + column;
+                    if (!covered[texel]) continue;
+                    const float* position = &samplePoints[texel * 6];
+                    const float* normal = position + 3;
+                    float origin[3];
+                    for (int k = 0; k < 3; ++k) origin[k] = position[k] + normal[k] * offset;
+
+                    float irradiance[3] = { 0.0f, 0.0f, 0.0f };
+                    directLight(scene, light, origin, normal, irradiance);
+
+                    float gathered[3] = { 0.0f, 0.0f, 0.0f };
+                    uint32_t rng = PathTracer::hashSeed(static_cast<uint32_t>(texel), static_cast<uint32_t>(target.key));
+                    for (int s = 0; s < samples; ++s) {
+                        float direction[3];
+                        PathTracer::sampleHemisphere(normal, rng, direction);
+                        if (!settings.indirect) {
+                            if (!scene.occluded(origin, direction, settings.aoDistance)) {
+                                for (int k = 0; k < 3; ++k) gathered[k] += light.skyColor[k];
+                            }
+                            continue;
+                        }
+                        PathTracer::RayHit hit;
+                        if (!scene.traceRay(origin, direction, hit)) {
+                            for (int k = 0; k < 3; ++k) gathered[k] += light.skyColor[k];
+                            continue;
+                        }
+                        // What the hit surface reflects: its direct light plus an unoccluded sky
+                        float bounce[3] = { light.skyColor[0], light.skyColor[1], light.skyColor[2] };
+                        float hitOrigin[3];
+                        for (int k = 0; k < 3; ++k) hitOrigin[k] = hit.position[k] + hit.normal[k] * offset;
+                        directLight(scene, light, hitOrigin, hit.normal, bounce);
+                        for (int k = 0; k < 3; ++k) gathered[k] += hit.albedo[k] * bounce[k];
+                    }
+
+                    float* out = &target.texels[texel * 3];
+                    for (int k = 0; k < 3; ++k) out[k] = irradiance[k] + gathered[k] / samples;
+                }
+                if (rowsDone) (*rowsDone)++;
+            }
+        };
+
+        unsigned int workers = std::max(1u, std::thread::hardware_concurrency());
+        std::vector<std::thread> threads;
+        for (unsigned int i = 1; i < workers; ++i) threads.emplace_back(work);
+        work();
+        for (std::thread& thread : threads) thread.join();
+        if (stopped) return false;
+
+        dilate(target, covered);
+        return true;
+    }
+
+    // Shelf packing, tallest first, in rows at most shelfWidth wide (wider items get a row each).
+    // Writes the positions and returns the height used.
+    static int packShelves(const std::vector<int>& widths, const std::vector<int>& heights, int shelfWidth,
+                           std::vector<int>& x, std::vector<int>& y) {
+        std::vector<size_t> order(widths.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+        std::stable_sort(order.begin(), order.end(), [&heights](size_t a, size_t b) { return heights[a] > heights[b]; });
+        x.assign(widths.size(), 0);
+        y.assign(widths.size(), 0);
+        int shelfY = 0, shelfHeight = 0, cursor = 0;
+        for (size_t i : order) {
+            if (cursor > 0 && cursor + widths[i] > shelfWidth) {
+                shelfY += shelfHeight;
+                shelfHeight = 0;
+                cursor = 0;
+            }
+            x[i] = cursor;
+            y[i] = shelfY;
+            cursor += widths[i];
+            shelfHeight = std::max(shelfHeight, heights[i]);
+        }
+        return shelfY + shelfHeight;
+    }
+
+    static bool save(const std::string& path, const LightmapBake& bake) {
+        FILE* out = fopen(path.c_str(), "wb");
+        if (!out) return false;
+        LightmapFileHeader header;
+        memcpy(header.magic, LMAP_MAGIC, sizeof(header.magic));
+        header.version = LMAP_VERSION;
+        header.key = bake.key;
+        header.width = bake.width;
+        header.height = bake.height;
+        header.vertexCount = static_cast<uint32_t>(bake.vertices.size() / FLOATS_PER_VERTEX);
+        header.indexCount = static_cast<uint32_t>(bake.indices.size());
+        header.chartCount = static_cast<uint32_t>(bake.chartCount);
+        header.texelsPerUnit = bake.texelsPerUnit;
+        bool written = fwrite(&header, sizeof(header), 1, out) == 1;
+        written = written && fwrite(bake.vertices.data(), sizeof(float), bake.vertices.size(), out) == bake.vertices.size();
+        written = written && fwrite(bake.indices.data(), sizeof(unsigned int), bake.indices.size(), out) == bake.indices.size();
+        written = written && fwrite(bake.texels.data(), sizeof(float), bake.texels.size(), out) == bake.texels.size();
+        written = fclose(out) == 0 && written;
+        if (!written) remove(path.c_str());
+        return written;
+    }
+
+    // False if the file is missing, corrupt, or holds a bake with another key
+    static bool load(const std::string& path, uint64_t key, LightmapBake& bake) {
+        FILE* in = fopen(path.c_str(), "rb");
+        if (!in) return false;
+        LightmapFileHeader header;
+        bool valid = fread(&header, sizeof(header), 1, in) == 1 &&
+                     memcmp(header.magic, LMAP_MAGIC, sizeof(header.magic)) == 0 &&
+                     header.version == LMAP_VERSION && header.key == key &&
+                     header.width > 0 && header.height > 0 && header.width <= 16384 && header.height <= 16384;
+        if (valid) {
+            bake.key = header.key;
+            bake.width = header.width;
+            bake.height = header.height;
+            bake.chartCount = static_cast<int>(header.chartCount);
+            bake.texelsPerUnit = header.texelsPerUnit;
+            bake.vertices.resize(static_cast<size_t>(header.vertexCount) * FLOATS_PER_VERTEX);
+            bake.indices.resize(header.indexCount);
+            bake.texels.resize(static_cast<size_t>(header.width) * header.height * 3);
+            valid = fread(bake.vertices.data(), sizeof(float), bake.vertices.size(), in) == bake.vertices.size() &&
+                    fread(bake.indices.data(), sizeof(unsigned int), bake.indices.size(), in) == bake.indices.size() &&
+                    fread(bake.texels.data(), sizeof(float), bake.texels.size(), in) == bake.texels.size();
+            for (size_t i = 0; valid && i < bake.indices.size(); ++i) valid = bake.indices[i] < header.vertexCount;
+        }
+        fclose(in);
+        return valid;
+    }
+
+private:
+    struct Chart {
+        int axis = 0;
+        float min[2] = { INFINITY, INFINITY };
+        float max[2] = { -INFINITY, -INFINITY };
+        int x = 0;
+        int y = 0;
+    };
+
+    static void transformPoint(const float* m, const float* p, float* out) {
+        for (int r = 0; r < 3; ++r) out[r] = m[r] * p[0] + m[4 + r] * p[1] + m[8 + r] * p[2] + m[12 + r];
+    }
+
+    // Coordinates on the plane a chart of the given axis (0..2) is projected onto
+    static void planeCoordinates(int axis, const float* p, float* uv) {
+        uv[0] = p[(axis + 1) % 3];
+        uv[1] = p[(axis + 2) % 3];
+    }
+
+    static void normalize(float* v) {
+        float length = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+        if (length > 0.0f) {
+            for (int k = 0; k < 3; ++k) v[k] /= length;
+        }
+    }
+
+    // Adds the point light's irradiance at a surface point; origin is already off the surface
+    static void directLight(const PathTracer& scene, const PathTracer::Settings& light, const float* origin,
+                            const float* normal, float* irradiance) {
+        float toLight[3];
+        for (int k = 0; k < 3; ++k) toLight[k] = light.lightPosition[k] - origin[k];
+        float length = sqrtf(toLight[0] * toLight[0] + toLight[1] * toLight[1] + toLight[2] * toLight[2]);
+        if (length <= 0.0f) return;
+        float cosine = (normal[0] * toLight[0] + normal[1] * toLight[1] + normal[2] * toLight[2]) / length;
+        if (cosine <= 0.0f || scene.occluded(origin, toLight, 1.0f)) return;
+        for (int k = 0; k < 3; ++k) irradiance[k] += light.lightColor[k] * cosine;
+    }
+
+    // World position and normal at the center of every texel a triangle covers
+    static void rasterize(const LightmapBake& bake, const float* model, std::vector<float>& samplePoints,
+                          std::vector<uint8_t>& covered) {
+        // Normals go to the world with the cofactor matrix (the inverse transpose up to scale)
+        float normalMatrix[9];
+        const float* m = model;
+        normalMatrix[0] = m[5] * m[10] - m[9] * m[6];
+        normalMatrix[1] = m[8] * m[6] - m[4] * m[10];
+        normalMatrix[2] = m[4] * m[9] - m[8] * m[5];
+        normalMatrix[3] = m[9] * m[2] - m[1] * m[10];
+        normalMatrix[4] = m[0] * m[10] - m[8] * m[2];
+        normalMatrix[5] = m[8] * m[1] - m[0] * m[9];
+        normalMatrix[6] = m[1] * m[6] - m[5] * m[2];
+        normalMatrix[7] = m[4] * m[2] - m[0] * m[6];
+        normalMatrix[8] = m[0] * m[5] - m[4] * m[1];
+        float det = m[0] * normalMatrix[0] + m[4] * normalMatrix[3] + m[8] * normalMatrix[6];
+        float handedness = det < 0.0f ? -1.0f : 1.0f;       // mirrored objects flip the winding
+
+        const int width = bake.width, height = bake.height;
+        const float* vertices = bake.vertices.data();
+        for (size_t t = 0; t + 2 < bake.indices.size(); t += 3) {
+            const float* v[3];
+            float px[3], py[3];
+            for (int c = 0; c < 3; ++c) {
+                v[c] = vertices + static_cast<size_t>(bake.indices[t + c]) * FLOATS_PER_VERTEX;
+                px[c] = v[c][6] * width;
+                py[c] = v[c][7] * height;
+            }
+            float area = (px[1] - px[0]) * (py[2] - py[0]) - (px[2] - px[0]) * (py[1] - py[0]);
+            if (fabsf(area) < 1e-12f) continue;
+
+            float p0[3], p1[3], p2[3], faceNormal[3];
+            transformPoint(model, v[0], p0);
+            transformPoint(model, v[1], p1);
+            transformPoint(model, v[2], p2);
+            float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+            float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+            faceNormal[0] = e1[1] * e2[2] - e1[2] * e2[1];
+            faceNormal[1] = e1[2] * e2[0] - e1[0] * e2[2];
+            faceNormal[2] = e1[0] * e2[1] - e1[1] * e2[0];
+            normalize(faceNormal);
+            for (int k = 0; k < 3; ++k) faceNormal[k] *= handedness;
+
+            int x0 = std::max(0, static_cast<int>(floorf(std::min(px[0], std::min(px[1], px[2])))));
+            int x1 = std::min(width - 1, static_cast<int>(ceilf(std::max(px[0], std::max(px[1], px[2])))));
+            int y0 = std::max(0, static_cast<int>(floorf(std::min(py[0], std::min(py[1], py[2])))));
+            int y1 = std::min(height - 1, static_cast<int>(ceilf(std::max(py[0], std::max(py[1], py[2])))));
+            for (int y = y0; y <= y1; ++y) {
+                for (int x = x0; x <= x1; ++x) {
+                    float cx = x + 0.5f, cy = y + 0.5f;
+                    float w0 = ((px[1] - cx) * (py[2] - cy) - (px[2] - cx) * (py[1] - cy)) / area;
+                    float w1 = ((px[2] - cx) * (py[0] - cy) - (px[0] - cx) * (py[2] - cy)) / area;
+                    float w2 = 1.0f - w0 - w1;
+                    if (w0 < -1e-4f || w1 < -1e-4f || w2 < -1e-4f) continue;
+
+                    size_t texel = static_cast<size_t>(y) * width + x;
+                    float* position = &samplePoints[texel * 6];
+                    float* normal = position + 3;
+                    float local[3];
+                    for (int k = 0; k < 3; ++k) position[k] = p0[k] * w0 + p1[k] * w1 + p2[k] * w2;
+                    for (int k = 0; k < 3; ++k) local[k] = v[0][3 + k] * w0 + v[1][3 + k] * w1 + v[2][3 + k] * w2;
+                    for (int k = 0; k < 3; ++k) {
+                        normal[k] = (normalMatrix[k] * local[0] + normalMatrix[3 + k] * local[1] +
+                                     normalMatrix[6 + k] * local[2]) * handedness;
+                    }
+                    normalize(normal);
+                    // Flat or flipped normals: the face decides which side the texel lights
+                    float facing = normal[0] * faceNormal[0] + normal[1] * faceNormal[1] + normal[2] * faceNormal[2];
+                    if (facing <= 0.0f) memcpy(normal, faceNormal, sizeof(faceNormal));
+                    covered[texel] = 1;
+                }
+            }
+        }
+    }
+
+    // Spread covered texels into the padding around them, so filtering at chart edges
+    // never blends in black
+    static void dilate(LightmapBake& bake, std::vector<uint8_t>& covered) {
+        const int width = bake.width, height = bake.height;
+        std::vector<uint8_t> next;
+        for (int pass = 0; pass < CHART_PADDING * 2; ++pass) {
+            next = covered;
+            bool changed = false;
+            for (int y = 0; y < height; ++y) {
+                for (int x = 0; x < width; ++x) {
+                    size_t texel = static_cast<size_t>(y) * width + x;
+                    if (covered[texel]) continue;
+                    float sum[3] = { 0.0f, 0.0f, 0.0f };
+                    int count = 0;
+                    for (int dy = -1; dy <= 1; ++dy) {
+                        for (int dx = -1; dx <= 1; ++dx) {
+                            int nx = x + dx, ny = y + dy;
+                            if (nx < 0 || ny < 0 || nx >= width || ny >= height) continue;
+                            size_t neighbour = static_cast<size_t>(ny) * width + nx;
+                            if (!covered[neighbour]) continue;
+                            for (int k = 0; k < 3; ++k) sum[k] += bake.texels[neighbour * 3 + k];
+                            count++;
+                        }
+                    }
+                    if (count == 0) continue;
+                    for (int k = 0; k < 3; ++k) bake.texels[texel * 3 + k] = sum[k] / count;
+                    next[texel] = 1;
+                    changed = true;
+                }
+            }
+            covered.swap(next);
+            if (!changed) break;
+        }
+    }
+};
@@ -6,6 +6,26 @@
 #include <sstream>
 #include <algorithm>
 #include <map>
+#include <cstring>
+#include <charconv>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <unordered_map>
+
+// Memory-mapped file access
+#ifdef _WIN32
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
 
 // OpenGL headers
 #include <GL/glew.h>
@@ -16,6 +36,9 @@
 #include "backends/imgui_impl_glfw.h"
 #include "backends/imgui_impl_opengl3.h"
 
+// Shared normal/tangent generation
+#include "mesh_normals.h"
+
 // Simple math functions
 struct Vec3 {
     float x, y, z;
@@ -40,37 +63,62 @@ struct Vec2 {
     Vec2(float x = 0, float y = 0) : x(x), y(y) {}
 };
 
+struct Vec4 {
+    float x, y, z, w;
+    Vec4(float x = 0, float y = 0, float z = 0, float w = 0) : x(x), y(y), z(z), w(w) {}
+};
+
 struct Vertex {
     Vec3 position;
     Vec3 normal;
     Vec2 texcoord;
     Vec3 color;
+    Vec4 tangent; // xyz tangent, w = bitangent sign
     
     Vertex(Vec3 pos = Vec3(), Vec3 norm = Vec3(), Vec2 tex = Vec2(), Vec3 col = Vec3(1,1,1)) 
-        : position(pos), normal(norm), texcoord(tex), color(col) {}
+        : position(pos), normal(norm), texcoord(tex), color(col), tangent(1, 0, 0, 1) {}
+};
+
+// One uploaded slice of a mesh. Large models are split into several of these
+// so they can be drawn while the rest of the file is still being parsed.
+struct MeshChunk {
+    GLuint VAO, VBO, EBO;
+    GLsizei indexCount;
+    
+    MeshChunk() : VAO(0), VBO(0), EBO(0), indexCount(0) {}
 };
 
 struct Mesh {
     std::vector<Vertex> vertices;
     std::vector<unsigned int> indices;
+    std::vector<MeshChunk> chunks;
+    size_t vertexCount;
+    size_t triangleCount;
     Vec3 color;
     
-    GLuint VAO, VBO, EBO;
-    
-    Mesh() : VAO(0), VBO(0), EBO(0), color(1.0f, 1.0f, 1.0f) {}
+    Mesh() : vertexCount(0), triangleCount(0), color(1.0f, 1.0f, 1.0f) {}
     
+    // Upload the CPU-side vertices/indices as a single chunk
     void setupBuffers() {
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        glGenBuffers(1, &EBO);
+        uploadChunk(vertices, indices);
+    }
+    
+    // Upload one chunk of geometry; the caller may free its arrays afterwards
+    void uploadChunk(const std::vector<Vertex>& chunkVertices, const std::vector<unsigned int>& chunkIndices) {
+        if (chunkVertices.empty() || chunkIndices.empty()) return;
+        
+        MeshChunk chunk;
+        glGenVertexArrays(1, &chunk.VAO);
+        glGenBuffers(1, &chunk.VBO);
+        glGenBuffers(1, &chunk.EBO);
         
-        glBindVertexArray(VAO);
+        glBindVertexArray(chunk.VAO);
         
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, chunk.VBO);
+        glBufferData(GL_ARRAY_BUFFER, chunkVertices.size() * sizeof(Vertex), chunkVertices.data(), GL_STATIC_DRAW);
         
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, chunk.EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, chunkIndices.size() * sizeof(unsigned int), chunkIndices.data(), GL_STATIC_DRAW);
         
         // Position attribute
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
@@ -84,19 +132,35 @@ struct Mesh {
         glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, color));
         glEnableVertexAttribArray(2);
         
+        // Tangent attribute
+        glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, tangent));
+        glEnableVertexAttribArray(3);
+        
         glBindVertexArray(0);
+        
+        chunk.indexCount = static_cast<GLsizei>(chunkIndices.size());
+        chunks.push_back(chunk);
+        
+        vertexCount += chunkVertices.size();
+        triangleCount += chunkIndices.size() / 3;
     }
     
     void cleanup() {
-        if (EBO) glDeleteBuffers(1, &EBO);
-        if (VBO) glDeleteBuffers(1, &VBO);
-        if (VAO) glDeleteVertexArrays(1, &VAO);
+        for (auto& chunk : chunks) {
+            if (chunk.EBO) glDeleteBuffers(1, &chunk.EBO);
+            if (chunk.VBO) glDeleteBuffers(1, &chunk.VBO);
+            if (chunk.VAO) glDeleteVertexArrays(1, &chunk.VAO);
+        }
+        chunks.clear();
+        vertexCount = 0;
+        triangleCount = 0;
     }
     
     void draw() {
-        if (VAO == 0) return;
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
+        for (const auto& chunk : chunks) {
+            glBindVertexArray(chunk.VAO);
+            glDrawElements(GL_TRIANGLES, chunk.indexCount, GL_UNSIGNED_INT, 0);
+        }
         glBindVertexArray(0);
     }
 };
@@ -289,12 +353,116 @@ void main()
 }
 )";
 
+// Read-only memory mapping of a whole file
+class MappedFile {
+public:
+    MappedFile() : data(nullptr), size(0) {
+#ifdef _WIN32
+        fileHandle = INVALID_HANDLE_VALUE;
+        mappingHandle = NULL;
+#endif
+    }
+    
+    ~MappedFile() { close(); }
+    
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    bool open(const std::string& path) {
+        close();
+#ifdef _WIN32
+        fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                                 OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (fileHandle == INVALID_HANDLE_VALUE) return false;
+        
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0) {
+            close();
+            return false;
+        }
+        size = static_cast<size_t>(fileSize.QuadPart);
+        
+        mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (!mappingHandle) {
+            close();
+            return false;
+        }
+        data = static_cast<const char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        
+        struct stat fileStat;
+        if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+        size = static_cast<size_t>(fileStat.st_size);
+        
+        void* mapped = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) {
+            size = 0;
+            return false;
+        }
+        madvise(mapped, size, MADV_SEQUENTIAL);
+        data = static_cast<const char*>(mapped);
+#endif
+        if (!data) {
+            close();
+            return false;
+        }
+        return true;
+    }
+    
+    void close() {
+#ifdef _WIN32
+        if (data) UnmapViewOfFile(data);
+        if (mappingHandle) CloseHandle(mappingHandle);
+        if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+        mappingHandle = NULL;
+        fileHandle = INVALID_HANDLE_VALUE;
+#else
+        if (data) munmap(const_cast<char*>(data), size);
+#endif
+        data = nullptr;
+        size = 0;
+    }
+    
+    const char* begin() const { return data; }
+    const char* end() const { return data + size; }
+    
+private:
+    const char* data;
+    size_t size;
+#ifdef _WIN32
+    HANDLE fileHandle;
+    HANDLE mappingHandle;
+#endif
+};
+
+// Geometry produced by the OBJ parser, at most OBJLoader::CHUNK_VERTICES vertices
+struct OBJChunk {
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+};
+
 // OBJ Loader Class
 class OBJLoader {
 public:
-    static bool loadOBJ(const std::string& filepath, Mesh& mesh) {
-        std::ifstream file(filepath);
-        if (!file.is_open()) {
+    // Vertices per emitted chunk; keeps each upload (and the parser's working set) bounded
+    static const size_t CHUNK_VERTICES = 65536;
+    
+    // Generated normals are split across edges sharper than this
+    static constexpr float SMOOTHING_ANGLE = 60.0f;
+    
+    typedef std::function<bool(OBJChunk&&)> ChunkCallback;
+    
+    // Parse an OBJ file, handing each finished chunk to onChunk.
+    // Returning false from onChunk stops parsing early.
+    static bool loadOBJ(const std::string& filepath, const ChunkCallback& onChunk) {
+        MappedFile file;
+        if (!file.open(filepath)) {
             std::cerr << "Failed to open OBJ file: " << filepath << std::endl;
             return false;
         }
@@ -303,146 +471,359 @@ public:
         std::vector<Vec3> normals;
         std::vector<Vec2> texcoords;
         
-        std::vector<Vertex> vertices;
-        std::vector<unsigned int> indices;
+        struct Corner { int pos, tex, norm; };
+        std::vector<Corner> polygon;
+        
+        OBJChunk chunk;
+        chunk.vertices.reserve(CHUNK_VERTICES);
+        chunk.indices.reserve(CHUNK_VERTICES * 3);
+        
+        // Source position and whether the file supplied a normal, per chunk vertex
+        std::vector<int> chunkPositionIds;
+        std::vector<char> chunkHasNormal;
+        
+        size_t totalVertices = 0;
+        size_t totalIndices = 0;
+        bool cancelled = false;
+        
+        auto flushChunk = [&]() {
+            if (chunk.vertices.empty()) return;
+            generateNormalsAndTangents(chunk, positions, chunkPositionIds, chunkHasNormal, !texcoords.empty());
+            chunkPositionIds.clear();
+            chunkHasNormal.clear();
+            totalVertices += chunk.vertices.size();
+            totalIndices += chunk.indices.size();
+            if (!onChunk(std::move(chunk))) cancelled = true;
+            chunk = OBJChunk();
+            chunk.vertices.reserve(CHUNK_VERTICES);
+            chunk.indices.reserve(CHUNK_VERTICES * 3);
+        };
+        
+        const char* p = file.begin();
+        const char* end = file.end();
         
-        std::string line;
-        while (std::getline(file, line)) {
-            std::istringstream iss(line);
-            std::string prefix;
-            iss >> prefix;
+        while (p < end && !cancelled) {
+            p = skipSpaces(p, end);
+            const char* lineEnd = findLineEnd(p, end);
             
-            if (prefix == "v") { // Vertex position
-                float x, y, z;
-                iss >> x >> y >> z;
-                positions.push_back(Vec3(x, y, z));
+            if (lineEnd - p >= 2 && p[0] == 'v' && isSpace(p[1])) { // Vertex position
+                Vec3 v;
+                p = parseFloat(p + 2, lineEnd, v.x);
+                p = parseFloat(p, lineEnd, v.y);
+                parseFloat(p, lineEnd, v.z);
+                positions.push_back(v);
             }
-            else if (prefix == "vn") { // Vertex normal
-                float x, y, z;
-                iss >> x >> y >> z;
-                normals.push_back(Vec3(x, y, z));
+            else if (lineEnd - p >= 3 && p[0] == 'v' && p[1] == 'n' && isSpace(p[2])) { // Vertex normal
+                Vec3 n;
+                p = parseFloat(p + 3, lineEnd, n.x);
+                p = parseFloat(p, lineEnd, n.y);
+                parseFloat(p, lineEnd, n.z);
+                normals.push_back(n);
             }
-            else if (prefix == "vt") { // Texture coordinate
-                float u, v;
-                iss >> u >> v;
-                texcoords.push_back(Vec2(u, v));
+            else if (lineEnd - p >= 3 && p[0] == 'v' && p[1] == 't' && isSpace(p[2])) { // Texture coordinate
+                Vec2 t;
+                p = parseFloat(p + 3, lineEnd, t.x);
+                parseFloat(p, lineEnd, t.y);
+                texcoords.push_back(t);
             }
-            else if (prefix == "f") { // Face
-                std::string vertex1, vertex2, vertex3;
-                iss >> vertex1 >> vertex2 >> vertex3;
+            else if (lineEnd - p >= 2 && p[0] == 'f' && isSpace(p[1])) { // Face (any number of corners)
+                polygon.clear();
+                p += 2;
                 
-                // Parse each vertex (format: position/texcoord/normal)
-                auto parseVertex = [&](const std::string& vertexStr) -> Vertex {
-                    std::istringstream vss(vertexStr);
-                    std::string posStr, texStr, normStr;
+                while (true) {
+                    p = skipSpaces(p, lineEnd);
+                    if (p >= lineEnd) break;
                     
-                    std::getline(vss, posStr, '/');
-                    std::getline(vss, texStr, '/');
-                    std::getline(vss, normStr, '/');
+                    // Corner format: pos[/tex][/norm], indices may be negative (relative)
+                    Corner corner = { -1, -1, -1 };
+                    int value = 0;
                     
-                    int posIdx = std::stoi(posStr) - 1;
-                    int texIdx = texStr.empty() ? -1 : std::stoi(texStr) - 1;
-                    int normIdx = normStr.empty() ? -1 : std::stoi(normStr) - 1;
+                    auto res = std::from_chars(p, lineEnd, value);
+                    if (res.ec != std::errc()) break;
+                    corner.pos = resolveIndex(value, positions.size());
+                    p = res.ptr;
                     
-                    Vec3 pos = positions[posIdx];
-                    Vec3 norm = (normIdx >= 0 && normIdx < normals.size()) ? normals[normIdx] : Vec3(0, 1, 0);
-                    Vec2 tex = (texIdx >= 0 && texIdx < texcoords.size()) ? texcoords[texIdx] : Vec2(0, 0);
+                    if (p < lineEnd && *p == '/') {
+                        ++p;
+                        res = std::from_chars(p, lineEnd, value);
+                        if (res.ec == std::errc()) {
+                            corner.tex = resolveIndex(value, texcoords.size());
+                            p = res.ptr;
+                        }
+                        if (p < lineEnd && *p == '/') {
+                            ++p;
+                            res = std::from_chars(p, lineEnd, value);
+                            if (res.ec == std::errc()) {
+                                corner.norm = resolveIndex(value, normals.size());
+                                p = res.ptr;
+                            }
+                        }
+                    }
                     
-                    // Generate a color based on position for visualization
-                    Vec3 color = Vec3(
-                        fabs(sin(pos.x * 2.0f)),
-                        fabs(cos(pos.y * 2.0f)),
-                        fabs(sin(pos.z * 2.0f))
-                    );
+                    // Skip anything unexpected up to the next separator
+                    while (p < lineEnd && !isSpace(*p)) ++p;
                     
-                    return Vertex(pos, norm, tex, color);
-                };
-                
-                Vertex v1 = parseVertex(vertex1);
-                Vertex v2 = parseVertex(vertex2);
-                Vertex v3 = parseVertex(vertex3);
-                
-                // Add vertices and indices
-                unsigned int baseIndex = vertices.size();
-                vertices.push_back(v1);
-                vertices.push_back(v2);
-                vertices.push_back(v3);
-                
-                indices.push_back(baseIndex);
-                indices.push_back(baseIndex + 1);
-                indices.push_back(baseIndex + 2);
+                    if (corner.pos >= 0) polygon.push_back(corner);
+                }
                 
-                // Check if there's a fourth vertex (quad face)
-                if (!iss.eof()) {
-                    std::string vertex4;
-                    iss >> vertex4;
-                    if (!vertex4.empty()) {
-                        Vertex v4 = parseVertex(vertex4);
+                if (polygon.size() >= 3) {
+                    if (chunk.vertices.size() + polygon.size() > CHUNK_VERTICES) {
+                        flushChunk();
+                    }
+                    
+                    unsigned int baseIndex = static_cast<unsigned int>(chunk.vertices.size());
+                    for (const Corner& corner : polygon) {
+                        Vec3 pos = positions[corner.pos];
+                        Vec3 norm = corner.norm >= 0 ? normals[corner.norm] : Vec3(0, 1, 0);
+                        Vec2 tex = corner.tex >= 0 ? texcoords[corner.tex] : Vec2(0, 0);
+                        
+                        // Generate a color based on position for visualization
+                        Vec3 color = Vec3(
+                            fabs(sin(pos.x * 2.0f)),
+                            fabs(cos(pos.y * 2.0f)),
+                            fabs(sin(pos.z * 2.0f))
+                        );
                         
-                        // Split quad into two triangles
-                        vertices.push_back(v4);
-                        indices.push_back(baseIndex);
-                        indices.push_back(baseIndex + 2);
-                        indices.push_back(baseIndex + 3);
+                        chunk.vertices.push_back(Vertex(pos, norm, tex, color));
+                        chunkPositionIds.push_back(corner.pos);
+                        chunkHasNormal.push_back(corner.norm >= 0);
+                    }
+                    
+                    // Fan triangulation
+                    for (unsigned int i = 1; i + 1 < polygon.size(); ++i) {
+                        chunk.indices.push_back(baseIndex);
+                        chunk.indices.push_back(baseIndex + i);
+                        chunk.indices.push_back(baseIndex + i + 1);
                     }
                 }
             }
+            
+            p = lineEnd < end ? lineEnd + 1 : end;
         }
         
-        file.close();
+        if (!cancelled) flushChunk();
         
-        if (vertices.empty()) {
+        if (totalVertices == 0) {
             std::cerr << "No vertices loaded from OBJ file" << std::endl;
             return false;
         }
         
-        // Calculate normals if none were provided
-        if (normals.empty()) {
-            calculateNormals(vertices, indices);
-        }
-        
-        mesh.vertices = vertices;
-        mesh.indices = indices;
-        
         std::cout << "Loaded OBJ: " << filepath << std::endl;
-        std::cout << "  Vertices: " << vertices.size() << std::endl;
-        std::cout << "  Indices: " << indices.size() << std::endl;
-        std::cout << "  Triangles: " << indices.size() / 3 << std::endl;
+        std::cout << "  Vertices: " << totalVertices << std::endl;
+        std::cout << "  Indices: " << totalIndices << std::endl;
+        std::cout << "  Triangles: " << totalIndices / 3 << std::endl;
         
-        return true;
+        return !cancelled;
+    }
+    
+    // Parse and upload on the calling thread (requires a current GL context)
+    static bool loadOBJ(const std::string& filepath, Mesh& mesh) {
+        return loadOBJ(filepath, [&mesh](OBJChunk&& chunk) {
+            mesh.uploadChunk(chunk.vertices, chunk.indices);
+            return true;
+        });
     }
     
 private:
-    static void calculateNormals(std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices) {
-        // Initialize normals to zero
-        for (auto& vertex : vertices) {
-            vertex.normal = Vec3(0, 0, 0);
+    // Fill in missing normals and compute tangents for one chunk. Vertices are
+    // welded by source position so smoothing works across faces; chunks are
+    // processed independently, so edges on a chunk border are not smoothed.
+    static void generateNormalsAndTangents(OBJChunk& chunk, const std::vector<Vec3>& positions,
+                                           const std::vector<int>& positionIds,
+                                           const std::vector<char>& hasNormal, bool hasTexcoords) {
+        bool needsNormals = std::find(hasNormal.begin(), hasNormal.end(), 0) != hasNormal.end();
+        if (!needsNormals && !hasTexcoords) return;
+        
+        // Compact the referenced positions into a local table
+        std::unordered_map<int, unsigned int> localIds;
+        std::vector<float> localPositions;
+        std::vector<unsigned int> vertexLocalIds(chunk.vertices.size());
+        for (size_t v = 0; v < chunk.vertices.size(); ++v) {
+            auto inserted = localIds.emplace(positionIds[v], static_cast<unsigned int>(localIds.size()));
+            if (inserted.second) {
+                const Vec3& pos = positions[positionIds[v]];
+                localPositions.push_back(pos.x);
+                localPositions.push_back(pos.y);
+                localPositions.push_back(pos.z);
+            }
+            vertexLocalIds[v] = inserted.first->second;
         }
         
-        // Calculate face normals and accumulate to vertices
-        for (size_t i = 0; i < indices.size(); i += 3) {
-            unsigned int i1 = indices[i];
-            unsigned int i2 = indices[i + 1];
-            unsigned int i3 = indices[i + 2];
-            
-            Vec3 v1 = vertices[i1].position;
-            Vec3 v2 = vertices[i2].position;
-            Vec3 v3 = vertices[i3].position;
-            
-            Vec3 edge1 = v2 - v1;
-            Vec3 edge2 = v3 - v1;
-            Vec3 normal = Vec3::cross(edge1, edge2).normalize();
+        size_t triangleCount = chunk.indices.size() / 3;
+        std::vector<unsigned int> cornerPositions(chunk.indices.size());
+        for (size_t c = 0; c < chunk.indices.size(); ++c) {
+            cornerPositions[c] = vertexLocalIds[chunk.indices[c]];
+        }
+        
+        std::vector<float> cornerNormals(chunk.indices.size() * 3);
+        if (needsNormals) {
+            NormalGenerator::computeNormals(localPositions.data(), localIds.size(), cornerPositions.data(),
+                                            triangleCount, SMOOTHING_ANGLE, cornerNormals.data());
             
-            vertices[i1].normal = vertices[i1].normal + normal;
-            vertices[i2].normal = vertices[i2].normal + normal;
-            vertices[i3].normal = vertices[i3].normal + normal;
+            // A polygon's first vertex is a corner of every triangle in its fan:
+            // sum the corners of each vertex and normalize once
+            for (size_t v = 0; v < chunk.vertices.size(); ++v) {
+                if (!hasNormal[v]) chunk.vertices[v].normal = Vec3(0, 0, 0);
+            }
+            for (size_t c = 0; c < chunk.indices.size(); ++c) {
+                Vertex& vertex = chunk.vertices[chunk.indices[c]];
+                if (!hasNormal[chunk.indices[c]]) {
+                    vertex.normal = vertex.normal + Vec3(cornerNormals[3 * c], cornerNormals[3 * c + 1], cornerNormals[3 * c + 2]);
+                }
+            }
+            for (size_t v = 0; v < chunk.vertices.size(); ++v) {
+                if (!hasNormal[v]) chunk.vertices[v].normal = chunk.vertices[v].normal.normalize();
+            }
+        }
+        
+        if (!hasTexcoords) return;
+        
+        std::vector<float> cornerUVs(chunk.indices.size() * 2);
+        for (size_t c = 0; c < chunk.indices.size(); ++c) {
+            const Vertex& vertex = chunk.vertices[chunk.indices[c]];
+            Vec3 n = vertex.normal.normalize();
+            cornerNormals[3 * c + 0] = n.x;
+            cornerNormals[3 * c + 1] = n.y;
+            cornerNormals[3 * c + 2] = n.z;
+            cornerUVs[2 * c + 0] = vertex.texcoord.x;
+            cornerUVs[2 * c + 1] = vertex.texcoord.y;
+        }
+        
+        std::vector<float> cornerTangents(chunk.indices.size() * 4);
+        NormalGenerator::computeTangents(localPositions.data(), localIds.size(), cornerPositions.data(),
+                                         triangleCount, cornerNormals.data(), cornerUVs.data(),
+                                         cornerTangents.data());
+        
+        // Same for tangents; the corners share the vertex normal, so the sum stays in its tangent plane
+        std::vector<Vec4> tangentSums(chunk.vertices.size());
+        for (size_t c = 0; c < chunk.indices.size(); ++c) {
+            const float* t = cornerTangents.data() + 4 * c;
+            Vec4& sum = tangentSums[chunk.indices[c]];
+            sum = Vec4(sum.x + t[0], sum.y + t[1], sum.z + t[2], sum.w + t[3]);
+        }
+        for (size_t v = 0; v < chunk.vertices.size(); ++v) {
+            const Vec4& sum = tangentSums[v];
+            Vec3 tangent = Vec3(sum.x, sum.y, sum.z).normalize();
+            if (tangent.length() > 0) {
+                chunk.vertices[v].tangent = Vec4(tangent.x, tangent.y, tangent.z, sum.w < 0 ? -1.0f : 1.0f);
+            }
+        }
+    }
+    
+    static bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+    
+    static const char* skipSpaces(const char* p, const char* end) {
+        while (p < end && isSpace(*p)) ++p;
+        return p;
+    }
+    
+    static const char* findLineEnd(const char* p, const char* end) {
+        const char* newline = static_cast<const char*>(memchr(p, '\n', end - p));
+        return newline ? newline : end;
+    }
+    
+    static const char* parseFloat(const char* p, const char* end, float& value) {
+        p = skipSpaces(p, end);
+        if (p < end && *p == '+') ++p; // from_chars rejects a leading '+'
+        auto res = std::from_chars(p, end, value);
+        if (res.ec != std::errc()) {
+            value = 0.0f;
+            while (p < end && !isSpace(*p)) ++p;
+            return p;
+        }
+        return res.ptr;
+    }
+    
+    // OBJ indices are 1-based; negative values count back from the last element
+    static int resolveIndex(int index, size_t count) {
+        int resolved = index > 0 ? index - 1 : static_cast<int>(count) + index;
+        return (resolved >= 0 && resolved < static_cast<int>(count)) ? resolved : -1;
+    }
+};
+
+// Parses an OBJ file on a worker thread and hands chunks to the render thread,
+// which uploads a few per frame so the model appears progressively.
+class OBJStreamLoader {
+public:
+    // Parsed chunks allowed to wait for upload before the parser blocks
+    static const size_t MAX_PENDING_CHUNKS = 4;
+    
+    OBJStreamLoader() : running(false), finished(false), succeeded(false), cancelRequested(false) {}
+    ~OBJStreamLoader() { cancel(); }
+    
+    void start(const std::string& filepath) {
+        cancel();
+        running = true;
+        finished = false;
+        succeeded = false;
+        cancelRequested = false;
+        
+        worker = std::thread([this, filepath]() {
+            bool ok = OBJLoader::loadOBJ(filepath, [this](OBJChunk&& chunk) {
+                std::unique_lock<std::mutex> lock(queueMutex);
+                queueSpace.wait(lock, [this]() {
+                    return pending.size() < MAX_PENDING_CHUNKS || cancelRequested;
+                });
+                if (cancelRequested) return false;
+                pending.push_back(std::move(chunk));
+                return true;
+            });
+            succeeded = ok;
+            finished = true;
+        });
+    }
+    
+    // Upload up to maxChunks parsed chunks into mesh; call once per frame on the GL thread
+    void uploadPending(Mesh& mesh, int maxChunks) {
+        for (int i = 0; i < maxChunks; ++i) {
+            OBJChunk chunk;
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                if (pending.empty()) break;
+                chunk = std::move(pending.front());
+                pending.pop_front();
+            }
+            queueSpace.notify_one();
+            mesh.uploadChunk(chunk.vertices, chunk.indices);
         }
         
-        // Normalize all vertex normals
-        for (auto& vertex : vertices) {
-            vertex.normal = vertex.normal.normalize();
+        if (running && finished && isDrained()) {
+            worker.join();
+            running = false;
         }
     }
+    
+    void cancel() {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            cancelRequested = true;
+            pending.clear();
+        }
+        queueSpace.notify_all();
+        if (worker.joinable()) worker.join();
+        running = false;
+    }
+    
+    bool isLoading() const { return running; }
+    bool isFinished() const { return finished && !running; }
+    bool loadSucceeded() const { return succeeded; }
+    
+private:
+    bool isDrained() {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        return pending.empty();
+    }
+    
+    std::thread worker;
+    std::mutex queueMutex;
+    std::condition_variable queueSpace;
+    std::deque<OBJChunk> pending;
+    bool running;
+    std::atomic<bool> finished;
+    std::atomic<bool> succeeded;
+    bool cancelRequested;
 };
 
 // Function to compile shaders
@@ -691,28 +1072,21 @@ int main() {
     // Try to load OBJ house file
     Mesh houseMesh;
     std::string objPath = "assets/models/obj/cottage_obj.obj";
-    bool objLoaded = false;
+    OBJStreamLoader objStream;
     
     if (std::ifstream(objPath).good()) {
+        // Parsed in the background; chunks are uploaded from the render loop as they arrive
         std::cout << "Found OBJ file at: " << objPath << std::endl;
-        objLoaded = OBJLoader::loadOBJ(objPath, houseMesh);
+        objStream.start(objPath);
     } else {
         std::cout << "OBJ file not found at: " << objPath << std::endl;
         std::cout << "Generating a simple house model..." << std::endl;
         generateSimpleHouse(houseMesh);
-        objLoaded = true;
-    }
-    
-    if (!objLoaded) {
-        std::cerr << "Failed to load or generate house model!" << std::endl;
-        return -1;
+        houseMesh.setupBuffers();
+        std::cout << "House mesh ready with " << houseMesh.vertexCount << " vertices and " 
+                  << houseMesh.triangleCount * 3 << " indices" << std::endl;
     }
     
-    // Setup mesh buffers
-    houseMesh.setupBuffers();
-    std::cout << "House mesh ready with " << houseMesh.vertices.size() << " vertices and " 
-              << houseMesh.indices.size() << " indices" << std::endl;
-    
     // Application state
     bool showImGui = true;
     float rotationSpeed = 30.0f;
@@ -748,6 +1122,22 @@ int main() {
         deltaTime = currentTime - lastTime;
         lastTime = currentTime;
         
+        // Upload any OBJ chunks parsed since the last frame
+        if (objStream.isLoading()) {
+            objStream.uploadPending(houseMesh, 4);
+            
+            if (objStream.isFinished()) {
+                if (objStream.loadSucceeded()) {
+                    std::cout << "House mesh ready with " << houseMesh.vertexCount << " vertices and " 
+                              << houseMesh.triangleCount * 3 << " indices" << std::endl;
+                } else if (houseMesh.chunks.empty()) {
+                    std::cerr << "Failed to load OBJ, generating a simple house model instead" << std::endl;
+                    generateSimpleHouse(houseMesh);
+                    houseMesh.setupBuffers();
+                }
+            }
+        }
+        
         // Calculate FPS
         frameCount++;
         fpsTime += deltaTime;
@@ -801,8 +1191,11 @@ int main() {
             // Performance info
             ImGui::Text("FPS: %.1f", fps);
             ImGui::Text("Frame Time: %.3f ms", deltaTime * 1000.0f);
-            ImGui::Text("Vertices: %zu", houseMesh.vertices.size());
-            ImGui::Text("Triangles: %zu", houseMesh.indices.size() / 3);
+            ImGui::Text("Vertices: %zu", houseMesh.vertexCount);
+            ImGui::Text("Triangles: %zu", houseMesh.triangleCount);
+            if (objStream.isLoading()) {
+                ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.2f, 1.0f), "Streaming model... (%zu chunks)", houseMesh.chunks.size());
+            }
             ImGui::Separator();
             
             // Camera controls
@@ -968,6 +1361,7 @@ int main() {
     ImGui::DestroyContext();
     
     // Cleanup mesh
+    objStream.cancel();
     houseMesh.cleanup();
     
     // Cleanup shader
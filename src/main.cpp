@@ -15,6 +15,16 @@
 #include "backends/imgui_impl_glfw.h"
 #include "backends/imgui_impl_opengl3.h"
 
+// GL command capture
+#include "gl_capture.h"
+
+// Per-frame arena and heap allocation counter
+#define FRAME_ARENA_IMPLEMENTATION
+#include "frame_arena.h"
+
+// CPU trace zones (F11 exports a Chrome trace)
+#include "cpu_trace.h"
+
 // Random number generator
 std::random_device rd;
 std::mt19937 gen(rd());
@@ -401,6 +411,7 @@ public:
     }
     
     void generateHeightMap() {
+        TRACE_ZONE("Terrain::generateHeightMap");
         heightMap.resize(width * depth);
         
         // Generate terrain using multiple octaves of noise
@@ -467,7 +478,9 @@ public:
     }
     
     Mesh generateMesh() {
+        TRACE_ZONE("Terrain::generateMesh");
         Mesh mesh;
+        mesh.vertices.reserve((width - 1) * (depth - 1) * 6);
         
         // Generate vertices
         for (int z = 0; z < depth - 1; z++) {
@@ -572,6 +585,7 @@ public:
     }
     
     void resetGame() {
+        TRACE_ZONE("Game::resetGame");
         player = MetaBall();
         terrain = Terrain(100, 200, 1.0f);
         obstacles.clear();
@@ -666,6 +680,7 @@ public:
     }
     
     void update(float deltaTime) {
+        TRACE_ZONE("Game::update");
         if (currentState != PLAYING) return;
         
         // Update environment rotation
@@ -850,7 +865,7 @@ public:
     Vec3 getCameraPosition() const { return cameraPosition; }
     Vec3 getCameraTarget() const { return cameraTarget; }
     
-    std::string getStateString() const {
+    const char* getStateString() const {
         switch(currentState) {
             case MENU: return "MAIN MENU";
             case PLAYING: return "PLAYING";
@@ -864,6 +879,8 @@ public:
 // Mesh generators
 Mesh generateSphere(int segments = 16, int rings = 16) {
     Mesh mesh;
+    mesh.vertices.reserve((rings + 1) * (segments + 1));
+    mesh.indices.reserve(rings * segments * 6);
     
     for (int i = 0; i <= rings; i++) {
         float phi = 3.14159f * i / rings;
@@ -1334,11 +1351,16 @@ int main() {
     std::cout << "R: Toggle Environment Rotation" << std::endl;
     std::cout << "F1: Toggle Debug Info" << std::endl;
     std::cout << "F2: Toggle Wireframe" << std::endl;
+    std::cout << "F11: Export CPU Trace" << std::endl;
+    std::cout << "F12: Capture GL Frame (Shift: 10 frames)" << std::endl;
     std::cout << "================\n" << std::endl;
     
     // Main game loop
     float lastTime = 0.0f;
+    CpuTrace::setThreadName("Main");
     while (!glfwWindowShouldClose(window)) {
+        TRACE_ZONE("Frame");
+        
         // Calculate delta time
         float currentTime = glfwGetTime();
         float deltaTime = currentTime - lastTime;
@@ -1397,6 +1419,27 @@ int main() {
             }
         }
         
+        if (glfwGetKey(window, GLFW_KEY_F11) == GLFW_PRESS) {
+            static double lastPress = 0;
+            if (currentTime - lastPress > 0.3) {
+                if (CpuTrace::exportChromeTrace()) {
+                    std::cout << "CPU trace saved: " << CpuTrace::lastExportPath() << " ("
+                              << CpuTrace::lastExportEvents() << " zones)" << std::endl;
+                }
+                lastPress = currentTime;
+            }
+        }
+        
+        if (glfwGetKey(window, GLFW_KEY_F12) == GLFW_PRESS) {
+            static double lastPress = 0;
+            if (currentTime - lastPress > 0.3) {
+                bool burst = glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS ||
+                             glfwGetKey(window, GLFW_KEY_RIGHT_SHIFT) == GLFW_PRESS;
+                GLCapture::requestCapture(burst ? 10 : 1);
+                lastPress = currentTime;
+            }
+        }
+        
         // Update game
         game.update(deltaTime);
         
@@ -1408,6 +1451,8 @@ int main() {
         // Get window size
         int width, height;
         glfwGetFramebufferSize(window, &width, &height);
+        GLCapture::beginFrame(width, height);
+        FrameArena::beginFrame();
         glViewport(0, 0, width, height);
         
         // Clear screen
@@ -1611,8 +1656,11 @@ int main() {
         // Debug window
         if (showDebug) {
             ImGui::Begin("Debug Info", &showDebug);
-            ImGui::Text("Game State: %s", game.getStateString().c_str());
+            ImGui::Text("Game State: %s", game.getStateString());
             ImGui::Text("FPS: %.1f", 1.0f / deltaTime);
+            ImGui::Text("Heap Allocs/Frame: %llu (clean for %llu)",
+                       (unsigned long long)FrameArena::frameHeapAllocations(),
+                       (unsigned long long)FrameArena::cleanFrameStreak());
             ImGui::Text("Ball Position: %.2f, %.2f, %.2f", 
                        game.getPlayer().position.x,
                        game.getPlayer().position.y,
@@ -1633,8 +1681,11 @@ int main() {
         // Render ImGui
         ImGui::Render();
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        GLCapture::endFrame();
+        FrameArena::endFrame();
         
         // Swap buffers
+        TRACE_ZONE("Swap Buffers");
         glfwSwapBuffers(window);
         glfwPollEvents();
     }
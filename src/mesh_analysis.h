@@ -0,0 +1,394 @@
+// src/mesh_analysis.h - Mesh efficiency statistics and optimisation passes
+//
+// Everything here works on plain CPU arrays (interleaved float vertices with
+// the position in the first three floats, 32-bit triangle indices) and does
+// not touch OpenGL, so it can run on a worker thread.
+
+#pragma once
+
+#include <math.h>
+#include <float.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+#include <unordered_set>
+#include <unordered_map>
+
+struct MeshStats {
+    size_t vertexCount = 0;
+    size_t indexCount = 0;
+    size_t triangleCount = 0;
+    size_t gpuBytes = 0;
+
+    size_t degenerateTriangles = 0;   // repeated index or zero area
+    size_t duplicateTriangles = 0;    // same three vertices as an earlier triangle
+    size_t unusedVertices = 0;
+
+    float acmr = 0.0f;                // post-transform cache misses per triangle (0.5 - 3.0)
+    float atvr = 0.0f;                // misses per referenced vertex (1.0 is ideal)
+    float overdraw = 0.0f;            // shaded fragments / covered pixels over the sampled views
+    float overfetch = 0.0f;           // bytes pulled through the vertex fetch cache / vertex buffer size
+};
+
+class MeshAnalyzer {
+public:
+    static const int VERTEX_CACHE_SIZE = 16;   // post-transform FIFO entries
+    static const int FETCH_CACHE_LINES = 64;   // 64-byte lines in the vertex fetch model
+    static const int OVERDRAW_RESOLUTION = 128;
+
+    static MeshStats analyze(const std::vector<float>& vertices, size_t floatsPerVertex,
+                             const std::vector<unsigned int>& indices, size_t gpuBytes) {
+        MeshStats stats;
+        stats.vertexCount = floatsPerVertex ? vertices.size() / floatsPerVertex : 0;
+        stats.indexCount = indices.size();
+        stats.triangleCount = indices.size() / 3;
+        stats.gpuBytes = gpuBytes;
+        if (stats.vertexCount == 0 || stats.triangleCount == 0) return stats;
+
+        countBadTriangles(vertices, floatsPerVertex, indices, stats);
+
+        std::vector<char> used(stats.vertexCount, 0);
+        size_t referenced = 0;
+        for (unsigned int index : indices) {
+            if (index < stats.vertexCount && !used[index]) {
+                used[index] = 1;
+                referenced++;
+            }
+        }
+        stats.unusedVertices = stats.vertexCount - referenced;
+
+        size_t misses = simulateVertexCache(indices, stats.vertexCount);
+        stats.acmr = static_cast<float>(misses) / static_cast<float>(stats.triangleCount);
+        stats.atvr = referenced ? static_cast<float>(misses) / static_cast<float>(referenced) : 0.0f;
+
+        size_t stride = floatsPerVertex * sizeof(float);
+        size_t fetched = simulateVertexFetch(indices, stats.vertexCount, stride);
+        stats.overfetch = static_cast<float>(fetched) / static_cast<float>(stats.vertexCount * stride);
+
+        stats.overdraw = estimateOverdraw(vertices, floatsPerVertex, indices);
+        return stats;
+    }
+
+    // Drop degenerate and duplicate triangles
+    static void removeBadTriangles(const std::vector<float>& vertices, size_t floatsPerVertex,
+                                   std::vector<unsigned int>& indices) {
+        std::unordered_set<unsigned long long> seen;
+        std::vector<unsigned int> kept;
+        kept.reserve(indices.size());
+        for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+            const unsigned int* tri = &indices[t];
+            if (isDegenerate(vertices, floatsPerVertex, tri)) continue;
+            if (!seen.insert(triangleKey(tri)).second) continue;
+            kept.insert(kept.end(), tri, tri + 3);
+        }
+        indices.swap(kept);
+    }
+
+    // Reorder triangles for the post-transform vertex cache (Tipsify, Sander et al. 2007)
+    static void optimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount) {
+        size_t triangleCount = indices.size() / 3;
+        if (triangleCount == 0) return;
+
+        // Vertex -> triangle adjacency
+        std::vector<unsigned int> offsets(vertexCount + 1, 0);
+        for (unsigned int index : indices) offsets[index + 1]++;
+        for (size_t v = 0; v < vertexCount; ++v) offsets[v + 1] += offsets[v];
+        std::vector<unsigned int> adjacency(indices.size());
+        std::vector<unsigned int> cursor(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); ++i) adjacency[cursor[indices[i]]++] = static_cast<unsigned int>(i / 3);
+
+        std::vector<int> liveTriangles(vertexCount);
+        for (size_t v = 0; v < vertexCount; ++v) liveTriangles[v] = offsets[v + 1] - offsets[v];
+
+        std::vector<int> cacheTime(vertexCount, 0);
+        std::vector<char> emitted(triangleCount, 0);
+        std::vector<unsigned int> deadEnd;
+        std::vector<unsigned int> candidates;
+        std::vector<unsigned int> output;
+        output.reserve(indices.size());
+
+        const int cacheSize = VERTEX_CACHE_SIZE;
+        int time = cacheSize + 1;
+        size_t scan = 0;
+        int fanning = 0;
+
+        while (fanning >= 0) {
+            candidates.clear();
+            for (unsigned int i = offsets[fanning]; i < offsets[fanning + 1]; ++i) {
+                unsigned int t = adjacency[i];
+                if (emitted[t]) continue;
+                emitted[t] = 1;
+                for (int k = 0; k < 3; ++k) {
+                    unsigned int v = indices[3 * t + k];
+                    output.push_back(v);
+                    deadEnd.push_back(v);
+                    candidates.push_back(v);
+                    liveTriangles[v]--;
+                    if (time - cacheTime[v] > cacheSize) {
+                        cacheTime[v] = time++;
+                    }
+                }
+            }
+
+            // Pick the candidate that will still be in cache after its fan, or otherwise the oldest
+            int best = -1;
+            int bestPriority = -1;
+            for (unsigned int v : candidates) {
+                if (liveTriangles[v] <= 0) continue;
+                int priority = 0;
+                if (time - cacheTime[v] + 2 * liveTriangles[v] <= cacheSize) {
+                    priority = time - cacheTime[v];
+                }
+                if (priority > bestPriority) {
+                    bestPriority = priority;
+                    best = static_cast<int>(v);
+                }
+            }
+
+            if (best < 0) {
+                // Dead end: backtrack through recently used vertices, then scan for any live one
+                while (!deadEnd.empty()) {
+                    unsigned int v = deadEnd.back();
+                    deadEnd.pop_back();
+                    if (liveTriangles[v] > 0) {
+                        best = static_cast<int>(v);
+                        break;
+                    }
+                }
+                while (best < 0 && scan < vertexCount) {
+                    if (liveTriangles[scan] > 0) best = static_cast<int>(scan);
+                    scan++;
+                }
+            }
+            fanning = best;
+        }
+
+        indices.swap(output);
+    }
+
+    // Renumber vertices in order of first use so fetches walk the buffer linearly;
+    // unreferenced vertices are dropped. Returns the new vertex count.
+    static size_t optimizeVertexFetch(std::vector<float>& vertices, size_t floatsPerVertex,
+                                      std::vector<unsigned int>& indices) {
+        size_t vertexCount = vertices.size() / floatsPerVertex;
+        std::vector<unsigned int> remap(vertexCount, ~0u);
+        std::vector<float> reordered;
+        reordered.reserve(vertices.size());
+
+        unsigned int next = 0;
+        for (unsigned int& index : indices) {
+            if (remap[index] == ~0u) {
+                remap[index] = next++;
+                const float* src = &vertices[index * floatsPerVertex];
+                reordered.insert(reordered.end(), src, src + floatsPerVertex);
+            }
+            index = remap[index];
+        }
+
+        vertices.swap(reordered);
+        return next;
+    }
+
+    // Merge vertices whose attributes are bit-identical (the editor's OBJ import
+    // emits one vertex per corner). Returns the new vertex count.
+    static size_t weldVertices(std::vector<float>& vertices, size_t floatsPerVertex,
+                               std::vector<unsigned int>& indices) {
+        size_t vertexCount = vertices.size() / floatsPerVertex;
+        size_t bytes = floatsPerVertex * sizeof(float);
+
+        struct Key {
+            const float* data;
+            size_t bytes;
+            bool operator==(const Key& other) const { return memcmp(data, other.data, bytes) == 0; }
+        };
+        struct KeyHash {
+            size_t operator()(const Key& key) const {
+                // FNV-1a over the raw attribute bytes
+                const unsigned char* p = reinterpret_cast<const unsigned char*>(key.data);
+                size_t hash = 1469598103934665603ull;
+                for (size_t i = 0; i < key.bytes; ++i) hash = (hash ^ p[i]) * 1099511628211ull;
+                return hash;
+            }
+        };
+
+        std::unordered_map<Key, unsigned int, KeyHash> unique;
+        unique.reserve(vertexCount);
+        std::vector<unsigned int> remap(vertexCount);
+        std::vector<float> welded;
+        welded.reserve(vertices.size());
+
+        for (size_t v = 0; v < vertexCount; ++v) {
+            Key key = { &vertices[v * floatsPerVertex], bytes };
+            auto found = unique.find(key);
+            if (found != unique.end()) {
+                remap[v] = found->second;
+                continue;
+            }
+            unsigned int id = static_cast<unsigned int>(welded.size() / floatsPerVertex);
+            welded.insert(welded.end(), key.data, key.data + floatsPerVertex);
+            // Keys point into the input array, which stays untouched until the swap below
+            unique.emplace(key, id);
+            remap[v] = id;
+        }
+
+        for (unsigned int& index : indices) index = remap[index];
+        size_t count = welded.size() / floatsPerVertex;
+        vertices.swap(welded);
+        return count;
+    }
+
+private:
+    static unsigned long long triangleKey(const unsigned int* tri) {
+        // Rotate so the smallest index comes first; keeps winding, ignores starting corner
+        int first = 0;
+        if (tri[1] < tri[first]) first = 1;
+        if (tri[2] < tri[first]) first = 2;
+        unsigned long long a = tri[first], b = tri[(first + 1) % 3], c = tri[(first + 2) % 3];
+        return (a * 2654435761ull) ^ (b << 21) ^ (c << 42) ^ (b * 40503ull) ^ c;
+    }
+
+    static bool isDegenerate(const std::vector<float>& vertices, size_t floatsPerVertex, const unsigned int* tri) {
+        if (tri[0] == tri[1] || tri[1] == tri[2] || tri[0] == tri[2]) return true;
+        const float* a = &vertices[tri[0] * floatsPerVertex];
+        const float* b = &vertices[tri[1] * floatsPerVertex];
+        const float* c = &vertices[tri[2] * floatsPerVertex];
+        float e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+        float e2[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+        float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+        return n[0] * n[0] + n[1] * n[1] + n[2] * n[2] <= 1e-24f;
+    }
+
+    static void countBadTriangles(const std::vector<float>& vertices, size_t floatsPerVertex,
+                                  const std::vector<unsigned int>& indices, MeshStats& stats) {
+        std::unordered_set<unsigned long long> seen;
+        seen.reserve(stats.triangleCount);
+        for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+            const unsigned int* tri = &indices[t];
+            if (tri[0] >= stats.vertexCount || tri[1] >= stats.vertexCount || tri[2] >= stats.vertexCount) {
+                stats.degenerateTriangles++;
+                continue;
+            }
+            if (isDegenerate(vertices, floatsPerVertex, tri)) {
+                stats.degenerateTriangles++;
+            } else if (!seen.insert(triangleKey(tri)).second) {
+                stats.duplicateTriangles++;
+            }
+        }
+    }
+
+    // FIFO post-transform cache; returns the number of vertex shader invocations
+    static size_t simulateVertexCache(const std::vector<unsigned int>& indices, size_t vertexCount) {
+        std::vector<size_t> insertedAt(vertexCount, 0);
+        size_t clock = VERTEX_CACHE_SIZE + 1; // any vertex not seen yet is a miss
+        size_t misses = 0;
+        for (unsigned int index : indices) {
+            if (index >= vertexCount) continue;
+            if (clock - insertedAt[index] > VERTEX_CACHE_SIZE) {
+                insertedAt[index] = clock++;
+                misses++;
+            }
+        }
+        return misses;
+    }
+
+    // FIFO cache of 64-byte lines in front of the vertex buffer; returns bytes fetched
+    static size_t simulateVertexFetch(const std::vector<unsigned int>& indices, size_t vertexCount, size_t stride) {
+        const size_t lineSize = 64;
+        size_t lineCount = (vertexCount * stride + lineSize - 1) / lineSize;
+        std::vector<size_t> insertedAt(lineCount, 0);
+        size_t clock = FETCH_CACHE_LINES + 1;
+        size_t fetched = 0;
+        for (unsigned int index : indices) {
+            if (index >= vertexCount) continue;
+            size_t first = (index * stride) / lineSize;
+            size_t last = (index * stride + stride - 1) / lineSize;
+            for (size_t line = first; line <= last; ++line) {
+                if (clock - insertedAt[line] > FETCH_CACHE_LINES) {
+                    insertedAt[line] = clock++;
+                    fetched += lineSize;
+                }
+            }
+        }
+        return fetched;
+    }
+
+    // Rasterise the mesh in index order from the six axis directions into a small
+    // depth buffer. Every fragment that passes the depth test counts as shaded.
+    // No back-face culling, matching the editor viewport.
+    static float estimateOverdraw(const std::vector<float>& vertices, size_t floatsPerVertex,
+                                  const std::vector<unsigned int>& indices) {
+        size_t vertexCount = vertices.size() / floatsPerVertex;
+        float bmin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+        float bmax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+        for (size_t v = 0; v < vertexCount; ++v) {
+            for (int k = 0; k < 3; ++k) {
+                bmin[k] = std::min(bmin[k], vertices[v * floatsPerVertex + k]);
+                bmax[k] = std::max(bmax[k], vertices[v * floatsPerVertex + k]);
+            }
+        }
+        float extent = std::max(bmax[0] - bmin[0], std::max(bmax[1] - bmin[1], bmax[2] - bmin[2]));
+        if (extent <= 0.0f) return 0.0f;
+
+        const int res = OVERDRAW_RESOLUTION;
+        std::vector<float> depth(res * res);
+        std::vector<float> projected(vertexCount * 3);
+        size_t shaded = 0;
+        size_t covered = 0;
+
+        for (int axis = 0; axis < 3; ++axis) {
+            for (int flip = 0; flip < 2; ++flip) {
+                int u = (axis + 1) % 3;
+                int w = (axis + 2) % 3;
+                for (size_t v = 0; v < vertexCount; ++v) {
+                    const float* p = &vertices[v * floatsPerVertex];
+                    projected[v * 3 + 0] = (p[u] - bmin[u]) / extent * (res - 1);
+                    projected[v * 3 + 1] = (p[w] - bmin[w]) / extent * (res - 1);
+                    float d = (p[axis] - bmin[axis]) / extent;
+                    projected[v * 3 + 2] = flip ? 1.0f - d : d;
+                }
+
+                std::fill(depth.begin(), depth.end(), FLT_MAX);
+                for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+                    if (indices[t] >= vertexCount || indices[t + 1] >= vertexCount || indices[t + 2] >= vertexCount) continue;
+                    shaded += rasterizeTriangle(&projected[indices[t] * 3], &projected[indices[t + 1] * 3],
+                                                &projected[indices[t + 2] * 3], depth.data(), res);
+                }
+                for (float d : depth) {
+                    if (d != FLT_MAX) covered++;
+                }
+            }
+        }
+
+        return covered ? static_cast<float>(shaded) / static_cast<float>(covered) : 0.0f;
+    }
+
+    // Returns the number of pixels that passed the depth test
+    static size_t rasterizeTriangle(const float* a, const float* b, const float* c, float* depth, int res) {
+        float area = (b[0] - a[0]) * (c[1] - a[1]) - (c[0] - a[0]) * (b[1] - a[1]);
+        if (fabsf(area) < 1e-12f) return 0;
+
+        int minX = std::max(0, static_cast<int>(floorf(std::min(a[0], std::min(b[0], c[0])))));
+        int maxX = std::min(res - 1, static_cast<int>(ceilf(std::max(a[0], std::max(b[0], c[0])))));
+        int minY = std::max(0, static_cast<int>(floorf(std::min(a[1], std::min(b[1], c[1])))));
+        int maxY = std::min(res - 1, static_cast<int>(ceilf(std::max(a[1], std::max(b[1], c[1])))));
+
+        float invArea = 1.0f / area;
+        size_t passed = 0;
+        for (int y = minY; y <= maxY; ++y) {
+            for (int x = minX; x <= maxX; ++x) {
+                float px = x + 0.5f, py = y + 0.5f;
+                float w0 = ((b[0] - px) * (c[1] - py) - (c[0] - px) * (b[1] - py)) * invArea;
+                float w1 = ((c[0] - px) * (a[1] - py) - (a[0] - px) * (c[1] - py)) * invArea;
+                float w2 = 1.0f - w0 - w1;
+                if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) continue;
+                float z = w0 * a[2] + w1 * b[2] + w2 * c[2];
+                float& stored = depth[y * res + x];
+                if (z < stored) {
+                    stored = z;
+                    passed++;
+                }
+            }
+        }
+        return passed;
+    }
+};
@@ -0,0 +1,327 @@
+// src/mesh_normals.h - Shared vertex normal and tangent generation
+//
+// Works on triangle lists where every corner (3 per triangle) refers to a
+// position id. Normals are angle- and area-weighted and split across edges
+// sharper than the smoothing angle. Tangents follow the MikkTSpace
+// conventions (angle weighting, Gram-Schmidt against the normal, bitangent
+// sign in w) so normal maps baked by common tools line up.
+//
+// Both passes run in parallel over triangles. Each worker accumulates into
+// its own buffer or gathers from an adjacency table, so no atomics are used.
+
+#pragma once
+
+#include <math.h>
+#include <vector>
+#include <thread>
+#include <algorithm>
+
+class NormalGenerator {
+public:
+    // Triangles below this count are processed on the calling thread only
+    static const size_t MIN_TRIANGLES_PER_THREAD = 8192;
+
+    // Writes 3 floats per corner to outNormals.
+    // positions: 3 floats per position id
+    // cornerPositions: position id for each corner, 3 per triangle
+    // smoothingAngleDegrees: faces meeting at a sharper angle keep separate normals (>= 180 smooths everything)
+    static void computeNormals(const float* positions, size_t positionCount,
+                               const unsigned int* cornerPositions, size_t triangleCount,
+                               float smoothingAngleDegrees, float* outNormals) {
+        if (triangleCount == 0) return;
+
+        std::vector<float> faceNormals(triangleCount * 3);
+        std::vector<float> cornerWeights(triangleCount * 3);
+        computeFaceData(positions, cornerPositions, triangleCount, faceNormals.data(), cornerWeights.data());
+
+        if (smoothingAngleDegrees >= 180.0f) {
+            smoothAll(positionCount, cornerPositions, triangleCount,
+                      faceNormals.data(), cornerWeights.data(), outNormals);
+        } else {
+            float cosThreshold = cosf(smoothingAngleDegrees * 3.14159265f / 180.0f);
+            smoothWithThreshold(positionCount, cornerPositions, triangleCount, cosThreshold,
+                                faceNormals.data(), cornerWeights.data(), outNormals);
+        }
+    }
+
+    // Writes 4 floats per corner to outTangents (xyz tangent, w = bitangent sign).
+    // cornerNormals: 3 floats per corner, cornerUVs: 2 floats per corner
+    static void computeTangents(const float* positions, size_t positionCount,
+                                const unsigned int* cornerPositions, size_t triangleCount,
+                                const float* cornerNormals, const float* cornerUVs,
+                                float* outTangents) {
+        if (triangleCount == 0) return;
+
+        size_t cornerCount = triangleCount * 3;
+        std::vector<float> cornerTangents(cornerCount * 3);
+        std::vector<float> cornerSigns(cornerCount);
+
+        // Per-triangle UV derivatives, projected into each corner's tangent plane
+        parallelFor(triangleCount, [&](size_t begin, size_t end, unsigned int) {
+            for (size_t t = begin; t < end; ++t) {
+                const float* p0 = positions + 3 * cornerPositions[3 * t + 0];
+                const float* p1 = positions + 3 * cornerPositions[3 * t + 1];
+                const float* p2 = positions + 3 * cornerPositions[3 * t + 2];
+                const float* uv0 = cornerUVs + 6 * t;
+                const float* uv1 = uv0 + 2;
+                const float* uv2 = uv0 + 4;
+
+                float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+                float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+                float du1 = uv1[0] - uv0[0], dv1 = uv1[1] - uv0[1];
+                float du2 = uv2[0] - uv0[0], dv2 = uv2[1] - uv0[1];
+
+                float det = du1 * dv2 - du2 * dv1;
+                float sdir[3] = { 0.0f, 0.0f, 0.0f };
+                float tdir[3] = { 0.0f, 0.0f, 0.0f };
+                if (fabsf(det) > 1e-12f) {
+                    float r = 1.0f / det;
+                    for (int k = 0; k < 3; ++k) {
+                        sdir[k] = (e1[k] * dv2 - e2[k] * dv1) * r;
+                        tdir[k] = (e2[k] * du1 - e1[k] * du2) * r;
+                    }
+                }
+
+                for (int c = 0; c < 3; ++c) {
+                    size_t corner = 3 * t + c;
+                    const float* n = cornerNormals + 3 * corner;
+                    float weight = cornerAngle(positions, cornerPositions, t, c);
+
+                    // Gram-Schmidt against the corner normal
+                    float d = dot(n, sdir);
+                    float tangent[3] = { sdir[0] - n[0] * d, sdir[1] - n[1] * d, sdir[2] - n[2] * d };
+                    normalize(tangent);
+
+                    cornerTangents[3 * corner + 0] = tangent[0] * weight;
+                    cornerTangents[3 * corner + 1] = tangent[1] * weight;
+                    cornerTangents[3 * corner + 2] = tangent[2] * weight;
+
+                    float bitangent[3];
+                    cross(n, sdir, bitangent);
+                    cornerSigns[corner] = dot(bitangent, tdir) < 0.0f ? -1.0f : 1.0f;
+                }
+            }
+        });
+
+        // Merge corners that MikkTSpace would treat as one vertex:
+        // same position, normal, UV and handedness
+        std::vector<unsigned int> offsets, corners;
+        buildAdjacency(positionCount, cornerPositions, cornerCount, offsets, corners);
+
+        parallelFor(triangleCount, [&](size_t begin, size_t end, unsigned int) {
+            for (size_t corner = begin * 3; corner < end * 3; ++corner) {
+                const float* n = cornerNormals + 3 * corner;
+                const float* uv = cornerUVs + 2 * corner;
+                float sign = cornerSigns[corner];
+                float sum[3] = { 0.0f, 0.0f, 0.0f };
+
+                unsigned int position = cornerPositions[corner];
+                for (unsigned int i = offsets[position]; i < offsets[position + 1]; ++i) {
+                    unsigned int other = corners[i];
+                    const float* otherUV = cornerUVs + 2 * other;
+                    if (cornerSigns[other] != sign) continue;
+                    if (fabsf(otherUV[0] - uv[0]) > 1e-6f || fabsf(otherUV[1] - uv[1]) > 1e-6f) continue;
+                    if (dot(cornerNormals + 3 * other, n) < 0.9999f) continue;
+                    sum[0] += cornerTangents[3 * other + 0];
+                    sum[1] += cornerTangents[3 * other + 1];
+                    sum[2] += cornerTangents[3 * other + 2];
+                }
+
+                float d = dot(n, sum);
+                float tangent[3] = { sum[0] - n[0] * d, sum[1] - n[1] * d, sum[2] - n[2] * d };
+                if (!normalize(tangent)) {
+                    // Degenerate UVs: any unit vector perpendicular to the normal
+                    float axis[3] = { fabsf(n[0]) < 0.9f ? 1.0f : 0.0f, fabsf(n[0]) < 0.9f ? 0.0f : 1.0f, 0.0f };
+                    cross(axis, n, tangent);
+                    normalize(tangent);
+                }
+
+                outTangents[4 * corner + 0] = tangent[0];
+                outTangents[4 * corner + 1] = tangent[1];
+                outTangents[4 * corner + 2] = tangent[2];
+                outTangents[4 * corner + 3] = sign;
+            }
+        });
+    }
+
+    // Runs fn(begin, end, threadIndex) over [0, count) split across hardware threads.
+    // Returns the number of threads used.
+    template <typename Fn>
+    static unsigned int parallelFor(size_t count, Fn fn) {
+        unsigned int threadCount = threadCountFor(count);
+        if (threadCount <= 1) {
+            fn(0, count, 0);
+            return 1;
+        }
+
+        std::vector<std::thread> workers;
+        workers.reserve(threadCount - 1);
+        size_t step = (count + threadCount - 1) / threadCount;
+        for (unsigned int i = 1; i < threadCount; ++i) {
+            size_t begin = std::min(count, i * step);
+            size_t end = std::min(count, begin + step);
+            workers.emplace_back([&fn, begin, end, i]() { fn(begin, end, i); });
+        }
+        fn(0, std::min(count, step), 0);
+        for (auto& worker : workers) worker.join();
+        return threadCount;
+    }
+
+    static unsigned int threadCountFor(size_t triangleCount) {
+        unsigned int hardware = std::max(1u, std::thread::hardware_concurrency());
+        size_t wanted = triangleCount / MIN_TRIANGLES_PER_THREAD;
+        return static_cast<unsigned int>(std::max<size_t>(1, std::min<size_t>(hardware, wanted)));
+    }
+
+private:
+    static float dot(const float* a, const float* b) {
+        return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    }
+
+    static void cross(const float* a, const float* b, float* out) {
+        out[0] = a[1] * b[2] - a[2] * b[1];
+        out[1] = a[2] * b[0] - a[0] * b[2];
+        out[2] = a[0] * b[1] - a[1] * b[0];
+    }
+
+    static bool normalize(float* v) {
+        float len = sqrtf(dot(v, v));
+        if (len <= 1e-20f) return false;
+        v[0] /= len; v[1] /= len; v[2] /= len;
+        return true;
+    }
+
+    // Interior angle of triangle t at corner c
+    static float cornerAngle(const float* positions, const unsigned int* cornerPositions, size_t t, int c) {
+        const float* p = positions + 3 * cornerPositions[3 * t + c];
+        const float* a = positions + 3 * cornerPositions[3 * t + (c + 1) % 3];
+        const float* b = positions + 3 * cornerPositions[3 * t + (c + 2) % 3];
+        float ea[3] = { a[0] - p[0], a[1] - p[1], a[2] - p[2] };
+        float eb[3] = { b[0] - p[0], b[1] - p[1], b[2] - p[2] };
+        if (!normalize(ea) || !normalize(eb)) return 0.0f;
+        float d = std::max(-1.0f, std::min(1.0f, dot(ea, eb)));
+        return acosf(d);
+    }
+
+    // Unnormalised face normals (length = 2 * area) and per-corner angles
+    static void computeFaceData(const float* positions, const unsigned int* cornerPositions, size_t triangleCount,
+                                float* faceNormals, float* cornerWeights) {
+        parallelFor(triangleCount, [&](size_t begin, size_t end, unsigned int) {
+            for (size_t t = begin; t < end; ++t) {
+                const float* p0 = positions + 3 * cornerPositions[3 * t + 0];
+                const float* p1 = positions + 3 * cornerPositions[3 * t + 1];
+                const float* p2 = positions + 3 * cornerPositions[3 * t + 2];
+                float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+                float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+                cross(e1, e2, faceNormals + 3 * t);
+
+                for (int c = 0; c < 3; ++c) {
+                    cornerWeights[3 * t + c] = cornerAngle(positions, cornerPositions, t, c);
+                }
+            }
+        });
+    }
+
+    // Fallback when every contribution cancelled out: the face's own normal
+    static void writeNormal(float* sum, const float* faceNormal, float* out) {
+        if (!normalize(sum)) {
+            sum[0] = faceNormal[0]; sum[1] = faceNormal[1]; sum[2] = faceNormal[2];
+            if (!normalize(sum)) {
+                sum[0] = 0.0f; sum[1] = 1.0f; sum[2] = 0.0f;
+            }
+        }
+        out[0] = sum[0]; out[1] = sum[1]; out[2] = sum[2];
+    }
+
+    // No splitting: each thread accumulates into its own per-position buffer,
+    // then the buffers are reduced in parallel over positions
+    static void smoothAll(size_t positionCount, const unsigned int* cornerPositions, size_t triangleCount,
+                          const float* faceNormals, const float* cornerWeights, float* outNormals) {
+        unsigned int threadCount = threadCountFor(triangleCount);
+        std::vector<std::vector<float>> accumulators(threadCount);
+
+        parallelFor(triangleCount, [&](size_t begin, size_t end, unsigned int thread) {
+            std::vector<float>& acc = accumulators[thread];
+            acc.assign(positionCount * 3, 0.0f);
+            for (size_t t = begin; t < end; ++t) {
+                const float* fn = faceNormals + 3 * t;
+                for (int c = 0; c < 3; ++c) {
+                    float w = cornerWeights[3 * t + c];
+                    float* dst = acc.data() + 3 * cornerPositions[3 * t + c];
+                    dst[0] += fn[0] * w;
+                    dst[1] += fn[1] * w;
+                    dst[2] += fn[2] * w;
+                }
+            }
+        });
+
+        std::vector<float>& total = accumulators[0];
+        if (threadCount > 1) {
+            parallelFor(positionCount, [&](size_t begin, size_t end, unsigned int) {
+                for (unsigned int thread = 1; thread < threadCount; ++thread) {
+                    const std::vector<float>& acc = accumulators[thread];
+                    if (acc.empty()) continue;
+                    for (size_t i = begin * 3; i < end * 3; ++i) total[i] += acc[i];
+                }
+            });
+        }
+
+        parallelFor(triangleCount, [&](size_t begin, size_t end, unsigned int) {
+            for (size_t corner = begin * 3; corner < end * 3; ++corner) {
+                const float* src = total.data() + 3 * cornerPositions[corner];
+                float sum[3] = { src[0], src[1], src[2] };
+                writeNormal(sum, faceNormals + 3 * (corner / 3), outNormals + 3 * corner);
+            }
+        });
+    }
+
+    // Smoothing groups by angle: every corner gathers the weighted normals of
+    // the faces around its position that are within the threshold of its own face
+    static void smoothWithThreshold(size_t positionCount, const unsigned int* cornerPositions, size_t triangleCount,
+                                    float cosThreshold, const float* faceNormals, const float* cornerWeights,
+                                    float* outNormals) {
+        std::vector<float> unitFaces(faceNormals, faceNormals + triangleCount * 3);
+        parallelFor(triangleCount, [&](size_t begin, size_t end, unsigned int) {
+            for (size_t t = begin; t < end; ++t) normalize(unitFaces.data() + 3 * t);
+        });
+
+        std::vector<unsigned int> offsets, corners;
+        buildAdjacency(positionCount, cornerPositions, triangleCount * 3, offsets, corners);
+
+        parallelFor(triangleCount, [&](size_t begin, size_t end, unsigned int) {
+            for (size_t corner = begin * 3; corner < end * 3; ++corner) {
+                size_t face = corner / 3;
+                const float* ownFace = unitFaces.data() + 3 * face;
+                float sum[3] = { 0.0f, 0.0f, 0.0f };
+
+                unsigned int position = cornerPositions[corner];
+                for (unsigned int i = offsets[position]; i < offsets[position + 1]; ++i) {
+                    unsigned int other = corners[i];
+                    size_t otherFace = other / 3;
+                    if (otherFace != face && dot(unitFaces.data() + 3 * otherFace, ownFace) < cosThreshold) continue;
+                    float w = cornerWeights[other];
+                    const float* fn = faceNormals + 3 * otherFace;
+                    sum[0] += fn[0] * w;
+                    sum[1] += fn[1] * w;
+                    sum[2] += fn[2] * w;
+                }
+
+                writeNormal(sum, faceNormals + 3 * face, outNormals + 3 * corner);
+            }
+        });
+    }
+
+    // Position -> corners table in compressed row form
+    static void buildAdjacency(size_t positionCount, const unsigned int* cornerPositions, size_t cornerCount,
+                               std::vector<unsigned int>& offsets, std::vector<unsigned int>& corners) {
+        offsets.assign(positionCount + 1, 0);
+        for (size_t c = 0; c < cornerCount; ++c) offsets[cornerPositions[c] + 1]++;
+        for (size_t p = 0; p < positionCount; ++p) offsets[p + 1] += offsets[p];
+
+        corners.resize(cornerCount);
+        std::vector<unsigned int> cursor(offsets.begin(), offsets.end() - 1);
+        for (size_t c = 0; c < cornerCount; ++c) {
+            corners[cursor[cornerPositions[c]]++] = static_cast<unsigned int>(c);
+        }
+    }
+};
@@ -0,0 +1,805 @@
+#pragma once
+
+// Out-of-core meshes: OBJ files too large to hold in memory.
+//
+// OutOfCoreBuilder converts an OBJ once into a .oocm file: an octree of
+// chunks, each at most LEAF_TRIANGLES triangles. Leaves hold the original
+// triangles; every interior node holds a vertex-clustered simplification of
+// its children together with its geometric error (world units), so a renderer
+// can stop at any depth. The conversion streams through temporary files and
+// never holds more than a few nodes' worth of triangles.
+//
+// Chunks are stored ready to upload: 16-bit positions quantized to the
+// chunk's bounding cube, 8-bit normals and 16-bit indices (12 bytes per
+// vertex instead of 24, 2 bytes per index instead of 4).
+//
+// OutOfCoreMesh maps a .oocm file read-only; OocChunkLoader copies requested
+// chunks out of the mapping on a worker thread and drops the pages again, so
+// resident memory stays bounded by the loader queue, not the file size.
+// No OpenGL here; the editor owns the GPU cache.
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+static const char OOCM_MAGIC[4] = { 'O', 'O', 'C', 'M' };
+static const uint32_t OOCM_VERSION = 1;
+
+struct OocFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t nodeCount;
+    uint32_t rootNode;
+    uint64_t nodeTableOffset;
+    uint64_t triangleCount;         // leaf triangles, i.e. the source mesh
+    float boundsMin[3];
+    float boundsSize;               // the root is a cube
+};
+
+struct OocNode {
+    float boundsMin[3];             // cube the chunk's vertices are quantized to
+    float boundsSize;
+    float error;                    // world-space error of this chunk; 0 for leaves
+    uint32_t childCount;
+    uint32_t children[8];
+    uint64_t chunkOffset;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+};
+
+// position / 65535 * boundsSize + boundsMin; normal / 127
+struct OocVertex {
+    uint16_t position[4];           // w unused, keeps normals 4-byte aligned
+    int8_t normal[4];
+};
+
+class OutOfCoreBuilder {
+public:
+    static const uint32_t LEAF_TRIANGLES = 16384;
+    static const int MAX_DEPTH = 16;         // deeper nodes split by count, not space
+    static const int CLUSTER_GRID = 64;      // first clustering resolution tried for coarse chunks
+
+    // Convert objPath to outPath. progress, if given, goes from 0 to 1; setting
+    // *cancel stops the conversion and removes the partial output.
+    static bool build(const char* objPath, const char* outPath, std::atomic<float>* progress,
+                      const std::atomic<bool>* cancel, std::string& error) {
+        Context c;
+        c.tempBase = std::string(outPath) + ".tmp";
+        c.progress = progress;
+        c.cancel = cancel;
+        setProgress(c, 0.0f);
+
+        std::string positionsPath = c.tempBase + ".positions";
+        std::string facesPath = c.tempBase + ".faces";
+        std::string rootPath = nextTempPath(c);
+        float boundsMin[3], boundsSize;
+        bool ok = readOBJ(c, objPath, positionsPath, facesPath, boundsMin, boundsSize, error) &&
+                  resolveTriangles(c, positionsPath, facesPath, rootPath, error);
+        remove(positionsPath.c_str());
+        remove(facesPath.c_str());
+        if (!ok) {
+            remove(rootPath.c_str());
+            return false;
+        }
+        if (c.totalTriangles == 0) {
+            remove(rootPath.c_str());
+            error = "No triangles found in OBJ file";
+            return false;
+        }
+
+        c.out = fopen(outPath, "wb");
+        if (!c.out) {
+            remove(rootPath.c_str());
+            error = std::string("Cannot write ") + outPath;
+            return false;
+        }
+
+        OocFileHeader header = {};
+        fwrite(&header, sizeof(header), 1, c.out);
+        c.offset = sizeof(header);
+
+        std::vector<float> rootTriangles;
+        uint32_t root = buildNode(c, rootPath, c.totalTriangles, boundsMin, boundsSize, 0, rootTriangles);
+
+        memcpy(header.magic, OOCM_MAGIC, sizeof(header.magic));
+        header.version = OOCM_VERSION;
+        header.nodeCount = (uint32_t)c.nodes.size();
+        header.rootNode = root;
+        header.nodeTableOffset = c.offset;
+        header.triangleCount = c.totalTriangles;
+        memcpy(header.boundsMin, boundsMin, sizeof(header.boundsMin));
+        header.boundsSize = boundsSize;
+
+        bool written = fwrite(c.nodes.data(), sizeof(OocNode), c.nodes.size(), c.out) == c.nodes.size();
+        written = written && fseek(c.out, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, c.out) == 1;
+        written = fclose(c.out) == 0 && written;
+        if (!written || c.failed) {
+            remove(outPath);
+            error = cancelled(c) ? "Conversion cancelled" : std::string("Failed writing ") + outPath;
+            return false;
+        }
+        setProgress(c, 1.0f);
+        return true;
+    }
+
+private:
+    struct Context {
+        FILE* out = nullptr;
+        uint64_t offset = 0;
+        std::vector<OocNode> nodes;
+        std::string tempBase;
+        int tempCounter = 0;
+        uint64_t totalTriangles = 0;
+        uint64_t doneTriangles = 0;
+        std::atomic<float>* progress = nullptr;
+        const std::atomic<bool>* cancel = nullptr;
+        bool failed = false;
+    };
+
+    static bool cancelled(const Context& c) {
+        return c.cancel && c.cancel->load(std::memory_order_relaxed);
+    }
+
+    static void setProgress(Context& c, float value) {
+        if (c.progress) c.progress->store(value, std::memory_order_relaxed);
+    }
+
+    static std::string nextTempPath(Context& c) {
+        char suffix[32];
+        snprintf(suffix, sizeof(suffix), ".%d", c.tempCounter++);
+        return c.tempBase + suffix;
+    }
+
+    // Pass 1: stream the OBJ once, writing positions as floats and fan-triangulated
+    // faces as absolute position indices
+    static bool readOBJ(Context& c, const char* objPath, const std::string& positionsPath, const std::string& facesPath,
+                        float boundsMin[3], float& boundsSize, std::string& error) {
+        FILE* in = fopen(objPath, "rb");
+        if (!in) {
+            error = std::string("Cannot open ") + objPath;
+            return false;
+        }
+        FILE* positions = fopen(positionsPath.c_str(), "wb");
+        FILE* faces = fopen(facesPath.c_str(), "wb");
+        if (!positions || !faces) {
+            if (positions) fclose(positions);
+            if (faces) fclose(faces);
+            fclose(in);
+            error = "Cannot create temporary files next to the output";
+            return false;
+        }
+
+        float lo[3] = { FLT_MAX_VALUE, FLT_MAX_VALUE, FLT_MAX_VALUE };
+        float hi[3] = { -FLT_MAX_VALUE, -FLT_MAX_VALUE, -FLT_MAX_VALUE };
+        uint64_t positionCount = 0;
+        bool tooLarge = false;
+
+        const size_t BLOCK = 1 << 20;
+        std::vector<char> buffer(BLOCK + 1);
+        size_t carry = 0;
+        std::vector<uint32_t> polygon;
+        for (;;) {
+            size_t read = fread(buffer.data() + carry, 1, BLOCK - carry, in);
+            size_t length = carry + read;
+            if (length == 0) break;
+            bool last = read == 0 || feof(in);
+
+            size_t start = 0;
+            for (size_t i = 0; i <= length; ++i) {
+                bool endOfLine = i < length ? buffer[i] == '\n' : last;
+                if (!endOfLine) continue;
+                buffer[i] = '\0';
+                const char* line = buffer.data() + start;
+                start = i + 1;
+
+                while (*line == ' ' || *line == '\t') line++;
+                if (line[0] == 'v' && (line[1] == ' ' || line[1] == '\t')) {
+                    char* p = const_cast<char*>(line + 2);
+                    float v[3];
+                    for (int k = 0; k < 3; ++k) v[k] = strtof(p, &p);
+                    for (int k = 0; k < 3; ++k) {
+                        lo[k] = std::min(lo[k], v[k]);
+                        hi[k] = std::max(hi[k], v[k]);
+                    }
+                    fwrite(v, sizeof(float), 3, positions);
+                    positionCount++;
+                } else if (line[0] == 'f' && (line[1] == ' ' || line[1] == '\t')) {
+                    polygon.clear();
+                    const char* p = line + 2;
+                    for (;;) {
+                        while (*p == ' ' || *p == '\t' || *p == '\r') p++;
+                        if (!*p) break;
+                        char* end;
+                        long long index = strtoll(p, &end, 10);
+                        if (end == p) break;
+                        p = end;
+                        while (*p && *p != ' ' && *p != '\t' && *p != '\r') p++;   // skip /vt/vn
+                        long long resolved = index < 0 ? (long long)positionCount + index : index - 1;
+                        if (resolved < 0 || resolved >= (long long)UINT32_MAX) continue;
+                        polygon.push_back((uint32_t)resolved);
+                    }
+                    for (size_t k = 2; k < polygon.size(); ++k) {
+                        uint32_t triangle[3] = { polygon[0], polygon[k - 1], polygon[k] };
+                        fwrite(triangle, sizeof(uint32_t), 3, faces);
+                    }
+                }
+                if (positionCount >= UINT32_MAX) tooLarge = true;
+            }
+            if (last || cancelled(c)) break;
+
+            // Keep the unfinished line for the next block
+            carry = length - std::min(start, length);
+            if (carry >= BLOCK) {
+                carry = 0;      // absurdly long line, drop it
+            } else {
+                memmove(buffer.data(), buffer.data() + start, carry);
+            }
+        }
+
+        bool ok = !ferror(in) && !ferror(positions) && !ferror(faces);
+        fclose(in);
+        ok = fclose(positions) == 0 && ok;
+        ok = fclose(faces) == 0 && ok;
+        if (cancelled(c)) {
+            error = "Conversion cancelled";
+            return false;
+        }
+        if (!ok || tooLarge) {
+            error = tooLarge ? "OBJ has more than 4 billion vertices" : "I/O error while reading the OBJ";
+            return false;
+        }
+        if (positionCount == 0) {
+            error = "No vertices found in OBJ file";
+            return false;
+        }
+
+        float extent = std::max(std::max(hi[0] - lo[0], hi[1] - lo[1]), hi[2] - lo[2]);
+        boundsSize = extent * 1.001f + 1e-6f;
+        for (int k = 0; k < 3; ++k) {
+            boundsMin[k] = (lo[k] + hi[k]) * 0.5f - boundsSize * 0.5f;
+        }
+        return true;
+    }
+
+    // Pass 2: look the face indices up in the mapped positions and write a triangle soup
+    static bool resolveTriangles(Context& c, const std::string& positionsPath, const std::string& facesPath,
+                                 const std::string& rootPath, std::string& error) {
+        MappedRegion positions;
+        if (!positions.open(positionsPath)) {
+            error = "Cannot map temporary positions";
+            return false;
+        }
+        const float* position = reinterpret_cast<const float*>(positions.data);
+        uint64_t positionCount = positions.size / (3 * sizeof(float));
+
+        FILE* faces = fopen(facesPath.c_str(), "rb");
+        FILE* out = fopen(rootPath.c_str(), "wb");
+        if (!faces || !out) {
+            if (faces) fclose(faces);
+            if (out) fclose(out);
+            error = "Cannot create temporary files next to the output";
+            return false;
+        }
+
+        std::vector<uint32_t> indices(3 * 65536);
+        std::vector<float> triangles;
+        size_t count;
+        while (!cancelled(c) && (count = fread(indices.data(), sizeof(uint32_t) * 3, indices.size() / 3, faces)) > 0) {
+            triangles.clear();
+            for (size_t t = 0; t < count; ++t) {
+                const uint32_t* corner = &indices[t * 3];
+                if (corner[0] >= positionCount || corner[1] >= positionCount || corner[2] >= positionCount) continue;
+                for (int k = 0; k < 3; ++k) {
+                    triangles.insert(triangles.end(), position + (size_t)corner[k] * 3, position + (size_t)corner[k] * 3 + 3);
+                }
+            }
+            fwrite(triangles.data(), sizeof(float), triangles.size(), out);
+            c.totalTriangles += triangles.size() / 9;
+        }
+
+        bool ok = !ferror(faces) && !ferror(out);
+        fclose(faces);
+        ok = fclose(out) == 0 && ok;
+        if (!ok) error = "I/O error while resolving faces";
+        if (cancelled(c)) {
+            error = "Conversion cancelled";
+            ok = false;
+        }
+        return ok;
+    }
+
+    // Build the subtree for the triangles in `path` (which is consumed) and
+    // return its node index. `chunkTriangles` receives the node's own chunk
+    // so the parent can simplify it further.
+    static uint32_t buildNode(Context& c, const std::string& path, uint64_t count, const float boundsMin[3],
+                              float boundsSize, int depth, std::vector<float>& chunkTriangles) {
+        OocNode node = {};
+        chunkTriangles.clear();
+        if (cancelled(c)) c.failed = true;
+
+        if (count <= LEAF_TRIANGLES) {
+            chunkTriangles.resize(count * 9);
+            FILE* in = fopen(path.c_str(), "rb");
+            size_t read = in ? fread(chunkTriangles.data(), sizeof(float) * 9, count, in) : 0;
+            if (in) fclose(in);
+            remove(path.c_str());
+            if (read != count) c.failed = true;
+            chunkTriangles.resize(read * 9);
+
+            writeChunk(c, node, chunkTriangles);
+            c.doneTriangles += count;
+            setProgress(c, 0.99f * (float)c.doneTriangles / (float)c.totalTriangles);
+            c.nodes.push_back(node);
+            return (uint32_t)c.nodes.size() - 1;
+        }
+
+        // Split by centroid octant, or into equal runs once the tree is deep enough
+        // that the triangles are probably coincident
+        std::string childPaths[8];
+        FILE* childFiles[8] = {};
+        uint64_t childCounts[8] = {};
+        for (int i = 0; i < 8; ++i) {
+            childPaths[i] = nextTempPath(c);
+            childFiles[i] = fopen(childPaths[i].c_str(), "wb");
+            if (!childFiles[i]) c.failed = true;
+        }
+
+        float half = boundsSize * 0.5f;
+        FILE* in = fopen(path.c_str(), "rb");
+        std::vector<float> block(9 * 4096);
+        uint64_t seen = 0;
+        size_t read;
+        while (in && (read = fread(block.data(), sizeof(float) * 9, block.size() / 9, in)) > 0) {
+            for (size_t t = 0; t < read; ++t, ++seen) {
+                const float* triangle = &block[t * 9];
+                int child;
+                if (depth < MAX_DEPTH) {
+                    child = 0;
+                    for (int k = 0; k < 3; ++k) {
+                        float centroid = (triangle[k] + triangle[3 + k] + triangle[6 + k]) / 3.0f;
+                        if (centroid >= boundsMin[k] + half) child |= 1 << k;
+                    }
+                } else {
+                    child = (int)(seen * 8 / count);
+                }
+                if (childFiles[child]) fwrite(triangle, sizeof(float), 9, childFiles[child]);
+                childCounts[child]++;
+            }
+        }
+        if (in) fclose(in);
+        remove(path.c_str());
+        for (int i = 0; i < 8; ++i) {
+            if (childFiles[i] && fclose(childFiles[i]) != 0) c.failed = true;
+        }
+
+        std::vector<float> gathered;
+        std::vector<float> childTriangles;
+        float childError = 0.0f;
+        for (int i = 0; i < 8; ++i) {
+            if (childCounts[i] == 0 || c.failed) {
+                remove(childPaths[i].c_str());
+                continue;
+            }
+            float childMin[3];
+            float childSize = boundsSize;
+            memcpy(childMin, boundsMin, sizeof(childMin));
+            if (depth < MAX_DEPTH) {
+                childSize = half;
+                for (int k = 0; k < 3; ++k) {
+                    if (i & (1 << k)) childMin[k] += half;
+                }
+            }
+            uint32_t childIndex = buildNode(c, childPaths[i], childCounts[i], childMin, childSize, depth + 1, childTriangles);
+            node.children[node.childCount++] = childIndex;
+            childError = std::max(childError, c.nodes[childIndex].error);
+            gathered.insert(gathered.end(), childTriangles.begin(), childTriangles.end());
+        }
+
+        // Coarsen until the chunk fits; the cell diagonal bounds the error
+        float cellError = 0.0f;
+        for (int grid = CLUSTER_GRID; grid >= 1; grid /= 2) {
+            clusterTriangles(gathered, boundsMin, boundsSize, grid, chunkTriangles);
+            cellError = boundsSize / grid * 1.7320508f;
+            if (chunkTriangles.size() / 9 <= LEAF_TRIANGLES) break;
+        }
+        if (chunkTriangles.size() / 9 > LEAF_TRIANGLES) chunkTriangles.resize(LEAF_TRIANGLES * 9);
+        node.error = std::max(cellError, childError * 1.0001f);
+
+        writeChunk(c, node, chunkTriangles);
+        c.nodes.push_back(node);
+        return (uint32_t)c.nodes.size() - 1;
+    }
+
+    // Vertex clustering: snap every corner to the average of its grid cell and
+    // drop triangles that collapse
+    static void clusterTriangles(const std::vector<float>& triangles, const float boundsMin[3], float boundsSize,
+                                 int grid, std::vector<float>& result) {
+        std::unordered_map<uint32_t, uint32_t> cellIndex;
+        std::vector<float> sums;
+        std::vector<uint32_t> counts;
+        std::vector<uint32_t> corners(triangles.size() / 3);
+        float scale = grid / boundsSize;
+        for (size_t v = 0; v < corners.size(); ++v) {
+            const float* p = &triangles[v * 3];
+            uint32_t cell = 0;
+            for (int k = 2; k >= 0; --k) {
+                int coordinate = (int)((p[k] - boundsMin[k]) * scale);
+                coordinate = std::min(std::max(coordinate, 0), grid - 1);
+                cell = cell * grid + (uint32_t)coordinate;
+            }
+            auto inserted = cellIndex.emplace(cell, (uint32_t)counts.size());
+            if (inserted.second) {
+                sums.insert(sums.end(), { 0.0f, 0.0f, 0.0f });
+                counts.push_back(0);
+            }
+            uint32_t index = inserted.first->second;
+            for (int k = 0; k < 3; ++k) sums[index * 3 + k] += p[k];
+            counts[index]++;
+            corners[v] = index;
+        }
+
+        result.clear();
+        for (size_t t = 0; t + 2 < corners.size(); t += 3) {
+            uint32_t a = corners[t], b = corners[t + 1], d = corners[t + 2];
+            if (a == b || b == d || a == d) continue;
+            for (uint32_t index : { a, b, d }) {
+                for (int k = 0; k < 3; ++k) result.push_back(sums[index * 3 + k] / counts[index]);
+            }
+        }
+    }
+
+    struct PositionKey {
+        float p[3];
+        bool operator==(const PositionKey& other) const { return memcmp(p, other.p, sizeof(p)) == 0; }
+    };
+
+    struct PositionHash {
+        size_t operator()(const PositionKey& key) const {
+            uint32_t bits[3];
+            memcpy(bits, key.p, sizeof(bits));
+            return (size_t)(bits[0] * 73856093u ^ bits[1] * 19349663u ^ bits[2] * 83492791u);
+        }
+    };
+
+    // Weld, generate normals, quantize and append one chunk to the output
+    static void writeChunk(Context& c, OocNode& node, const std::vector<float>& triangles) {
+        std::unordered_map<PositionKey, uint32_t, PositionHash> welded;
+        std::vector<float> positions;
+        std::vector<uint16_t> indices;
+        indices.reserve(triangles.size() / 3);
+        for (size_t v = 0; v + 9 <= triangles.size(); v += 9) {
+            uint16_t corner[3];
+            for (int k = 0; k < 3; ++k) {
+                PositionKey key;
+                memcpy(key.p, &triangles[v + k * 3], sizeof(key.p));
+                auto inserted = welded.emplace(key, (uint32_t)(positions.size() / 3));
+                if (inserted.second) positions.insert(positions.end(), key.p, key.p + 3);
+                corner[k] = (uint16_t)inserted.first->second;
+            }
+            if (corner[0] == corner[1] || corner[1] == corner[2] || corner[0] == corner[2]) continue;
+            indices.insert(indices.end(), corner, corner + 3);
+        }
+
+        // Area-weighted vertex normals
+        size_t vertexCount = positions.size() / 3;
+        std::vector<float> normals(positions.size(), 0.0f);
+        for (size_t t = 0; t < indices.size(); t += 3) {
+            const float* a = &positions[indices[t] * 3];
+            const float* b = &positions[indices[t + 1] * 3];
+            const float* d = &positions[indices[t + 2] * 3];
+            float e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+            float e2[3] = { d[0] - a[0], d[1] - a[1], d[2] - a[2] };
+            float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+            for (int corner = 0; corner < 3; ++corner) {
+                for (int k = 0; k < 3; ++k) normals[indices[t + corner] * 3 + k] += n[k];
+            }
+        }
+
+        // Quantize to the chunk's own bounding cube (triangles can poke out of their octree cell)
+        float lo[3] = { FLT_MAX_VALUE, FLT_MAX_VALUE, FLT_MAX_VALUE };
+        float hi[3] = { -FLT_MAX_VALUE, -FLT_MAX_VALUE, -FLT_MAX_VALUE };
+        for (size_t v = 0; v < vertexCount; ++v) {
+            for (int k = 0; k < 3; ++k) {
+                lo[k] = std::min(lo[k], positions[v * 3 + k]);
+                hi[k] = std::max(hi[k], positions[v * 3 + k]);
+            }
+        }
+        float size = vertexCount ? std::max(std::max(hi[0] - lo[0], hi[1] - lo[1]), hi[2] - lo[2]) : 0.0f;
+        size = std::max(size, 1e-6f);
+        for (int k = 0; k < 3; ++k) node.boundsMin[k] = vertexCount ? lo[k] : 0.0f;
+        node.boundsSize = size;
+
+        std::vector<OocVertex> vertices(vertexCount);
+        for (size_t v = 0; v < vertexCount; ++v) {
+            const float* n = &normals[v * 3];
+            float length = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            float inverse = length > 0.0f ? 127.0f / length : 0.0f;
+            for (int k = 0; k < 3; ++k) {
+                float q = (positions[v * 3 + k] - node.boundsMin[k]) / size * 65535.0f + 0.5f;
+                vertices[v].position[k] = (uint16_t)std::min(std::max(q, 0.0f), 65535.0f);
+                vertices[v].normal[k] = (int8_t)lrintf(n[k] * inverse);
+            }
+            vertices[v].position[3] = 0;
+            vertices[v].normal[3] = 0;
+        }
+
+        node.chunkOffset = c.offset;
+        node.vertexCount = (uint32_t)vertexCount;
+        node.indexCount = (uint32_t)indices.size();
+        size_t written = fwrite(vertices.data(), sizeof(OocVertex), vertices.size(), c.out) * sizeof(OocVertex);
+        written += fwrite(indices.data(), sizeof(uint16_t), indices.size(), c.out) * sizeof(uint16_t);
+        static const char padding[4] = {};
+        size_t pad = (4 - written % 4) % 4;
+        written += fwrite(padding, 1, pad, c.out);
+        if (written != vertices.size() * sizeof(OocVertex) + indices.size() * sizeof(uint16_t) + pad) c.failed = true;
+        c.offset += written;
+    }
+
+public:
+    // Read-only mapping of a whole file
+    struct MappedRegion {
+        const char* data = nullptr;
+        uint64_t size = 0;
+#ifdef _WIN32
+        HANDLE file = INVALID_HANDLE_VALUE;
+        HANDLE mapping = NULL;
+#endif
+
+        MappedRegion() {}
+        ~MappedRegion() { close(); }
+        MappedRegion(const MappedRegion&) = delete;
+        MappedRegion& operator=(const MappedRegion&) = delete;
+
+        bool open(const std::string& path) {
+            close();
+#ifdef _WIN32
+            file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, NULL);
+            if (file == INVALID_HANDLE_VALUE) return false;
+            LARGE_INTEGER fileSize;
+            if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+                close();
+                return false;
+            }
+            size = (uint64_t)fileSize.QuadPart;
+            mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+            if (mapping) data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) return false;
+            struct stat fileStat;
+            if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0) {
+                ::close(fd);
+                return false;
+            }
+            size = (uint64_t)fileStat.st_size;
+            void* mapped = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (mapped != MAP_FAILED) {
+                madvise(mapped, size, MADV_RANDOM);
+                data = static_cast<const char*>(mapped);
+            }
+#endif
+            if (!data) {
+                close();
+                return false;
+            }
+            return true;
+        }
+
+        void close() {
+#ifdef _WIN32
+            if (data) UnmapViewOfFile(data);
+            if (mapping) CloseHandle(mapping);
+            if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+            mapping = NULL;
+            file = INVALID_HANDLE_VALUE;
+#else
+            if (data) munmap(const_cast<char*>(data), size);
+#endif
+            data = nullptr;
+            size = 0;
+        }
+
+        // Let the OS drop the pages behind a range we have finished copying
+        void release(uint64_t offset, uint64_t length) const {
+#ifndef _WIN32
+            static const uint64_t page = (uint64_t)sysconf(_SC_PAGESIZE);
+            uint64_t begin = (offset + page - 1) / page * page;
+            uint64_t end = (offset + length) / page * page;
+            if (end > begin) madvise(const_cast<char*>(data) + begin, end - begin, MADV_DONTNEED);
+#else
+            (void)offset;
+            (void)length;       // clean file-backed pages are trimmed from the working set by the OS
+#endif
+        }
+    };
+
+private:
+    static constexpr float FLT_MAX_VALUE = 3.402823466e+38f;
+};
+
+// A converted mesh, mapped read-only
+class OutOfCoreMesh {
+public:
+    bool open(const std::string& path, std::string& error) {
+        close();
+        if (!file.open(path)) {
+            error = "Cannot open " + path;
+            return false;
+        }
+        if (file.size < sizeof(OocFileHeader)) {
+            error = "Not an out-of-core mesh: " + path;
+            close();
+            return false;
+        }
+        memcpy(&header, file.data, sizeof(header));
+        if (memcmp(header.magic, OOCM_MAGIC, sizeof(header.magic)) != 0 || header.version != OOCM_VERSION ||
+            header.nodeTableOffset + (uint64_t)header.nodeCount * sizeof(OocNode) > file.size ||
+            header.rootNode >= header.nodeCount) {
+            error = "Not an out-of-core mesh (or an old version): " + path;
+            close();
+            return false;
+        }
+        nodes.resize(header.nodeCount);
+        memcpy(nodes.data(), file.data + header.nodeTableOffset, nodes.size() * sizeof(OocNode));
+        for (const OocNode& node : nodes) {
+            if (node.chunkOffset + chunkBytes(node) > header.nodeTableOffset || node.childCount > 8) {
+                error = "Corrupt out-of-core mesh: " + path;
+                close();
+                return false;
+            }
+        }
+        file.release(header.nodeTableOffset, nodes.size() * sizeof(OocNode));
+        return true;
+    }
+
+    void close() {
+        file.close();
+        nodes.clear();
+        header = OocFileHeader();
+    }
+
+    bool isOpen() const { return file.data != nullptr; }
+    const OocFileHeader& info() const { return header; }
+    uint32_t nodeCount() const { return (uint32_t)nodes.size(); }
+    uint32_t rootNode() const { return header.rootNode; }
+    const OocNode& node(uint32_t index) const { return nodes[index]; }
+
+    static uint64_t chunkBytes(const OocNode& node) {
+        return (uint64_t)node.vertexCount * sizeof(OocVertex) + (uint64_t)node.indexCount * sizeof(uint16_t);
+    }
+
+    // Copy a chunk out of the mapping and drop its pages again
+    void readChunk(uint32_t index, std::vector<char>& out) const {
+        const OocNode& n = nodes[index];
+        uint64_t bytes = chunkBytes(n);
+        out.assign(file.data + n.chunkOffset, file.data + n.chunkOffset + bytes);
+        file.release(n.chunkOffset, bytes);
+    }
+
+private:
+    OutOfCoreBuilder::MappedRegion file;
+    OocFileHeader header = {};
+    std::vector<OocNode> nodes;
+};
+
+struct OocLoadedChunk {
+    uint32_t node = 0;
+    std::vector<char> data;         // OocVertex[vertexCount] then uint16_t[indexCount]
+};
+
+// Worker thread that reads requested chunks in priority order. setRequests()
+// replaces the whole queue each frame, so requests the camera no longer needs
+// are dropped. At most MAX_READY chunks wait for upload.
+class OocChunkLoader {
+public:
+    static const size_t MAX_READY = 16;
+
+    ~OocChunkLoader() { stop(); }
+
+    void start(const OutOfCoreMesh* source) {
+        stop();
+        mesh = source;
+        quit = false;
+        worker = std::thread([this]() { run(); });
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quit = true;
+        }
+        wake.notify_all();
+        if (worker.joinable()) worker.join();
+        requests.clear();
+        ready.clear();
+        inFlight = UINT32_MAX;
+    }
+
+    // Nodes to load, most important first
+    void setRequests(const std::vector<uint32_t>& nodes) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            requests.assign(nodes.rbegin(), nodes.rend());     // popped from the back
+            requests.erase(std::remove_if(requests.begin(), requests.end(), [this](uint32_t node) {
+                return node == inFlight || isReady(node);
+            }), requests.end());
+        }
+        wake.notify_one();
+    }
+
+    bool popReady(OocLoadedChunk& chunk) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (ready.empty()) return false;
+        chunk = std::move(ready.front());
+        ready.erase(ready.begin());
+        wake.notify_one();
+        return true;
+    }
+
+    size_t pendingRequests() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return requests.size();
+    }
+
+    uint64_t loadedChunks() const { return loaded.load(std::memory_order_relaxed); }
+
+private:
+    bool isReady(uint32_t node) const {
+        for (const OocLoadedChunk& chunk : ready) {
+            if (chunk.node == node) return true;
+        }
+        return false;
+    }
+
+    void run() {
+        for (;;) {
+            uint32_t node;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this]() { return quit || (!requests.empty() && ready.size() < MAX_READY); });
+                if (quit) return;
+                node = requests.back();
+                requests.pop_back();
+                inFlight = node;
+            }
+
+            OocLoadedChunk chunk;
+            chunk.node = node;
+            mesh->readChunk(node, chunk.data);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            inFlight = UINT32_MAX;
+            ready.push_back(std::move(chunk));
+            loaded.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    const OutOfCoreMesh* mesh = nullptr;
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<uint32_t> requests;
+    std::vector<OocLoadedChunk> ready;
+    uint32_t inFlight = UINT32_MAX;
+    bool quit = false;
+    std::atomic<uint64_t> loaded{0};
+};
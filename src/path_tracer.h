@@ -0,0 +1,1150 @@
+// src/path_tracer.h - Progressive CPU path tracer for editor scenes
+//
+// Meshes are stored once in object space, each with its own bounding volume
+// hierarchy built with the surface area heuristic (16 bins per axis).
+// Instances place meshes in the world with a transform and a color, and a
+// small top-level tree over the instances is rebuilt whenever they change, so
+// moving an object never rebuilds the tree of its mesh.
+//
+// Camera rays and the shadow rays from their hit points are traced as 2x2
+// packets: the four rays of a pixel quad walk the trees together, with the box
+// and triangle tests written as 4-lane loops over SoA data that the compiler
+// turns into SIMD. Bounce rays scatter too much for packets to stay coherent
+// and are traced one at a time.
+//
+// The image is cut into 32x32 tiles that the workers (one per core) take from
+// a shared counter, so fast tiles never wait for slow ones. Every pass adds one
+// sample per pixel to a float accumulation buffer; the 8-bit image is resolved
+// after each pass for whoever displays it. start() runs passes on a background
+// thread until stop() or the sample count is reached; renderPass() runs one on
+// the calling thread, for tools that render stills.
+//
+// Shading follows the editor viewport: Lambertian surfaces in the object
+// color, a point light without falloff (sampled directly, with shadow rays)
+// and a uniform sky light that plays the part of the viewport's ambient term.
+// An optional ground plane below the scene catches shadows.
+//
+// The scene, camera and settings may only change while no passes run.
+// No OpenGL here.
+
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+
+class PathTracer {
+public:
+    static const int TILE_SIZE = 32;
+
+    struct Settings {
+        int maxBounces = 3;                         // indirect bounces, 0 renders direct light only
+        float lightPosition[3] = { 5.0f, 5.0f, 5.0f };
+        float lightColor[3] = { 1.0f, 1.0f, 1.0f };
+        float skyColor[3] = { 0.2f, 0.2f, 0.2f };   // radiance of rays that leave the scene after a bounce
+        float background[3] = { 0.0f, 0.0f, 0.0f }; // camera rays that miss
+        bool groundPlane = true;
+        float groundHeight = 0.0f;
+        float groundColor[3] = { 0.5f, 0.5f, 0.5f };
+        float exposure = 1.0f;
+    };
+
+    ~PathTracer() { stop(); }
+
+    // Copies a triangle mesh; vertices are stride floats apart, with the position first and,
+    // when stride >= 6, the normal next to it. Returns the id instances refer to.
+    int addMesh(const float* vertices, size_t vertexCount, size_t stride,
+                const unsigned int* indices, size_t indexCount) {
+        Mesh mesh;
+        mesh.positions.resize(vertexCount * 3);
+        if (stride >= 6) mesh.normals.resize(vertexCount * 3);
+        for (size_t i = 0; i < vertexCount; ++i) {
+            const float* v = vertices + i * stride;
+            memcpy(&mesh.positions[i * 3], v, 3 * sizeof(float));
+            if (stride >= 6) memcpy(&mesh.normals[i * 3], v + 3, 3 * sizeof(float));
+        }
+        // Triangles referring past the vertex data are dropped
+        mesh.indices.reserve(indexCount - indexCount % 3);
+        for (size_t i = 0; i + 2 < indexCount; i += 3) {
+            if (indices[i] >= vertexCount || indices[i + 1] >= vertexCount || indices[i + 2] >= vertexCount) continue;
+            mesh.indices.insert(mesh.indices.end(), indices + i, indices + i + 3);
+        }
+        sceneDirty = true;
+        if (!freeMeshes.empty()) {
+            int id = freeMeshes.back();
+            freeMeshes.pop_back();
+            meshes[id] = std::move(mesh);
+            return id;
+        }
+        meshes.push_back(std::move(mesh));
+        return static_cast<int>(meshes.size()) - 1;
+    }
+
+    // Frees the mesh; addMesh() hands its id out again. No instance may refer to it.
+    void removeMesh(int id) {
+        if (id < 0 || id >= static_cast<int>(meshes.size())) return;
+        meshes[id] = Mesh();
+        meshes[id].built = true;
+        freeMeshes.push_back(id);
+        sceneDirty = true;
+    }
+
+    void clearMeshes() {
+        meshes.clear();
+        freeMeshes.clear();
+        instances.clear();
+        sceneDirty = true;
+    }
+
+    void clearInstances() {
+        instances.clear();
+        sceneDirty = true;
+    }
+
+    // model: column-major 4x4 (as glm stores it), affine
+    void addInstance(int mesh, const float* model, const float* color) {
+        if (mesh < 0 || mesh >= static_cast<int>(meshes.size())) return;
+        Instance instance;
+        instance.mesh = mesh;
+        for (int row = 0; row < 3; ++row) {
+            for (int column = 0; column < 4; ++column) instance.toWorld[row * 4 + column] = model[column * 4 + row];
+        }
+        if (!invertAffine(instance.toWorld, instance.toObject)) return;     // flattened by a zero scale
+        memcpy(instance.color, color, sizeof(instance.color));
+        instances.push_back(instance);
+        sceneDirty = true;
+    }
+
+    // inverseViewProjection: column-major 4x4; rays run from the near to the far plane, so
+    // orthographic cameras work too. Resizing clears the image.
+    void setCamera(const float* inverseViewProjection, int width, int height) {
+        memcpy(cameraToWorld, inverseViewProjection, sizeof(cameraToWorld));
+        if (width != imageWidth || height != imageHeight) {
+            imageWidth = std::max(width, 0);
+            imageHeight = std::max(height, 0);
+            accumulation.assign(static_cast<size_t>(imageWidth) * imageHeight * 3, 0.0f);
+            std::lock_guard<std::mutex> lock(imageMutex);
+            image.assign(static_cast<size_t>(imageWidth) * imageHeight * 4, 0);
+            imageSamples = 0;
+        }
+    }
+
+    void setSettings(const Settings& value) { settings = value; }
+    const Settings& getSettings() const { return settings; }
+
+    // Builds the trees that are missing; renderPass() and start() call it as well
+    void prepare() {
+        if (!sceneDirty) return;
+        buildMeshTrees();
+        buildInstanceTree();
+        sceneDirty = false;
+    }
+
+    // Drops the accumulated samples
+    void reset() {
+        std::fill(accumulation.begin(), accumulation.end(), 0.0f);
+        sampleCount = 0;
+    }
+
+    // One sample per pixel over the whole image, on every core. Returns false if stop()
+    // cancelled it; the pass is not counted and the samples need a reset() before the next.
+    bool renderPass() {
+        prepare();
+        if (imageWidth <= 0 || imageHeight <= 0) return false;
+        auto start = std::chrono::steady_clock::now();
+
+        int tilesX = (imageWidth + TILE_SIZE - 1) / TILE_SIZE;
+        int tilesY = (imageHeight + TILE_SIZE - 1) / TILE_SIZE;
+        int tileCount = tilesX * tilesY;
+        uint32_t pass = static_cast<uint32_t>(sampleCount);
+        std::atomic<int> nextTile(0);
+        std::atomic<uint64_t> rays(0);
+
+        auto work = [&]() {
+            uint64_t traced = 0;
+            for (;;) {
+                int tile = nextTile++;
+                if (tile >= tileCount || cancel) break;
+                renderTile((tile % tilesX) * TILE_SIZE, (tile / tilesX) * TILE_SIZE, pass, traced);
+            }
+            rays += traced;
+        };
+
+        unsigned int threadCount = std::max(1u, std::min<unsigned int>(std::thread::hardware_concurrency(), tileCount));
+        std::vector<std::thread> workers;
+        workers.reserve(threadCount - 1);
+        for (unsigned int i = 1; i < threadCount; ++i) workers.emplace_back(work);
+        work();
+        for (auto& worker : workers) worker.join();
+        if (cancel) return false;
+
+        sampleCount++;
+        resolve();
+        float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        passMs = ms;
+        raysPerSecond = ms > 0.0f ? static_cast<double>(rays) * 1000.0 / ms : 0.0;
+        return true;
+    }
+
+    // Runs passes on a background thread from a cleared image until maxSamples are taken
+    void start(int maxSamples) {
+        stop();
+        cancel = false;
+        reset();
+        worker = std::thread([this, maxSamples]() {
+            while (!cancel && sampleCount < maxSamples) {
+                if (!renderPass()) break;
+            }
+        });
+    }
+
+    // Cancels the pass in flight and waits for the workers
+    void stop() {
+        if (!worker.joinable()) return;
+        cancel = true;
+        worker.join();
+        cancel = false;
+    }
+
+    bool running() const { return worker.joinable(); }
+
+    // Copies the newest image (RGBA, 8 bits) if it changed since version; rows run top to
+    // bottom unless bottomUp is set, which is what GL textures expect
+    bool takeImage(std::vector<uint8_t>& rgba, uint64_t& version, bool bottomUp) {
+        std::lock_guard<std::mutex> lock(imageMutex);
+        if (version == imageVersion) return false;
+        version = imageVersion;
+        rgba.resize(image.size());
+        size_t rowBytes = static_cast<size_t>(imageWidth) * 4;
+        for (int y = 0; y < imageHeight; ++y) {
+            int source = bottomUp ? imageHeight - 1 - y : y;
+            if (rowBytes) memcpy(&rgba[y * rowBytes], &image[source * rowBytes], rowBytes);
+        }
+        return true;
+    }
+
+    // Ray queries for other CPU tools (bakers). Call prepare() first and leave the scene alone
+    // while they run; any number of threads may query at once. Directions need not be unit
+    // length, t is in units of the direction.
+    struct RayHit {
+        float t;
+        int instance;                           // -1 for the ground plane
+        float position[3];
+        float normal[3];                        // shading normal, facing the ray
+        float albedo[3];
+    };
+
+    bool traceRay(const float* origin, const float* direction, RayHit& out) const {
+        Hit hit;
+        if (!intersect(origin, direction, hit, false)) return false;
+        Surface surface;
+        surfaceAt(origin, direction, hit, surface);
+        out.t = hit.t;
+        out.instance = hit.instance == GROUND ? -1 : hit.instance;
+        memcpy(out.position, surface.position, sizeof(out.position));
+        memcpy(out.normal, surface.normal, sizeof(out.normal));
+        memcpy(out.albedo, surface.albedo, sizeof(out.albedo));
+        return true;
+    }
+
+    bool occluded(const float* origin, const float* direction, float tMax) const {
+        Hit hit;
+        hit.t = tMax;
+        return intersect(origin, direction, hit, true);
+    }
+
+    // Four occlusion rays at once through the packet path; origins and directions are 4 x 3
+    // floats. Lanes with tMax <= 0 are skipped. Bit l of the result is set when ray l is blocked.
+    int occluded4(const float* origins, const float* directions, const float* tMax) const {
+        RayPacket packet;
+        for (int l = 0; l < 4; ++l) {
+            packet.ox[l] = origins[l * 3];
+            packet.oy[l] = origins[l * 3 + 1];
+            packet.oz[l] = origins[l * 3 + 2];
+            packet.dx[l] = directions[l * 3];
+            packet.dy[l] = directions[l * 3 + 1];
+            packet.dz[l] = directions[l * 3 + 2];
+            packet.tMax[l] = tMax[l] > 0.0f ? tMax[l] : -1.0f;
+        }
+        intersectPacket(packet, true);
+        int blocked = 0;
+        for (int l = 0; l < 4; ++l) {
+            if (tMax[l] > 0.0f && packet.tMax[l] < 0.0f) blocked |= 1 << l;
+        }
+        return blocked;
+    }
+
+    // Distance rays start off a surface by, to clear it; scales with the scene
+    float surfaceOffset() const { return rayOffset; }
+
+    // Sampling helpers, shared with the bakers
+    static float random(uint32_t& state) {
+        state = state * 747796405u + 2891336453u;
+        uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+        word = (word >> 22u) ^ word;
+        return (word >> 8) * (1.0f / 16777216.0f);
+    }
+
+    static uint32_t hashSeed(uint32_t a, uint32_t b) {
+        uint32_t h = a * 0x9E3779B1u ^ (b + 0x7F4A7C15u + (a << 6) + (a >> 2));
+        h ^= h >> 16;
+        h *= 0x85EBCA6Bu;
+        h ^= h >> 13;
+        h *= 0xC2B2AE35u;
+        h ^= h >> 16;
+        return h;
+    }
+
+    // Cosine-weighted direction around n
+    static void sampleHemisphere(const float* n, uint32_t& rng, float* out) {
+        float r1 = random(rng), r2 = random(rng);
+        float radius = sqrtf(r1);
+        float phi = 6.28318530718f * r2;
+        float x = radius * cosf(phi), y = radius * sinf(phi), z = sqrtf(std::max(0.0f, 1.0f - r1));
+
+        float sign = n[2] >= 0.0f ? 1.0f : -1.0f;
+        float a = -1.0f / (sign + n[2]);
+        float b = n[0] * n[1] * a;
+        float tangent[3] = { 1.0f + sign * n[0] * n[0] * a, sign * b, -sign * n[0] };
+        float bitangent[3] = { b, sign + n[1] * n[1] * a, -n[1] };
+        for (int k = 0; k < 3; ++k) out[k] = tangent[k] * x + bitangent[k] * y + n[k] * z;
+    }
+
+    int width() const { return imageWidth; }
+    int height() const { return imageHeight; }
+    int samples() const { return sampleCount; }
+    int imageSampleCount() const { return imageSamples; }
+    float lastPassMs() const { return passMs; }
+    double lastRaysPerSecond() const { return raysPerSecond; }
+    size_t meshCount() const { return meshes.size() - freeMeshes.size(); }
+    size_t instanceCount() const { return instances.size(); }
+
+    size_t triangleCount() const {
+        size_t count = 0;
+        for (const Instance& instance : instances) count += meshes[instance.mesh].indices.size() / 3;
+        return count;
+    }
+
+    // Tree nodes and triangle data of every mesh
+    size_t memoryBytes() const {
+        size_t bytes = instanceNodes.size() * sizeof(Node) + instances.size() * sizeof(Instance);
+        for (const Mesh& mesh : meshes) {
+            bytes += (mesh.positions.size() + mesh.normals.size() + mesh.triangles.size()) * sizeof(float);
+            bytes += (mesh.indices.size() + mesh.triangleIndex.size()) * sizeof(unsigned int);
+            bytes += mesh.nodes.size() * sizeof(Node);
+        }
+        return bytes + accumulation.size() * sizeof(float);
+    }
+
+private:
+    static const int BINS = 16;
+    static const int MAX_DEPTH = 48;                // deeper nodes are split at the median
+    static const int STACK_SIZE = 2 * MAX_DEPTH + 4;
+    static const int MESH_LEAF_SIZE = 4;
+    static const int INSTANCE_LEAF_SIZE = 1;
+    static const int GROUND = -2;                   // Hit::instance for the ground plane
+
+    // Inner nodes have count 0 and their children at first and first + 1
+    struct Node {
+        float min[3];
+        unsigned int first;
+        float max[3];
+        unsigned int count;
+    };
+
+    struct Bounds {
+        float min[3] = { INFINITY, INFINITY, INFINITY };
+        float max[3] = { -INFINITY, -INFINITY, -INFINITY };
+
+        void grow(const float* p) {
+            for (int k = 0; k < 3; ++k) {
+                min[k] = std::min(min[k], p[k]);
+                max[k] = std::max(max[k], p[k]);
+            }
+        }
+        void grow(const Bounds& b) {
+            for (int k = 0; k < 3; ++k) {
+                min[k] = std::min(min[k], b.min[k]);
+                max[k] = std::max(max[k], b.max[k]);
+            }
+        }
+        float area() const {
+            float dx = max[0] - min[0], dy = max[1] - min[1], dz = max[2] - min[2];
+            if (dx < 0.0f) return 0.0f;
+            return 2.0f * (dx * dy + dy * dz + dz * dx);
+        }
+    };
+
+    struct Mesh {
+        std::vector<float> positions;           // 3 per vertex
+        std::vector<float> normals;             // 3 per vertex, empty for flat shading
+        std::vector<unsigned int> indices;
+        std::vector<Node> nodes;
+        std::vector<float> triangles;           // in tree order: v0, v1 - v0, v2 - v0
+        std::vector<unsigned int> triangleIndex;    // tree order -> original triangle
+        bool built = false;
+    };
+
+    struct Instance {
+        int mesh = 0;
+        float toWorld[12];                      // row-major 3x4
+        float toObject[12];
+        float color[3];
+        Bounds bounds;
+    };
+
+    struct Hit {
+        float t = INFINITY;
+        int instance = -1;
+        unsigned int triangle = 0;
+        float u = 0.0f, v = 0.0f;
+    };
+
+    // Four rays traced together; lanes with a negative tMax take no part
+    struct RayPacket {
+        float ox[4], oy[4], oz[4];
+        float dx[4], dy[4], dz[4];
+        float tMax[4];
+        int instance[4];
+        unsigned int triangle[4];
+        float u[4], v[4];
+    };
+
+    struct Surface {
+        float position[3];
+        float normal[3];                        // faces the incoming ray
+        float albedo[3];
+    };
+
+    std::vector<Mesh> meshes;
+    std::vector<int> freeMeshes;
+    std::vector<Instance> instances;
+    std::vector<Node> instanceNodes;
+    std::vector<unsigned int> instanceOrder;
+    bool sceneDirty = true;
+    float rayOffset = 1e-4f;
+
+    Settings settings;
+    float cameraToWorld[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+    int imageWidth = 0, imageHeight = 0;
+    std::vector<float> accumulation;            // 3 per pixel, sum of all samples
+
+    std::mutex imageMutex;
+    std::vector<uint8_t> image;
+    uint64_t imageVersion = 0;
+    int imageSamples = 0;
+
+    std::thread worker;
+    std::atomic<bool> cancel{false};
+    std::atomic<int> sampleCount{0};
+    std::atomic<float> passMs{0.0f};
+    std::atomic<double> raysPerSecond{0.0};
+
+    // ---- Building -------------------------------------------------------------------------
+
+    static bool invertAffine(const float* m, float* out) {
+        float a = m[0], b = m[1], c = m[2];
+        float d = m[4], e = m[5], f = m[6];
+        float g = m[8], h = m[9], i = m[10];
+        float c0 = e * i - f * h, c1 = f * g - d * i, c2 = d * h - e * g;
+        float det = a * c0 + b * c1 + c * c2;
+        if (fabsf(det) < 1e-20f) return false;
+        float r = 1.0f / det;
+        float inv[9] = {
+            c0 * r, (c * h - b * i) * r, (b * f - c * e) * r,
+            c1 * r, (a * i - c * g) * r, (c * d - a * f) * r,
+            c2 * r, (b * g - a * h) * r, (a * e - b * d) * r
+        };
+        for (int row = 0; row < 3; ++row) {
+            out[row * 4 + 0] = inv[row * 3 + 0];
+            out[row * 4 + 1] = inv[row * 3 + 1];
+            out[row * 4 + 2] = inv[row * 3 + 2];
+            out[row * 4 + 3] = -(inv[row * 3 + 0] * m[3] + inv[row * 3 + 1] * m[7] + inv[row * 3 + 2] * m[11]);
+        }
+        return true;
+    }
+
+    static void transformPoint(const float* m, const float* p, float* out) {
+        for (int row = 0; row < 3; ++row) {
+            out[row] = m[row * 4] * p[0] + m[row * 4 + 1] * p[1] + m[row * 4 + 2] * p[2] + m[row * 4 + 3];
+        }
+    }
+
+    static void transformVector(const float* m, const float* v, float* out) {
+        for (int row = 0; row < 3; ++row) {
+            out[row] = m[row * 4] * v[0] + m[row * 4 + 1] * v[1] + m[row * 4 + 2] * v[2];
+        }
+    }
+
+    // Binned SAH over the boxes; order receives the leaf contents, leaves index into it
+    static void buildTree(const std::vector<Bounds>& boxes, unsigned int maxLeafSize,
+                          std::vector<Node>& nodes, std::vector<unsigned int>& order) {
+        struct Task { unsigned int node, begin, end; int depth; };
+        const float TRAVERSAL_COST = 1.0f;
+
+        size_t count = boxes.size();
+        order.resize(count);
+        std::vector<float> centroids(count * 3);
+        for (size_t i = 0; i < count; ++i) {
+            order[i] = static_cast<unsigned int>(i);
+            for (int k = 0; k < 3; ++k) centroids[i * 3 + k] = 0.5f * (boxes[i].min[k] + boxes[i].max[k]);
+        }
+
+        nodes.clear();
+        nodes.reserve(count * 2 + 1);
+        nodes.push_back(Node());
+        std::vector<Task> tasks;
+        tasks.push_back({ 0, 0, static_cast<unsigned int>(count), 0 });
+
+        while (!tasks.empty()) {
+            Task task = tasks.back();
+            tasks.pop_back();
+
+            Bounds bounds, centroidBounds;
+            for (unsigned int i = task.begin; i < task.end; ++i) {
+                bounds.grow(boxes[order[i]]);
+                centroidBounds.grow(&centroids[order[i] * 3]);
+            }
+            Node& node = nodes[task.node];
+            for (int k = 0; k < 3; ++k) {
+                node.min[k] = bounds.min[k];
+                node.max[k] = bounds.max[k];
+            }
+            unsigned int n = task.end - task.begin;
+            node.first = task.begin;
+            node.count = n;
+            if (n <= 1) continue;
+
+            // Best plane among the bin boundaries of every axis
+            float bestCost = INFINITY;
+            int bestAxis = -1, bestSplit = 0;
+            if (task.depth < MAX_DEPTH) {
+                for (int axis = 0; axis < 3; ++axis) {
+                    float lo = centroidBounds.min[axis], extent = centroidBounds.max[axis] - lo;
+                    if (!(extent > 0.0f)) continue;
+                    float scale = BINS / extent;
+
+                    Bounds binBounds[BINS];
+                    unsigned int binCount[BINS] = {};
+                    for (unsigned int i = task.begin; i < task.end; ++i) {
+                        int bin = std::min(BINS - 1, static_cast<int>((centroids[order[i] * 3 + axis] - lo) * scale));
+                        binBounds[bin].grow(boxes[order[i]]);
+                        binCount[bin]++;
+                    }
+
+                    float rightArea[BINS];
+                    unsigned int rightCount[BINS];
+                    Bounds right;
+                    unsigned int counted = 0;
+                    for (int bin = BINS - 1; bin > 0; --bin) {
+                        right.grow(binBounds[bin]);
+                        counted += binCount[bin];
+                        rightArea[bin] = right.area();
+                        rightCount[bin] = counted;
+                    }
+                    Bounds left;
+                    counted = 0;
+                    for (int split = 1; split < BINS; ++split) {
+                        left.grow(binBounds[split - 1]);
+                        counted += binCount[split - 1];
+                        if (counted == 0 || rightCount[split] == 0) continue;
+                        float cost = left.area() * counted + rightArea[split] * rightCount[split];
+                        if (cost < bestCost) {
+                            bestCost = cost;
+                            bestAxis = axis;
+                            bestSplit = split;
+                        }
+                    }
+                }
+            }
+
+            unsigned int middle;
+            if (bestAxis >= 0) {
+                float area = bounds.area();
+                float splitCost = TRAVERSAL_COST + (area > 0.0f ? bestCost / area : static_cast<float>(n));
+                if (n <= maxLeafSize && splitCost >= static_cast<float>(n)) continue;
+
+                float lo = centroidBounds.min[bestAxis];
+                float scale = BINS / (centroidBounds.max[bestAxis] - lo);
+                unsigned int* first = order.data() + task.begin;
+                unsigned int* split = std::partition(first, order.data() + task.end, [&](unsigned int i) {
+                    return std::min(BINS - 1, static_cast<int>((centroids[i * 3 + bestAxis] - lo) * scale)) < bestSplit;
+                });
+                middle = task.begin + static_cast<unsigned int>(split - first);
+            } else {
+                // All centroids in one place, or too deep: split the range in half
+                if (n <= maxLeafSize && task.depth < MAX_DEPTH) continue;
+                middle = task.begin + n / 2;
+            }
+
+            unsigned int children = static_cast<unsigned int>(nodes.size());
+            nodes[task.node].first = children;
+            nodes[task.node].count = 0;
+            nodes.push_back(Node());
+            nodes.push_back(Node());
+            tasks.push_back({ children, task.begin, middle, task.depth + 1 });
+            tasks.push_back({ children + 1, middle, task.end, task.depth + 1 });
+        }
+    }
+
+    void buildMesh(Mesh& mesh) {
+        size_t triangleCount = mesh.indices.size() / 3;
+        std::vector<Bounds> boxes(triangleCount);
+        for (size_t t = 0; t < triangleCount; ++t) {
+            for (int c = 0; c < 3; ++c) boxes[t].grow(&mesh.positions[mesh.indices[t * 3 + c] * 3]);
+        }
+        buildTree(boxes, MESH_LEAF_SIZE, mesh.nodes, mesh.triangleIndex);
+
+        mesh.triangles.resize(triangleCount * 9);
+        for (size_t i = 0; i < triangleCount; ++i) {
+            const unsigned int* corner = &mesh.indices[mesh.triangleIndex[i] * 3];
+            const float* p0 = &mesh.positions[corner[0] * 3];
+            const float* p1 = &mesh.positions[corner[1] * 3];
+            const float* p2 = &mesh.positions[corner[2] * 3];
+            float* out = &mesh.triangles[i * 9];
+            for (int k = 0; k < 3; ++k) {
+                out[k] = p0[k];
+                out[3 + k] = p1[k] - p0[k];
+                out[6 + k] = p2[k] - p0[k];
+            }
+        }
+        mesh.built = true;
+    }
+
+    // Meshes build in parallel with each other
+    void buildMeshTrees() {
+        std::vector<Mesh*> pending;
+        for (Mesh& mesh : meshes) {
+            if (!mesh.built) pending.push_back(&mesh);
+        }
+        if (pending.empty()) return;
+
+        std::atomic<size_t> next(0);
+        auto work = [&]() {
+            for (size_t i = next++; i < pending.size(); i = next++) buildMesh(*pending[i]);
+        };
+        unsigned int threadCount = std::max(1u, std::min<unsigned int>(std::thread::hardware_concurrency(),
+                                                                     static_cast<unsigned int>(pending.size())));
+        std::vector<std::thread> workers;
+        for (unsigned int i = 1; i < threadCount; ++i) workers.emplace_back(work);
+        work();
+        for (auto& w : workers) w.join();
+    }
+
+    void buildInstanceTree() {
+        std::vector<Bounds> boxes(instances.size());
+        Bounds scene;
+        for (size_t i = 0; i < instances.size(); ++i) {
+            Instance& instance = instances[i];
+            instance.bounds = Bounds();
+            const Mesh& mesh = meshes[instance.mesh];
+            if (!mesh.nodes.empty() && !mesh.triangles.empty()) {
+                const Node& root = mesh.nodes[0];
+                for (int corner = 0; corner < 8; ++corner) {
+                    float p[3] = {
+                        (corner & 1) ? root.max[0] : root.min[0],
+                        (corner & 2) ? root.max[1] : root.min[1],
+                        (corner & 4) ? root.max[2] : root.min[2]
+                    };
+                    float world[3];
+                    transformPoint(instance.toWorld, p, world);
+                    instance.bounds.grow(world);
+                }
+            }
+            boxes[i] = instance.bounds;
+            scene.grow(instance.bounds);
+        }
+        buildTree(boxes, INSTANCE_LEAF_SIZE, instanceNodes, instanceOrder);
+
+        float size = 1.0f;
+        if (!instances.empty() && scene.max[0] >= scene.min[0]) {
+            for (int k = 0; k < 3; ++k) size = std::max(size, std::max(fabsf(scene.min[k]), fabsf(scene.max[k])));
+        }
+        rayOffset = 1e-4f * size;
+    }
+
+    // ---- Single rays ----------------------------------------------------------------------
+
+    // Entry distance of the ray into the node, or INFINITY
+    static float boxEntry(const Node& node, const float* o, const float* inverse, float tMax) {
+        float tNear = 0.0f, tFar = tMax;
+        for (int k = 0; k < 3; ++k) {
+            float t1 = (node.min[k] - o[k]) * inverse[k];
+            float t2 = (node.max[k] - o[k]) * inverse[k];
+            tNear = std::max(tNear, std::min(t1, t2));
+            tFar = std::min(tFar, std::max(t1, t2));
+        }
+        return tNear <= tFar ? tNear : INFINITY;
+    }
+
+    static bool intersectTriangle(const float* tri, const float* o, const float* d, float tMax,
+                                  float& t, float& u, float& v) {
+        const float* e1 = tri + 3;
+        const float* e2 = tri + 6;
+        float p[3] = { d[1] * e2[2] - d[2] * e2[1], d[2] * e2[0] - d[0] * e2[2], d[0] * e2[1] - d[1] * e2[0] };
+        float det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+        if (fabsf(det) < 1e-12f) return false;
+        float r = 1.0f / det;
+        float s[3] = { o[0] - tri[0], o[1] - tri[1], o[2] - tri[2] };
+        u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * r;
+        if (u < 0.0f || u > 1.0f) return false;
+        float q[3] = { s[1] * e1[2] - s[2] * e1[1], s[2] * e1[0] - s[0] * e1[2], s[0] * e1[1] - s[1] * e1[0] };
+        v = (d[0] * q[0] + d[1] * q[1] + d[2] * q[2]) * r;
+        if (v < 0.0f || u + v > 1.0f) return false;
+        t = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) * r;
+        return t > 0.0f && t < tMax;
+    }
+
+    // Closest hit (or any hit) of an object space ray against one mesh
+    bool intersectMesh(const Mesh& mesh, const float* o, const float* d, Hit& hit, int instance, bool anyHit) const {
+        if (mesh.nodes.empty() || mesh.triangles.empty()) return false;
+        float inverse[3] = { 1.0f / d[0], 1.0f / d[1], 1.0f / d[2] };
+        if (boxEntry(mesh.nodes[0], o, inverse, hit.t) == INFINITY) return false;
+
+        bool found = false;
+        unsigned int stack[STACK_SIZE];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const Node& node = mesh.nodes[stack[--top]];
+            if (node.count > 0) {
+                for (unsigned int i = node.first; i < node.first + node.count; ++i) {
+                    float t, u, v;
+                    if (!intersectTriangle(&mesh.triangles[i * 9], o, d, hit.t, t, u, v)) continue;
+                    hit.t = t;
+                    hit.u = u;
+                    hit.v = v;
+                    hit.triangle = mesh.triangleIndex[i];
+                    hit.instance = instance;
+                    if (anyHit) return true;
+                    found = true;
+                }
+                continue;
+            }
+            float nearT = boxEntry(mesh.nodes[node.first], o, inverse, hit.t);
+            float farT = boxEntry(mesh.nodes[node.first + 1], o, inverse, hit.t);
+            unsigned int nearChild = node.first, farChild = node.first + 1;
+            if (farT < nearT) {
+                std::swap(nearT, farT);
+                std::swap(nearChild, farChild);
+            }
+            if (farT != INFINITY) stack[top++] = farChild;
+            if (nearT != INFINITY) stack[top++] = nearChild;
+        }
+        return found;
+    }
+
+    bool intersectGround(const float* o, const float* d, Hit& hit) const {
+        if (!settings.groundPlane || d[1] == 0.0f) return false;
+        float t = (settings.groundHeight - o[1]) / d[1];
+        if (!(t > 0.0f && t < hit.t)) return false;
+        hit.t = t;
+        hit.instance = GROUND;
+        return true;
+    }
+
+    bool intersect(const float* o, const float* d, Hit& hit, bool anyHit) const {
+        bool found = false;
+        if (!instanceNodes.empty() && !instances.empty()) {
+            float inverse[3] = { 1.0f / d[0], 1.0f / d[1], 1.0f / d[2] };
+            unsigned int stack[STACK_SIZE];
+            int top = 0;
+            if (boxEntry(instanceNodes[0], o, inverse, hit.t) != INFINITY) stack[top++] = 0;
+            while (top > 0) {
+                const Node& node = instanceNodes[stack[--top]];
+                if (node.count > 0) {
+                    for (unsigned int i = node.first; i < node.first + node.count; ++i) {
+                        int index = static_cast<int>(instanceOrder[i]);
+                        const Instance& instance = instances[index];
+                        float localO[3], localD[3];
+                        transformPoint(instance.toObject, o, localO);
+                        transformVector(instance.toObject, d, localD);
+                        if (intersectMesh(meshes[instance.mesh], localO, localD, hit, index, anyHit)) {
+                            if (anyHit) return true;
+                            found = true;
+                        }
+                    }
+                    continue;
+                }
+                float nearT = boxEntry(instanceNodes[node.first], o, inverse, hit.t);
+                float farT = boxEntry(instanceNodes[node.first + 1], o, inverse, hit.t);
+                unsigned int nearChild = node.first, farChild = node.first + 1;
+                if (farT < nearT) {
+                    std::swap(nearT, farT);
+                    std::swap(nearChild, farChild);
+                }
+                if (farT != INFINITY) stack[top++] = farChild;
+                if (nearT != INFINITY) stack[top++] = nearChild;
+            }
+        }
+        return intersectGround(o, d, hit) || found;
+    }
+
+    // ---- Packets --------------------------------------------------------------------------
+
+    // Lanes whose ray enters the node before their tMax; also the nearest entry among them
+    static int packetEntry(const Node& node, const float* ox, const float* oy, const float* oz,
+                           const float* ix, const float* iy, const float* iz, const float* tMax, float& nearest) {
+        float entry[4];
+        int hits[4];
+        for (int l = 0; l < 4; ++l) {
+            float tx1 = (node.min[0] - ox[l]) * ix[l], tx2 = (node.max[0] - ox[l]) * ix[l];
+            float ty1 = (node.min[1] - oy[l]) * iy[l], ty2 = (node.max[1] - oy[l]) * iy[l];
+            float tz1 = (node.min[2] - oz[l]) * iz[l], tz2 = (node.max[2] - oz[l]) * iz[l];
+            float tNear = std::max(std::max(std::min(tx1, tx2), std::min(ty1, ty2)), std::max(std::min(tz1, tz2), 0.0f));
+            float tFar = std::min(std::min(std::max(tx1, tx2), std::max(ty1, ty2)), std::min(std::max(tz1, tz2), tMax[l]));
+            hits[l] = tNear <= tFar;
+            entry[l] = hits[l] ? tNear : INFINITY;
+        }
+        nearest = std::min(std::min(entry[0], entry[1]), std::min(entry[2], entry[3]));
+        return hits[0] | (hits[1] << 1) | (hits[2] << 2) | (hits[3] << 3);
+    }
+
+    // Object space packet against one mesh; hits update packet in place
+    void intersectMeshPacket(const Mesh& mesh, const float* ox, const float* oy, const float* oz,
+                             const float* dx, const float* dy, const float* dz, RayPacket& packet,
+                             int instance, bool anyHit) const {
+        if (mesh.nodes.empty() || mesh.triangles.empty()) return;
+        float ix[4], iy[4], iz[4];
+        for (int l = 0; l < 4; ++l) {
+            ix[l] = 1.0f / dx[l];
+            iy[l] = 1.0f / dy[l];
+            iz[l] = 1.0f / dz[l];
+        }
+
+        float nearest;
+        if (!packetEntry(mesh.nodes[0], ox, oy, oz, ix, iy, iz, packet.tMax, nearest)) return;
+        unsigned int stack[STACK_SIZE];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const Node& node = mesh.nodes[stack[--top]];
+            if (node.count > 0) {
+                for (unsigned int i = node.first; i < node.first + node.count; ++i) {
+                    const float* tri = &mesh.triangles[i * 9];
+                    float t[4], u[4], v[4];
+                    int hit[4];
+                    for (int l = 0; l < 4; ++l) {
+                        float px = dy[l] * tri[8] - dz[l] * tri[7];
+                        float py = dz[l] * tri[6] - dx[l] * tri[8];
+                        float pz = dx[l] * tri[7] - dy[l] * tri[6];
+                        float det = tri[3] * px + tri[4] * py + tri[5] * pz;
+                        float r = 1.0f / det;
+                        float sx = ox[l] - tri[0], sy = oy[l] - tri[1], sz = oz[l] - tri[2];
+                        u[l] = (sx * px + sy * py + sz * pz) * r;
+                        float qx = sy * tri[5] - sz * tri[4];
+                        float qy = sz * tri[3] - sx * tri[5];
+                        float qz = sx * tri[4] - sy * tri[3];
+                        v[l] = (dx[l] * qx + dy[l] * qy + dz[l] * qz) * r;
+                        t[l] = (tri[6] * qx + tri[7] * qy + tri[8] * qz) * r;
+                        hit[l] = fabsf(det) >= 1e-12f && u[l] >= 0.0f && v[l] >= 0.0f && u[l] + v[l] <= 1.0f &&
+                                 t[l] > 0.0f && t[l] < packet.tMax[l];
+                    }
+                    for (int l = 0; l < 4; ++l) {
+                        if (!hit[l]) continue;
+                        // Occluded shadow lanes drop out of the packet
+                        packet.tMax[l] = anyHit ? -1.0f : t[l];
+                        packet.u[l] = u[l];
+                        packet.v[l] = v[l];
+                        packet.triangle[l] = mesh.triangleIndex[i];
+                        packet.instance[l] = instance;
+                    }
+                }
+                continue;
+            }
+            float nearT, farT;
+            int nearMask = packetEntry(mesh.nodes[node.first], ox, oy, oz, ix, iy, iz, packet.tMax, nearT);
+            int farMask = packetEntry(mesh.nodes[node.first + 1], ox, oy, oz, ix, iy, iz, packet.tMax, farT);
+            unsigned int nearChild = node.first, farChild = node.first + 1;
+            if (farT < nearT) {
+                std::swap(nearMask, farMask);
+                std::swap(nearChild, farChild);
+            }
+            if (farMask) stack[top++] = farChild;
+            if (nearMask) stack[top++] = nearChild;
+        }
+    }
+
+    void intersectPacket(RayPacket& packet, bool anyHit) const {
+        for (int l = 0; l < 4; ++l) packet.instance[l] = -1;
+        if (!instanceNodes.empty() && !instances.empty()) {
+            float ix[4], iy[4], iz[4];
+            for (int l = 0; l < 4; ++l) {
+                ix[l] = 1.0f / packet.dx[l];
+                iy[l] = 1.0f / packet.dy[l];
+                iz[l] = 1.0f / packet.dz[l];
+            }
+            float nearest;
+            unsigned int stack[STACK_SIZE];
+            int top = 0;
+            if (packetEntry(instanceNodes[0], packet.ox, packet.oy, packet.oz, ix, iy, iz, packet.tMax, nearest)) {
+                stack[top++] = 0;
+            }
+            while (top > 0) {
+                const Node& node = instanceNodes[stack[--top]];
+                if (node.count > 0) {
+                    for (unsigned int i = node.first; i < node.first + node.count; ++i) {
+                        int index = static_cast<int>(instanceOrder[i]);
+                        const Instance& instance = instances[index];
+                        const float* m = instance.toObject;
+                        float ox[4], oy[4], oz[4], dx[4], dy[4], dz[4];
+                        for (int l = 0; l < 4; ++l) {
+                            ox[l] = m[0] * packet.ox[l] + m[1] * packet.oy[l] + m[2] * packet.oz[l] + m[3];
+                            oy[l] = m[4] * packet.ox[l] + m[5] * packet.oy[l] + m[6] * packet.oz[l] + m[7];
+                            oz[l] = m[8] * packet.ox[l] + m[9] * packet.oy[l] + m[10] * packet.oz[l] + m[11];
+                            dx[l] = m[0] * packet.dx[l] + m[1] * packet.dy[l] + m[2] * packet.dz[l];
+                            dy[l] = m[4] * packet.dx[l] + m[5] * packet.dy[l] + m[6] * packet.dz[l];
+                            dz[l] = m[8] * packet.dx[l] + m[9] * packet.dy[l] + m[10] * packet.dz[l];
+                        }
+                        intersectMeshPacket(meshes[instance.mesh], ox, oy, oz, dx, dy, dz, packet, index, anyHit);
+                    }
+                    continue;
+                }
+                float nearT, farT;
+                int nearMask = packetEntry(instanceNodes[node.first], packet.ox, packet.oy, packet.oz, ix, iy, iz, packet.tMax, nearT);
+                int farMask = packetEntry(instanceNodes[node.first + 1], packet.ox, packet.oy, packet.oz, ix, iy, iz, packet.tMax, farT);
+                unsigned int nearChild = node.first, farChild = node.first + 1;
+                if (farT < nearT) {
+                    std::swap(nearMask, farMask);
+                    std::swap(nearChild, farChild);
+                }
+                if (farMask) stack[top++] = farChild;
+                if (nearMask) stack[top++] = nearChild;
+            }
+        }
+
+        for (int l = 0; l < 4; ++l) {
+            if (packet.tMax[l] < 0.0f) continue;
+            float o[3] = { packet.ox[l], packet.oy[l], packet.oz[l] };
+            float d[3] = { packet.dx[l], packet.dy[l], packet.dz[l] };
+            Hit hit;
+            hit.t = packet.tMax[l];
+            if (!intersectGround(o, d, hit)) continue;
+            packet.tMax[l] = anyHit ? -1.0f : hit.t;
+            packet.instance[l] = GROUND;
+        }
+    }
+
+    // ---- Shading --------------------------------------------------------------------------
+
+    static float dot(const float* a, const float* b) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+
+    static void normalize(float* v) {
+        float length = sqrtf(dot(v, v));
+        if (length > 0.0f) {
+            v[0] /= length;
+            v[1] /= length;
+            v[2] /= length;
+        }
+    }
+
+    // Hit point, normal facing the ray, and color
+    void surfaceAt(const float* o, const float* d, const Hit& hit, Surface& surface) const {
+        for (int k = 0; k < 3; ++k) surface.position[k] = o[k] + d[k] * hit.t;
+        if (hit.instance == GROUND) {
+            surface.normal[0] = 0.0f;
+            surface.normal[1] = d[1] > 0.0f ? -1.0f : 1.0f;
+            surface.normal[2] = 0.0f;
+            memcpy(surface.albedo, settings.groundColor, sizeof(surface.albedo));
+            return;
+        }
+
+        const Instance& instance = instances[hit.instance];
+        const Mesh& mesh = meshes[instance.mesh];
+        const unsigned int* corner = &mesh.indices[hit.triangle * 3];
+        float local[3];
+        if (!mesh.normals.empty()) {
+            float w = 1.0f - hit.u - hit.v;
+            const float* n0 = &mesh.normals[corner[0] * 3];
+            const float* n1 = &mesh.normals[corner[1] * 3];
+            const float* n2 = &mesh.normals[corner[2] * 3];
+            for (int k = 0; k < 3; ++k) local[k] = n0[k] * w + n1[k] * hit.u + n2[k] * hit.v;
+        }
+        if (mesh.normals.empty() || dot(local, local) < 1e-12f) {
+            const float* p0 = &mesh.positions[corner[0] * 3];
+            const float* p1 = &mesh.positions[corner[1] * 3];
+            const float* p2 = &mesh.positions[corner[2] * 3];
+            float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+            float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+            local[0] = e1[1] * e2[2] - e1[2] * e2[1];
+            local[1] = e1[2] * e2[0] - e1[0] * e2[2];
+            local[2] = e1[0] * e2[1] - e1[1] * e2[0];
+        }
+
+        // Normals go to the world with the inverse transpose
+        const float* m = instance.toObject;
+        for (int k = 0; k < 3; ++k) surface.normal[k] = m[k] * local[0] + m[4 + k] * local[1] + m[8 + k] * local[2];
+        normalize(surface.normal);
+        if (dot(surface.normal, d) > 0.0f) {
+            for (int k = 0; k < 3; ++k) surface.normal[k] = -surface.normal[k];
+        }
+        memcpy(surface.albedo, instance.color, sizeof(surface.albedo));
+    }
+
+    // Origin for rays leaving the surface, and the unnormalized direction to the light
+    // along with its cosine; false when the light is behind the surface
+    bool lightRay(const Surface& surface, float* origin, float* toLight, float& cosine) const {
+        for (int k = 0; k < 3; ++k) {
+            origin[k] = surface.position[k] + surface.normal[k] * rayOffset;
+            toLight[k] = settings.lightPosition[k] - origin[k];
+        }
+        float length = sqrtf(dot(toLight, toLight));
+        if (length <= 0.0f) return false;
+        cosine = dot(surface.normal, toLight) / length;
+        return cosine > 0.0f;
+    }
+
+    // Light gathered past the first hit, direct light at that hit excluded
+    void traceBounces(Surface surface, uint32_t& rng, float* radiance, uint64_t& rays) const {
+        float throughput[3] = { surface.albedo[0], surface.albedo[1], surface.albedo[2] };
+        for (int bounce = 0; bounce < settings.maxBounces; ++bounce) {
+            float origin[3], direction[3];
+            for (int k = 0; k < 3; ++k) origin[k] = surface.position[k] + surface.normal[k] * rayOffset;
+            sampleHemisphere(surface.normal, rng, direction);
+
+            Hit hit;
+            rays++;
+            if (!intersect(origin, direction, hit, false)) {
+                for (int k = 0; k < 3; ++k) radiance[k] += throughput[k] * settings.skyColor[k];
+                return;
+            }
+            surfaceAt(origin, direction, hit, surface);
+
+            float lightOrigin[3], toLight[3], cosine;
+            if (lightRay(surface, lightOrigin, toLight, cosine)) {
+                Hit shadow;
+                shadow.t = 1.0f;
+                rays++;
+                if (!intersect(lightOrigin, toLight, shadow, true)) {
+                    for (int k = 0; k < 3; ++k) {
+                        radiance[k] += throughput[k] * surface.albedo[k] * settings.lightColor[k] * cosine;
+                    }
+                }
+            }
+            for (int k = 0; k < 3; ++k) throughput[k] *= surface.albedo[k];
+
+            // Russian roulette once the path has had a chance to pick up some light
+            if (bounce >= 2) {
+                float survive = std::min(0.95f, std::max(throughput[0], std::max(throughput[1], throughput[2])));
+                if (random(rng) >= survive) return;
+                for (int k = 0; k < 3; ++k) throughput[k] /= survive;
+            }
+        }
+    }
+
+    void cameraRay(float px, float py, float* origin, float* direction) const {
+        float x = px / imageWidth * 2.0f - 1.0f;
+        float y = 1.0f - py / imageHeight * 2.0f;
+        const float* m = cameraToWorld;
+        float nearPoint[4], farPoint[4];
+        for (int row = 0; row < 4; ++row) {
+            float xy = m[row] * x + m[4 + row] * y + m[12 + row];
+            nearPoint[row] = xy - m[8 + row];
+            farPoint[row] = xy + m[8 + row];
+        }
+        for (int k = 0; k < 3; ++k) {
+            origin[k] = nearPoint[k] / nearPoint[3];
+            direction[k] = farPoint[k] / farPoint[3] - origin[k];
+        }
+        normalize(direction);
+    }
+
+    void renderTile(int x0, int y0, uint32_t pass, uint64_t& rays) {
+        int x1 = std::min(x0 + TILE_SIZE, imageWidth);
+        int y1 = std::min(y0 + TILE_SIZE, imageHeight);
+        float* accum = accumulation.data();
+
+        for (int y = y0; y < y1; y += 2) {
+            for (int x = x0; x < x1; x += 2) {
+                RayPacket packet;
+                int px[4], py[4];
+                uint32_t rng[4];
+                for (int l = 0; l < 4; ++l) {
+                    px[l] = x + (l & 1);
+                    py[l] = y + (l >> 1);
+                    bool inside = px[l] < x1 && py[l] < y1;
+                    rng[l] = hashSeed(static_cast<uint32_t>(py[l] * imageWidth + px[l]), pass);
+                    float o[3], d[3];
+                    cameraRay(px[l] + random(rng[l]), py[l] + random(rng[l]), o, d);
+                    packet.ox[l] = o[0]; packet.oy[l] = o[1]; packet.oz[l] = o[2];
+                    packet.dx[l] = d[0]; packet.dy[l] = d[1]; packet.dz[l] = d[2];
+                    packet.tMax[l] = inside ? INFINITY : -1.0f;
+                    if (inside) rays++;
+                }
+                intersectPacket(packet, false);
+
+                float radiance[4][3] = {};
+                Surface surfaces[4];
+                RayPacket shadow;
+                float cosine[4] = {};
+                for (int l = 0; l < 4; ++l) {
+                    shadow.tMax[l] = -1.0f;
+                    shadow.ox[l] = shadow.oy[l] = shadow.oz[l] = 0.0f;
+                    shadow.dx[l] = shadow.dy[l] = shadow.dz[l] = 1.0f;
+                    if (packet.tMax[l] < 0.0f) continue;
+                    if (packet.instance[l] == -1) {
+                        memcpy(radiance[l], settings.background, sizeof(radiance[l]));
+                        continue;
+                    }
+                    float o[3] = { packet.ox[l], packet.oy[l], packet.oz[l] };
+                    float d[3] = { packet.dx[l], packet.dy[l], packet.dz[l] };
+                    Hit hit;
+                    hit.t = packet.tMax[l];
+                    hit.instance = packet.instance[l];
+                    hit.triangle = packet.triangle[l];
+                    hit.u = packet.u[l];
+                    hit.v = packet.v[l];
+                    surfaceAt(o, d, hit, surfaces[l]);
+
+                    float origin[3], toLight[3];
+                    if (lightRay(surfaces[l], origin, toLight, cosine[l])) {
+                        shadow.ox[l] = origin[0]; shadow.oy[l] = origin[1]; shadow.oz[l] = origin[2];
+                        shadow.dx[l] = toLight[0]; shadow.dy[l] = toLight[1]; shadow.dz[l] = toLight[2];
+                        shadow.tMax[l] = 1.0f;
+                        rays++;
+                    }
+                    traceBounces(surfaces[l], rng[l], radiance[l], rays);
+                }
+
+                // Shadow rays of a quad head for the same light, so they stay a packet
+                intersectPacket(shadow, true);
+                for (int l = 0; l < 4; ++l) {
+                    if (shadow.tMax[l] > 0.0f) {
+                        for (int k = 0; k < 3; ++k) {
+                            radiance[l][k] += surfaces[l].albedo[k] * settings.lightColor[k] * cosine[l];
+                        }
+                    }
+                    if (packet.tMax[l] < 0.0f) continue;
+                    float* pixel = accum + (static_cast<size_t>(py[l]) * imageWidth + px[l]) * 3;
+                    for (int k = 0; k < 3; ++k) {
+                        // A stray NaN would stay in the pixel for good
+                        if (radiance[l][k] == radiance[l][k]) pixel[k] += radiance[l][k];
+                    }
+                }
+            }
+        }
+    }
+
+    void resolve() {
+        int samples = sampleCount;
+        float scale = settings.exposure / std::max(samples, 1);
+        std::lock_guard<std::mutex> lock(imageMutex);
+        size_t pixels = static_cast<size_t>(imageWidth) * imageHeight;
+        image.resize(pixels * 4);
+        for (size_t i = 0; i < pixels; ++i) {
+            for (int k = 0; k < 3; ++k) {
+                float value = std::min(std::max(accumulation[i * 3 + k] * scale, 0.0f), 1.0f);
+                image[i * 4 + k] = static_cast<uint8_t>(value * 255.0f + 0.5f);
+            }
+            image[i * 4 + 3] = 255;
+        }
+        imageSamples = samples;
+        imageVersion++;
+    }
+};
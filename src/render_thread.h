@@ -0,0 +1,198 @@
+#pragma once
+
+// Render thread fed with double-buffered frame packets.
+//
+// The main thread fills packet() with everything a frame needs and calls
+// submit(). The render thread, which owns the GL context, draws that packet
+// while the main thread builds the next one in the other buffer. With only two
+// packets the render thread is at most one frame behind; submit() waits when
+// it falls further back.
+//
+// GL work the main thread still has to do (resource creation, uploads) goes
+// through invoke(): it runs on the render thread after every packet already
+// submitted, and the caller waits for it. defer() runs work after the packet
+// being built has been drawn, which is when a resource that packet may refer
+// to can be released.
+//
+// Without the thread (before start(), after stop()) the renderer runs inline:
+// submit() draws on the calling thread and invoke() is a plain call, so the
+// thread can be switched on and off between frames.
+
+#include <cstdint>
+#include <chrono>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+
+template <typename Packet>
+class RenderThread {
+public:
+    using Work = std::function<void()>;
+    using RenderFunction = std::function<void(Packet&)>;
+
+    ~RenderThread() { stop(); }
+
+    void setRenderer(RenderFunction function) { render = function; }
+
+    // begin and end run on the render thread before the first and after the last packet
+    // (make the context current there and release it again)
+    void start(Work begin, Work end) {
+        if (worker.joinable()) return;
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = false;
+        worker = std::thread([this, begin, end]() {
+            { std::lock_guard<std::mutex> started(mutex); }   // threadId is set
+            begin();
+            run();
+            end();
+        });
+        threadId = worker.get_id();
+    }
+
+    // Draws everything already submitted and joins; rendering continues inline
+    void stop() {
+        if (!worker.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quit = true;
+        }
+        wake.notify_all();
+        worker.join();
+        threadId = std::thread::id();
+    }
+
+    // Run the work deferred for the packet being built now, at shutdown (inline only)
+    void flushDeferred() {
+        if (!worker.joinable()) runDeferred(writeIndex);
+    }
+
+    bool threaded() const { return worker.joinable(); }
+
+    // True where GL calls are allowed: on the render thread, or anywhere when it is not running
+    bool isRenderThread() const {
+        return !worker.joinable() || std::this_thread::get_id() == threadId;
+    }
+
+    // The packet the main thread is filling; the render thread does not touch it until submit()
+    Packet& packet() { return packets[writeIndex]; }
+
+    void submit() {
+        int submitted = writeIndex;
+        if (!worker.joinable()) {
+            auto start = std::chrono::steady_clock::now();
+            render(packets[submitted]);
+            runDeferred(submitted);
+            renderMs = elapsedMs(start);
+            return;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        int next = 1 - submitted;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            Item item;
+            item.packet = submitted;
+            item.ticket = ++issued;
+            busy[submitted] = true;
+            queue.push_back(item);
+            wake.notify_all();
+            finished.wait(lock, [this, next]() { return !busy[next]; });
+        }
+        writeIndex = next;
+        submitWaitMs = elapsedMs(start);
+    }
+
+    // Run GL work on the render thread, after everything already submitted, and wait for it
+    void invoke(const Work& work) {
+        if (isRenderThread()) {
+            work();
+            return;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        Item item;
+        item.work = &work;
+        item.ticket = ++issued;
+        uint64_t ticket = item.ticket;
+        queue.push_back(item);
+        wake.notify_all();
+        finished.wait(lock, [this, ticket]() { return completed >= ticket; });
+    }
+
+    // Run work once the packet being built has been drawn
+    void defer(Work work) {
+        deferred[writeIndex].push_back(std::move(work));
+    }
+
+    // Main thread time spent waiting in submit(), and render time of the last packet
+    float lastSubmitWaitMs() const { return submitWaitMs; }
+    float lastRenderMs() const { return renderMs; }
+
+private:
+    struct Item {
+        int packet = -1;                // packet to draw, or
+        const Work* work = nullptr;     // work from invoke()
+        uint64_t ticket = 0;
+    };
+
+    RenderFunction render;
+    Packet packets[2];
+    std::vector<Work> deferred[2];      // deferred[i] belongs to whoever holds packets[i]
+    int writeIndex = 0;                 // main thread only
+
+    std::thread worker;
+    std::thread::id threadId;
+    std::mutex mutex;
+    std::condition_variable wake;       // render thread: work queued or quit
+    std::condition_variable finished;   // callers: an item completed
+    std::deque<Item> queue;
+    bool busy[2] = { false, false };
+    bool quit = false;
+    uint64_t issued = 0;
+    uint64_t completed = 0;
+
+    std::atomic<float> submitWaitMs{0.0f};
+    std::atomic<float> renderMs{0.0f};
+
+    static float elapsedMs(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void runDeferred(int index) {
+        std::vector<Work> work;
+        work.swap(deferred[index]);
+        for (Work& w : work) w();
+    }
+
+    void run() {
+        for (;;) {
+            Item item;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this]() { return quit || !queue.empty(); });
+                if (queue.empty()) return;
+                item = queue.front();
+                queue.pop_front();
+            }
+
+            if (item.packet >= 0) {
+                auto start = std::chrono::steady_clock::now();
+                render(packets[item.packet]);
+                runDeferred(item.packet);
+                renderMs = elapsedMs(start);
+            } else {
+                (*item.work)();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (item.packet >= 0) busy[item.packet] = false;
+                completed = item.ticket;
+            }
+            finished.notify_all();
+        }
+    }
+};
@@ -2,6 +2,9 @@
 #include <vector>
 #include <cmath>
 #include <string>
+#include <list>
+#include <map>
+#include <algorithm>
 
 // OpenGL headers
 #include <GL/glew.h>
@@ -226,41 +229,248 @@ void main()
 }
 )";
 
-// Function to generate sphere vertices
+// Impostor vertex shader: expands a camera-facing quad per instance that
+// covers the sphere's silhouette
+const char* impostorVertexShaderSource = R"(
+#version 330 core
+layout (location = 0) in vec2 aCorner;
+layout (location = 1) in vec3 aCenter;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec3 cameraPos;
+uniform float radius;
+
+out vec3 RayTarget;
+flat out vec3 Center;
+
+void main()
+{
+    vec3 toCenter = aCenter - cameraPos;
+    float dist = length(toCenter);
+    vec3 forward = toCenter / dist;
+    vec3 up = abs(forward.y) > 0.999 ? vec3(1.0, 0.0, 0.0) : vec3(0.0, 1.0, 0.0);
+    vec3 right = normalize(cross(forward, up));
+    up = cross(right, forward);
+    
+    // The silhouette cone meets the plane through the center at r*d/sqrt(d^2 - r^2)
+    float extent = radius * dist / sqrt(max(dist * dist - radius * radius, 1e-4));
+    vec3 worldPos = aCenter + (right * aCorner.x + up * aCorner.y) * extent;
+    
+    RayTarget = worldPos;
+    Center = aCenter;
+    gl_Position = projection * view * vec4(worldPos, 1.0);
+}
+)";
+
+// Impostor fragment shader: ray-sphere intersection with exact depth and
+// procedural texture coordinates that follow the sphere's rotation
+const char* impostorFragmentShaderSource = R"(
+#version 330 core
+in vec3 RayTarget;
+flat in vec3 Center;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform mat4 rotation;
+uniform vec3 cameraPos;
+uniform vec3 lightPos;
+uniform float radius;
+uniform vec2 checkerCount;
+
+out vec4 FragColor;
+
+void main()
+{
+    vec3 rayDir = normalize(RayTarget - cameraPos);
+    vec3 oc = cameraPos - Center;
+    float b = dot(oc, rayDir);
+    float c = dot(oc, oc) - radius * radius;
+    float disc = b * b - c;
+    if (disc < 0.0) discard;
+    
+    float t = -b - sqrt(disc);
+    if (t < 0.0) discard;
+    vec3 FragPos = cameraPos + rayDir * t;
+    vec3 norm = (FragPos - Center) / radius;
+    
+    vec4 clipPos = projection * view * vec4(FragPos, 1.0);
+    gl_FragDepth = (clipPos.z / clipPos.w) * 0.5 + 0.5;
+    
+    // Object space direction gives the same gradient as the mesh, plus a
+    // latitude/longitude checker so the rotation is visible
+    vec3 local = transpose(mat3(rotation)) * norm;
+    vec2 uv = vec2(atan(local.y, local.x) / 6.28318530718 + 0.5, acos(clamp(local.z, -1.0, 1.0)) / 3.14159265359);
+    vec2 cell = floor(uv * checkerCount);
+    float checker = mod(cell.x + cell.y, 2.0);
+    vec3 Color = (local + 1.0) * 0.5 * (0.85 + 0.15 * checker);
+    
+    // Ambient lighting
+    float ambientStrength = 0.3;
+    vec3 ambient = ambientStrength * vec3(1.0, 1.0, 1.0);
+    
+    // Diffuse lighting
+    vec3 lightDir = normalize(lightPos - FragPos);
+    float diff = max(dot(norm, lightDir), 0.0);
+    vec3 diffuse = diff * vec3(1.0, 1.0, 1.0);
+    
+    // Specular lighting
+    float specularStrength = 0.8;
+    vec3 viewDir = normalize(cameraPos - FragPos);
+    vec3 reflectDir = reflect(-lightDir, norm);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
+    vec3 specular = specularStrength * spec * vec3(1.0, 1.0, 1.0);
+    
+    vec3 result = (ambient + diffuse + specular) * Color;
+    FragColor = vec4(result, 1.0);
+}
+)";
+
+// Swarm compute shader: animates every instance on the GPU, culls it against
+// the view frustum and appends visible transforms for the indirect draw
+const char* swarmComputeShaderSource = R"(
+#version 430 core
+layout (local_size_x = 256) in;
+
+layout (std430, binding = 0) writeonly buffer Transforms { mat4 transforms[]; };
+layout (std430, binding = 1) buffer DrawCommand {
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    uint baseVertex;
+    uint baseInstance;
+} command;
+
+uniform uint instanceTotal;
+uniform float time;
+uniform float orbitSpread;
+uniform float sphereScale;
+uniform bool frustumCulling;
+uniform vec4 frustumPlanes[6];
+
+// Per-instance parameters come from a hash of the index, so nothing is uploaded
+float hash(uint x)
+{
+    x ^= x >> 16; x *= 0x7feb352dU;
+    x ^= x >> 15; x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return float(x) / 4294967295.0;
+}
+
+mat4 rotationX(float angle)
+{
+    float c = cos(angle), s = sin(angle);
+    return mat4(1, 0, 0, 0,  0, c, s, 0,  0, -s, c, 0,  0, 0, 0, 1);
+}
+
+mat4 rotationY(float angle)
+{
+    float c = cos(angle), s = sin(angle);
+    return mat4(c, 0, -s, 0,  0, 1, 0, 0,  s, 0, c, 0,  0, 0, 0, 1);
+}
+
+void main()
+{
+    uint id = gl_GlobalInvocationID.x;
+    if (id >= instanceTotal) return;
+    
+    float orbitRadius = 2.0 + orbitSpread * sqrt(hash(id * 7U + 1U));
+    float orbitSpeed = (0.2 + hash(id * 7U + 2U)) * 3.0 / orbitRadius;
+    float phase = hash(id * 7U + 3U) * 6.28318530718;
+    float inclination = (hash(id * 7U + 4U) - 0.5) * 1.2;
+    float node = hash(id * 7U + 5U) * 6.28318530718;
+    float spinSpeed = (hash(id * 7U + 6U) - 0.5) * 4.0;
+    float scale = sphereScale * (0.5 + hash(id * 7U + 7U));
+    
+    // Orbit in a tilted plane, then spin about the sphere's own axes
+    float angle = phase + orbitSpeed * time;
+    vec3 position = vec3(cos(angle), 0.0, sin(angle)) * orbitRadius;
+    position = (rotationY(node) * rotationX(inclination) * vec4(position, 1.0)).xyz;
+    
+    if (frustumCulling) {
+        for (int i = 0; i < 6; ++i) {
+            if (dot(frustumPlanes[i].xyz, position) + frustumPlanes[i].w < -scale) return;
+        }
+    }
+    
+    mat4 model = rotationY(spinSpeed * time) * rotationX(spinSpeed * time * 0.5);
+    model[0] *= scale;
+    model[1] *= scale;
+    model[2] *= scale;
+    model[3] = vec4(position, 1.0);
+    
+    uint slot = atomicAdd(command.instanceCount, 1U);
+    transforms[slot] = model;
+}
+)";
+
+// Swarm vertex shader: reads the instance transform written by the compute pass
+const char* swarmVertexShaderSource = R"(
+#version 430 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec3 aColor;
+
+layout (std430, binding = 0) readonly buffer Transforms { mat4 transforms[]; };
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec3 lightPos;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec3 Color;
+out vec3 LightPos;
+
+void main()
+{
+    mat4 model = transforms[gl_InstanceID];
+    FragPos = vec3(model * vec4(aPos, 1.0));
+    Normal = mat3(model) * aNormal;
+    Color = aColor;
+    LightPos = lightPos;
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
+)";
+
+// Append one vertex of a unit sphere (position, normal, gradient color)
+void pushSphereVertex(std::vector<float>& vertices, float x, float y, float z) {
+    // Position
+    vertices.push_back(x);
+    vertices.push_back(y);
+    vertices.push_back(z);
+    
+    // Normal (position of a unit sphere)
+    vertices.push_back(x);
+    vertices.push_back(y);
+    vertices.push_back(z);
+    
+    // Color (based on position for nice gradient)
+    vertices.push_back((x + 1.0f) * 0.5f); // Red
+    vertices.push_back((y + 1.0f) * 0.5f); // Green
+    vertices.push_back((z + 1.0f) * 0.5f); // Blue
+}
+
+// Function to generate unit UV sphere vertices (radius is applied by the model matrix)
 void generateSphere(std::vector<float>& vertices, std::vector<unsigned int>& indices,
-                   float radius = 1.0f, int sectors = 32, int stacks = 16) {
+                   int sectors = 32, int stacks = 16) {
     
     const float PI = 3.14159265358979323846f;
     
     vertices.clear();
     indices.clear();
+    vertices.reserve((stacks + 1) * (sectors + 1) * 9);
+    indices.reserve(stacks * sectors * 6);
     
     // Generate vertices
     for (int i = 0; i <= stacks; ++i) {
         float stackAngle = PI / 2.0f - i * (PI / stacks);
-        float xy = radius * cosf(stackAngle);
-        float z = radius * sinf(stackAngle);
+        float xy = cosf(stackAngle);
+        float z = sinf(stackAngle);
         
         for (int j = 0; j <= sectors; ++j) {
             float sectorAngle = j * (2.0f * PI / sectors);
-            
-            float x = xy * cosf(sectorAngle);
-            float y = xy * sinf(sectorAngle);
-            
-            // Position
-            vertices.push_back(x);
-            vertices.push_back(y);
-            vertices.push_back(z);
-            
-            // Normal (normalized position)
-            vertices.push_back(x / radius);
-            vertices.push_back(y / radius);
-            vertices.push_back(z / radius);
-            
-            // Color (based on position for nice gradient)
-            vertices.push_back((x + radius) / (2.0f * radius)); // Red
-            vertices.push_back((y + radius) / (2.0f * radius)); // Green
-            vertices.push_back((z + radius) / (2.0f * radius)); // Blue
+            pushSphereVertex(vertices, xy * cosf(sectorAngle), xy * sinf(sectorAngle), z);
         }
     }
     
@@ -285,6 +495,282 @@ void generateSphere(std::vector<float>& vertices, std::vector<unsigned int>& ind
     }
 }
 
+// Function to generate a unit icosphere by recursive midpoint subdivision.
+// Triangles stay close to equilateral, so there is no pole pinching.
+void generateIcosphere(std::vector<float>& vertices, std::vector<unsigned int>& indices,
+                      int subdivisions = 3) {
+    
+    const float t = (1.0f + sqrtf(5.0f)) * 0.5f;
+    std::vector<Vec3> positions = {
+        Vec3(-1,  t,  0), Vec3( 1,  t,  0), Vec3(-1, -t,  0), Vec3( 1, -t,  0),
+        Vec3( 0, -1,  t), Vec3( 0,  1,  t), Vec3( 0, -1, -t), Vec3( 0,  1, -t),
+        Vec3( t,  0, -1), Vec3( t,  0,  1), Vec3(-t,  0, -1), Vec3(-t,  0,  1)
+    };
+    for (auto& p : positions) p = p.normalize();
+    
+    std::vector<unsigned int> faces = {
+        0, 11, 5,   0, 5, 1,    0, 1, 7,    0, 7, 10,   0, 10, 11,
+        1, 5, 9,    5, 11, 4,   11, 10, 2,  10, 7, 6,   7, 1, 8,
+        3, 9, 4,    3, 4, 2,    3, 2, 6,    3, 6, 8,    3, 8, 9,
+        4, 9, 5,    2, 4, 11,   6, 2, 10,   8, 6, 7,    9, 8, 1
+    };
+    
+    for (int level = 0; level < subdivisions; ++level) {
+        // Shared edges get a single midpoint vertex
+        std::map<std::pair<unsigned int, unsigned int>, unsigned int> midpoints;
+        auto midpoint = [&](unsigned int a, unsigned int b) {
+            std::pair<unsigned int, unsigned int> key(std::min(a, b), std::max(a, b));
+            auto it = midpoints.find(key);
+            if (it != midpoints.end()) return it->second;
+            
+            unsigned int index = static_cast<unsigned int>(positions.size());
+            positions.push_back(((positions[a] + positions[b]) * 0.5f).normalize());
+            midpoints[key] = index;
+            return index;
+        };
+        
+        std::vector<unsigned int> refined;
+        refined.reserve(faces.size() * 4);
+        for (size_t i = 0; i < faces.size(); i += 3) {
+            unsigned int a = faces[i], b = faces[i + 1], c = faces[i + 2];
+            unsigned int ab = midpoint(a, b);
+            unsigned int bc = midpoint(b, c);
+            unsigned int ca = midpoint(c, a);
+            
+            unsigned int tris[12] = { a, ab, ca,   b, bc, ab,   c, ca, bc,   ab, bc, ca };
+            refined.insert(refined.end(), tris, tris + 12);
+        }
+        faces.swap(refined);
+    }
+    
+    vertices.clear();
+    vertices.reserve(positions.size() * 9);
+    for (const auto& p : positions) {
+        pushSphereVertex(vertices, p.x, p.y, p.z);
+    }
+    indices = faces;
+}
+
+// Function to generate a unit cube sphere: a subdivided cube whose faces are
+// pushed onto the sphere with an area-preserving mapping.
+void generateCubeSphere(std::vector<float>& vertices, std::vector<unsigned int>& indices,
+                       int resolution = 16) {
+    
+    // Face normal followed by two tangent axes with cross(u, v) == normal
+    const Vec3 faces[6][3] = {
+        { Vec3( 1, 0, 0), Vec3(0, 1, 0), Vec3(0, 0, 1) },
+        { Vec3(-1, 0, 0), Vec3(0, 0, 1), Vec3(0, 1, 0) },
+        { Vec3( 0, 1, 0), Vec3(0, 0, 1), Vec3(1, 0, 0) },
+        { Vec3( 0,-1, 0), Vec3(1, 0, 0), Vec3(0, 0, 1) },
+        { Vec3( 0, 0, 1), Vec3(1, 0, 0), Vec3(0, 1, 0) },
+        { Vec3( 0, 0,-1), Vec3(0, 1, 0), Vec3(1, 0, 0) }
+    };
+    
+    vertices.clear();
+    indices.clear();
+    vertices.reserve(6 * (resolution + 1) * (resolution + 1) * 9);
+    indices.reserve(6 * resolution * resolution * 6);
+    
+    for (int f = 0; f < 6; ++f) {
+        unsigned int base = static_cast<unsigned int>(vertices.size() / 9);
+        
+        for (int i = 0; i <= resolution; ++i) {
+            for (int j = 0; j <= resolution; ++j) {
+                float s = 2.0f * i / resolution - 1.0f;
+                float t = 2.0f * j / resolution - 1.0f;
+                Vec3 p = faces[f][0] + faces[f][1] * s + faces[f][2] * t;
+                
+                float x2 = p.x * p.x, y2 = p.y * p.y, z2 = p.z * p.z;
+                float x = p.x * sqrtf(1.0f - y2 * 0.5f - z2 * 0.5f + y2 * z2 / 3.0f);
+                float y = p.y * sqrtf(1.0f - z2 * 0.5f - x2 * 0.5f + z2 * x2 / 3.0f);
+                float z = p.z * sqrtf(1.0f - x2 * 0.5f - y2 * 0.5f + x2 * y2 / 3.0f);
+                pushSphereVertex(vertices, x, y, z);
+            }
+        }
+        
+        for (int i = 0; i < resolution; ++i) {
+            for (int j = 0; j < resolution; ++j) {
+                unsigned int k1 = base + i * (resolution + 1) + j;
+                unsigned int k2 = k1 + resolution + 1;
+                
+                indices.push_back(k1);
+                indices.push_back(k2);
+                indices.push_back(k2 + 1);
+                
+                indices.push_back(k1);
+                indices.push_back(k2 + 1);
+                indices.push_back(k1 + 1);
+            }
+        }
+    }
+}
+
+enum SphereType {
+    SPHERE_UV,
+    SPHERE_ICO,
+    SPHERE_CUBE
+};
+
+// GPU-resident sphere tessellation
+struct SphereMesh {
+    unsigned long long key = 0;
+    GLuint vao = 0, vbo = 0, ebo = 0;
+    GLsizeiptr vboCapacity = 0, eboCapacity = 0;
+    int vertexCount = 0;
+    int indexCount = 0;
+};
+
+// LRU cache of sphere meshes keyed by tessellation parameters. Evicted entries
+// hand their buffers to the next miss, which orphans and refills them instead
+// of creating new GL objects.
+class SphereMeshCache {
+public:
+    static constexpr size_t MAX_ENTRIES = 8;
+    
+    // The first parameter is segments / subdivisions / resolution, the second is stacks (UV only)
+    const SphereMesh& get(SphereType type, int detail, int stacks) {
+        if (type != SPHERE_UV) stacks = 0;
+        unsigned long long key = (static_cast<unsigned long long>(type) << 48) |
+                                 (static_cast<unsigned long long>(detail & 0xFFFFFF) << 24) |
+                                 static_cast<unsigned long long>(stacks & 0xFFFFFF);
+        
+        auto it = lookup.find(key);
+        if (it != lookup.end()) {
+            hits++;
+            meshes.splice(meshes.begin(), meshes, it->second);
+            return meshes.front();
+        }
+        misses++;
+        
+        std::vector<float> vertices;
+        std::vector<unsigned int> indices;
+        switch (type) {
+            case SPHERE_ICO:  generateIcosphere(vertices, indices, detail); break;
+            case SPHERE_CUBE: generateCubeSphere(vertices, indices, detail); break;
+            default:          generateSphere(vertices, indices, detail, stacks); break;
+        }
+        
+        // Recycle the least recently used entry once the cache is full
+        SphereMesh mesh;
+        if (meshes.size() >= MAX_ENTRIES) {
+            mesh = meshes.back();
+            lookup.erase(mesh.key);
+            meshes.pop_back();
+        } else {
+            createMesh(mesh);
+        }
+        
+        mesh.key = key;
+        mesh.vertexCount = static_cast<int>(vertices.size() / 9);
+        mesh.indexCount = static_cast<int>(indices.size());
+        uploadBuffer(GL_ARRAY_BUFFER, mesh.vao, mesh.vbo, mesh.vboCapacity,
+                     vertices.size() * sizeof(float), vertices.data());
+        uploadBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.vao, mesh.ebo, mesh.eboCapacity,
+                     indices.size() * sizeof(unsigned int), indices.data());
+        
+        meshes.push_front(mesh);
+        lookup[key] = meshes.begin();
+        return meshes.front();
+    }
+    
+    // Must be called while the GL context is still current
+    void clear() {
+        for (auto& mesh : meshes) {
+            glDeleteVertexArrays(1, &mesh.vao);
+            glDeleteBuffers(1, &mesh.vbo);
+            glDeleteBuffers(1, &mesh.ebo);
+        }
+        meshes.clear();
+        lookup.clear();
+    }
+    
+    size_t size() const { return meshes.size(); }
+    size_t getHits() const { return hits; }
+    size_t getMisses() const { return misses; }
+    
+    size_t gpuBytes() const {
+        size_t bytes = 0;
+        for (const auto& mesh : meshes) bytes += mesh.vboCapacity + mesh.eboCapacity;
+        return bytes;
+    }
+    
+private:
+    std::list<SphereMesh> meshes;   // most recently used first
+    std::map<unsigned long long, std::list<SphereMesh>::iterator> lookup;
+    size_t hits = 0;
+    size_t misses = 0;
+    
+    static void createMesh(SphereMesh& mesh) {
+        glGenVertexArrays(1, &mesh.vao);
+        glGenBuffers(1, &mesh.vbo);
+        glGenBuffers(1, &mesh.ebo);
+        
+        glBindVertexArray(mesh.vao);
+        glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.ebo);
+        
+        // Position attribute
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        
+        // Normal attribute
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void*)(3 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+        
+        // Color attribute
+        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void*)(6 * sizeof(float)));
+        glEnableVertexAttribArray(2);
+        
+        glBindVertexArray(0);
+    }
+    
+    // Reuse the existing storage when the data fits, growing it otherwise
+    static void uploadBuffer(GLenum target, GLuint vao, GLuint buffer, GLsizeiptr& capacity,
+                             size_t size, const void* data) {
+        // The element binding is VAO state, so bind the VAO first
+        glBindVertexArray(vao);
+        glBindBuffer(target, buffer);
+        if (static_cast<GLsizeiptr>(size) > capacity) {
+            capacity = static_cast<GLsizeiptr>(size);
+            glBufferData(target, capacity, data, GL_STATIC_DRAW);
+        } else {
+            // Orphan the old storage so the driver need not wait for pending draws
+            glBufferData(target, capacity, NULL, GL_STATIC_DRAW);
+            glBufferSubData(target, 0, size, data);
+        }
+        glBindVertexArray(0);
+    }
+};
+
+// Function to lay out sphere centers on a cube grid around the origin
+void generateSphereGrid(std::vector<float>& centers, int count, float spacing) {
+    centers.clear();
+    centers.reserve(count * 3);
+    
+    int side = 1;
+    while (side * side * side < count) side++;
+    float offset = (side - 1) * spacing * 0.5f;
+    
+    // Fill shells outward so the first instance stays at the origin
+    std::vector<int> cells(side * side * side);
+    for (size_t i = 0; i < cells.size(); ++i) cells[i] = static_cast<int>(i);
+    auto distanceToCenter = [&](int cell) {
+        float x = (cell % side) * spacing - offset;
+        float y = (cell / side % side) * spacing - offset;
+        float z = (cell / (side * side)) * spacing - offset;
+        return x * x + y * y + z * z;
+    };
+    std::stable_sort(cells.begin(), cells.end(), [&](int a, int b) {
+        return distanceToCenter(a) < distanceToCenter(b);
+    });
+    
+    for (int i = 0; i < count; ++i) {
+        centers.push_back((cells[i] % side) * spacing - offset);
+        centers.push_back((cells[i] / side % side) * spacing - offset);
+        centers.push_back((cells[i] / (side * side)) * spacing - offset);
+    }
+}
+
 // Function to compile shaders
 GLuint compileShader(GLenum type, const char* source) {
     GLuint shader = glCreateShader(type);
@@ -303,9 +789,9 @@ GLuint compileShader(GLenum type, const char* source) {
 }
 
 // Function to create shader program
-GLuint createShaderProgram() {
-    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexShaderSource);
-    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
+GLuint createShaderProgram(const char* vertexSource, const char* fragmentSource) {
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource);
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
     
     GLuint shaderProgram = glCreateProgram();
     glAttachShader(shaderProgram, vertexShader);
@@ -334,6 +820,36 @@ void setShaderMat4(GLuint shader, const char* name, const Mat4& matrix) {
     }
 }
 
+// Function to create a compute shader program (0 on failure)
+GLuint createComputeProgram(const char* computeSource) {
+    GLuint computeShader = compileShader(GL_COMPUTE_SHADER, computeSource);
+    
+    GLuint program = glCreateProgram();
+    glAttachShader(program, computeShader);
+    glLinkProgram(program);
+    glDeleteShader(computeShader);
+    
+    GLint success;
+    char infoLog[512];
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, 512, NULL, infoLog);
+        std::cerr << "Compute program linking failed:\n" << infoLog << std::endl;
+        glDeleteProgram(program);
+        return 0;
+    }
+    
+    return program;
+}
+
+// Function to send float to shader
+void setShaderFloat(GLuint shader, const char* name, float value) {
+    GLint loc = glGetUniformLocation(shader, name);
+    if (loc != -1) {
+        glUniform1f(loc, value);
+    }
+}
+
 // Function to send vector to shader
 void setShaderVec3(GLuint shader, const char* name, const Vec3& vec) {
     GLint loc = glGetUniformLocation(shader, name);
@@ -342,6 +858,107 @@ void setShaderVec3(GLuint shader, const char* name, const Vec3& vec) {
     }
 }
 
+// GPU-driven swarm of orbiting spheres (GL 4.3). The CPU only resets the
+// indirect command and issues one dispatch and one indirect draw per frame,
+// whatever the instance count.
+class SphereSwarm {
+public:
+    static constexpr int MAX_INSTANCES = 1000000;
+    static constexpr int WORKGROUP_SIZE = 256;
+    
+    void init(GLuint computeProgram, GLuint renderProgram) {
+        this->computeProgram = computeProgram;
+        this->renderProgram = renderProgram;
+        
+        glGenBuffers(1, &transformBuffer);
+        glGenBuffers(1, &commandBuffer);
+        
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(DrawCommand), NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+    
+    void clear() {
+        if (transformBuffer) glDeleteBuffers(1, &transformBuffer);
+        if (commandBuffer) glDeleteBuffers(1, &commandBuffer);
+        transformBuffer = commandBuffer = 0;
+        capacity = 0;
+    }
+    
+    void draw(const SphereMesh& mesh, int count, float time, float sphereScale, bool frustumCulling,
+              const Mat4& view, const Mat4& projection, const Vec3& lightPos) {
+        if (!transformBuffer || count <= 0) return;
+        
+        // Grow the transform storage on demand, one mat4 per instance
+        if (count > capacity) {
+            capacity = count;
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, transformBuffer);
+            glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr)capacity * 16 * sizeof(float), NULL, GL_DYNAMIC_COPY);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        }
+        
+        // The compute pass appends visible instances, so start from zero
+        DrawCommand command = { (GLuint)mesh.indexCount, 0, 0, 0, 0 };
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+        glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, sizeof(command), &command);
+        
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, transformBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, commandBuffer);
+        
+        // Frustum planes from the combined matrix (Mat4 multiplies left to right)
+        Mat4 viewProjection = view * projection;
+        float planes[6][4];
+        for (int i = 0; i < 3; ++i) {
+            for (int side = 0; side < 2; ++side) {
+                float* plane = planes[i * 2 + side];
+                float sign = side == 0 ? 1.0f : -1.0f;
+                for (int c = 0; c < 4; ++c) {
+                    plane[c] = viewProjection.m[c * 4 + 3] + sign * viewProjection.m[c * 4 + i];
+                }
+                float length = sqrtf(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+                for (int c = 0; c < 4; ++c) plane[c] /= length;
+            }
+        }
+        
+        glUseProgram(computeProgram);
+        glUniform1ui(glGetUniformLocation(computeProgram, "instanceTotal"), (GLuint)count);
+        glUniform1f(glGetUniformLocation(computeProgram, "time"), time);
+        glUniform1f(glGetUniformLocation(computeProgram, "orbitSpread"), 2.0f * cbrtf((float)count));
+        glUniform1f(glGetUniformLocation(computeProgram, "sphereScale"), sphereScale);
+        glUniform1i(glGetUniformLocation(computeProgram, "frustumCulling"), frustumCulling ? 1 : 0);
+        glUniform4fv(glGetUniformLocation(computeProgram, "frustumPlanes"), 6, &planes[0][0]);
+        glDispatchCompute((count + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+        
+        // Transforms feed the vertex shader, the command feeds the indirect draw
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+        
+        glUseProgram(renderProgram);
+        setShaderMat4(renderProgram, "view", view);
+        setShaderMat4(renderProgram, "projection", projection);
+        setShaderVec3(renderProgram, "lightPos", lightPos);
+        
+        glBindVertexArray(mesh.vao);
+        glDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)0);
+        glBindVertexArray(0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+    
+private:
+    struct DrawCommand {
+        GLuint count;
+        GLuint instanceCount;
+        GLuint firstIndex;
+        GLuint baseVertex;
+        GLuint baseInstance;
+    };
+    
+    GLuint computeProgram = 0;
+    GLuint renderProgram = 0;
+    GLuint transformBuffer = 0;
+    GLuint commandBuffer = 0;
+    int capacity = 0;
+};
+
 int main() {
     std::cout << "Initializing OpenGL Sphere Game..." << std::endl;
     
@@ -371,7 +988,8 @@ int main() {
     }
     
     // Configure GLFW window
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    // 4.3 enables the compute stress test, 3.3 is the fallback
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
@@ -380,6 +998,11 @@ int main() {
     
     // Create GLFW window
     GLFWwindow* window = glfwCreateWindow(1280, 720, "3D Sphere with ImGui", NULL, NULL);
+    if (!window) {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        window = glfwCreateWindow(1280, 720, "3D Sphere with ImGui", NULL, NULL);
+    }
     if (!window) {
         std::cerr << "GLFW window creation failed!" << std::endl;
         glfwTerminate();
@@ -422,40 +1045,43 @@ int main() {
     glCullFace(GL_BACK);
     
     // Create shader program
-    GLuint shaderProgram = createShaderProgram();
-    
-    // Generate sphere geometry
-    std::vector<float> sphereVertices;
-    std::vector<unsigned int> sphereIndices;
-    generateSphere(sphereVertices, sphereIndices);
-    std::cout << "Sphere generated with " << sphereVertices.size()/9 << " vertices and " 
-              << sphereIndices.size() << " indices" << std::endl;
+    GLuint shaderProgram = createShaderProgram(vertexShaderSource, fragmentShaderSource);
+    GLuint impostorProgram = createShaderProgram(impostorVertexShaderSource, impostorFragmentShaderSource);
     
-    // Create sphere VAO, VBO, EBO
-    GLuint sphereVAO, sphereVBO, sphereEBO;
-    glGenVertexArrays(1, &sphereVAO);
-    glGenBuffers(1, &sphereVBO);
-    glGenBuffers(1, &sphereEBO);
+    // Compute stress test needs GL 4.3 (compute shaders, SSBOs, indirect draws)
+    GLuint swarmComputeProgram = 0;
+    GLuint swarmProgram = 0;
+    SphereSwarm swarm;
+    bool swarmSupported = false;
+    if (GLEW_VERSION_4_3) {
+        swarmComputeProgram = createComputeProgram(swarmComputeShaderSource);
+        swarmProgram = createShaderProgram(swarmVertexShaderSource, fragmentShaderSource);
+        swarmSupported = swarmComputeProgram != 0;
+        if (swarmSupported) swarm.init(swarmComputeProgram, swarmProgram);
+    }
+    std::cout << "Compute stress test: " << (swarmSupported ? "available" : "needs OpenGL 4.3") << std::endl;
     
-    glBindVertexArray(sphereVAO);
+    // Sphere meshes are built on demand and kept in an LRU cache
+    SphereMeshCache sphereCache;
     
-    glBindBuffer(GL_ARRAY_BUFFER, sphereVBO);
-    glBufferData(GL_ARRAY_BUFFER, sphereVertices.size() * sizeof(float), sphereVertices.data(), GL_STATIC_DRAW);
+    // Impostor quad (4 corners) plus per-instance sphere centers
+    const float quadCorners[] = { -1.0f, -1.0f,   1.0f, -1.0f,   -1.0f, 1.0f,   1.0f, 1.0f };
+    GLuint impostorVAO, quadVBO, instanceVBO;
+    glGenVertexArrays(1, &impostorVAO);
+    glGenBuffers(1, &quadVBO);
+    glGenBuffers(1, &instanceVBO);
     
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, sphereEBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sphereIndices.size() * sizeof(unsigned int), sphereIndices.data(), GL_STATIC_DRAW);
+    glBindVertexArray(impostorVAO);
     
-    // Position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void*)0);
+    glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quadCorners), quadCorners, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(0);
     
-    // Normal attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void*)(3 * sizeof(float)));
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(1);
-    
-    // Color attribute
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(1, 1);
     
     glBindVertexArray(0);
     
@@ -470,9 +1096,18 @@ int main() {
     bool wireframeMode = false;
     bool rotateSphere = true;
     float sphereRadius = 1.0f;
+    int sphereType = SPHERE_UV;
     int sphereSegments = 32;
     int sphereStacks = 16;
-    bool regenerateSphere = false;
+    int icoSubdivisions = 3;
+    int cubeResolution = 16;
+    bool impostorMode = false;
+    int impostorCount = 1;
+    int uploadedImpostorCount = 0;
+    const float impostorSpacing = 3.0f;
+    bool swarmMode = false;
+    int swarmCount = 100000;
+    bool swarmCulling = true;
     
     // Performance tracking
     float lastTime = 0.0f;
@@ -539,7 +1174,7 @@ int main() {
             
             // Camera controls
             ImGui::Text("Camera Settings:");
-            ImGui::SliderFloat("Distance", &cameraDistance, 1.0f, 10.0f);
+            ImGui::SliderFloat("Distance", &cameraDistance, 1.0f, (impostorMode || swarmMode) ? 200.0f : 10.0f);
             ImGui::SliderFloat("Height", &cameraHeight, -2.0f, 2.0f);
             ImGui::SliderFloat("Angle", &cameraAngle, 0.0f, 360.0f);
             
@@ -549,18 +1184,38 @@ int main() {
             ImGui::Checkbox("Auto Rotate", &rotateSphere);
             ImGui::SliderFloat("Rotation Speed", &rotationSpeed, 0.0f, 180.0f);
             
-            if (ImGui::SliderFloat("Radius", &sphereRadius, 0.1f, 3.0f)) {
-                regenerateSphere = true;
-            }
+            ImGui::SliderFloat("Radius", &sphereRadius, 0.1f, 3.0f);
             
             // Sphere detail
             ImGui::Separator();
             ImGui::Text("Sphere Detail:");
-            if (ImGui::SliderInt("Segments", &sphereSegments, 8, 64)) {
-                regenerateSphere = true;
+            if (swarmSupported) {
+                ImGui::Checkbox("Compute Stress Test", &swarmMode);
+                if (swarmMode) {
+                    ImGui::SliderInt("Orbiting Spheres", &swarmCount, 1, SphereSwarm::MAX_INSTANCES);
+                    ImGui::Checkbox("GPU Frustum Culling", &swarmCulling);
+                    ImGui::Text("Submitted Triangles: %.1fM", swarmCount * (sphereSegments * (sphereStacks - 1) * 2.0f) / 1e6f);
+                }
+            } else {
+                ImGui::TextDisabled("Compute Stress Test (needs OpenGL 4.3)");
+            }
+            ImGui::Checkbox("Ray-cast Impostor", &impostorMode);
+            if (impostorMode) {
+                ImGui::SliderInt("Instances", &impostorCount, 1, 100000);
+                ImGui::Text("Quad vertices: %d", impostorCount * 4);
             }
-            if (ImGui::SliderInt("Stacks", &sphereStacks, 4, 32)) {
-                regenerateSphere = true;
+            const char* sphereTypes[] = { "UV Sphere", "Icosphere", "Cube Sphere" };
+            if (!impostorMode) ImGui::Combo("Tessellation", &sphereType, sphereTypes, 3);
+            if (impostorMode) {
+                ImGui::SliderInt("Segments", &sphereSegments, 8, 64);
+                ImGui::SliderInt("Stacks", &sphereStacks, 4, 32);
+            } else if (sphereType == SPHERE_UV) {
+                ImGui::SliderInt("Segments", &sphereSegments, 8, 64);
+                ImGui::SliderInt("Stacks", &sphereStacks, 4, 32);
+            } else if (sphereType == SPHERE_ICO) {
+                ImGui::SliderInt("Subdivisions", &icoSubdivisions, 0, 6);
+            } else {
+                ImGui::SliderInt("Resolution", &cubeResolution, 1, 64);
             }
             
             // Lighting controls
@@ -574,15 +1229,10 @@ int main() {
             ImGui::Checkbox("Wireframe Mode", &wireframeMode);
             ImGui::ColorEdit3("Background", backgroundColor);
             
-            // Regenerate sphere if needed
-            if (regenerateSphere) {
-                generateSphere(sphereVertices, sphereIndices, sphereRadius, sphereSegments, sphereStacks);
-                glBindBuffer(GL_ARRAY_BUFFER, sphereVBO);
-                glBufferData(GL_ARRAY_BUFFER, sphereVertices.size() * sizeof(float), sphereVertices.data(), GL_STATIC_DRAW);
-                glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, sphereEBO);
-                glBufferData(GL_ELEMENT_ARRAY_BUFFER, sphereIndices.size() * sizeof(unsigned int), sphereIndices.data(), GL_STATIC_DRAW);
-                regenerateSphere = false;
-            }
+            // Mesh cache info
+            ImGui::Text("Cached Meshes: %zu / %zu (%.1f KB)", sphereCache.size(),
+                        SphereMeshCache::MAX_ENTRIES, sphereCache.gpuBytes() / 1024.0f);
+            ImGui::Text("Cache Hits: %zu  Misses: %zu", sphereCache.getHits(), sphereCache.getMisses());
             
             // Reset button
             ImGui::Separator();
@@ -596,9 +1246,15 @@ int main() {
                 backgroundColor[1] = 0.1f;
                 backgroundColor[2] = 0.15f;
                 sphereRadius = 1.0f;
+                sphereType = SPHERE_UV;
                 sphereSegments = 32;
                 sphereStacks = 16;
-                regenerateSphere = true;
+                icoSubdivisions = 3;
+                cubeResolution = 16;
+                impostorMode = false;
+                impostorCount = 1;
+                swarmMode = false;
+                swarmCount = 100000;
             }
             
             ImGui::SameLine();
@@ -641,7 +1297,7 @@ int main() {
         );
         
         // Create matrices
-        Mat4 projection = Mat4::perspective(60.0f, (float)width / (float)height, 0.1f, 100.0f);
+        Mat4 projection = Mat4::perspective(60.0f, (float)width / (float)height, 0.1f, 500.0f);
         Mat4 view = Mat4::lookAt(cameraPos, Vec3(0.0f, 0.0f, 0.0f), Vec3(0.0f, 1.0f, 0.0f));
         
         // Create model matrix for sphere
@@ -653,21 +1309,59 @@ int main() {
         // Fixed: Use matrix multiplication with the operator we defined
         Mat4 rotationY = Mat4::rotateY(rotationAngle);
         Mat4 rotationX = Mat4::rotateX(rotationAngle * 0.5f);
-        Mat4 model = rotationY * rotationX;
-        
-        // Use shader program
-        glUseProgram(shaderProgram);
+        Mat4 scale = Mat4::scale(sphereRadius, sphereRadius, sphereRadius);
+        Mat4 model = scale * rotationY * rotationX;
         
-        // Pass matrices to shader
-        setShaderMat4(shaderProgram, "model", model);
-        setShaderMat4(shaderProgram, "view", view);
-        setShaderMat4(shaderProgram, "projection", projection);
-        setShaderVec3(shaderProgram, "lightPos", lightPos);
+        if (impostorMode) {
+            // Re-layout instances only when the count changes
+            if (uploadedImpostorCount != impostorCount) {
+                std::vector<float> centers;
+                generateSphereGrid(centers, impostorCount, impostorSpacing);
+                glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+                glBufferData(GL_ARRAY_BUFFER, centers.size() * sizeof(float), centers.data(), GL_STATIC_DRAW);
+                uploadedImpostorCount = impostorCount;
+            }
+            
+            glUseProgram(impostorProgram);
+            
+            setShaderMat4(impostorProgram, "view", view);
+            setShaderMat4(impostorProgram, "projection", projection);
+            setShaderMat4(impostorProgram, "rotation", rotationY * rotationX);
+            setShaderVec3(impostorProgram, "cameraPos", cameraPos);
+            setShaderVec3(impostorProgram, "lightPos", lightPos);
+            setShaderFloat(impostorProgram, "radius", sphereRadius);
+            GLint checkerLoc = glGetUniformLocation(impostorProgram, "checkerCount");
+            glUniform2f(checkerLoc, (float)sphereSegments, (float)sphereStacks);
+            
+            // One instanced draw for every sphere
+            glBindVertexArray(impostorVAO);
+            glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, impostorCount);
+            glBindVertexArray(0);
+        } else {
+            // Use shader program
+            glUseProgram(shaderProgram);
+            
+            // Pass matrices to shader
+            setShaderMat4(shaderProgram, "model", model);
+            setShaderMat4(shaderProgram, "view", view);
+            setShaderMat4(shaderProgram, "projection", projection);
+            setShaderVec3(shaderProgram, "lightPos", lightPos);
+            
+            // Draw sphere (cache hit unless the detail just changed)
+            int detail = sphereType == SPHERE_UV ? sphereSegments :
+                         sphereType == SPHERE_ICO ? icoSubdivisions : cubeResolution;
+            const SphereMesh& sphere = sphereCache.get(static_cast<SphereType>(sphereType), detail, sphereStacks);
+            glBindVertexArray(sphere.vao);
+            glDrawElements(GL_TRIANGLES, sphere.indexCount, GL_UNSIGNED_INT, 0);
+            glBindVertexArray(0);
+        }
         
-        // Draw sphere
-        glBindVertexArray(sphereVAO);
-        glDrawElements(GL_TRIANGLES, sphereIndices.size(), GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
+        // Orbiting swarm, animated and culled entirely on the GPU
+        if (swarmMode && swarmSupported) {
+            const SphereMesh& swarmMesh = sphereCache.get(SPHERE_UV, sphereSegments, sphereStacks);
+            swarm.draw(swarmMesh, swarmCount, currentTime, sphereRadius * 0.25f, swarmCulling,
+                       view, projection, lightPos);
+        }
         
         // Render ImGui
         ImGui::Render();
@@ -687,10 +1381,15 @@ int main() {
     ImGui::DestroyContext();
     
     // Cleanup OpenGL resources
-    glDeleteVertexArrays(1, &sphereVAO);
-    glDeleteBuffers(1, &sphereVBO);
-    glDeleteBuffers(1, &sphereEBO);
+    sphereCache.clear();
+    glDeleteVertexArrays(1, &impostorVAO);
+    glDeleteBuffers(1, &quadVBO);
+    glDeleteBuffers(1, &instanceVBO);
     glDeleteProgram(shaderProgram);
+    glDeleteProgram(impostorProgram);
+    swarm.clear();
+    if (swarmComputeProgram) glDeleteProgram(swarmComputeProgram);
+    if (swarmProgram) glDeleteProgram(swarmProgram);
     
     // Cleanup SDL3
 #ifdef HAS_SDL3
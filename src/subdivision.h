@@ -0,0 +1,818 @@
+// src/subdivision.h - Catmull-Clark and Loop subdivision surfaces from stencil tables
+//
+// The control cage's topology is refined once, up to the requested level, and
+// every refined vertex is written down as a weighted sum of control vertices
+// (its stencil). Evaluating the surface is then a sparse product that runs in
+// parallel over refined vertices; when control vertices move, only the refined
+// vertices whose stencils refer to them are evaluated again, followed by the
+// normals around them.
+//
+// Edges are sharp on boundaries, where more than two faces meet, and where the
+// faces on either side meet at more than the crease angle. Sharp edges follow
+// the crease rules (and vertices on three or more of them stay put); the output
+// keeps separate normals on either side of them. Catmull-Clark takes any
+// polygons, Loop needs triangles.
+//
+// Control positions are padded to 4 floats so each stencil term is one 4-wide
+// multiply-add the compiler can vectorise. The output layout matches the rest
+// of the editor: position + normal (6 floats) per vertex, triangle indices.
+//
+// How far to refine is up to the caller; levelFor() estimates the level that
+// brings the surface within a screen-space tolerance of its limit.
+//
+// No OpenGL here.
+
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+#include <vector>
+#include <algorithm>
+#include <utility>
+
+#include "half_edge_mesh.h"
+#include "mesh_normals.h"
+
+enum SubdivisionScheme {
+    SUBDIVISION_CATMULL_CLARK,
+    SUBDIVISION_LOOP
+};
+
+// Polygons over control vertices
+struct SubdivisionCage {
+    std::vector<float> positions;       // xyz per control vertex
+    std::vector<int> faceStart;         // first corner of each face, then one past the last
+    std::vector<int> faceVertices;      // control vertex at each corner
+
+    int vertexCount() const { return static_cast<int>(positions.size() / 3); }
+    int faceCount() const { return faceStart.empty() ? 0 : static_cast<int>(faceStart.size()) - 1; }
+
+    bool trianglesOnly() const {
+        for (int f = 0; f < faceCount(); ++f) {
+            if (faceStart[f + 1] - faceStart[f] != 3) return false;
+        }
+        return true;
+    }
+
+    // Polygons fanned into triangles over the same vertices, for Loop
+    SubdivisionCage triangulated() const {
+        SubdivisionCage cage;
+        cage.positions = positions;
+        cage.faceStart.push_back(0);
+        for (int f = 0; f < faceCount(); ++f) {
+            for (int h = faceStart[f] + 1; h + 1 < faceStart[f + 1]; ++h) {
+                cage.faceVertices.push_back(faceVertices[faceStart[f]]);
+                cage.faceVertices.push_back(faceVertices[h]);
+                cage.faceVertices.push_back(faceVertices[h + 1]);
+                cage.faceStart.push_back(static_cast<int>(cage.faceVertices.size()));
+            }
+        }
+        return cage;
+    }
+
+    // The faces of a half-edge mesh, keeping its vertex ids. mergeQuads joins coplanar
+    // triangle pairs across an edge that is the longest of both, which undoes the
+    // triangulation of quads (Catmull-Clark gives much rounder results on those).
+    static SubdivisionCage fromHalfEdgeMesh(const HalfEdgeMesh& mesh, bool mergeQuads) {
+        SubdivisionCage cage;
+        cage.positions = mesh.positions;
+        cage.faceStart.reserve(mesh.faceCount() + 1);
+        cage.faceVertices.reserve(mesh.edgeCount());
+        cage.faceStart.push_back(0);
+
+        std::vector<char> merged(mesh.faceCount(), 0);
+        for (int f = 0; f < mesh.faceCount(); ++f) {
+            if (merged[f]) continue;
+
+            if (mergeQuads && mesh.faceSize(f) == 3) {
+                int h = longestEdge(mesh, f);
+                int t = mesh.edgeTwin[h];
+                int g = t >= 0 ? mesh.edgeFace[t] : -1;
+                if (g > f && !merged[g] && mesh.faceSize(g) == 3 && longestEdge(mesh, g) == t && coplanar(mesh, f, g)) {
+                    merged[g] = 1;
+                    // a->b is shared; g runs b->a->d, so a quad a, d, b, c keeps the winding
+                    cage.faceVertices.push_back(mesh.edgeVertex[h]);
+                    cage.faceVertices.push_back(mesh.edgeVertex[mesh.prev(t)]);
+                    cage.faceVertices.push_back(mesh.edgeVertex[mesh.next(h)]);
+                    cage.faceVertices.push_back(mesh.edgeVertex[mesh.prev(h)]);
+                    cage.faceStart.push_back(static_cast<int>(cage.faceVertices.size()));
+                    continue;
+                }
+            }
+
+            for (int h = mesh.faceStart[f]; h < mesh.faceStart[f + 1]; ++h) {
+                cage.faceVertices.push_back(mesh.edgeVertex[h]);
+            }
+            cage.faceStart.push_back(static_cast<int>(cage.faceVertices.size()));
+        }
+        return cage;
+    }
+
+private:
+    static float edgeLengthSquared(const HalfEdgeMesh& mesh, int h) {
+        const float* a = &mesh.positions[mesh.edgeVertex[h] * 3];
+        const float* b = &mesh.positions[mesh.edgeVertex[mesh.next(h)] * 3];
+        float d[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+        return d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+    }
+
+    static int longestEdge(const HalfEdgeMesh& mesh, int f) {
+        int best = mesh.faceStart[f];
+        for (int h = best + 1; h < mesh.faceStart[f + 1]; ++h) {
+            if (edgeLengthSquared(mesh, h) > edgeLengthSquared(mesh, best)) best = h;
+        }
+        return best;
+    }
+
+    static bool coplanar(const HalfEdgeMesh& mesh, int f, int g) {
+        float a[3], b[3];
+        mesh.faceNormal(f, a);
+        mesh.faceNormal(g, b);
+        float dot = a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+        float lengths = sqrtf((a[0] * a[0] + a[1] * a[1] + a[2] * a[2]) * (b[0] * b[0] + b[1] * b[1] + b[2] * b[2]));
+        return lengths > 0.0f && dot > 0.9999f * lengths;
+    }
+};
+
+class SubdivisionSurface {
+public:
+    static const int MAX_LEVEL = 6;
+
+    // Refine the cage's topology to level and build the stencil tables. Positions only
+    // decide which edges are creases (creaseAngleDegrees >= 180 creases only boundaries).
+    // Returns false for an empty cage, or for Loop on anything but triangles.
+    bool build(const SubdivisionCage& cage, SubdivisionScheme scheme, int level, float creaseAngleDegrees) {
+        *this = SubdivisionSurface();
+        if (cage.faceCount() == 0) return false;
+        if (scheme == SUBDIVISION_LOOP && !cage.trianglesOnly()) return false;
+        if (level < 0) level = 0;
+        if (level > MAX_LEVEL) level = MAX_LEVEL;
+
+        Level current;
+        current.vertexCount = cage.vertexCount();
+        current.faceStart = cage.faceStart;
+        current.faceVertices = cage.faceVertices;
+        linkLevel(current, std::vector<uint64_t>());
+        markCreases(current, cage.positions.data(), creaseAngleDegrees);
+
+        Stencils flat;
+        flat.start.resize(current.vertexCount + 1);
+        flat.index.resize(current.vertexCount);
+        flat.weight.assign(current.vertexCount, 1.0f);
+        for (int v = 0; v <= current.vertexCount; ++v) flat.start[v] = v;
+        for (int v = 0; v < current.vertexCount; ++v) flat.index[v] = v;
+
+        for (int l = 0; l < level; ++l) {
+            Level next;
+            Stencils local;
+            refine(current, scheme, next, local);
+            flat = compose(local, flat, cage.vertexCount());
+            current = std::move(next);
+        }
+
+        controlCount = cage.vertexCount();
+        schemeBuilt = scheme;
+        levelBuilt = level;
+        stencils = std::move(flat);
+        buildOutput(current);
+        return true;
+    }
+
+    // Every refined vertex and normal from scratch; the whole output is marked dirty
+    void evaluate(const float* controlPositions) {
+        control.resize(static_cast<size_t>(controlCount) * 4);
+        for (int c = 0; c < controlCount; ++c) {
+            control[c * 4] = controlPositions[c * 3];
+            control[c * 4 + 1] = controlPositions[c * 3 + 1];
+            control[c * 4 + 2] = controlPositions[c * 3 + 2];
+            control[c * 4 + 3] = 0.0f;
+        }
+        refined.resize(static_cast<size_t>(refinedCount()) * 4);
+        faceNormals.resize(static_cast<size_t>(faceCount()) * 3);
+        vertices.resize(static_cast<size_t>(vertexCount()) * 6);
+
+        NormalGenerator::parallelFor(refinedCount(), [&](size_t begin, size_t end, unsigned int) {
+            for (size_t i = begin; i < end; ++i) evaluateRefined(static_cast<int>(i));
+        });
+        NormalGenerator::parallelFor(faceCount(), [&](size_t begin, size_t end, unsigned int) {
+            for (size_t f = begin; f < end; ++f) evaluateFaceNormal(static_cast<int>(f));
+        });
+        NormalGenerator::parallelFor(vertexCount(), [&](size_t begin, size_t end, unsigned int) {
+            for (size_t o = begin; o < end; ++o) evaluateOutput(static_cast<int>(o));
+        });
+        dirtyVertices.clear();
+        dirtyVertices.add(0, vertexCount());
+    }
+
+    // Re-evaluate what depends on the moved control vertices (positions holds all of them,
+    // 3 floats each). Output vertices that changed are added to dirtyVertices.
+    void update(const float* controlPositions, const std::vector<int>& moved) {
+        if (control.empty()) {
+            evaluate(controlPositions);
+            return;
+        }
+        for (int c : moved) {
+            control[c * 4] = controlPositions[c * 3];
+            control[c * 4 + 1] = controlPositions[c * 3 + 1];
+            control[c * 4 + 2] = controlPositions[c * 3 + 2];
+        }
+
+        uint32_t stamp = nextStamp();
+        std::vector<int> refinedList;
+        for (int c : moved) {
+            for (int i = controlStart[c]; i < controlStart[c + 1]; ++i) {
+                int r = controlRefined[i];
+                if (refinedMark[r] != stamp) {
+                    refinedMark[r] = stamp;
+                    refinedList.push_back(r);
+                }
+            }
+        }
+        // Past a quarter of the surface the lookups cost more than they save
+        if (refinedList.size() * 4 > static_cast<size_t>(refinedCount())) {
+            evaluate(controlPositions);
+            return;
+        }
+
+        std::vector<int> faceList;
+        for (int r : refinedList) {
+            for (int i = refinedCornerStart[r]; i < refinedCornerStart[r + 1]; ++i) {
+                int f = cornerFace[refinedCorners[i]];
+                if (faceMark[f] != stamp) {
+                    faceMark[f] = stamp;
+                    faceList.push_back(f);
+                }
+            }
+        }
+
+        std::vector<int> outputList;
+        for (int f : faceList) {
+            for (int corner = faceStart[f]; corner < faceStart[f + 1]; ++corner) {
+                int o = cornerOutput[corner];
+                if (outputMark[o] != stamp) {
+                    outputMark[o] = stamp;
+                    outputList.push_back(o);
+                }
+            }
+        }
+        std::sort(outputList.begin(), outputList.end());
+
+        NormalGenerator::parallelFor(refinedList.size(), [&](size_t begin, size_t end, unsigned int) {
+            for (size_t i = begin; i < end; ++i) evaluateRefined(refinedList[i]);
+        });
+        NormalGenerator::parallelFor(faceList.size(), [&](size_t begin, size_t end, unsigned int) {
+            for (size_t i = begin; i < end; ++i) evaluateFaceNormal(faceList[i]);
+        });
+        NormalGenerator::parallelFor(outputList.size(), [&](size_t begin, size_t end, unsigned int) {
+            for (size_t i = begin; i < end; ++i) evaluateOutput(outputList[i]);
+        });
+        for (int o : outputList) dirtyVertices.add(o);
+    }
+
+    // Output: position + normal per vertex, triangles over those vertices
+    const std::vector<float>& vertexData() const { return vertices; }
+    const std::vector<unsigned int>& indexData() const { return indices; }
+    DirtyRanges dirtyVertices;
+
+    int level() const { return levelBuilt; }
+    SubdivisionScheme scheme() const { return schemeBuilt; }
+    int controlVertexCount() const { return controlCount; }
+    int refinedCount() const { return static_cast<int>(stencils.start.size()) - 1; }
+    int faceCount() const { return faceStart.empty() ? 0 : static_cast<int>(faceStart.size()) - 1; }
+    int vertexCount() const { return static_cast<int>(outputRefined.size()); }
+    int indexCount() const { return static_cast<int>(indices.size()); }
+    size_t stencilEntries() const { return stencils.index.size(); }
+
+    // Memory held by the tables, not counting the evaluated output
+    size_t tableBytes() const {
+        return stencils.start.size() * sizeof(int) + stencils.index.size() * (sizeof(int) + sizeof(float)) +
+               (controlStart.size() + controlRefined.size() + refinedCornerStart.size() + refinedCorners.size() +
+                faceStart.size() + cornerFace.size() + cornerOutput.size() + outputRefined.size() +
+                outputCornerStart.size() + outputCorners.size()) * sizeof(int);
+    }
+
+    // Faces a cage has after level steps; quads throughout after the first Catmull-Clark step
+    static size_t faceCountAt(const SubdivisionCage& cage, SubdivisionScheme scheme, int level) {
+        if (level <= 0) return cage.faceCount();
+        size_t count = scheme == SUBDIVISION_LOOP ? static_cast<size_t>(cage.faceCount()) * 4 : cage.faceVertices.size();
+        for (int l = 1; l < level; ++l) count *= 4;
+        return count;
+    }
+
+    // Rough distance between the cage and its limit surface: each smooth edge bending by
+    // angle a over length L is taken to sag by about L * a / 8, as a chord of a circle would
+    static float cageDeviation(const SubdivisionCage& cage, float creaseAngleDegrees) {
+        if (cage.faceCount() == 0) return 0.0f;
+        Level level;
+        level.vertexCount = cage.vertexCount();
+        level.faceStart = cage.faceStart;
+        level.faceVertices = cage.faceVertices;
+        linkLevel(level, std::vector<uint64_t>());
+        markCreases(level, cage.positions.data(), creaseAngleDegrees);
+
+        std::vector<float> normals;
+        faceNormalsOf(level, cage.positions.data(), normals);
+        float deviation = 0.0f;
+        for (size_t e = 0; e < level.edgeSharp.size(); ++e) {
+            if (level.edgeSharp[e]) continue;
+            const float* n0 = &normals[level.cornerFace[level.edgeCorners[e * 2]] * 3];
+            const float* n1 = &normals[level.cornerFace[level.edgeCorners[e * 2 + 1]] * 3];
+            float angle = acosf(std::max(-1.0f, std::min(1.0f, n0[0] * n1[0] + n0[1] * n1[1] + n0[2] * n1[2])));
+            const float* a = &cage.positions[level.edgeVertices[e * 2] * 3];
+            const float* b = &cage.positions[level.edgeVertices[e * 2 + 1] * 3];
+            float d[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+            deviation = std::max(deviation, sqrtf(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]) * angle * 0.125f);
+        }
+        return deviation;
+    }
+
+    // Smallest level whose deviation, cut about four times per level, stays within
+    // tolerancePixels once scaled to the screen by pixelsPerUnit
+    static int levelFor(float deviation, float pixelsPerUnit, float tolerancePixels, int maxLevel) {
+        float error = deviation * pixelsPerUnit;
+        int level = 0;
+        while (level < maxLevel && error > tolerancePixels) {
+            error *= 0.25f;
+            ++level;
+        }
+        return level;
+    }
+
+private:
+    // Compressed rows: row i is terms [start[i], start[i + 1])
+    struct Stencils {
+        std::vector<int> start;
+        std::vector<int> index;
+        std::vector<float> weight;
+    };
+
+    struct Level {
+        int vertexCount = 0;
+        std::vector<int> faceStart, faceVertices;
+        std::vector<int> cornerFace;        // per corner
+        std::vector<int> cornerEdge;        // edge from this corner's vertex to the next one
+        std::vector<int> edgeVertices;      // 2 per edge
+        std::vector<int> edgeCorners;       // 2 per edge: a corner starting it in each face, -1 if none
+        std::vector<char> edgeSharp;
+        std::vector<int> vertexEdgeStart, vertexEdges;
+        std::vector<int> vertexCornerStart, vertexCorners;
+
+        int nextCorner(int h) const { return h + 1 == faceStart[cornerFace[h] + 1] ? faceStart[cornerFace[h]] : h + 1; }
+        int faceCount() const { return static_cast<int>(faceStart.size()) - 1; }
+        int edgeCount() const { return static_cast<int>(edgeSharp.size()); }
+    };
+
+    int controlCount = 0;
+    int levelBuilt = 0;
+    SubdivisionScheme schemeBuilt = SUBDIVISION_CATMULL_CLARK;
+
+    Stencils stencils;                                  // refined vertex -> control vertices
+    std::vector<int> controlStart, controlRefined;      // control vertex -> refined vertices it moves
+    std::vector<int> faceStart, cornerFace;             // refined faces
+    std::vector<int> refinedCornerStart, refinedCorners;
+    std::vector<int> cornerOutput;                      // output vertex of each corner
+    std::vector<int> outputRefined;                     // refined vertex of each output vertex
+    std::vector<int> outputCornerStart, outputCorners;  // corners sharing an output vertex (and its normal)
+    std::vector<unsigned int> indices;
+
+    std::vector<float> control;                         // 4 floats per control vertex
+    std::vector<float> refined;                         // 4 floats per refined vertex
+    std::vector<float> faceNormals;
+    std::vector<float> vertices;
+
+    std::vector<uint32_t> refinedMark, faceMark, outputMark;
+    uint32_t stamp = 0;
+
+    static uint64_t edgeKey(int a, int b) {
+        return a < b ? (static_cast<uint64_t>(a) << 32) | static_cast<uint32_t>(b)
+                     : (static_cast<uint64_t>(b) << 32) | static_cast<uint32_t>(a);
+    }
+
+    // Rows of a compressed table from per-row counts
+    static void countsToStarts(std::vector<int>& start) {
+        int sum = 0;
+        for (int& s : start) {
+            int count = s;
+            s = sum;
+            sum += count;
+        }
+    }
+
+    // Edges, and vertex -> edge and vertex -> corner tables. Edges listed in sharpKeys
+    // (sorted) are sharp, as are boundaries, non-manifold edges and flipped neighbours.
+    static void linkLevel(Level& level, const std::vector<uint64_t>& sharpKeys) {
+        int cornerCount = static_cast<int>(level.faceVertices.size());
+        level.cornerFace.resize(cornerCount);
+        for (int f = 0; f < level.faceCount(); ++f) {
+            for (int h = level.faceStart[f]; h < level.faceStart[f + 1]; ++h) level.cornerFace[h] = f;
+        }
+
+        std::vector<std::pair<uint64_t, int>> keys(cornerCount);
+        for (int h = 0; h < cornerCount; ++h) {
+            keys[h] = std::make_pair(edgeKey(level.faceVertices[h], level.faceVertices[level.nextCorner(h)]), h);
+        }
+        std::sort(keys.begin(), keys.end());
+
+        level.cornerEdge.assign(cornerCount, -1);
+        level.edgeVertices.clear();
+        level.edgeCorners.clear();
+        level.edgeSharp.clear();
+        for (int i = 0; i < cornerCount;) {
+            int j = i + 1;
+            while (j < cornerCount && keys[j].first == keys[i].first) ++j;
+
+            int e = level.edgeCount();
+            int h0 = keys[i].second;
+            int h1 = j - i >= 2 ? keys[i + 1].second : -1;
+            level.edgeVertices.push_back(static_cast<int>(keys[i].first >> 32));
+            level.edgeVertices.push_back(static_cast<int>(keys[i].first & 0xffffffffu));
+            level.edgeCorners.push_back(h0);
+            level.edgeCorners.push_back(h1);
+            bool sharp = j - i != 2 || level.faceVertices[h0] == level.faceVertices[h1] ||
+                         std::binary_search(sharpKeys.begin(), sharpKeys.end(), keys[i].first);
+            level.edgeSharp.push_back(sharp ? 1 : 0);
+            for (int k = i; k < j; ++k) level.cornerEdge[keys[k].second] = e;
+            i = j;
+        }
+
+        level.vertexEdgeStart.assign(level.vertexCount + 1, 0);
+        for (int v : level.edgeVertices) level.vertexEdgeStart[v]++;
+        countsToStarts(level.vertexEdgeStart);
+        level.vertexEdges.resize(level.edgeVertices.size());
+        std::vector<int> fill(level.vertexEdgeStart.begin(), level.vertexEdgeStart.end() - 1);
+        for (int e = 0; e < level.edgeCount(); ++e) {
+            level.vertexEdges[fill[level.edgeVertices[e * 2]]++] = e;
+            level.vertexEdges[fill[level.edgeVertices[e * 2 + 1]]++] = e;
+        }
+
+        level.vertexCornerStart.assign(level.vertexCount + 1, 0);
+        for (int v : level.faceVertices) level.vertexCornerStart[v]++;
+        countsToStarts(level.vertexCornerStart);
+        level.vertexCorners.resize(cornerCount);
+        fill.assign(level.vertexCornerStart.begin(), level.vertexCornerStart.end() - 1);
+        for (int h = 0; h < cornerCount; ++h) level.vertexCorners[fill[level.faceVertices[h]]++] = h;
+    }
+
+    // Newell normals, normalised
+    static void faceNormalsOf(const Level& level, const float* positions, std::vector<float>& normals) {
+        normals.assign(static_cast<size_t>(level.faceCount()) * 3, 0.0f);
+        for (int f = 0; f < level.faceCount(); ++f) {
+            float* n = &normals[f * 3];
+            for (int h = level.faceStart[f]; h < level.faceStart[f + 1]; ++h) {
+                const float* a = &positions[level.faceVertices[h] * 3];
+                const float* b = &positions[level.faceVertices[level.nextCorner(h)] * 3];
+                n[0] += (a[1] - b[1]) * (a[2] + b[2]);
+                n[1] += (a[2] - b[2]) * (a[0] + b[0]);
+                n[2] += (a[0] - b[0]) * (a[1] + b[1]);
+            }
+            float length = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            if (length > 0.0f) {
+                n[0] /= length;
+                n[1] /= length;
+                n[2] /= length;
+            }
+        }
+    }
+
+    static void markCreases(Level& level, const float* positions, float creaseAngleDegrees) {
+        if (creaseAngleDegrees >= 180.0f) return;
+        float cosThreshold = cosf(creaseAngleDegrees * 3.14159265f / 180.0f);
+        std::vector<float> normals;
+        faceNormalsOf(level, positions, normals);
+        for (int e = 0; e < level.edgeCount(); ++e) {
+            if (level.edgeSharp[e]) continue;
+            const float* n0 = &normals[level.cornerFace[level.edgeCorners[e * 2]] * 3];
+            const float* n1 = &normals[level.cornerFace[level.edgeCorners[e * 2 + 1]] * 3];
+            if (n0[0] * n1[0] + n0[1] * n1[1] + n0[2] * n1[2] < cosThreshold) level.edgeSharp[e] = 1;
+        }
+    }
+
+    // Collects the terms of one stencil row; repeated indices are summed when it is closed
+    struct RowBuilder {
+        std::vector<std::pair<int, float>> terms;
+
+        void add(int index, float weight) { terms.push_back(std::make_pair(index, weight)); }
+
+        void close(Stencils& table) {
+            std::sort(terms.begin(), terms.end(),
+                      [](const std::pair<int, float>& a, const std::pair<int, float>& b) { return a.first < b.first; });
+            for (size_t i = 0; i < terms.size(); ++i) {
+                if (i > 0 && terms[i].first == terms[i - 1].first) {
+                    table.weight.back() += terms[i].second;
+                } else {
+                    table.index.push_back(terms[i].first);
+                    table.weight.push_back(terms[i].second);
+                }
+            }
+            table.start.push_back(static_cast<int>(table.index.size()));
+            terms.clear();
+        }
+    };
+
+    // One refinement step: the next level's faces, and its vertices in terms of this level's.
+    // New vertices are numbered vertex points, then edge points, then face points.
+    static void refine(const Level& level, SubdivisionScheme scheme, Level& next, Stencils& local) {
+        int vertexCount = level.vertexCount, edgeCount = level.edgeCount(), faceCount = level.faceCount();
+        int edgeBase = vertexCount, faceBase = vertexCount + edgeCount;
+        bool loop = scheme == SUBDIVISION_LOOP;
+
+        local.start.assign(1, 0);
+        local.index.clear();
+        local.weight.clear();
+        RowBuilder row;
+
+        for (int v = 0; v < vertexCount; ++v) {
+            int edgeBegin = level.vertexEdgeStart[v], edgeEnd = level.vertexEdgeStart[v + 1];
+            int valence = edgeEnd - edgeBegin;
+            int sharpCount = 0;
+            for (int i = edgeBegin; i < edgeEnd; ++i) sharpCount += level.edgeSharp[level.vertexEdges[i]];
+
+            if (valence == 0 || sharpCount > 2) {
+                row.add(v, 1.0f);                               // corner, or unused
+            } else if (sharpCount == 2) {
+                row.add(v, 0.75f);                              // crease
+                for (int i = edgeBegin; i < edgeEnd; ++i) {
+                    int e = level.vertexEdges[i];
+                    if (level.edgeSharp[e]) row.add(otherEnd(level, e, v), 0.125f);
+                }
+            } else if (loop) {
+                float beta = valence == 3 ? 3.0f / 16.0f : 3.0f / (8.0f * valence);
+                row.add(v, 1.0f - valence * beta);
+                for (int i = edgeBegin; i < edgeEnd; ++i) row.add(otherEnd(level, level.vertexEdges[i], v), beta);
+            } else {
+                // (Q + 2R + (n - 3) v) / n: Q averages the face points, R the edge midpoints
+                float n = static_cast<float>(valence);
+                row.add(v, (n - 3.0f) / n);
+                for (int i = edgeBegin; i < edgeEnd; ++i) {
+                    row.add(v, 1.0f / (n * n));
+                    row.add(otherEnd(level, level.vertexEdges[i], v), 1.0f / (n * n));
+                }
+                int cornerBegin = level.vertexCornerStart[v], cornerEnd = level.vertexCornerStart[v + 1];
+                float faceWeight = 1.0f / (n * (cornerEnd - cornerBegin));
+                for (int i = cornerBegin; i < cornerEnd; ++i) {
+                    int f = level.cornerFace[level.vertexCorners[i]];
+                    float weight = faceWeight / (level.faceStart[f + 1] - level.faceStart[f]);
+                    for (int h = level.faceStart[f]; h < level.faceStart[f + 1]; ++h) row.add(level.faceVertices[h], weight);
+                }
+            }
+            row.close(local);
+        }
+
+        for (int e = 0; e < edgeCount; ++e) {
+            int a = level.edgeVertices[e * 2], b = level.edgeVertices[e * 2 + 1];
+            if (level.edgeSharp[e]) {
+                row.add(a, 0.5f);
+                row.add(b, 0.5f);
+            } else if (loop) {
+                row.add(a, 0.375f);
+                row.add(b, 0.375f);
+                for (int k = 0; k < 2; ++k) {
+                    int h = level.edgeCorners[e * 2 + k];
+                    row.add(level.faceVertices[level.nextCorner(level.nextCorner(h))], 0.125f);
+                }
+            } else {
+                row.add(a, 0.25f);
+                row.add(b, 0.25f);
+                for (int k = 0; k < 2; ++k) {
+                    int f = level.cornerFace[level.edgeCorners[e * 2 + k]];
+                    float weight = 0.25f / (level.faceStart[f + 1] - level.faceStart[f]);
+                    for (int h = level.faceStart[f]; h < level.faceStart[f + 1]; ++h) row.add(level.faceVertices[h], weight);
+                }
+            }
+            row.close(local);
+        }
+
+        next.faceStart.assign(1, 0);
+        next.faceVertices.clear();
+        if (loop) {
+            next.vertexCount = vertexCount + edgeCount;
+            next.faceVertices.reserve(static_cast<size_t>(faceCount) * 12);
+            for (int f = 0; f < faceCount; ++f) {
+                int h = level.faceStart[f];
+                int a = level.faceVertices[h], b = level.faceVertices[h + 1], c = level.faceVertices[h + 2];
+                int ab = edgeBase + level.cornerEdge[h];
+                int bc = edgeBase + level.cornerEdge[h + 1];
+                int ca = edgeBase + level.cornerEdge[h + 2];
+                const int triangles[4][3] = { { a, ab, ca }, { ab, b, bc }, { ca, bc, c }, { ab, bc, ca } };
+                for (const auto& triangle : triangles) {
+                    next.faceVertices.insert(next.faceVertices.end(), triangle, triangle + 3);
+                    next.faceStart.push_back(static_cast<int>(next.faceVertices.size()));
+                }
+            }
+        } else {
+            next.vertexCount = faceBase + faceCount;
+            next.faceVertices.reserve(level.faceVertices.size() * 4);
+            for (int f = 0; f < faceCount; ++f) {
+                int first = level.faceStart[f], last = level.faceStart[f + 1];
+                float weight = 1.0f / (last - first);
+                for (int h = first; h < last; ++h) row.add(level.faceVertices[h], weight);
+                row.close(local);
+
+                for (int h = first; h < last; ++h) {
+                    int previous = h == first ? last - 1 : h - 1;
+                    next.faceVertices.push_back(level.faceVertices[h]);
+                    next.faceVertices.push_back(edgeBase + level.cornerEdge[h]);
+                    next.faceVertices.push_back(faceBase + f);
+                    next.faceVertices.push_back(edgeBase + level.cornerEdge[previous]);
+                    next.faceStart.push_back(static_cast<int>(next.faceVertices.size()));
+                }
+            }
+        }
+
+        // Both halves of a sharp edge stay sharp
+        std::vector<uint64_t> sharpKeys;
+        for (int e = 0; e < edgeCount; ++e) {
+            if (!level.edgeSharp[e]) continue;
+            sharpKeys.push_back(edgeKey(level.edgeVertices[e * 2], edgeBase + e));
+            sharpKeys.push_back(edgeKey(edgeBase + e, level.edgeVertices[e * 2 + 1]));
+        }
+        std::sort(sharpKeys.begin(), sharpKeys.end());
+        linkLevel(next, sharpKeys);
+    }
+
+    static int otherEnd(const Level& level, int e, int v) {
+        return level.edgeVertices[e * 2] == v ? level.edgeVertices[e * 2 + 1] : level.edgeVertices[e * 2];
+    }
+
+    // Rows of local (over the previous level) rewritten over control vertices. Each worker
+    // fills its own table with a dense scratch row; the tables are joined in order.
+    static Stencils compose(const Stencils& local, const Stencils& previous, int controlCount) {
+        size_t rowCount = local.start.size() - 1;
+        unsigned int threadCount = NormalGenerator::threadCountFor(rowCount);
+        std::vector<Stencils> parts(threadCount);
+
+        NormalGenerator::parallelFor(rowCount, [&](size_t begin, size_t end, unsigned int thread) {
+            Stencils& part = parts[thread];
+            part.start.reserve(end - begin);
+            std::vector<float> scratch(controlCount, 0.0f);
+            std::vector<char> used(controlCount, 0);
+            std::vector<int> touched;
+            for (size_t i = begin; i < end; ++i) {
+                for (int s = local.start[i]; s < local.start[i + 1]; ++s) {
+                    int j = local.index[s];
+                    float w = local.weight[s];
+                    for (int t = previous.start[j]; t < previous.start[j + 1]; ++t) {
+                        int c = previous.index[t];
+                        if (!used[c]) {
+                            used[c] = 1;
+                            touched.push_back(c);
+                        }
+                        scratch[c] += w * previous.weight[t];
+                    }
+                }
+                // Ascending control order keeps the gathers in evaluation moving forward
+                std::sort(touched.begin(), touched.end());
+                for (int c : touched) {
+                    part.index.push_back(c);
+                    part.weight.push_back(scratch[c]);
+                    scratch[c] = 0.0f;
+                    used[c] = 0;
+                }
+                part.start.push_back(static_cast<int>(part.index.size()));
+                touched.clear();
+            }
+        });
+
+        Stencils result;
+        result.start.reserve(rowCount + 1);
+        result.start.push_back(0);
+        for (const Stencils& part : parts) {
+            int base = result.start.back();
+            for (int s : part.start) result.start.push_back(base + s);
+            result.index.insert(result.index.end(), part.index.begin(), part.index.end());
+            result.weight.insert(result.weight.end(), part.weight.begin(), part.weight.end());
+        }
+        return result;
+    }
+
+    static int findRoot(std::vector<int>& parent, int i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    }
+
+    // Tables for evaluation from the finest level: the reverse stencil lookup, output vertices
+    // (one per refined vertex and run of faces between sharp edges) and the triangles
+    void buildOutput(const Level& level) {
+        int cornerCount = static_cast<int>(level.faceVertices.size());
+        faceStart = level.faceStart;
+        cornerFace = level.cornerFace;
+        refinedCornerStart = level.vertexCornerStart;
+        refinedCorners = level.vertexCorners;
+
+        controlStart.assign(controlCount + 1, 0);
+        for (int c : stencils.index) controlStart[c]++;
+        countsToStarts(controlStart);
+        controlRefined.resize(stencils.index.size());
+        std::vector<int> fill(controlStart.begin(), controlStart.end() - 1);
+        for (int r = 0; r < refinedCount(); ++r) {
+            for (int s = stencils.start[r]; s < stencils.start[r + 1]; ++s) controlRefined[fill[stencils.index[s]]++] = r;
+        }
+
+        // Corners on either side of a smooth edge share their vertex's normal
+        std::vector<int> parent(cornerCount);
+        for (int h = 0; h < cornerCount; ++h) parent[h] = h;
+        for (int e = 0; e < level.edgeCount(); ++e) {
+            if (level.edgeSharp[e]) continue;
+            int h0 = level.edgeCorners[e * 2], h1 = level.edgeCorners[e * 2 + 1];
+            parent[findRoot(parent, h0)] = findRoot(parent, level.nextCorner(h1));
+            parent[findRoot(parent, level.nextCorner(h0))] = findRoot(parent, h1);
+        }
+
+        // Numbered in corner order so neighbouring faces get neighbouring vertices
+        cornerOutput.assign(cornerCount, -1);
+        outputRefined.clear();
+        for (int h = 0; h < cornerCount; ++h) {
+            int root = findRoot(parent, h);
+            if (cornerOutput[root] < 0) {
+                cornerOutput[root] = static_cast<int>(outputRefined.size());
+                outputRefined.push_back(level.faceVertices[h]);
+            }
+            cornerOutput[h] = cornerOutput[root];
+        }
+
+        outputCornerStart.assign(outputRefined.size() + 1, 0);
+        for (int o : cornerOutput) outputCornerStart[o]++;
+        countsToStarts(outputCornerStart);
+        outputCorners.resize(cornerCount);
+        fill.assign(outputCornerStart.begin(), outputCornerStart.end() - 1);
+        for (int h = 0; h < cornerCount; ++h) outputCorners[fill[cornerOutput[h]]++] = h;
+
+        indices.clear();
+        indices.reserve(static_cast<size_t>(cornerCount - 2 * level.faceCount()) * 3);
+        for (int f = 0; f < level.faceCount(); ++f) {
+            int first = level.faceStart[f], last = level.faceStart[f + 1];
+            for (int h = first + 1; h + 1 < last; ++h) {
+                indices.push_back(cornerOutput[first]);
+                indices.push_back(cornerOutput[h]);
+                indices.push_back(cornerOutput[h + 1]);
+            }
+        }
+
+        refinedMark.assign(refinedCount(), 0);
+        faceMark.assign(faceCount(), 0);
+        outputMark.assign(vertexCount(), 0);
+    }
+
+    uint32_t nextStamp() {
+        if (++stamp == 0) {
+            std::fill(refinedMark.begin(), refinedMark.end(), 0);
+            std::fill(faceMark.begin(), faceMark.end(), 0);
+            std::fill(outputMark.begin(), outputMark.end(), 0);
+            stamp = 1;
+        }
+        return stamp;
+    }
+
+    void evaluateRefined(int r) {
+        float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        for (int s = stencils.start[r]; s < stencils.start[r + 1]; ++s) {
+            const float* p = &control[stencils.index[s] * 4];
+            float w = stencils.weight[s];
+            for (int k = 0; k < 4; ++k) sum[k] += w * p[k];
+        }
+        for (int k = 0; k < 4; ++k) refined[r * 4 + k] = sum[k];
+    }
+
+    // Newell normal, left at twice the face area so larger faces weigh more
+    void evaluateFaceNormal(int f) {
+        float n[3] = { 0.0f, 0.0f, 0.0f };
+        int first = faceStart[f], last = faceStart[f + 1];
+        for (int h = first; h < last; ++h) {
+            const float* a = &refined[outputRefined[cornerOutput[h]] * 4];
+            const float* b = &refined[outputRefined[cornerOutput[h + 1 == last ? first : h + 1]] * 4];
+            n[0] += (a[1] - b[1]) * (a[2] + b[2]);
+            n[1] += (a[2] - b[2]) * (a[0] + b[0]);
+            n[2] += (a[0] - b[0]) * (a[1] + b[1]);
+        }
+        faceNormals[f * 3] = n[0];
+        faceNormals[f * 3 + 1] = n[1];
+        faceNormals[f * 3 + 2] = n[2];
+    }
+
+    void evaluateOutput(int o) {
+        float n[3] = { 0.0f, 0.0f, 0.0f };
+        for (int i = outputCornerStart[o]; i < outputCornerStart[o + 1]; ++i) {
+            const float* face = &faceNormals[cornerFace[outputCorners[i]] * 3];
+            n[0] += face[0];
+            n[1] += face[1];
+            n[2] += face[2];
+        }
+        float length = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (length > 0.0f) {
+            n[0] /= length;
+            n[1] /= length;
+            n[2] /= length;
+        }
+        const float* p = &refined[outputRefined[o] * 4];
+        float* out = &vertices[o * 6];
+        out[0] = p[0];
+        out[1] = p[1];
+        out[2] = p[2];
+        out[3] = n[0];
+        out[4] = n[1];
+        out[5] = n[2];
+    }
+};
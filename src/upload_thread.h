@@ -0,0 +1,209 @@
+#pragma once
+
+// Background GPU uploads on a second GL context shared with the main one.
+//
+// A job goes through up to four steps, each optional:
+//   prepare  upload thread, no GL (parsing, mesh processing)
+//   upload   upload thread, on the shared context: create buffers and fill them
+//   attach   render thread, from attachUploads(): anything that cannot be shared
+//            between contexts (vertex arrays) and bookkeeping tied to that thread
+//   finish   main thread, from finishUploads(): hand the result to the scene
+// After upload a fence is inserted and the job only moves on to attach once
+// glClientWaitSync() reports it signalled, so the render thread never sees a
+// buffer whose data is still in flight. The waiting happens on the upload
+// thread; neither the render nor the main thread blocks on an upload.
+//
+// If the shared context cannot be created the upload step runs on the render
+// thread in attachUploads() instead, which is what happened before.
+//
+// Upload steps run on another context, so they must call GL through the
+// uncaptured* entry points of gl_capture.h rather than the capture hooks.
+//
+// start() and stop() create and destroy a hidden window, so they belong on the
+// main thread. Include after the GL and GLFW headers.
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+
+class UploadThread {
+public:
+    using Work = std::function<void()>;
+
+    struct Job {
+        Work prepare;
+        Work upload;
+        Work attach;
+        Work finish;
+    };
+
+    ~UploadThread() { stop(); }
+
+    // Returns false (and runs uploads on the render thread) if no shared context is available.
+    // Call while the context of shareWith is not current on another thread.
+    bool start(GLFWwindow* shareWith) {
+        if (worker.joinable()) return shared;
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        context = glfwCreateWindow(1, 1, "Uploads", NULL, shareWith);
+        glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+        shared = context != NULL;
+
+        quit = false;
+        worker = std::thread([this]() {
+            if (context) glfwMakeContextCurrent(context);
+            run();
+            if (context) glfwMakeContextCurrent(NULL);
+        });
+        return shared;
+    }
+
+    // Waits for the job being uploaded and its fence; jobs not started yet are dropped.
+    // Finished jobs still have to go through attachUploads() and finishUploads().
+    void stop() {
+        if (!worker.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quit = true;
+            pendingJobs -= queue.size();
+            queue.clear();
+        }
+        wake.notify_all();
+        worker.join();
+        if (context) glfwDestroyWindow(context);
+        context = NULL;
+    }
+
+    bool running() const { return worker.joinable(); }
+    bool sharedContext() const { return shared; }
+
+    void submit(Job job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(std::move(job));
+            pendingJobs++;
+        }
+        wake.notify_all();
+    }
+
+    // Render thread: attach every job whose upload has completed
+    void attachUploads() {
+        std::vector<Job> jobs;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.swap(uploaded);
+        }
+        if (jobs.empty()) return;
+
+        for (Job& job : jobs) {
+            if (!shared && job.upload) job.upload();
+            if (job.attach) job.attach();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        for (Job& job : jobs) attached.push_back(std::move(job));
+    }
+
+    // Main thread: finish every attached job. Returns the number finished.
+    int finishUploads() {
+        std::vector<Job> jobs;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.swap(attached);
+            pendingJobs -= jobs.size();
+        }
+        for (Job& job : jobs) {
+            if (job.finish) job.finish();
+        }
+        return static_cast<int>(jobs.size());
+    }
+
+    // Jobs submitted and not yet finished
+    size_t pending() const { return pendingJobs; }
+
+    uint64_t bytesUploaded() const { return uploadedBytes; }
+
+    // Called from an upload step to account for what it sent
+    void addUploadedBytes(size_t bytes) { uploadedBytes += bytes; }
+
+private:
+    struct InFlight {
+        GLsync fence;
+        Job job;
+    };
+
+    GLFWwindow* context = NULL;
+    bool shared = false;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<Job> queue;              // submitted, not started
+    std::vector<Job> uploaded;          // fence signalled, waiting for attachUploads()
+    std::vector<Job> attached;          // waiting for finishUploads()
+    bool quit = false;
+    std::atomic<size_t> pendingJobs{0};
+    std::atomic<uint64_t> uploadedBytes{0};
+
+    std::deque<InFlight> inFlight;      // upload thread only
+
+    void complete(Job& job) {
+        std::lock_guard<std::mutex> lock(mutex);
+        uploaded.push_back(std::move(job));
+    }
+
+    // Move every job whose fence has signalled on to attach; waits up to timeout on the oldest
+    void retireFences(GLuint64 timeoutNs) {
+        while (!inFlight.empty()) {
+            GLenum result = glClientWaitSync(inFlight.front().fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeoutNs);
+            if (result == GL_TIMEOUT_EXPIRED) return;
+            // GL_WAIT_FAILED leaves nothing to wait for either
+            glDeleteSync(inFlight.front().fence);
+            complete(inFlight.front().job);
+            inFlight.pop_front();
+            timeoutNs = 0;
+        }
+    }
+
+    void run() {
+        const GLuint64 FENCE_POLL_NS = 1000000;
+        for (;;) {
+            Job job;
+            bool haveJob = false;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                if (inFlight.empty()) wake.wait(lock, [this]() { return quit || !queue.empty(); });
+                if (!queue.empty()) {
+                    job = std::move(queue.front());
+                    queue.pop_front();
+                    haveJob = true;
+                } else if (quit && inFlight.empty()) {
+                    return;
+                }
+            }
+
+            if (!haveJob) {
+                retireFences(quit ? GL_TIMEOUT_IGNORED : FENCE_POLL_NS);
+                continue;
+            }
+
+            if (job.prepare) job.prepare();
+            if (!shared) {
+                complete(job);
+                continue;
+            }
+
+            if (job.upload) job.upload();
+            InFlight entry;
+            entry.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            entry.job = std::move(job);
+            glFlush();
+            inFlight.push_back(std::move(entry));
+            retireFences(0);
+        }
+    }
+};
@@ -0,0 +1,177 @@
+// src/vertex_occlusion.h - Ambient occlusion baked into mesh vertices
+//
+// VertexOcclusion::bake() gives every vertex of a mesh the cosine-weighted
+// fraction of its hemisphere that stays open within a distance, so a shader
+// can darken creases and cavities with a single multiply.
+//
+// Rays are traced against the mesh's own BVH (a PathTracer scene holding just
+// that mesh), four at a time: the rays of one vertex share their origin, which
+// keeps a 4-ray packet coherent enough for its SoA box and triangle tests to
+// pay off. Vertices are handed out in blocks to one worker per core.
+//
+// Only the mesh occludes itself. The result belongs to the mesh and is shared
+// by every object drawing it, so neighbours in the scene play no part. The
+// distance is a fraction of the bounding box diagonal, which keeps the result
+// independent of the units a model was authored in.
+//
+// save() and load() keep results next to the mesh's source, keyed by whatever
+// identifies the mesh (the source's content hash) and the settings.
+// No OpenGL here.
+
+#pragma once
+
+#include <math.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "path_tracer.h"
+
+static const char VOCC_MAGIC[4] = { 'V', 'O', 'C', 'C' };
+static const uint32_t VOCC_VERSION = 1;
+
+struct VertexOcclusionFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t key;
+    uint64_t vertexCount;
+};
+
+struct VertexOcclusionSettings {
+    int rays = 64;                          // per vertex, rounded up to whole packets
+    float distance = 0.25f;                 // fraction of the bounding box diagonal
+};
+
+class VertexOcclusion {
+public:
+    static const int RAYS_PER_PACKET = 4;
+    static const size_t VERTICES_PER_BLOCK = 64;
+
+    // One value per vertex, 1 where nothing is in the way. Vertices are stride floats apart,
+    // position first and the normal next to it; vertices without a normal stay at 1.
+    static std::vector<float> bake(const float* vertices, size_t vertexCount, size_t stride,
+                                   const unsigned int* indices, size_t indexCount,
+                                   const VertexOcclusionSettings& settings) {
+        std::vector<float> occlusion(vertexCount, 1.0f);
+        if (vertexCount == 0 || indexCount < 3 || stride < 6) return occlusion;
+
+        PathTracer scene;
+        const float identity[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+        const float white[3] = { 1.0f, 1.0f, 1.0f };
+        scene.addInstance(scene.addMesh(vertices, vertexCount, stride, indices, indexCount), identity, white);
+        PathTracer::Settings sceneSettings;
+        sceneSettings.groundPlane = false;
+        scene.setSettings(sceneSettings);
+        scene.prepare();
+
+        float lo[3] = { INFINITY, INFINITY, INFINITY }, hi[3] = { -INFINITY, -INFINITY, -INFINITY };
+        for (size_t v = 0; v < vertexCount; ++v) {
+            for (int k = 0; k < 3; ++k) {
+                lo[k] = std::min(lo[k], vertices[v * stride + k]);
+                hi[k] = std::max(hi[k], vertices[v * stride + k]);
+            }
+        }
+        float extent[3] = { hi[0] - lo[0], hi[1] - lo[1], hi[2] - lo[2] };
+        const float maxDistance = sqrtf(extent[0] * extent[0] + extent[1] * extent[1] + extent[2] * extent[2]) *
+                                  settings.distance;
+        if (!(maxDistance > 0.0f)) return occlusion;
+
+        const float offset = scene.surfaceOffset();
+        const int packets = std::max(1, (settings.rays + RAYS_PER_PACKET - 1) / RAYS_PER_PACKET);
+        std::atomic<size_t> nextBlock{0};
+        auto work = [&]() {
+            for (;;) {
+                size_t begin = nextBlock.fetch_add(VERTICES_PER_BLOCK);
+                if (begin >= vertexCount) return;
+                size_t end = std::min(vertexCount, begin + VERTICES_PER_BLOCK);
+                for (size_t v = begin; v < end; ++v) {
+                    const float* vertex = vertices + v * stride;
+                    float normal[3] = { vertex[3], vertex[4], vertex[5] };
+                    float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+                    if (!(length > 0.0f)) continue;
+                    for (int k = 0; k < 3; ++k) normal[k] /= length;
+
+                    float origins[RAYS_PER_PACKET * 3], directions[RAYS_PER_PACKET * 3], tMax[RAYS_PER_PACKET];
+                    for (int l = 0; l < RAYS_PER_PACKET; ++l) {
+                        for (int k = 0; k < 3; ++k) origins[l * 3 + k] = vertex[k] + normal[k] * offset;
+                        tMax[l] = maxDistance;
+                    }
+                    uint32_t rng = PathTracer::hashSeed(static_cast<uint32_t>(v), 0x4F434355u);
+                    int open = 0;
+                    for (int p = 0; p < packets; ++p) {
+                        for (int l = 0; l < RAYS_PER_PACKET; ++l) {
+                            PathTracer::sampleHemisphere(normal, rng, &directions[l * 3]);
+                        }
+                        int blocked = scene.occluded4(origins, directions, tMax);
+                        for (int l = 0; l < RAYS_PER_PACKET; ++l) open += (blocked >> l) & 1 ? 0 : 1;
+                    }
+                    occlusion[v] = static_cast<float>(open) / (packets * RAYS_PER_PACKET);
+                }
+            }
+        };
+
+        size_t blocks = (vertexCount + VERTICES_PER_BLOCK - 1) / VERTICES_PER_BLOCK;
+        unsigned int workers = static_cast<unsigned int>(
+            std::min<size_t>(blocks, std::max(1u, std::thread::hardware_concurrency())));
+        std::vector<std::thread> threads;
+        for (unsigned int i = 1; i < workers; ++i) threads.emplace_back(work);
+        work();
+        for (std::thread& thread : threads) thread.join();
+        return occlusion;
+    }
+
+    // Folds the settings into a key that identifies the mesh
+    static uint64_t key(uint64_t meshKey, size_t vertexCount, const VertexOcclusionSettings& settings) {
+        uint64_t hash = meshKey ^ 1469598103934665603ull;
+        auto mix = [&hash](const void* data, size_t bytes) {
+            const uint8_t* p = static_cast<const uint8_t*>(data);
+            for (size_t i = 0; i < bytes; ++i) {
+                hash ^= p[i];
+                hash *= 1099511628211ull;
+            }
+        };
+        uint64_t count = vertexCount;
+        uint32_t version = VOCC_VERSION;
+        mix(&count, sizeof(count));
+        mix(&version, sizeof(version));
+        mix(&settings.rays, sizeof(settings.rays));
+        mix(&settings.distance, sizeof(settings.distance));
+        return hash;
+    }
+
+    static bool save(const std::string& path, uint64_t key, const std::vector<float>& occlusion) {
+        FILE* out = fopen(path.c_str(), "wb");
+        if (!out) return false;
+        VertexOcclusionFileHeader header;
+        memcpy(header.magic, VOCC_MAGIC, sizeof(header.magic));
+        header.version = VOCC_VERSION;
+        header.key = key;
+        header.vertexCount = occlusion.size();
+        bool written = fwrite(&header, sizeof(header), 1, out) == 1 &&
+                       fwrite(occlusion.data(), sizeof(float), occlusion.size(), out) == occlusion.size();
+        written = fclose(out) == 0 && written;
+        if (!written) remove(path.c_str());
+        return written;
+    }
+
+    // False if the file is missing, corrupt, or was baked for another mesh or other settings
+    static bool load(const std::string& path, uint64_t key, size_t vertexCount, std::vector<float>& occlusion) {
+        FILE* in = fopen(path.c_str(), "rb");
+        if (!in) return false;
+        VertexOcclusionFileHeader header;
+        bool valid = fread(&header, sizeof(header), 1, in) == 1 &&
+                     memcmp(header.magic, VOCC_MAGIC, sizeof(header.magic)) == 0 &&
+                     header.version == VOCC_VERSION && header.key == key && header.vertexCount == vertexCount;
+        if (valid) {
+            occlusion.resize(vertexCount);
+            valid = fread(occlusion.data(), sizeof(float), vertexCount, in) == vertexCount;
+        }
+        fclose(in);
+        return valid;
+    }
+};